@@ -0,0 +1,144 @@
+/*
+ * Copyright 2013 Google Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+/*
+ * Implementation for a simple region allocator.
+ */
+
+#include "arena.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "assert.h"
+
+/* Most parsed scripts fit in one or two blocks of this size. */
+#define ARENA_BLOCK_BYTES	(64 * 1024)
+
+/* Every allocation is rounded up to a multiple of this. */
+#define ARENA_ALIGN		16
+
+/* Memory is carved off the front of a chain of blocks. Requests too
+ * big to share a block get a block of their own.
+ */
+struct arena_block {
+	struct arena_block *next;	/* the block filled before this one */
+	size_t size;			/* bytes in data[] */
+	size_t used;			/* bytes of data[] handed out */
+	char data[] __aligned(ARENA_ALIGN);
+};
+
+struct arena {
+	struct arena_block *blocks;	/* the block we carve from, first */
+};
+
+struct arena *arena_new(void)
+{
+	struct arena *arena = calloc(1, sizeof(struct arena));
+
+	assert(arena != NULL);
+	return arena;
+}
+
+void arena_free(struct arena *arena)
+{
+	struct arena_block *block, *next;
+
+	if (arena == NULL)
+		return;
+	for (block = arena->blocks; block != NULL; block = next) {
+		next = block->next;
+		free(block);
+	}
+	free(arena);
+}
+
+static struct arena_block *arena_block_new(size_t size)
+{
+	struct arena_block *block = malloc(sizeof(*block) + size);
+
+	assert(block != NULL);
+	block->next = NULL;
+	block->size = size;
+	block->used = 0;
+	return block;
+}
+
+void *arena_alloc(struct arena *arena, size_t bytes)
+{
+	struct arena_block *block = arena->blocks;
+	void *p;
+
+	bytes = (bytes + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+	if (block == NULL || block->size - block->used < bytes) {
+		if (bytes > ARENA_BLOCK_BYTES / 4 && block != NULL) {
+			/* Put a big one behind the current block, so we
+			 * keep carving from the current block afterward.
+			 */
+			struct arena_block *big = arena_block_new(bytes);
+
+			big->next = block->next;
+			block->next = big;
+			block = big;
+		} else {
+			block = arena_block_new(bytes > ARENA_BLOCK_BYTES ?
+						bytes : ARENA_BLOCK_BYTES);
+			block->next = arena->blocks;
+			arena->blocks = block;
+		}
+	}
+	p = block->data + block->used;
+	block->used += bytes;
+	memset(p, 0, bytes);
+	return p;
+}
+
+char *arena_strndup(struct arena *arena, const char *s, size_t n)
+{
+	size_t len = strnlen(s, n);
+	char *copy = arena_alloc(arena, len + 1);
+
+	memcpy(copy, s, len);
+	copy[len] = '\0';
+	return copy;
+}
+
+char *arena_strdup(struct arena *arena, const char *s)
+{
+	return arena_strndup(arena, s, strlen(s));
+}
+
+char *arena_asprintf(struct arena *arena, const char *format, ...)
+{
+	va_list ap;
+	char *s;
+	int len;
+
+	va_start(ap, format);
+	len = vsnprintf(NULL, 0, format, ap);
+	va_end(ap);
+	assert(len >= 0);
+
+	s = arena_alloc(arena, len + 1);
+	va_start(ap, format);
+	vsnprintf(s, len + 1, format, ap);
+	va_end(ap);
+	return s;
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2013 Google Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+/*
+ * Interface for a simple region allocator. Everything allocated from
+ * an arena is released at once by arena_free(), so a data structure
+ * with many small nodes (such as a parsed script) can be freed without
+ * walking it, and its nodes must never be passed to free().
+ */
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include "types.h"
+
+#include <stdarg.h>
+
+struct arena;
+
+/* Allocate and initialize an empty arena. */
+extern struct arena *arena_new(void);
+
+/* Free the arena and everything allocated from it. NULL is a no-op. */
+extern void arena_free(struct arena *arena);
+
+/* Return 'bytes' of zeroed memory, aligned for any type. */
+extern void *arena_alloc(struct arena *arena, size_t bytes);
+
+/* Return a copy of the NUL-terminated string 's'. */
+extern char *arena_strdup(struct arena *arena, const char *s);
+
+/* Return a NUL-terminated copy of at most 'n' bytes of 's'. */
+extern char *arena_strndup(struct arena *arena, const char *s, size_t n);
+
+/* Return a newly formatted string, as for asprintf(). */
+extern char *arena_asprintf(struct arena *arena, const char *format, ...)
+	__attribute__((format(printf, 2, 3)));
+
+#endif /* __ARENA_H__ */
@@ -24,31 +24,188 @@
 
 #include "checksum.h"
 
+#include <pthread.h>
 #include <stdint.h>
+#include <string.h>
 #include "assert.h"
+#include "logging.h"
+
+/* Add a 64-bit value to a one's complement running sum, folding the
+ * carry out of the top bit back into the bottom (RFC 1071).
+ */
+static inline u64 add_with_carry(u64 sum, u64 value)
+{
+	sum += value;
+	return sum + (sum < value);
+}
+
+/* The routines below each add the given bytes, whose count must be a
+ * multiple of 4, to a running one's complement sum. Thanks to the
+ * byte-order and word-size independence of the one's complement sum
+ * (RFC 1071) they are free to load as many bytes at a time as they
+ * like, and we use unaligned loads so that any buffer address works.
+ */
+
+static u64 ip_checksum_words_scalar(const u8 *p, size_t len, u64 sum)
+{
+	u64 word64;
+	u32 word32;
+
+	/* Main loop: 64 bits at a time. */
+	for (; len >= sizeof(word64); len -= sizeof(word64)) {
+		memcpy(&word64, p, sizeof(word64));
+		sum = add_with_carry(sum, word64);
+		p += sizeof(word64);
+	}
+	if (len >= sizeof(word32)) {
+		memcpy(&word32, p, sizeof(word32));
+		sum = add_with_carry(sum, word32);
+	}
+	return sum;
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+
+#include <immintrin.h>
+
+/* SSE2 is part of the x86-64 baseline, so this needs no CPU check.
+ * We widen each 32-bit lane to 64 bits before adding, so the lanes
+ * cannot overflow for any buffer smaller than 16GB.
+ */
+static u64 ip_checksum_words_sse2(const u8 *p, size_t len, u64 sum)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i acc = _mm_setzero_si128();
+	u64 lanes[2];
+
+	for (; len >= 16; len -= 16, p += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)p);
+
+		acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, zero));
+		acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(v, zero));
+	}
+	_mm_storeu_si128((__m128i *)lanes, acc);
+	sum = add_with_carry(sum, lanes[0]);
+	sum = add_with_carry(sum, lanes[1]);
+	return ip_checksum_words_scalar(p, len, sum);
+}
+
+__attribute__((target("avx2")))
+static u64 ip_checksum_words_avx2(const u8 *p, size_t len, u64 sum)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i acc0 = _mm256_setzero_si256();
+	__m256i acc1 = _mm256_setzero_si256();
+	u64 lanes[4];
+	int i;
+
+	/* Two independent accumulators hide the latency of the adds. */
+	for (; len >= 64; len -= 64, p += 64) {
+		__m256i v0 = _mm256_loadu_si256((const __m256i *)p);
+		__m256i v1 = _mm256_loadu_si256((const __m256i *)(p + 32));
+
+		acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(v0, zero));
+		acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(v0, zero));
+		acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(v1, zero));
+		acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(v1, zero));
+	}
+	_mm256_storeu_si256((__m256i *)lanes, _mm256_add_epi64(acc0, acc1));
+	for (i = 0; i < 4; ++i)
+		sum = add_with_carry(sum, lanes[i]);
+	return ip_checksum_words_sse2(p, len, sum);
+}
+
+#endif  /* __x86_64__ && __GNUC__ */
+
+struct ip_checksum_impl {
+	const char *name;
+	u64 (*sum_words)(const u8 *p, size_t len, u64 sum);
+	bool (*is_supported)(void);
+};
+
+static bool always_supported(void)
+{
+	return true;
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+static bool avx2_supported(void)
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0;
+}
+#endif
+
+/* Available implementations, best first. */
+static const struct ip_checksum_impl ip_checksum_impls[] = {
+#if defined(__x86_64__) && defined(__GNUC__)
+	{ "avx2",	ip_checksum_words_avx2,		avx2_supported },
+	{ "sse2",	ip_checksum_words_sse2,		always_supported },
+#endif
+	{ "scalar",	ip_checksum_words_scalar,	always_supported },
+};
+
+/* The implementation in use, picked on first use. */
+static const struct ip_checksum_impl *ip_checksum_impl;
+
+static const struct ip_checksum_impl *ip_checksum_get_impl(void)
+{
+	int i;
+
+	if (ip_checksum_impl != NULL)
+		return ip_checksum_impl;
+	for (i = 0; i < ARRAY_SIZE(ip_checksum_impls); ++i) {
+		if (ip_checksum_impls[i].is_supported()) {
+			ip_checksum_impl = &ip_checksum_impls[i];
+			break;
+		}
+	}
+	assert(ip_checksum_impl != NULL);
+	return ip_checksum_impl;
+}
+
+int ip_checksum_select(const char *name)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(ip_checksum_impls); ++i) {
+		if (strcmp(ip_checksum_impls[i].name, name) == 0 &&
+		    ip_checksum_impls[i].is_supported()) {
+			ip_checksum_impl = &ip_checksum_impls[i];
+			return STATUS_OK;
+		}
+	}
+	return STATUS_ERR;
+}
+
+const char *ip_checksum_selected(void)
+{
+	return ip_checksum_get_impl()->name;
+}
 
 /* Add bytes in buffer to a running checksum. Returns the new
  * intermediate checksum. Use ip_checksum_fold() to convert the
- * intermediate checksum to final form.
+ * intermediate checksum to final form. The buffer need not be aligned.
  */
 static u64 ip_checksum_partial(const void *p, size_t len, u64 sum)
 {
-	assert(((uintptr_t)p & 0x03) == 0);
-	/* Main loop: 32 bits at a time. */
-	const u32 *p32 = (const u32 *)(p);
-	for (; len >= sizeof(*p32); len -= sizeof(*p32))
-		sum += *p32++;
+	const u8 *p8 = p;
+	const size_t words_len = len & ~(size_t)0x03;
+	u16 word16;
+
+	sum = ip_checksum_get_impl()->sum_words(p8, words_len, sum);
+	p8 += words_len;
+	len -= words_len;
 
 	/* Handle un-32bit-aligned trailing bytes */
-	const u16 *p16 = (const u16 *)(p32);
 	if (len >= 2) {
-		sum += *p16++;
-		len -= sizeof(*p16);
-	}
-	if (len > 0) {
-		const u8 *p8 = (const u8 *)(p16);
-		sum += ntohs(*p8 << 8);	/* RFC says pad last byte */
+		memcpy(&word16, p8, sizeof(word16));
+		sum = add_with_carry(sum, word16);
+		p8 += sizeof(word16);
+		len -= sizeof(word16);
 	}
+	if (len > 0)
+		sum = add_with_carry(sum, ntohs(*p8 << 8)); /* RFC says pad last byte */
 
 	return sum;
 }
@@ -167,89 +324,252 @@ __be16 udplite_v6_checksum(const struct in6_addr *src_ip,
 	return ip_checksum_fold(sum);
 }
 
-#define CRC32C(c, d) (c = (c>>8) ^ crc_c[(c^(d))&0xFF])
-
-static u32 crc_c[256] = {
-	0x00000000, 0xF26B8303, 0xE13B70F7, 0x1350F3F4,
-	0xC79A971F, 0x35F1141C, 0x26A1E7E8, 0xD4CA64EB,
-	0x8AD958CF, 0x78B2DBCC, 0x6BE22838, 0x9989AB3B,
-	0x4D43CFD0, 0xBF284CD3, 0xAC78BF27, 0x5E133C24,
-	0x105EC76F, 0xE235446C, 0xF165B798, 0x030E349B,
-	0xD7C45070, 0x25AFD373, 0x36FF2087, 0xC494A384,
-	0x9A879FA0, 0x68EC1CA3, 0x7BBCEF57, 0x89D76C54,
-	0x5D1D08BF, 0xAF768BBC, 0xBC267848, 0x4E4DFB4B,
-	0x20BD8EDE, 0xD2D60DDD, 0xC186FE29, 0x33ED7D2A,
-	0xE72719C1, 0x154C9AC2, 0x061C6936, 0xF477EA35,
-	0xAA64D611, 0x580F5512, 0x4B5FA6E6, 0xB93425E5,
-	0x6DFE410E, 0x9F95C20D, 0x8CC531F9, 0x7EAEB2FA,
-	0x30E349B1, 0xC288CAB2, 0xD1D83946, 0x23B3BA45,
-	0xF779DEAE, 0x05125DAD, 0x1642AE59, 0xE4292D5A,
-	0xBA3A117E, 0x4851927D, 0x5B016189, 0xA96AE28A,
-	0x7DA08661, 0x8FCB0562, 0x9C9BF696, 0x6EF07595,
-	0x417B1DBC, 0xB3109EBF, 0xA0406D4B, 0x522BEE48,
-	0x86E18AA3, 0x748A09A0, 0x67DAFA54, 0x95B17957,
-	0xCBA24573, 0x39C9C670, 0x2A993584, 0xD8F2B687,
-	0x0C38D26C, 0xFE53516F, 0xED03A29B, 0x1F682198,
-	0x5125DAD3, 0xA34E59D0, 0xB01EAA24, 0x42752927,
-	0x96BF4DCC, 0x64D4CECF, 0x77843D3B, 0x85EFBE38,
-	0xDBFC821C, 0x2997011F, 0x3AC7F2EB, 0xC8AC71E8,
-	0x1C661503, 0xEE0D9600, 0xFD5D65F4, 0x0F36E6F7,
-	0x61C69362, 0x93AD1061, 0x80FDE395, 0x72966096,
-	0xA65C047D, 0x5437877E, 0x4767748A, 0xB50CF789,
-	0xEB1FCBAD, 0x197448AE, 0x0A24BB5A, 0xF84F3859,
-	0x2C855CB2, 0xDEEEDFB1, 0xCDBE2C45, 0x3FD5AF46,
-	0x7198540D, 0x83F3D70E, 0x90A324FA, 0x62C8A7F9,
-	0xB602C312, 0x44694011, 0x5739B3E5, 0xA55230E6,
-	0xFB410CC2, 0x092A8FC1, 0x1A7A7C35, 0xE811FF36,
-	0x3CDB9BDD, 0xCEB018DE, 0xDDE0EB2A, 0x2F8B6829,
-	0x82F63B78, 0x709DB87B, 0x63CD4B8F, 0x91A6C88C,
-	0x456CAC67, 0xB7072F64, 0xA457DC90, 0x563C5F93,
-	0x082F63B7, 0xFA44E0B4, 0xE9141340, 0x1B7F9043,
-	0xCFB5F4A8, 0x3DDE77AB, 0x2E8E845F, 0xDCE5075C,
-	0x92A8FC17, 0x60C37F14, 0x73938CE0, 0x81F80FE3,
-	0x55326B08, 0xA759E80B, 0xB4091BFF, 0x466298FC,
-	0x1871A4D8, 0xEA1A27DB, 0xF94AD42F, 0x0B21572C,
-	0xDFEB33C7, 0x2D80B0C4, 0x3ED04330, 0xCCBBC033,
-	0xA24BB5A6, 0x502036A5, 0x4370C551, 0xB11B4652,
-	0x65D122B9, 0x97BAA1BA, 0x84EA524E, 0x7681D14D,
-	0x2892ED69, 0xDAF96E6A, 0xC9A99D9E, 0x3BC21E9D,
-	0xEF087A76, 0x1D63F975, 0x0E330A81, 0xFC588982,
-	0xB21572C9, 0x407EF1CA, 0x532E023E, 0xA145813D,
-	0x758FE5D6, 0x87E466D5, 0x94B49521, 0x66DF1622,
-	0x38CC2A06, 0xCAA7A905, 0xD9F75AF1, 0x2B9CD9F2,
-	0xFF56BD19, 0x0D3D3E1A, 0x1E6DCDEE, 0xEC064EED,
-	0xC38D26C4, 0x31E6A5C7, 0x22B65633, 0xD0DDD530,
-	0x0417B1DB, 0xF67C32D8, 0xE52CC12C, 0x1747422F,
-	0x49547E0B, 0xBB3FFD08, 0xA86F0EFC, 0x5A048DFF,
-	0x8ECEE914, 0x7CA56A17, 0x6FF599E3, 0x9D9E1AE0,
-	0xD3D3E1AB, 0x21B862A8, 0x32E8915C, 0xC083125F,
-	0x144976B4, 0xE622F5B7, 0xF5720643, 0x07198540,
-	0x590AB964, 0xAB613A67, 0xB831C993, 0x4A5A4A90,
-	0x9E902E7B, 0x6CFBAD78, 0x7FAB5E8C, 0x8DC0DD8F,
-	0xE330A81A, 0x115B2B19, 0x020BD8ED, 0xF0605BEE,
-	0x24AA3F05, 0xD6C1BC06, 0xC5914FF2, 0x37FACCF1,
-	0x69E9F0D5, 0x9B8273D6, 0x88D28022, 0x7AB90321,
-	0xAE7367CA, 0x5C18E4C9, 0x4F48173D, 0xBD23943E,
-	0xF36E6F75, 0x0105EC76, 0x12551F82, 0xE03E9C81,
-	0x34F4F86A, 0xC69F7B69, 0xD5CF889D, 0x27A40B9E,
-	0x79B737BA, 0x8BDCB4B9, 0x988C474D, 0x6AE7C44E,
-	0xBE2DA0A5, 0x4C4623A6, 0x5F16D052, 0xAD7D5351
+/* CRC32C (Castagnoli), as used by SCTP (RFC 4960, Appendix B). All the
+ * routines below work on the bit-reflected CRC register without the
+ * initial and final inversions, which crc32c_init() and crc32c_final()
+ * take care of.
+ */
+#define CRC32C_POLY	0x82F63B78	/* reflected polynomial */
+
+/* Software tables for slicing-by-8, built on first use. Table 0 is
+ * the classic byte-at-a-time table; table k advances a byte through k
+ * further bytes of zeros, so eight bytes can be folded in at once.
+ * More than one thread may compute checksums, so the tables are built
+ * under pthread_once().
+ */
+static u32 crc32c_table[8][256];
+static pthread_once_t crc32c_table_once = PTHREAD_ONCE_INIT;
+
+static void crc32c_table_init(void)
+{
+	u32 crc;
+	int i, j;
+
+	for (i = 0; i < 256; ++i) {
+		crc = i;
+		for (j = 0; j < 8; ++j)
+			crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLY : 0);
+		crc32c_table[0][i] = crc;
+	}
+	for (i = 0; i < 256; ++i) {
+		crc = crc32c_table[0][i];
+		for (j = 1; j < 8; ++j) {
+			crc = (crc >> 8) ^ crc32c_table[0][crc & 0xff];
+			crc32c_table[j][i] = crc;
+		}
+	}
+}
+
+/* Loads 4 bytes as a little-endian value, whatever the host order. */
+static inline u32 load_le32(const u8 *p)
+{
+	return (u32)p[0] | ((u32)p[1] << 8) |
+	       ((u32)p[2] << 16) | ((u32)p[3] << 24);
+}
+
+static u32 crc32c_update_slice8(u32 crc, const u8 *p, size_t len)
+{
+	const u32 (*t)[256] = crc32c_table;
+	u32 lo, hi;
+
+	if (pthread_once(&crc32c_table_once, crc32c_table_init) != 0)
+		die_perror("pthread_once");
+
+	for (; len >= 8; len -= 8, p += 8) {
+		lo = crc ^ load_le32(p);
+		hi = load_le32(p + 4);
+		crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^
+		      t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+		      t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^
+		      t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+	}
+	for (; len > 0; --len, ++p)
+		crc = (crc >> 8) ^ t[0][(crc ^ *p) & 0xff];
+	return crc;
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+
+/* SSE4.2 has a crc32 instruction for exactly this polynomial, taking 8
+ * bytes per instruction. Unaligned loads cost it nothing on any CPU
+ * that has it, so we do not bother aligning the buffer first.
+ */
+__attribute__((target("sse4.2")))
+static u32 crc32c_update_sse42(u32 crc, const u8 *p, size_t len)
+{
+	u64 crc64 = crc, word;
+
+	for (; len >= 8; len -= 8, p += 8) {
+		memcpy(&word, p, sizeof(word));
+		crc64 = _mm_crc32_u64(crc64, word);
+	}
+	crc = crc64;
+	for (; len > 0; --len, ++p)
+		crc = _mm_crc32_u8(crc, *p);
+	return crc;
+}
+
+/* The crc32 instruction has a latency of 3 cycles but a throughput of
+ * one per cycle, so on long buffers we run three independent streams
+ * over consecutive blocks and then stitch them together. A CRC
+ * register advanced over n bytes of zeros is just the register times
+ * x^(8n) mod P, which we get with one carry-less multiply by a
+ * precomputed constant followed by a crc32 to reduce the product
+ * (which brings in a further factor of x^33, hence the constants are
+ * x^(8n-33) mod P, bit-reflected).
+ */
+struct crc32c_3way {
+	size_t block_bytes;	/* bytes in each of the three blocks */
+	u32 shift_1;		/* x^(8 * block_bytes - 33) mod P */
+	u32 shift_2;		/* x^(16 * block_bytes - 33) mod P */
 };
 
-__be32 sctp_crc32c(const void *packet, u32 len)
+static const struct crc32c_3way crc32c_3way_long  = { 1024, 0x170076fa,
+							      0xa51b6135 };
+static const struct crc32c_3way crc32c_3way_short = {  128, 0x0d3b6092,
+							      0xb9e02b86 };
+
+__attribute__((target("sse4.2,pclmul")))
+static u32 crc32c_shift_pclmul(u32 crc, u32 constant)
+{
+	__m128i product = _mm_clmulepi64_si128(_mm_cvtsi32_si128(crc),
+					       _mm_cvtsi32_si128(constant), 0);
+
+	return _mm_crc32_u64(0, _mm_cvtsi128_si64(product));
+}
+
+__attribute__((target("sse4.2,pclmul")))
+static u32 crc32c_update_3way(u32 crc, const u8 *p, size_t len,
+			      const struct crc32c_3way *way)
+{
+	const size_t block = way->block_bytes;
+	u64 crc0, crc1, crc2, word0, word1, word2;
+	size_t i;
+
+	for (; len >= 3 * block; len -= 3 * block, p += 3 * block) {
+		crc0 = crc;
+		crc1 = 0;
+		crc2 = 0;
+		for (i = 0; i < block; i += 8) {
+			memcpy(&word0, p + i, sizeof(word0));
+			memcpy(&word1, p + block + i, sizeof(word1));
+			memcpy(&word2, p + 2 * block + i, sizeof(word2));
+			crc0 = _mm_crc32_u64(crc0, word0);
+			crc1 = _mm_crc32_u64(crc1, word1);
+			crc2 = _mm_crc32_u64(crc2, word2);
+		}
+		crc = crc32c_shift_pclmul(crc0, way->shift_2) ^
+		      crc32c_shift_pclmul(crc1, way->shift_1) ^ crc2;
+	}
+	return crc;
+}
+
+__attribute__((target("sse4.2,pclmul")))
+static u32 crc32c_update_pclmul(u32 crc, const u8 *p, size_t len)
+{
+	const size_t long_bytes = 3 * crc32c_3way_long.block_bytes;
+	const size_t short_bytes = 3 * crc32c_3way_short.block_bytes;
+	size_t done;
+
+	done = len - len % long_bytes;
+	crc = crc32c_update_3way(crc, p, done, &crc32c_3way_long);
+	p += done;
+	len -= done;
+
+	done = len - len % short_bytes;
+	crc = crc32c_update_3way(crc, p, done, &crc32c_3way_short);
+	p += done;
+	len -= done;
+
+	return crc32c_update_sse42(crc, p, len);
+}
+
+static bool sse42_supported(void)
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse4.2") != 0;
+}
+
+static bool pclmul_supported(void)
+{
+	return sse42_supported() && __builtin_cpu_supports("pclmul") != 0;
+}
+
+#endif  /* __x86_64__ && __GNUC__ */
+
+struct crc32c_impl {
+	const char *name;
+	u32 (*update)(u32 crc, const u8 *p, size_t len);
+	bool (*is_supported)(void);
+};
+
+/* Available implementations, best first. */
+static const struct crc32c_impl crc32c_impls[] = {
+#if defined(__x86_64__) && defined(__GNUC__)
+	{ "pclmul",	crc32c_update_pclmul,	pclmul_supported },
+	{ "sse4.2",	crc32c_update_sse42,	sse42_supported },
+#endif
+	{ "slice8",	crc32c_update_slice8,	always_supported },
+};
+
+/* The implementation in use, picked on first use. */
+static const struct crc32c_impl *crc32c_impl;
+
+static const struct crc32c_impl *crc32c_get_impl(void)
+{
+	int i;
+
+	if (crc32c_impl != NULL)
+		return crc32c_impl;
+	for (i = 0; i < ARRAY_SIZE(crc32c_impls); ++i) {
+		if (crc32c_impls[i].is_supported()) {
+			crc32c_impl = &crc32c_impls[i];
+			break;
+		}
+	}
+	assert(crc32c_impl != NULL);
+	return crc32c_impl;
+}
+
+int crc32c_select(const char *name)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(crc32c_impls); ++i) {
+		if (strcmp(crc32c_impls[i].name, name) == 0 &&
+		    crc32c_impls[i].is_supported()) {
+			crc32c_impl = &crc32c_impls[i];
+			return STATUS_OK;
+		}
+	}
+	return STATUS_ERR;
+}
+
+const char *crc32c_selected(void)
+{
+	return crc32c_get_impl()->name;
+}
+
+u32 crc32c_update(u32 crc, const void *buf, size_t len)
+{
+	return crc32c_get_impl()->update(crc, buf, len);
+}
+
+__be32 crc32c_final(u32 crc)
 {
-	u32 i, crc32c;
 	u8 byte0, byte1, byte2, byte3;
-	const u8 *buf = (const u8 *)packet;
-
-	crc32c = ~0;
-	for (i = 0; i < len; i++)
-		CRC32C(crc32c, buf[i]);
-	crc32c = ~crc32c;
-	byte0  = crc32c & 0xff;
-	byte1  = (crc32c>>8) & 0xff;
-	byte2  = (crc32c>>16) & 0xff;
-	byte3  = (crc32c>>24) & 0xff;
-	crc32c = ((byte0 << 24) | (byte1 << 16) | (byte2 << 8) | byte3);
-	return htonl(crc32c);
+
+	/* SCTP transmits the reflected CRC least significant byte first. */
+	crc = ~crc;
+	byte0 = crc & 0xff;
+	byte1 = (crc >> 8) & 0xff;
+	byte2 = (crc >> 16) & 0xff;
+	byte3 = (crc >> 24) & 0xff;
+	crc = ((byte0 << 24) | (byte1 << 16) | (byte2 << 8) | byte3);
+	return htonl(crc);
+}
+
+__be32 sctp_crc32c(const void *packet, u32 len)
+{
+	return crc32c_final(crc32c_update(crc32c_init(), packet, len));
 }
@@ -28,6 +28,7 @@
 #include "types.h"
 
 #include <netinet/in.h>
+#include <string.h>
 #include <sys/types.h>
 
 /* IPv4 ... */
@@ -57,9 +58,114 @@ extern __be16 udplite_v6_checksum(const struct in6_addr *src_ip,
 				  u8 protocol, const void *payload,
 				  u32 len, u16 cov);
 
+/* The one's complement sum behind all the checksums above has several
+ * implementations (e.g. "avx2", "sse2", "scalar"). By default we use
+ * the fastest one this CPU supports. ip_checksum_select() forces the
+ * named one instead, returning STATUS_ERR if it is unavailable; this
+ * is mainly for tests and benchmarks.
+ */
+extern int ip_checksum_select(const char *name);
+
+/* Returns the name of the implementation currently in use. */
+extern const char *ip_checksum_selected(void);
+
 /* SCTP ... */
 
 /* Calculates the CRC32C checksum used by SCTP (in network byte order). */
 extern __be32 sctp_crc32c(const void *packet, u32 len);
 
+/* The same CRC32C, computed incrementally over several buffers:
+ *
+ *   u32 crc = crc32c_init();
+ *   crc = crc32c_update(crc, buf1, len1);
+ *   crc = crc32c_update(crc, buf2, len2);
+ *   sctp->crc32c = crc32c_final(crc);
+ */
+static inline u32 crc32c_init(void)
+{
+	return ~0U;
+}
+
+/* Adds 'len' bytes at 'buf' (which need not be aligned) to 'crc'. */
+extern u32 crc32c_update(u32 crc, const void *buf, size_t len);
+
+/* Returns the CRC32C ready to store in an SCTP common header. */
+extern __be32 crc32c_final(u32 crc);
+
+/* As for ip_checksum_select(), there are several CRC32C implementations
+ * (e.g. "pclmul", "sse4.2", "slice8"); by default we use the fastest
+ * one this CPU supports, and crc32c_select() forces the named one.
+ */
+extern int crc32c_select(const char *name);
+
+/* Returns the name of the CRC32C implementation currently in use. */
+extern const char *crc32c_selected(void);
+
+/* Incremental updates ...
+ *
+ * When a field covered by an Internet checksum changes from 'old' to
+ * 'new', the checksum HC can be fixed up without re-reading the rest
+ * of the data as HC' = ~(~HC + ~old + new) (RFC 1624, eqn. 3). The
+ * one's complement sum is byte-order independent, so all values here
+ * are passed exactly as they are stored in the packet.
+ */
+
+/* Folds a 32-bit one's complement sum into 16 bits. */
+static inline u16 checksum_fold(u32 sum)
+{
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+	return sum;
+}
+
+/* Returns the one's complement sum of (new - old) over the 'len'
+ * bytes (an even number) of a field that changed from 'old_bytes' to
+ * 'new_bytes'. Neither buffer needs to be aligned.
+ */
+static inline u16 checksum_delta(const void *old_bytes,
+				 const void *new_bytes, int len)
+{
+	const u8 *old_p = old_bytes, *new_p = new_bytes;
+	u32 sum = 0;
+	u16 old_word, new_word;
+	int i;
+
+	assert((len % 2) == 0);
+	for (i = 0; i < len; i += 2) {
+		memcpy(&old_word, old_p + i, sizeof(old_word));
+		memcpy(&new_word, new_p + i, sizeof(new_word));
+		sum += (u16)~old_word + new_word;
+	}
+	return checksum_fold(sum);
+}
+
+/* Returns checksum 'check' adjusted by a delta from checksum_delta().
+ * If the changed field starts at an odd byte offset within the
+ * checksummed data then its bytes straddle the 16-bit words of the
+ * sum, and the delta is byte-swapped to match.
+ */
+static inline __sum16 checksum_apply_delta(__sum16 check, u16 delta,
+					   bool odd_offset)
+{
+	if (odd_offset)
+		delta = (delta << 8) | (delta >> 8);
+	return ~checksum_fold((u16)~check + delta);
+}
+
+/* Returns 'check' updated for an aligned 16-bit field changing. */
+static inline __sum16 checksum_replace16(__sum16 check,
+					 u16 old_val, u16 new_val)
+{
+	return ~checksum_fold((u16)~check + (u16)~old_val + new_val);
+}
+
+/* Returns 'check' updated for an aligned 32-bit field changing. */
+static inline __sum16 checksum_replace32(__sum16 check,
+					 u32 old_val, u32 new_val)
+{
+	return ~checksum_fold((u16)~check +
+			      (u16)~old_val + (u16)~(old_val >> 16) +
+			      (u16)new_val + (u16)(new_val >> 16));
+}
+
 #endif /* __CHECKSUM_H__ */
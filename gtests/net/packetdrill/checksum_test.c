@@ -25,6 +25,8 @@
 #include "checksum.h"
 
 #include <arpa/inet.h>
+#include <stdlib.h>
+#include <sys/time.h>
 #include "assert.h"
 #include "ip.h"
 #include "ipv6.h"
@@ -190,6 +192,211 @@ static void test_udplite_v6_checksum(void)
 	assert(checksum == 0x4efd);
 }
 
+/* Names of all the one's complement sum implementations to try. */
+static const char *checksum_impls[] = { "avx2", "sse2", "scalar" };
+
+/* A straightforward RFC 1071 checksum over 16-bit big-endian words,
+ * as a reference for the optimized implementations.
+ */
+static u16 reference_checksum(const u8 *data, size_t len)
+{
+	u32 sum = 0;
+	size_t i;
+
+	for (i = 0; i + 1 < len; i += 2)
+		sum += (data[i] << 8) | data[i + 1];
+	if (len & 1)
+		sum += data[len - 1] << 8;
+	while (sum >> 16)
+		sum = (sum >> 16) + (sum & 0xffff);
+	return ~sum;
+}
+
+/* Check every implementation against the reference, for all buffer
+ * alignments and for lengths that exercise each tail case.
+ */
+static void test_checksum_implementations(void)
+{
+	u8 data[1024 + 8] __aligned(8);
+	size_t offset, len;
+	int i;
+
+	srandom(1);
+	for (i = 0; i < sizeof(data); ++i)
+		data[i] = random();
+	/* Make sure the end-around carry gets exercised. */
+	memset(data + 512, 0xff, 256);
+
+	for (i = 0; i < ARRAY_SIZE(checksum_impls); ++i) {
+		if (ip_checksum_select(checksum_impls[i]) != STATUS_OK)
+			continue;
+		for (offset = 0; offset < 8; ++offset) {
+			for (len = 0; len <= 1024; len += (len < 160) ? 1 : 61) {
+				u16 expected = reference_checksum(data + offset,
+								  len);
+				u16 actual = ntohs(ipv4_checksum(data + offset,
+								 len));
+				assert(actual == expected);
+			}
+		}
+	}
+	assert(ip_checksum_select("no_such_impl") == STATUS_ERR);
+}
+
+/* Check that RFC 1624 incremental updates agree with a full
+ * re-checksum, for fields at both even and odd byte offsets.
+ */
+static void test_incremental_checksum(void)
+{
+	u8 data[64] __aligned(4);
+	u8 old_bytes[16];
+	int offset, len, i;
+
+	srandom(2);
+	for (i = 0; i < sizeof(data); ++i)
+		data[i] = random();
+
+	for (len = 2; len <= 16; len *= 2) {
+		for (offset = 0; offset + len <= sizeof(data); ++offset) {
+			__sum16 check = ipv4_checksum(data, sizeof(data));
+			u16 delta;
+
+			memcpy(old_bytes, data + offset, len);
+			for (i = 0; i < len; ++i)
+				data[offset + i] = random();
+			delta = checksum_delta(old_bytes, data + offset, len);
+			check = checksum_apply_delta(check, delta,
+						     (offset % 2) != 0);
+			assert(check == ipv4_checksum(data, sizeof(data)));
+		}
+	}
+
+	/* Aligned 16-bit and 32-bit fields. */
+	for (offset = 0; offset + 4 <= sizeof(data); offset += 4) {
+		__sum16 check = ipv4_checksum(data, sizeof(data));
+		u32 old_val, new_val = random();
+		u16 old_val16, new_val16 = random();
+
+		memcpy(&old_val, data + offset, sizeof(old_val));
+		memcpy(data + offset, &new_val, sizeof(new_val));
+		check = checksum_replace32(check, old_val, new_val);
+		assert(check == ipv4_checksum(data, sizeof(data)));
+
+		memcpy(&old_val16, data + offset + 2, sizeof(old_val16));
+		memcpy(data + offset + 2, &new_val16, sizeof(new_val16));
+		check = checksum_replace16(check, old_val16, new_val16);
+		assert(check == ipv4_checksum(data, sizeof(data)));
+	}
+}
+
+/* Names of all the CRC32C implementations to try. */
+static const char *crc32c_impls[] = { "pclmul", "sse4.2", "slice8" };
+
+/* A bit-at-a-time CRC32C, as a reference for the optimized ones. */
+static u32 reference_crc32c(const u8 *data, size_t len)
+{
+	u32 crc = ~0U;
+	size_t i;
+	int bit;
+
+	for (i = 0; i < len; ++i) {
+		crc ^= data[i];
+		for (bit = 0; bit < 8; ++bit)
+			crc = (crc >> 1) ^ ((crc & 1) ? 0x82F63B78 : 0);
+	}
+	return ~crc;
+}
+
+/* Check every CRC32C implementation against the reference, for all
+ * buffer alignments and for lengths on both sides of the block sizes
+ * of the three-way hardware path, and check that computing it in
+ * pieces gives the same result as in one go.
+ */
+static void test_crc32c_implementations(void)
+{
+	static u8 data[8192 + 8] __aligned(8);
+	size_t offset, len, split;
+	int i;
+
+	srandom(3);
+	for (i = 0; i < sizeof(data); ++i)
+		data[i] = random();
+
+	for (i = 0; i < ARRAY_SIZE(crc32c_impls); ++i) {
+		if (crc32c_select(crc32c_impls[i]) != STATUS_OK)
+			continue;
+		for (offset = 0; offset < 8; ++offset) {
+			for (len = 0; len <= 8192;
+			     len += (len < 400) ? 1 : 127) {
+				__be32 expected, actual;
+				u32 crc = reference_crc32c(data + offset, len);
+
+				expected = htonl(__builtin_bswap32(crc));
+				actual = sctp_crc32c(data + offset, len);
+				assert(actual == expected);
+
+				split = len / 3;
+				crc = crc32c_update(crc32c_init(),
+						    data + offset, split);
+				crc = crc32c_update(crc, data + offset + split,
+						    len - split);
+				assert(crc32c_final(crc) == expected);
+			}
+		}
+	}
+	assert(crc32c_select("no_such_impl") == STATUS_ERR);
+}
+
+/* Print the throughput of each implementation on 64KB buffers, the
+ * size of the largest (TSO) packets we checksum.
+ */
+static void benchmark_checksum_implementations(void)
+{
+	const int buffer_bytes = 64 * 1024;
+	const int iterations = 2000;
+	u8 *data = malloc(buffer_bytes + 1);
+	struct timeval start, end;
+	volatile u16 checksum;
+	int i, j;
+
+	for (i = 0; i < buffer_bytes + 1; ++i)
+		data[i] = i;
+
+	for (i = 0; i < ARRAY_SIZE(checksum_impls); ++i) {
+		double usecs;
+
+		if (ip_checksum_select(checksum_impls[i]) != STATUS_OK)
+			continue;
+		gettimeofday(&start, NULL);
+		for (j = 0; j < iterations; ++j)	/* deliberately unaligned */
+			checksum = ipv4_checksum(data + 1, buffer_bytes);
+		gettimeofday(&end, NULL);
+		usecs = (end.tv_sec - start.tv_sec) * 1000000.0 +
+			(end.tv_usec - start.tv_usec);
+		printf("checksum %-6s: %8.1f MB/s\n", checksum_impls[i],
+		       (double)buffer_bytes * iterations / (usecs > 0 ? usecs : 1));
+	}
+	(void)checksum;
+
+	for (i = 0; i < ARRAY_SIZE(crc32c_impls); ++i) {
+		volatile __be32 crc32c;
+		double usecs;
+
+		if (crc32c_select(crc32c_impls[i]) != STATUS_OK)
+			continue;
+		gettimeofday(&start, NULL);
+		for (j = 0; j < iterations; ++j)
+			crc32c = sctp_crc32c(data + 1, buffer_bytes);
+		gettimeofday(&end, NULL);
+		usecs = (end.tv_sec - start.tv_sec) * 1000000.0 +
+			(end.tv_usec - start.tv_usec);
+		printf("crc32c   %-6s: %8.1f MB/s\n", crc32c_impls[i],
+		       (double)buffer_bytes * iterations / (usecs > 0 ? usecs : 1));
+		(void)crc32c;
+	}
+	free(data);
+}
+
 int main(void)
 {
 	test_tcp_udp_v4_checksum();
@@ -198,5 +405,9 @@ int main(void)
 	test_sctp_crc32c();
 	test_udplite_v4_checksum();
 	test_udplite_v6_checksum();
+	test_checksum_implementations();
+	test_incremental_checksum();
+	test_crc32c_implementations();
+	benchmark_checksum_implementations();
 	return 0;
 }
@@ -22,6 +22,7 @@
  * Helper functions for configuration information for a test run.
  */
 
+#include <pthread.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <unistd.h>
@@ -60,6 +61,16 @@ enum option_codes {
 	OPT_DRY_RUN,
 	OPT_DEBUG,
 	OPT_UDP_ENCAPS,
+	OPT_PCAP_OUT,
+	OPT_REPLAY,
+	OPT_STATS_JSON,
+#if defined(linux)
+	OPT_PARALLEL,
+	OPT_PACKET_RING,
+	OPT_TUN_NAPI,
+	OPT_NETNS,
+	OPT_SCRIPT_CACHE,
+#endif
 #if defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
 	OPT_TUN_DEV,
 	OPT_PERSISTENT_TUN_DEV,
@@ -97,6 +108,16 @@ struct option options[] = {
 	{ "verbose",		.has_arg = false, NULL, OPT_VERBOSE },
 	{ "debug",		.has_arg = false, NULL, OPT_DEBUG },
 	{ "udp_encapsulation",	.has_arg = true,  NULL, OPT_UDP_ENCAPS },
+	{ "pcap_out",		.has_arg = true,  NULL, OPT_PCAP_OUT },
+	{ "replay",		.has_arg = true,  NULL, OPT_REPLAY },
+	{ "stats_json",		.has_arg = true,  NULL, OPT_STATS_JSON },
+#if defined(linux)
+	{ "parallel",		.has_arg = true,  NULL, OPT_PARALLEL },
+	{ "packet_ring",	.has_arg = false, NULL, OPT_PACKET_RING },
+	{ "tun_napi",		.has_arg = false, NULL, OPT_TUN_NAPI },
+	{ "netns",		.has_arg = false, NULL, OPT_NETNS },
+	{ "script_cache",	.has_arg = true,  NULL, OPT_SCRIPT_CACHE },
+#endif
 #if defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
 	{ "tun_dev",		.has_arg = true,  NULL, OPT_TUN_DEV },
 	{ "persistent_tun_dev",	.has_arg = false, NULL, OPT_PERSISTENT_TUN_DEV },
@@ -134,6 +155,16 @@ void show_usage(void)
 		"\t[--verbose|-v]\n"
 		"\t[--debug] * requires compilation with DEBUG *\n"
 		"\t[--udp_encapsulation=[sctp,tcp]]\n"
+		"\t[--pcap_out=<pcapng file to record packets to>]\n"
+		"\t[--replay=<pcap or pcapng file to check the script against>]\n"
+		"\t[--stats_json=<file to append per-script timing stats to>]\n"
+#if defined(linux)
+		"\t[--parallel=<max number of scripts to run concurrently>]\n"
+		"\t[--packet_ring]\n"
+		"\t[--tun_napi]\n"
+		"\t[--netns]\n"
+		"\t[--script_cache=<directory to keep compiled scripts in>]\n"
+#endif
 #if defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
 		"\t[--tun_dev=<tun_dev_name>]\n"
 		"\t[--persistent_tun_dev]\n"
@@ -224,6 +255,7 @@ void set_default_config(struct config *config)
 	config->tolerance_usecs		= 4000;
 	config->speed			= TUN_DRIVER_SPEED_CUR;
 	config->mtu			= TUN_DRIVER_DEFAULT_MTU;
+	config->parallel		= 1;
 
 	/* For now, by default we disable checks of outbound TS val
 	 * values, since there are timestamp val bugs in the tests and
@@ -518,6 +550,15 @@ static void process_option(int opt, char *optarg, struct config *config,
 	case OPT_DRY_RUN:
 		config->dry_run = true;
 		break;
+	case OPT_PCAP_OUT:
+		config->pcap_out = strdup(optarg);
+		break;
+	case OPT_REPLAY:
+		config->replay = strdup(optarg);
+		break;
+	case OPT_STATS_JSON:
+		config->stats_json = strdup(optarg);
+		break;
 	case OPT_DEFINE:
 		equals = strstr(optarg, "=");
 		if (equals == optarg || equals == NULL)
@@ -543,6 +584,25 @@ static void process_option(int opt, char *optarg, struct config *config,
 		else
 			die("%s: bad --udp_encapsulation: %s\n", where, optarg);
 		break;
+#if defined(linux)
+	case OPT_PARALLEL:
+		config->parallel = atoi(optarg);
+		if (config->parallel <= 0)
+			die("%s: bad --parallel: %s\n", where, optarg);
+		break;
+	case OPT_PACKET_RING:
+		config->packet_ring = true;
+		break;
+	case OPT_TUN_NAPI:
+		config->tun_napi = true;
+		break;
+	case OPT_NETNS:
+		config->netns = true;
+		break;
+	case OPT_SCRIPT_CACHE:
+		config->script_cache = strdup(optarg);
+		break;
+#endif
 #if defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
 	case OPT_TUN_DEV:
 		config->tun_device = strdup(optarg);
@@ -558,12 +618,18 @@ static void process_option(int opt, char *optarg, struct config *config,
 }
 
 
+/* getopt_long() keeps its state in globals, and wire server threads
+ * parse their command lines concurrently, so we take turns.
+ */
+static pthread_mutex_t getopt_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 /* Parse command line options. Returns a pointer to the first argument
  * beyond the options.
  */
 char **parse_command_line_options(int argc, char *argv[],
 				  struct config *config)
 {
+	char **args = NULL;
 	int c = 0;
 	int i = 0;
 
@@ -581,12 +647,41 @@ char **parse_command_line_options(int argc, char *argv[],
 		config->argv[i] = strdup(argv[i]);
 
 	/* Parse the arguments. */
+	if (pthread_mutex_lock(&getopt_mutex) != 0)
+		die_perror("pthread_mutex_lock");
 	optind = 0;
 	while ((c = getopt_long(argc, argv, "vD:", options, NULL)) > 0)
 		process_option(c, optarg, config, "Command Line");
-	return argv + optind;
+	args = argv + optind;
+	if (pthread_mutex_unlock(&getopt_mutex) != 0)
+		die_perror("pthread_mutex_unlock");
+	return args;
 }
 
+#if defined(linux)
+char *command_line_script_cache(int argc, char *argv[], int *num_options)
+{
+	char *dir = NULL;
+	int c = 0;
+
+	/* Only look for --script_cache; the options have already been
+	 * checked, and nothing here allocates or changes a config.
+	 */
+	if (pthread_mutex_lock(&getopt_mutex) != 0)
+		die_perror("pthread_mutex_lock");
+	optind = 0;
+	while ((c = getopt_long(argc, argv, "vD:", options, NULL)) > 0) {
+		if (c == OPT_SCRIPT_CACHE)
+			dir = optarg;
+	}
+	/* getopt has moved the options up front, ahead of the scripts. */
+	*num_options = optind - 1;
+	if (pthread_mutex_unlock(&getopt_mutex) != 0)
+		die_perror("pthread_mutex_unlock");
+	return dir;
+}
+#endif
+
 static void parse_script_options(struct config *config,
 				 struct option_list *option_list)
 {
@@ -126,6 +126,20 @@ struct config {
 
 	bool dry_run;			/* parse script but don't execute? */
 
+	char *pcap_out;			/* pcapng file to record packets to */
+	char *replay;			/* capture to replay, not a kernel */
+	char *stats_json;		/* file to report timing stats to */
+
+	int parallel;			/* max scripts to run concurrently */
+
+	bool packet_ring;		/* sniff via mmap-ed PACKET_RX_RING? */
+
+	bool tun_napi;			/* inject via per-CPU NAPI tun queues? */
+
+	bool netns;			/* run each script in a new netns? */
+
+	char *script_cache;		/* dir of compiled scripts, or NULL */
+
 	bool verbose;			/* print detailed debug info? */
 
 	u8 udp_encaps;			/* Protocol encapsulated in UDP */
@@ -195,6 +209,15 @@ extern void show_usage(void);
 extern char **parse_command_line_options(int argc, char *argv[],
 					 struct config *config);
 
+#if defined(linux)
+/* Return the --script_cache directory on the command line, or NULL if
+ * there is none, and set *num_options to the number of arguments
+ * before the script paths. Returns a pointer into argv.
+ */
+extern char *command_line_script_cache(int argc, char *argv[],
+				       int *num_options);
+#endif
+
 /* The parser calls this function to finalize processing of config info. */
 extern void parse_and_finalize_config(struct invocation *invocation);
 
@@ -40,6 +40,7 @@
 #define	ETHERTYPE_IPV6		0x86dd	/* IP protocol version 6 */
 #define	ETHERTYPE_MPLS_UC	0x8847	/* MPLS unicast */
 #define	ETHERTYPE_MPLS_MC	0x8848	/* MPLS multicast */
+#define	ETHERTYPE_VLAN		0x8100	/* IEEE 802.1Q VLAN tag */
 
 /* To tell a packet socket that you want traffic for all protocols. */
 #define ETH_P_ALL       0x0003
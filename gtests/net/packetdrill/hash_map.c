@@ -26,137 +26,188 @@
 
 #include <stdlib.h>
 #include <string.h>
-#include "hash.h"
+#include "assert.h"
 
 static const size_t MAX_BUCKETS = 1ULL << 30;	/* max 1B buckets */
+static const size_t MIN_BUCKETS = 8;
 
-/* Hash a key. We use the fast, public-domain MurmurHash3.*/
+/* Longest probe sequence we can record in a u8 (0 means empty). */
+static const u8 MAX_PROBE_LEN = 255;
+
+/* Hash a key. Keys are single words, so rather than a general-purpose
+ * hash we just use the MurmurHash3 32-bit finalizer, a cheap
+ * invertible mixer with good avalanche behavior.
+ */
 static inline size_t hash_key(u32 key)
 {
-	u32 hash;
-	MurmurHash3_x86_32(&key, sizeof(key), 0, &hash);
-	return hash;
+	key ^= key >> 16;
+	key *= 0x85ebca6b;
+	key ^= key >> 13;
+	key *= 0xc2b2ae35;
+	key ^= key >> 16;
+	return key;
 }
 
-/* Find the bucket number for a key. */
+/* Find the home slot number for a key. */
 static inline size_t hash_bucket_num(const struct hash_map *map, u32 key)
 {
 	size_t bucket_num = hash_key(key) & map->bucket_mask;
 	return bucket_num;
 }
 
-/* Try to find the smallest bucket count that is a power of 2 and is
- * greater than the given number of keys.
+/* Return true if adding one more key would push the map past its
+ * maximum load factor of 7/8.
+ */
+static inline bool hash_map_is_full(const struct hash_map *map)
+{
+	return (map->num_keys + 1) * 8 > map->num_buckets * 7;
+}
+
+/* Try to find the smallest bucket count that is a power of 2 and
+ * holds the given number of keys within our load factor.
  */
 static inline size_t hash_map_pick_bucket_count(size_t num_keys)
 {
-	size_t buckets = 1;
-	while ((buckets < num_keys) && (buckets < MAX_BUCKETS))
+	size_t buckets = MIN_BUCKETS;
+	while ((buckets * 7 < num_keys * 8) && (buckets < MAX_BUCKETS))
 		buckets <<= 1;
 	return buckets;
 }
 
+static void hash_map_alloc_slots(struct hash_map *map, size_t num_buckets)
+{
+	map->num_buckets = num_buckets;
+	map->bucket_mask = num_buckets - 1;
+	map->slots = calloc(num_buckets, sizeof(struct hash_slot));
+	map->probe_lens = calloc(num_buckets, sizeof(u8));
+}
+
 struct hash_map *hash_map_new(size_t num_keys)
 {
 	struct hash_map *map = calloc(1, sizeof(struct hash_map));
-	map->num_buckets = hash_map_pick_bucket_count(num_keys);
-	map->bucket_mask = map->num_buckets - 1;
-	map->buckets = calloc(map->num_buckets, sizeof(struct hash_node *));
+	hash_map_alloc_slots(map, hash_map_pick_bucket_count(num_keys));
 	return map;
 }
 
 void hash_map_free(struct hash_map *map)
 {
-	/* Walk through the buckets and free nodes. */
-	int bucket_num;
-	for (bucket_num = 0; bucket_num < map->num_buckets; ++bucket_num) {
-		struct hash_node *node = NULL;
-		struct hash_node *next = NULL;
-		for (node = map->buckets[bucket_num]; node != NULL;
-		     node = next) {
-			next = node->next;
-			free(node);
-		}
-	}
-
-	free(map->buckets);
+	free(map->slots);
+	free(map->probe_lens);
 	memset(map, 0, sizeof(*map));	/* paranoia to help catch bugs */
 	free(map);
 }
 
-/* Link the given node into the correct bucket linked list in the hash map. */
-static void hash_map_link(struct hash_map *map,
-				  struct hash_node *node)
+/* Place the given entry, whose key must not already be in the map.
+ * Robin Hood rule: an entry that has probed further than the one
+ * occupying a slot takes that slot, and the evicted entry carries on
+ * probing. Returns false, with *slot holding whichever entry is still
+ * homeless, if some probe sequence would grow too long to record.
+ */
+static bool hash_map_place(struct hash_map *map, struct hash_slot *slot)
 {
-	const size_t bucket_num = hash_bucket_num(map, node->key);
-	node->next = map->buckets[bucket_num];
-	map->buckets[bucket_num] = node;
+	size_t bucket_num = hash_bucket_num(map, slot->key);
+	u8 probe_len = 1;
+
+	while (1) {
+		if (map->probe_lens[bucket_num] == 0) {
+			map->slots[bucket_num] = *slot;
+			map->probe_lens[bucket_num] = probe_len;
+			return true;
+		}
+		if (map->probe_lens[bucket_num] < probe_len) {
+			struct hash_slot evicted = map->slots[bucket_num];
+			u8 evicted_probe_len = map->probe_lens[bucket_num];
+
+			map->slots[bucket_num] = *slot;
+			map->probe_lens[bucket_num] = probe_len;
+			*slot = evicted;
+			probe_len = evicted_probe_len;
+		}
+		if (probe_len == MAX_PROBE_LEN)
+			return false;
+		++probe_len;
+		bucket_num = (bucket_num + 1) & map->bucket_mask;
+	}
 }
 
-/* Create a new array of buckets that's twice the size of the current
- * array. Then Walk through the old buckets and move all the nodes to
- * the new buckets.
+/* Create a new array of slots that's twice the size of the current
+ * array. Then walk through the old slots and move all the entries to
+ * the new slots.
  */
 static void hash_map_grow(struct hash_map *map)
 {
 	const size_t old_num_buckets = map->num_buckets;
-	map->num_buckets *= 2;
-	map->bucket_mask = map->num_buckets - 1;
-	struct hash_node **old_buckets = map->buckets;
-	map->buckets = calloc(map->num_buckets, sizeof(struct hash_node *));
-
+	struct hash_slot *old_slots = map->slots;
+	u8 *old_probe_lens = map->probe_lens;
 	size_t old_bucket_num = 0;
+
+	assert(map->num_buckets < MAX_BUCKETS);
+	hash_map_alloc_slots(map, map->num_buckets * 2);
+
 	for (old_bucket_num = 0; old_bucket_num < old_num_buckets;
 	     ++old_bucket_num) {
-		struct hash_node *node = NULL;
-		struct hash_node *next = NULL;
-		for (node = old_buckets[old_bucket_num]; node != NULL;
-		     node = next) {
-			next = node->next;
-			hash_map_link(map, node);
-		}
+		struct hash_slot slot = old_slots[old_bucket_num];
+
+		if (old_probe_lens[old_bucket_num] == 0)
+			continue;
+		if (!hash_map_place(map, &slot))
+			assert(!"hash map probe sequence overflow after grow");
 	}
 
-	free(old_buckets);
+	free(old_slots);
+	free(old_probe_lens);
 }
 
-/* Insert a new node in the hash map, first growing the map if needed. */
+/* Insert a new entry in the hash map, first growing the map if needed. */
 static void hash_map_insert(struct hash_map *map, u32 key, u32 value)
 {
-	/* To keep things simple, we target a load factor of 1.0. */
-	if ((map->num_keys >= map->num_buckets) &&
-	    (map->num_buckets < MAX_BUCKETS)) {
+	struct hash_slot slot = { .key = key, .value = value };
+
+	if (hash_map_is_full(map))
+		hash_map_grow(map);
+	while (!hash_map_place(map, &slot))
 		hash_map_grow(map);
-	}
 	++map->num_keys;
-	struct hash_node *node = calloc(1, sizeof(struct hash_node));
-	node->key = key;
-	node->value = value;
-	hash_map_link(map, node);
+}
+
+/* Return the slot number holding the given key, or -1 if none. */
+static ssize_t hash_map_find(const struct hash_map *map, u32 key)
+{
+	size_t bucket_num = hash_bucket_num(map, key);
+	u8 probe_len = 1;
+
+	/* Robin Hood ordering means that once we reach an empty slot
+	 * or an entry closer to its home than we are to ours, our key
+	 * cannot be further along.
+	 */
+	while (map->probe_lens[bucket_num] >= probe_len) {
+		if (map->slots[bucket_num].key == key)
+			return bucket_num;
+		if (probe_len == MAX_PROBE_LEN)
+			break;
+		++probe_len;
+		bucket_num = (bucket_num + 1) & map->bucket_mask;
+	}
+	return -1;
 }
 
 void hash_map_set(struct hash_map *map, u32 key, u32 value)
 {
-	const size_t bucket_num = hash_bucket_num(map, key);
-	struct hash_node *node = NULL;
-	for (node = map->buckets[bucket_num]; node != NULL; node = node->next) {
-		if (node->key == key) {
-			node->value = value;
-			return;
-		}
+	ssize_t bucket_num = hash_map_find(map, key);
+
+	if (bucket_num >= 0) {
+		map->slots[bucket_num].value = value;
+		return;
 	}
 	hash_map_insert(map, key, value);
 }
 
 bool hash_map_get(const struct hash_map *map, u32 key, u32 *value)
 {
-	const size_t bucket_num = hash_bucket_num(map, key);
-	struct hash_node *node = NULL;
-	for (node = map->buckets[bucket_num]; node != NULL; node = node->next) {
-		if (node->key == key) {
-			*value = node->value;
-			return true;
-		}
-	}
-	return false;
+	ssize_t bucket_num = hash_map_find(map, key);
+
+	if (bucket_num < 0)
+		return false;
+	*value = map->slots[bucket_num].value;
+	return true;
 }
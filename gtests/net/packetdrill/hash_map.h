@@ -28,19 +28,24 @@
 
 #include "types.h"
 
-/* Node for hash table buckets; maps u32 key to u32 value. */
-struct hash_node {
+/* Slot in the hash table; maps u32 key to u32 value. */
+struct hash_slot {
 	u32 key;
 	u32 value;
-	struct hash_node *next;
 };
 
-/* Hash map mapping u32 to u32. */
+/* Hash map mapping u32 to u32. This is an open-addressing table using
+ * linear probing with Robin Hood displacement, so all entries live in
+ * one flat array and lookups touch few cache lines.
+ */
 struct hash_map {
 	size_t num_keys;		/* number of keys */
-	size_t num_buckets;		/* number of buckets (a power of 2) */
-	size_t bucket_mask;		/* bit mask to find bucket number */
-	struct hash_node **buckets;	/* array of hash buckets */
+	size_t num_buckets;		/* number of slots (a power of 2) */
+	size_t bucket_mask;		/* bit mask to find slot number */
+	struct hash_slot *slots;	/* array of key/value slots */
+	u8 *probe_lens;			/* 0 if slot is empty, else 1 + the
+					 * distance from the key's home slot
+					 */
 };
 
 extern struct hash_map *hash_map_new(size_t num_keys);
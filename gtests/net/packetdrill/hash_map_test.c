@@ -0,0 +1,255 @@
+/*
+ * Copyright 2013 Google Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+/*
+ * Unit test for hash_map.c.
+ */
+
+#include "hash_map.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "assert.h"
+
+int debug_logging = 0;
+
+/* The bucket count of a newly allocated small map. */
+#define MIN_TEST_BUCKETS	8
+
+/* Check that the map holds exactly the given value for the key. */
+static void check_get(const struct hash_map *map, u32 key, u32 expected)
+{
+	u32 value = 0;
+
+	assert(hash_map_get(map, key, &value));
+	assert(value == expected);
+}
+
+/* Check that the map does not hold the key. */
+static void check_missing(const struct hash_map *map, u32 key)
+{
+	u32 value = 0xdeadbeef;
+
+	assert(!hash_map_get(map, key, &value));
+	assert(value == 0xdeadbeef);
+}
+
+/* Check the invariants of the slot array: the key count matches the
+ * occupied slots, and an entry never sits further from its home slot
+ * than the entry before it could have moved on to (so every entry
+ * after the first in a run is at most one probe further along).
+ */
+static void check_slots(const struct hash_map *map)
+{
+	size_t i, num_keys = 0;
+
+	for (i = 0; i < map->num_buckets; ++i) {
+		size_t prev = (i - 1) & map->bucket_mask;
+		u8 probe_len = map->probe_lens[i];
+
+		if (probe_len == 0)
+			continue;
+		++num_keys;
+		if (probe_len > 1)
+			assert(map->probe_lens[prev] >= probe_len - 1);
+	}
+	assert(num_keys == map->num_keys);
+	assert(map->num_keys * 8 <= map->num_buckets * 7);
+}
+
+static void test_insert_and_overwrite(void)
+{
+	struct hash_map *map = hash_map_new(1);
+
+	check_missing(map, 1);
+	hash_map_set(map, 1, 10);
+	check_get(map, 1, 10);
+	hash_map_set(map, 1, 11);
+	check_get(map, 1, 11);
+	assert(map->num_keys == 1);
+
+	/* Every u32 is a usable key, including 0 and all ones. */
+	hash_map_set(map, 0, 100);
+	hash_map_set(map, 0xffffffff, 200);
+	check_get(map, 0, 100);
+	check_get(map, 0xffffffff, 200);
+	assert(map->num_keys == 3);
+	check_slots(map);
+
+	hash_map_free(map);
+}
+
+static void test_growth(void)
+{
+	struct hash_map *map = hash_map_new(1);
+	const u32 num_keys = 10000;
+	u32 i;
+
+	assert(map->num_buckets == MIN_TEST_BUCKETS);
+	for (i = 0; i < num_keys; ++i) {
+		hash_map_set(map, i * 7919, i);
+		assert(map->num_keys == i + 1);
+	}
+	assert((map->num_buckets & map->bucket_mask) == 0);
+	assert(map->bucket_mask == map->num_buckets - 1);
+	check_slots(map);
+
+	for (i = 0; i < num_keys; ++i) {
+		check_get(map, i * 7919, i);
+		check_missing(map, i * 7919 + 1);
+	}
+	hash_map_free(map);
+
+	/* A map sized up front never needs to grow. */
+	map = hash_map_new(num_keys);
+	i = map->num_buckets;
+	while (map->num_keys < num_keys)
+		hash_map_set(map, map->num_keys, 0);
+	assert(map->num_buckets == i);
+	hash_map_free(map);
+}
+
+/* Return the home slot of the key in a map of MIN_TEST_BUCKETS slots,
+ * found by placing the key alone in an empty map.
+ */
+static size_t home_slot(u32 key)
+{
+	struct hash_map *map = hash_map_new(1);
+	size_t i, home = 0;
+
+	hash_map_set(map, key, 0);
+	for (i = 0; i < map->num_buckets; ++i) {
+		if (map->probe_lens[i] != 0) {
+			assert(map->probe_lens[i] == 1);
+			home = i;
+		}
+	}
+	hash_map_free(map);
+	return home;
+}
+
+static void test_robin_hood_displacement(void)
+{
+	struct hash_map *map = hash_map_new(1);
+	size_t home = home_slot(0);
+	size_t next = (home + 1) & (MIN_TEST_BUCKETS - 1);
+	size_t after = (home + 2) & (MIN_TEST_BUCKETS - 1);
+	u32 first = 0, second, neighbor;
+
+	/* Find a second key with the same home slot as key 0, and one
+	 * whose home is the slot right after it.
+	 */
+	for (second = first + 1; home_slot(second) != home; ++second)
+		;
+	for (neighbor = 1; home_slot(neighbor) != next; ++neighbor)
+		;
+
+	/* The neighbor settles in its home slot, and the first key in
+	 * its own.
+	 */
+	hash_map_set(map, neighbor, 1);
+	hash_map_set(map, first, 2);
+	assert(map->slots[next].key == neighbor);
+	assert(map->probe_lens[next] == 1);
+	assert(map->slots[home].key == first);
+	assert(map->probe_lens[home] == 1);
+
+	/* The second key has probed further than the neighbor when it
+	 * reaches the neighbor's slot, so it takes that slot and the
+	 * neighbor moves on, each ending up one slot from home.
+	 */
+	hash_map_set(map, second, 3);
+	assert(map->num_buckets == MIN_TEST_BUCKETS);
+	assert(map->slots[next].key == second);
+	assert(map->probe_lens[next] == 2);
+	assert(map->slots[after].key == neighbor);
+	assert(map->probe_lens[after] == 2);
+	check_slots(map);
+
+	check_get(map, neighbor, 1);
+	check_get(map, first, 2);
+	check_get(map, second, 3);
+
+	/* Overwriting a displaced key leaves it where it is. */
+	hash_map_set(map, neighbor, 4);
+	assert(map->slots[after].key == neighbor);
+	check_get(map, neighbor, 4);
+	assert(map->num_keys == 3);
+
+	hash_map_free(map);
+}
+
+/* Return the i-th of a sequence of distinct keys spread over all u32
+ * values: multiplying by an odd constant is a bijection.
+ */
+static u32 scattered_key(u32 i)
+{
+	return i * 2654435761U;
+}
+
+/* Insert thousands of scattered keys into a map that starts small,
+ * overwrite some of them, and check every value after each rehash.
+ */
+static void test_many_inserts(void)
+{
+	enum { NUM_KEYS = 5000 };
+	struct hash_map *map = hash_map_new(1);
+	u32 *values = calloc(NUM_KEYS, sizeof(u32));
+	size_t num_buckets = map->num_buckets;
+	u32 i, j;
+
+	srandom(1);
+	for (i = 0; i < NUM_KEYS; ++i) {
+		values[i] = random();
+		hash_map_set(map, scattered_key(i), values[i]);
+		assert(map->num_keys == i + 1);
+
+		/* After each grow, every key must have been rehashed. */
+		if (map->num_buckets != num_buckets) {
+			assert(map->num_buckets == num_buckets * 2);
+			num_buckets = map->num_buckets;
+			check_slots(map);
+			for (j = 0; j <= i; ++j)
+				check_get(map, scattered_key(j), values[j]);
+		}
+	}
+
+	for (i = 0; i < NUM_KEYS; i += 3) {
+		values[i] = random();
+		hash_map_set(map, scattered_key(i), values[i]);
+	}
+	assert(map->num_keys == NUM_KEYS);
+	assert(map->num_buckets == num_buckets);
+	check_slots(map);
+
+	for (i = 0; i < NUM_KEYS; ++i)
+		check_get(map, scattered_key(i), values[i]);
+	check_missing(map, scattered_key(NUM_KEYS));
+
+	free(values);
+	hash_map_free(map);
+}
+
+int main(void)
+{
+	test_insert_and_overwrite();
+	test_growth();
+	test_robin_hood_displacement();
+	test_many_inserts();
+	return 0;
+}
@@ -24,12 +24,20 @@
 
 #include "net_utils.h"
 
+#include <errno.h>
 #include <stdlib.h>
 #include <net/if.h>
+#include <sys/ioctl.h>
 #include <unistd.h>
+#ifdef linux
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <sched.h>
+#endif
 
 #include "logging.h"
 
+#if !defined(linux)
 static void verbose_system(const char *command)
 {
 	int result;
@@ -40,6 +48,122 @@ static void verbose_system(const char *command)
 	if (result != 0)
 		DEBUGP("error executing command '%s'\n", command);
 }
+#endif /* !defined(linux) */
+
+#ifdef linux
+/* On Linux we configure addresses and routes by talking rtnetlink to
+ * the kernel directly, rather than paying to fork and exec ip(8).
+ */
+
+/* A request to the kernel's rtnetlink routing subsystem. */
+struct rtnl_request {
+	struct nlmsghdr header;
+	union {
+		struct ifaddrmsg ifa;
+		struct rtmsg rtm;
+	} msg;
+	u8 attributes[128];	/* space for route attributes */
+};
+
+/* Start a request of the given type, with a message of 'msg_len'. */
+static void rtnl_request_init(struct rtnl_request *req, u16 type,
+			      u16 flags, int msg_len)
+{
+	memset(req, 0, sizeof(*req));
+	req->header.nlmsg_len = NLMSG_LENGTH(msg_len);
+	req->header.nlmsg_type = type;
+	req->header.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK | flags;
+}
+
+/* Append a route attribute to the request. */
+static void rtnl_add_attribute(struct rtnl_request *req, u16 type,
+			       const void *data, int len)
+{
+	int offset = NLMSG_ALIGN(req->header.nlmsg_len);
+	struct rtattr *rta = (struct rtattr *)((u8 *)req + offset);
+
+	assert(offset + RTA_LENGTH(len) <= (int)sizeof(*req));
+	rta->rta_type = type;
+	rta->rta_len = RTA_LENGTH(len);
+	memcpy(RTA_DATA(rta), data, len);
+	req->header.nlmsg_len = offset + RTA_ALIGN(rta->rta_len);
+}
+
+/* Send the request to the kernel and wait for its acknowledgement.
+ * Returns 0 on success, or else the errno value the kernel reports.
+ */
+static int rtnl_talk(struct rtnl_request *req)
+{
+	struct sockaddr_nl kernel;
+	struct nlmsghdr *reply;
+	struct nlmsgerr *ack;
+	u8 buf[1024];
+	int fd, len;
+
+	fd = socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+	if (fd < 0)
+		die_perror("opening AF_NETLINK, SOCK_RAW, NETLINK_ROUTE socket");
+
+	memset(&kernel, 0, sizeof(kernel));
+	kernel.nl_family = AF_NETLINK;
+	if (sendto(fd, req, req->header.nlmsg_len, 0,
+		   (struct sockaddr *)&kernel, sizeof(kernel)) < 0)
+		die_perror("rtnetlink sendto()");
+
+	len = recv(fd, buf, sizeof(buf), 0);
+	if (len < 0)
+		die_perror("rtnetlink recv()");
+	close(fd);
+
+	reply = (struct nlmsghdr *)buf;
+	if (!NLMSG_OK(reply, len) || (reply->nlmsg_type != NLMSG_ERROR))
+		die("rtnetlink: unexpected reply type %d\n",
+		    reply->nlmsg_type);
+	ack = NLMSG_DATA(reply);
+	return -ack->error;
+}
+
+/* Add (RTM_NEWADDR) or remove (RTM_DELADDR) an address on the given
+ * device. Returns 0 on success, or else an errno value.
+ */
+static int rtnl_change_address(u16 type, const char *dev_name,
+			       const struct ip_address *ip, int prefix_len)
+{
+	struct rtnl_request req;
+	int ip_bytes = ip_address_length(ip->address_family);
+	int index = if_nametoindex(dev_name);
+
+	if (index == 0)
+		return errno;
+
+	rtnl_request_init(&req, type,
+			  type == RTM_NEWADDR ? NLM_F_CREATE | NLM_F_EXCL : 0,
+			  sizeof(struct ifaddrmsg));
+	req.msg.ifa.ifa_family = ip->address_family;
+	req.msg.ifa.ifa_prefixlen = prefix_len;
+	req.msg.ifa.ifa_index = index;
+	rtnl_add_attribute(&req, IFA_LOCAL, &ip->ip, ip_bytes);
+	rtnl_add_attribute(&req, IFA_ADDRESS, &ip->ip, ip_bytes);
+	return rtnl_talk(&req);
+}
+
+/* Configure a local IPv4 or IPv6 address for the device */
+static void net_add_linux_address(const char *dev_name,
+				  const struct ip_address *local_ip,
+				  int prefix_len)
+{
+	char local_ip_string[ADDR_STR_LEN];
+	int error;
+
+	error = rtnl_change_address(RTM_NEWADDR, dev_name,
+				    local_ip, prefix_len);
+	if (error != 0 && error != EEXIST) {
+		die("error adding address %s/%d to %s: %s\n",
+		    ip_to_string(local_ip, local_ip_string), prefix_len,
+		    dev_name, strerror(error));
+	}
+}
+#endif  /* linux */
 
 /* Configure a local IPv4 address and netmask for the device */
 static void net_add_ipv4_address(const char *dev_name,
@@ -47,6 +171,9 @@ static void net_add_ipv4_address(const char *dev_name,
 				 int prefix_len,
 				 const struct ip_address *gateway_ip)
 {
+#ifdef linux
+	net_add_linux_address(dev_name, local_ip, prefix_len);
+#else
 	char *command = NULL;
 	char local_ip_string[ADDR_STR_LEN];
 	char gateway_ip_string[ADDR_STR_LEN];
@@ -54,10 +181,6 @@ static void net_add_ipv4_address(const char *dev_name,
 	ip_to_string(local_ip, local_ip_string);
 	ip_to_string(gateway_ip, gateway_ip_string);
 
-#ifdef linux
-	asprintf(&command, "ip addr add %s/%d dev %s > /dev/null 2>&1",
-		 local_ip_string, prefix_len, dev_name);
-#endif
 #if defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
 	asprintf(&command, "/sbin/ifconfig %s %s/%d alias",
 		 dev_name, local_ip_string, prefix_len);
@@ -68,6 +191,7 @@ static void net_add_ipv4_address(const char *dev_name,
 #endif /* defined(__APPLE__) */
 	verbose_system(command);
 	free(command);
+#endif /* defined(linux) */
 }
 
 /* Configure a local IPv6 address and prefix length for the device */
@@ -75,21 +199,18 @@ static void net_add_ipv6_address(const char *dev_name,
 				 const struct ip_address *local_ip,
 				 int prefix_len)
 {
+#ifdef linux
+	net_add_linux_address(dev_name, local_ip, prefix_len);
+#else
 	char *command = NULL;
 	char local_ip_string[ADDR_STR_LEN];
 
 	ip_to_string(local_ip, local_ip_string);
-
-#ifdef linux
-	asprintf(&command, "ip addr add %s/%d dev %s > /dev/null 2>&1",
-		 local_ip_string, prefix_len, dev_name);
-#else
 	asprintf(&command, "/sbin/ifconfig %s inet6 %s/%d",
 		 dev_name, local_ip_string, prefix_len);
-#endif /* defined(linux) */
-
 	verbose_system(command);
 	free(command);
+#endif /* defined(linux) */
 
 	/* Wait for IPv6 duplicate address detection to converge,
 	 * so that this address no longer shows as "tentative".
@@ -126,21 +247,26 @@ void net_del_dev_address(const char *dev_name,
 			 const struct ip_address *ip,
 			 int prefix_len)
 {
-	char *command = NULL;
 	char ip_string[ADDR_STR_LEN];
 
 	ip_to_string(ip, ip_string);
 #if defined(linux)
-	asprintf(&command, "ip addr del %s/%d dev %s > /dev/null 2>&1",
-		 ip_string, prefix_len, dev_name);
+	int error = rtnl_change_address(RTM_DELADDR, dev_name,
+					ip, prefix_len);
+	if (error != 0) {
+		DEBUGP("error deleting %s/%d from %s: %s\n",
+		       ip_string, prefix_len, dev_name, strerror(error));
+	}
 #else
+	char *command = NULL;
+
 	asprintf(&command, "/sbin/ifconfig %s %s %s/%d -alias",
 		 dev_name,
 		 ip->address_family ==  AF_INET6 ? "inet6" : "",
 		 ip_string, prefix_len);
-#endif /* defined(linux) */
 	verbose_system(command);
 	free(command);
+#endif /* defined(linux) */
 }
 
 /* In general we want to avoid configuring a new IP address on an
@@ -171,3 +297,71 @@ void net_setup_dev_address(const char *dev_name,
 		net_del_dev_address(cur_dev_name, local_ip, prefix_len);
 	net_add_dev_address(dev_name, local_ip, prefix_len, gateway_ip);
 }
+
+#ifdef linux
+void net_setup_route(const char *dev_name,
+		     const struct ip_prefix *prefix,
+		     const struct ip_address *gateway_ip)
+{
+	struct rtnl_request req;
+	char prefix_string[ADDR_STR_LEN];
+	int ip_bytes = ip_address_length(prefix->ip.address_family);
+	int index = if_nametoindex(dev_name);
+	int error;
+
+	if (index == 0)
+		die_perror("if_nametoindex");
+
+	/* Remove any old route to the prefix, wherever it points. */
+	rtnl_request_init(&req, RTM_DELROUTE, 0, sizeof(struct rtmsg));
+	req.msg.rtm.rtm_family = prefix->ip.address_family;
+	req.msg.rtm.rtm_dst_len = prefix->prefix_len;
+	req.msg.rtm.rtm_table = RT_TABLE_MAIN;
+	req.msg.rtm.rtm_scope = RT_SCOPE_NOWHERE;
+	rtnl_add_attribute(&req, RTA_DST, &prefix->ip.ip, ip_bytes);
+	error = rtnl_talk(&req);
+	DEBUGP("net_setup_route: delete: %d\n", error);
+
+	rtnl_request_init(&req, RTM_NEWROUTE, NLM_F_CREATE | NLM_F_EXCL,
+			  sizeof(struct rtmsg));
+	req.msg.rtm.rtm_family = prefix->ip.address_family;
+	req.msg.rtm.rtm_dst_len = prefix->prefix_len;
+	req.msg.rtm.rtm_table = RT_TABLE_MAIN;
+	req.msg.rtm.rtm_protocol = RTPROT_BOOT;
+	req.msg.rtm.rtm_scope = RT_SCOPE_UNIVERSE;
+	req.msg.rtm.rtm_type = RTN_UNICAST;
+	rtnl_add_attribute(&req, RTA_DST, &prefix->ip.ip, ip_bytes);
+	rtnl_add_attribute(&req, RTA_GATEWAY, &gateway_ip->ip, ip_bytes);
+	rtnl_add_attribute(&req, RTA_OIF, &index, sizeof(index));
+	error = rtnl_talk(&req);
+	if (error != 0) {
+		ip_prefix_to_string((struct ip_prefix *)prefix, prefix_string);
+		die("error adding route to %s via %s: %s\n",
+		    prefix_string, dev_name, strerror(error));
+	}
+}
+
+void net_setup_namespace(void)
+{
+	struct ifreq ifr;
+	int fd;
+
+	if (unshare(CLONE_NEWNET) < 0)
+		die_perror("unshare(CLONE_NEWNET)");
+
+	/* A fresh namespace starts with only a loopback device, and
+	 * that device is down.
+	 */
+	fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
+	if (fd < 0)
+		die_perror("opening AF_INET, SOCK_DGRAM, IPPROTO_IP socket");
+	memset(&ifr, 0, sizeof(ifr));
+	strcpy(ifr.ifr_name, "lo");
+	if (ioctl(fd, SIOCGIFFLAGS, &ifr) < 0)
+		die_perror("SIOCGIFFLAGS");
+	ifr.ifr_flags |= IFF_UP | IFF_RUNNING;
+	if (ioctl(fd, SIOCSIFFLAGS, &ifr) < 0)
+		die_perror("SIOCSIFFLAGS");
+	close(fd);
+}
+#endif  /* linux */
@@ -29,6 +29,7 @@
 #include "types.h"
 
 #include "ip_address.h"
+#include "ip_prefix.h"
 
 /* Delete the given IP address, with the given subnet/prefix length,
  * from the given device.
@@ -49,4 +50,21 @@ extern void net_setup_dev_address(const char *dev_name,
 				  int prefix_len,
 				  const struct ip_address *gateway_ip);
 
+#ifdef linux
+/* Route traffic for the given prefix out of the given device, via the
+ * given gateway, replacing any existing route for the prefix.
+ */
+extern void net_setup_route(const char *dev_name,
+			    const struct ip_prefix *prefix,
+			    const struct ip_address *gateway_ip);
+
+/* Move the calling process into a new, private network namespace and
+ * bring up the loopback device there. Everything the test configures
+ * afterwards (tun device, addresses, routes) is then invisible to
+ * other processes and vanishes when the last process in the namespace
+ * exits.
+ */
+extern void net_setup_namespace(void);
+#endif
+
 #endif /* __NET_UTILS_H__ */
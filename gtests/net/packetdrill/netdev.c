@@ -30,6 +30,7 @@
 #include <fcntl.h>
 #include <net/if.h>
 #include <netinet/in.h>
+#include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -52,6 +53,7 @@
 #include <sys/kern_event.h>
 #endif
 #include "assert.h"
+#include "hash.h"
 #include "ip.h"
 #include "ipv6.h"
 #include "logging.h"
@@ -59,6 +61,7 @@
 #include "packet.h"
 #include "packet_parser.h"
 #include "packet_socket.h"
+#include "socket.h"
 #include "tcp.h"
 #include "tun.h"
 
@@ -68,6 +71,8 @@ struct local_netdev {
 
 	char *name;		/* malloc-ed copy of interface name (owned) */
 	int tun_fd;		/* tun for sending/receiving packets */
+	int *queue_fds;		/* fds for all tun queues, tun_fd first */
+	int num_queues;		/* number of tun queues (Linux only) */
 	int ipv4_control_fd;	/* fd for IPv4 configuration of tun interface */
 	int ipv6_control_fd;	/* fd for IPv6 configuration of tun interface */
 	int index;		/* interface index from if_nametoindex */
@@ -125,6 +130,43 @@ static void check_remote_address(struct config *config,
 	}
 }
 
+#ifdef linux
+/* By default the tun device has the one queue we created it with,
+ * and the kernel receives our packets through netif_rx(). With
+ * --tun_napi we instead created it with IFF_NAPI | IFF_MULTI_QUEUE,
+ * so that injected packets go through napi_gro_receive() like those
+ * from a real NIC, and here we attach one more queue per extra CPU.
+ */
+static void add_device_queues(struct config *config,
+			      struct local_netdev *netdev,
+			      struct ifreq *ifr)
+{
+	int i, fd;
+
+	netdev->num_queues = 1;
+	if (config->tun_napi) {
+		netdev->num_queues = sysconf(_SC_NPROCESSORS_ONLN);
+		if (netdev->num_queues < 0)
+			die_perror("sysconf(_SC_NPROCESSORS_ONLN)");
+		netdev->num_queues = max(1, min(netdev->num_queues,
+						TUN_MAX_QUEUES));
+	}
+	DEBUGP("tun queues: %d\n", netdev->num_queues);
+
+	netdev->queue_fds = calloc(netdev->num_queues, sizeof(int));
+	netdev->queue_fds[0] = netdev->tun_fd;
+	for (i = 1; i < netdev->num_queues; ++i) {
+		fd = open(TUN_DIR "/tun", O_RDWR);
+		if (fd < 0)
+			die_perror("open tun device");
+		/* The ifreq now names our device, so this attaches. */
+		if (ioctl(fd, TUNSETIFF, (void *)ifr) < 0)
+			die_perror("TUNSETIFF (attach queue)");
+		netdev->queue_fds[i] = fd;
+	}
+}
+#endif  /* linux */
+
 /* Create a tun device for the lifetime of this test. */
 #if defined(__APPLE__)
 static void create_device(struct config *config, struct local_netdev *netdev)
@@ -215,11 +257,14 @@ static void create_device(struct config *config, struct local_netdev *netdev)
 	struct ifreq ifr;
 	memset(&ifr, 0, sizeof(ifr));
 	ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+	if (config->tun_napi)
+		ifr.ifr_flags |= IFF_NAPI | IFF_MULTI_QUEUE;
 	int status = ioctl(netdev->tun_fd, TUNSETIFF, (void *)&ifr);
 	if (status < 0)
 		die_perror("TUNSETIFF");
 
 	netdev->name = strdup(ifr.ifr_name);
+	add_device_queues(config, netdev, &ifr);
 #endif
 
 #if defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
@@ -345,16 +390,12 @@ static void bring_up_device(struct local_netdev *netdev)
 static void route_traffic_to_device(struct config *config,
 				    struct local_netdev *netdev)
 {
-	char *route_command = NULL;
 #if defined(linux)
-	asprintf(&route_command,
-		 "ip route del %s > /dev/null 2>&1 ; "
-		 "ip route add %s dev %s via %s > /dev/null 2>&1",
-		 config->live_remote_prefix_string,
-		 config->live_remote_prefix_string,
-		 netdev->name,
-		 config->live_gateway_ip_string);
+	net_setup_route(netdev->name, &config->live_remote_prefix,
+			&config->live_gateway_ip);
 #else
+	char *route_command = NULL;
+
 	if (config->wire_protocol == AF_INET) {
 		asprintf(&route_command,
 			 "route delete %s > /dev/null 2>&1 ; "
@@ -372,13 +413,13 @@ static void route_traffic_to_device(struct config *config,
 	} else {
 		assert(!"bad wire protocol");
 	}
-#endif /* defined(linux) */
 	int result = system(route_command);
 	if ((result == -1) || (WEXITSTATUS(result) != 0)) {
 		die("error executing route command '%s'\n",
 		    route_command);
 	}
 	free(route_command);
+#endif /* defined(linux) */
 }
 
 struct netdev *local_netdev_new(struct config *config)
@@ -403,6 +444,8 @@ struct netdev *local_netdev_new(struct config *config)
 
 	route_traffic_to_device(config, netdev);
 	netdev->psock = packet_socket_new(netdev->name);
+	if (config->packet_ring)
+		packet_socket_enable_ring(netdev->psock);
 #if !defined(linux)
 	/* Make sure we only see packets from the machine under test. */
 	packet_socket_set_filter(netdev->psock,
@@ -416,9 +459,13 @@ struct netdev *local_netdev_new(struct config *config)
 static void local_netdev_free(struct netdev *a_netdev)
 {
 	struct local_netdev *netdev = to_local_netdev(a_netdev);
+	int i;
 
 	if (netdev->psock)
 		packet_socket_free(netdev->psock);
+	for (i = 1; i < netdev->num_queues; ++i)
+		close(netdev->queue_fds[i]);
+	free(netdev->queue_fds);
 	if (netdev->tun_fd >= 0) {
 		close(netdev->tun_fd);
 #if defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
@@ -467,19 +514,36 @@ static void bsd_tun_write(struct local_netdev *netdev,
 #endif /* defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__) || defined(__APPLE__) */
 
 #ifdef linux
+/* Pick the tun queue for the packet by hashing its flow, so that all
+ * packets of a flow go through the same queue (and NAPI context), in
+ * order, as they would with RSS on a real NIC.
+ */
+static int tun_queue_fd(struct local_netdev *netdev,
+			const struct packet *packet)
+{
+	struct tuple tuple;
+	u32 hash = 0;
+
+	if (netdev->num_queues <= 1)
+		return netdev->tun_fd;
+
+	get_packet_tuple(packet, &tuple);
+	MurmurHash3_x86_32(&tuple, sizeof(tuple), 0, &hash);
+	return netdev->queue_fds[hash % netdev->num_queues];
+}
+
 static void linux_tun_write(struct local_netdev *netdev,
 			    struct packet *packet)
 {
-	if (write(netdev->tun_fd, packet_start(packet), packet->ip_bytes) < 0)
+	if (write(tun_queue_fd(netdev, packet),
+		  packet_start(packet), packet->ip_bytes) < 0)
 		die_perror("Linux tun write()");
 }
 #endif  /* linux */
 
-static int local_netdev_send(struct netdev *a_netdev,
-			     struct packet *packet)
+/* Write one packet to the tun device. */
+static void tun_write(struct local_netdev *netdev, struct packet *packet)
 {
-	struct local_netdev *netdev = to_local_netdev(a_netdev);
-
 	assert(packet->ip_bytes > 0);
 	/* We do IPv4 and IPv6 */
 	assert(packet->ipv4 || packet->ipv6);
@@ -487,8 +551,6 @@ static int local_netdev_send(struct netdev *a_netdev,
 	assert(packet->sctp || packet->tcp || packet->udp || packet->udplite ||
 	       packet->icmpv4 || packet->icmpv6);
 
-	DEBUGP("local_netdev_send\n");
-
 #if defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__) || defined(__APPLE__)
 	bsd_tun_write(netdev, packet);
 #endif /* defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__) || defined(__APPLE__) */
@@ -496,10 +558,65 @@ static int local_netdev_send(struct netdev *a_netdev,
 #ifdef linux
 	linux_tun_write(netdev, packet);
 #endif  /* linux */
+}
+
+static int local_netdev_send(struct netdev *a_netdev,
+			     struct packet *packet)
+{
+	struct local_netdev *netdev = to_local_netdev(a_netdev);
+
+	DEBUGP("local_netdev_send\n");
+
+	tun_write(netdev, packet);
+
+	return STATUS_OK;
+}
+
+/* A tun device takes exactly one packet per write(), so the best we
+ * can do for a train of packets is to issue the writes back to back.
+ */
+static int local_netdev_send_batch(struct netdev *a_netdev,
+				   struct packet **packets, int num_packets)
+{
+	struct local_netdev *netdev = to_local_netdev(a_netdev);
+	int i;
+
+	DEBUGP("local_netdev_send_batch: %d packets\n", num_packets);
+
+	for (i = 0; i < num_packets; ++i)
+		tun_write(netdev, packets[i]);
 
 	return STATUS_OK;
 }
 
+/* Return the fd of a tun queue with a packet to read. The kernel
+ * picks which queue each outgoing packet lands in, so with several
+ * queues we wait until one of them has something for us.
+ */
+static int tun_readable_fd(struct local_netdev *netdev)
+{
+	struct pollfd pfds[TUN_MAX_QUEUES];
+	int i;
+
+	if (netdev->num_queues <= 1)
+		return netdev->tun_fd;
+
+	for (i = 0; i < netdev->num_queues; ++i) {
+		pfds[i].fd = netdev->queue_fds[i];
+		pfds[i].events = POLLIN;
+		pfds[i].revents = 0;
+	}
+	while (poll(pfds, netdev->num_queues, -1) < 0) {
+		if (errno != EINTR)
+			die_perror("poll tun queues");
+	}
+	for (i = 0; i < netdev->num_queues; ++i) {
+		if (pfds[i].revents & POLLIN)
+			return pfds[i].fd;
+	}
+	die("poll tun queues: no queue readable\n");
+}
+
 /* Read the given number of packets out of the tun device. We read
  * these packets so that the kernel can exercise its normal code paths
  * for packet transmit completion, since this code path may feed back
@@ -515,7 +632,7 @@ static void local_netdev_read_queue(struct local_netdev *netdev,
 	int i = 0, in_bytes = 0;
 
 	for (i = 0; i < num_packets; ++i) {
-		in_bytes = read(netdev->tun_fd, buf, sizeof(buf));
+		in_bytes = read(tun_readable_fd(netdev), buf, sizeof(buf));
 		assert(in_bytes <= (int)sizeof(buf));
 
 		if (in_bytes < 0) {
@@ -527,8 +644,10 @@ static void local_netdev_read_queue(struct local_netdev *netdev,
 	}
 }
 
-static int local_netdev_receive(struct netdev *a_netdev, u8 udp_encaps,
-				struct packet **packet, char **error)
+static int local_netdev_receive(struct netdev *a_netdev,
+				struct packet_pool *pool, u8 udp_encaps,
+				s64 deadline_usecs, struct packet **packet,
+				char **error)
 {
 	struct local_netdev *netdev = to_local_netdev(a_netdev);
 	int status = STATUS_ERR;
@@ -536,20 +655,37 @@ static int local_netdev_receive(struct netdev *a_netdev, u8 udp_encaps,
 
 	DEBUGP("local_netdev_receive\n");
 
-	status = netdev_receive_loop(netdev->psock, DIRECTION_OUTBOUND,
-				     udp_encaps,packet, &num_packets, error);
+	status = netdev_receive_loop(netdev->psock, pool, DIRECTION_OUTBOUND,
+				     udp_encaps, deadline_usecs, packet,
+				     &num_packets, error);
 	local_netdev_read_queue(netdev, num_packets);
 	return status;
 }
 
+/* Return the number of microseconds from now until the given wall
+ * clock time.
+ */
+static s64 usecs_until(s64 deadline_usecs)
+{
+	struct timeval now;
+
+	if (gettimeofday(&now, NULL) < 0)
+		die_perror("gettimeofday");
+	return deadline_usecs - timeval_to_usecs(&now);
+}
+
 int netdev_receive_loop(struct packet_socket *psock,
+			struct packet_pool *pool,
 			enum direction_t direction,
 			u8 udp_encaps,
+			s64 deadline_usecs,
 			struct packet **packet,
 			int *num_packets,
 			char **error)
 {
 	u16 ether_type;
+	bool draining = false;
+	int status;
 
 	assert(*packet == NULL);	/* should be no packet yet */
 
@@ -558,11 +694,38 @@ int netdev_receive_loop(struct packet_socket *psock,
 		int in_bytes = 0;
 		enum packet_parse_result_t result;
 
-		*packet = packet_new(PACKET_READ_BYTES);
+		/* Wait for a packet without blocking past our deadline. Once
+		 * the deadline has passed we still drain whatever the kernel
+		 * has already sniffed, since a packet sent in time may only
+		 * have been queued for us after we woke up; verify_time()
+		 * then judges it by its sniffed timestamp.
+		 */
+		if (deadline_usecs != NO_DEADLINE) {
+			s64 timeout_usecs = usecs_until(deadline_usecs);
+
+			if (timeout_usecs <= 0) {
+				draining = true;
+				if (packet_socket_wait(psock, 0))
+					goto timeout;
+			} else if (packet_socket_wait(psock, timeout_usecs)) {
+				continue;
+			}
+		}
 
-		/* Sniff the next outbound packet from the kernel under test. */
-		if (packet_socket_receive(psock, direction, &ether_type,
-					  *packet, &in_bytes))
+		/* Reuse the buffer if we didn't manage to read anything. */
+		if (*packet == NULL)
+			*packet = packet_pool_get(pool, PACKET_READ_BYTES);
+
+		/* Sniff the next outbound packet from the kernel under test.
+		 * While draining, a packet we filtered out says nothing
+		 * about what is queued behind it, so we go back and let
+		 * packet_socket_wait() tell us whether the queue is empty.
+		 */
+		status = packet_socket_receive(psock, direction, &ether_type,
+					       *packet, &in_bytes);
+		if (status == STATUS_TIMEOUT && draining)
+			goto timeout;
+		if (status != STATUS_OK)
 			continue;
 
 		++*num_packets;
@@ -582,12 +745,17 @@ int netdev_receive_loop(struct packet_socket *psock,
 		       result, *error);
 	}
 
-	assert(!"should not be reached");
-	return STATUS_ERR;	/* not reached */
+timeout:
+	if (*packet != NULL) {
+		packet_free(*packet);
+		*packet = NULL;
+	}
+	return STATUS_TIMEOUT;
 }
 
 struct netdev_ops local_netdev_ops = {
 	.free = local_netdev_free,
 	.send = local_netdev_send,
+	.send_batch = local_netdev_send_batch,
 	.receive = local_netdev_receive,
 };
@@ -30,11 +30,18 @@
 
 #include "config.h"
 #include "packet.h"
+#include "packet_pool.h"
 #include "packet_parser.h"
 #include "packet_socket.h"
 
 struct netdev_ops;
 
+/* A receive deadline meaning "wait as long as it takes". */
+#define NO_DEADLINE	-1
+
+/* Most packets we inject with one netdev_send_batch() call. */
+#define NETDEV_MAX_BATCH	64
+
 /* A C-style poor-man's "pure virtual" netdev. */
 struct netdev {
 	struct netdev_ops *ops;	/* C-style vtable pointer */
@@ -48,11 +55,21 @@ struct netdev_ops {
 	int (*send)(struct netdev *netdev,
 		    struct packet *packet);
 
+	/* Inject 'num_packets' raw TCP/IP packets into the kernel, back
+	 * to back and in order. Optional: if NULL we call send() for
+	 * each packet in turn.
+	 */
+	int (*send_batch)(struct netdev *netdev,
+			  struct packet **packets, int num_packets);
+
 	/* Sniff the next TCP/IP packet leaving the kernel and return a
-	 * pointer to the newly-allocated packet. Caller must free the packet
-	 * with packet_free().
+	 * pointer to a packet allocated from the given pool. Caller must
+	 * free the packet with packet_free(). Gives up and returns
+	 * STATUS_TIMEOUT if no packet arrives by 'deadline_usecs' (wall
+	 * clock time, as from now_usecs()), unless that is NO_DEADLINE.
 	 */
-	int (*receive)(struct netdev *netdev, u8 udp_encaps,
+	int (*receive)(struct netdev *netdev, struct packet_pool *pool,
+		       u8 udp_encaps, s64 deadline_usecs,
 		       struct packet **packet, char **error);
 };
 
@@ -70,26 +87,55 @@ static inline int netdev_send(struct netdev *netdev,
 	return netdev->ops->send(netdev, packet);
 }
 
+/* Inject up to NETDEV_MAX_BATCH raw TCP/IP packets into the kernel,
+ * back to back and in order, with as few system calls as the netdev
+ * can manage.
+ */
+static inline int netdev_send_batch(struct netdev *netdev,
+				    struct packet **packets, int num_packets)
+{
+	int i;
+
+	assert(num_packets <= NETDEV_MAX_BATCH);
+	if (netdev->ops->send_batch != NULL)
+		return netdev->ops->send_batch(netdev, packets, num_packets);
+	for (i = 0; i < num_packets; ++i) {
+		if (netdev->ops->send(netdev, packets[i]))
+			return STATUS_ERR;
+	}
+	return STATUS_OK;
+}
+
 /* Sniff the next TCP/IP packet leaving the kernel and return a
- * pointer to the newly-allocated packet. Caller must free the packet
- * with packet_free().
+ * pointer to a packet allocated from the given pool. Caller must free
+ * the packet with packet_free(). Returns STATUS_TIMEOUT if no packet
+ * arrives by 'deadline_usecs', unless that is NO_DEADLINE.
  */
 static inline int netdev_receive(struct netdev *netdev,
+				 struct packet_pool *pool,
 				 u8 udp_encaps,
+				 s64 deadline_usecs,
 				 struct packet **packet,
 				 char **error)
 {
-	return netdev->ops->receive(netdev, udp_encaps, packet, error);
+	return netdev->ops->receive(netdev, pool, udp_encaps, deadline_usecs,
+				    packet, error);
 }
 
 
 /* Keep sniffing packets leaving the kernel until we see one we know
- * about and can parse. Return a pointer to the newly-allocated
- * packet. Caller must free the packet with packet_free().
+ * about and can parse. Return a pointer to a packet allocated from
+ * the given pool. Caller must free the packet with packet_free().
+ * Returns STATUS_TIMEOUT if there is no such packet by
+ * 'deadline_usecs', unless that is NO_DEADLINE; packets the kernel had
+ * already sniffed by then are still returned, so that the caller can
+ * judge them by their sniffed timestamps.
  */
 extern int netdev_receive_loop(struct packet_socket *psock,
+			       struct packet_pool *pool,
 			       enum direction_t direction,
 			       u8 udp_encaps,
+			       s64 deadline_usecs,
 			       struct packet **packet,
 			       int *num_packets,
 			       char **error);
@@ -32,6 +32,7 @@
 #include "gre_packet.h"
 #include "ip_packet.h"
 #include "mpls_packet.h"
+#include "packet_pool.h"
 #include "sctp_packet.h"
 #include "udp_packet.h"
 
@@ -62,6 +63,10 @@ struct packet *packet_new(u32 buffer_bytes)
 
 void packet_free(struct packet *packet)
 {
+	if (packet->pool != NULL) {
+		packet_pool_put(packet);
+		return;
+	}
 	sctp_chunk_list_free(packet->chunk_list);
 	free(packet->buffer);
 	memset(packet, 0, sizeof(*packet));  /* paranoia to help catch bugs */
@@ -137,16 +142,18 @@ static void *offset_ptr(u8 *old_base, u8* new_base, void *old_ptr)
 /* Make a copy of the given old packet, but in the new copy reserve the
  * given number of bytes of headroom at the start of the packet->buffer.
  * This empty headroom can later be filled with outer packet headers.
+ * The new packet is allocated from the given pool, which may be NULL.
  * A slow but simple model.
  */
-static struct packet *packet_copy_with_headroom(struct packet *old_packet,
+static struct packet *packet_copy_with_headroom(struct packet_pool *pool,
+						struct packet *old_packet,
 						int bytes_headroom)
 {
 	/* Allocate a new packet and copy link layer header and IP datagram. */
 	const int bytes_used = packet_end(old_packet) - old_packet->buffer;
 	assert(bytes_used >= 0);
 	assert(bytes_used <= 128*1024);
-	struct packet *packet = packet_new(max(bytes_headroom + bytes_used, old_packet->buffer_bytes));
+	struct packet *packet = packet_pool_get(pool, max(bytes_headroom + bytes_used, old_packet->buffer_bytes));
 	u8 *old_base = old_packet->buffer;
 	u8 *new_base = packet->buffer + bytes_headroom;
 	struct sctp_chunk_list_item *old_chunk_item, *new_chunk_item;
@@ -180,6 +187,7 @@ static struct packet *packet_copy_with_headroom(struct packet *old_packet,
 	packet->icmpv6	= offset_ptr(old_base, new_base, old_packet->icmpv6);
         
         if (old_packet->chunk_list == NULL) {
+		sctp_chunk_list_free(packet->chunk_list);
 		packet->chunk_list = NULL;
 		return packet;
         }
@@ -231,7 +239,13 @@ static struct packet *packet_copy_with_headroom(struct packet *old_packet,
 
 struct packet *packet_copy(struct packet *old_packet)
 {
-	return packet_copy_with_headroom(old_packet, 0);
+	return packet_copy_with_headroom(old_packet->pool, old_packet, 0);
+}
+
+struct packet *packet_copy_in_pool(struct packet_pool *pool,
+				   struct packet *old_packet)
+{
+	return packet_copy_with_headroom(pool, old_packet, 0);
 }
 
 /* Finalize all the headers once we know what's inside inner layers. */
@@ -263,7 +277,7 @@ struct packet *packet_encapsulate(struct packet *outer, struct packet *inner)
 	assert(outer_headers + inner_headers <= PACKET_MAX_HEADERS);
 
 	/* Copy the inner packet bits and header metadata. */
-	packet = packet_copy_with_headroom(inner, outer->ip_bytes);
+	packet = packet_copy_with_headroom(inner->pool, inner, outer->ip_bytes);
 
 	/* Copy over the bits in the outer headers. */
 	memcpy(packet->buffer, outer->buffer, outer->ip_bytes);
@@ -42,6 +42,8 @@
 #include "udplite.h"
 #include "unaligned.h"
 
+struct packet_pool;
+
 /* The data offset field is 4 bits, and specifies the length of the TCP header,
  * including options, in 32-bit words.
  */
@@ -116,11 +118,15 @@ struct packet {
 #define FLAGS_UDP_ENCAPSULATED    0x80 /* TCP/UDP or SCTP/UDP encapsulated */
 #define FLAG_IGNORE_TS_VAL        0x100 /* set to ignore processing of TS val */
 #define FLAG_IGNORE_SEQ           0x200 /* set to ignore processing of sequence numbers */
+#define FLAG_CHECKSUMS_VALID      0x400 /* checksums filled in and kept current */
 
 	enum ip_ecn_t ecn;	/* IPv4/IPv6 ECN treatment for packet */
 
 	__be32 *tcp_ts_val;	/* location of TCP timestamp val, or NULL */
 	__be32 *tcp_ts_ecr;	/* location of TCP timestamp ecr, or NULL */
+
+	struct packet_pool *pool;	/* pool we came from, or NULL */
+	struct packet *pool_next;	/* next free packet in our pool */
 };
 
 /* Allocate and initialize a packet. */
@@ -129,9 +135,15 @@ extern struct packet *packet_new(u32 buffer_length);
 /* Free all the memory used by the packet. */
 extern void packet_free(struct packet *packet);
 
-/* Create a packet that is a copy of the contents of the given packet. */
+/* Create a packet that is a copy of the contents of the given packet.
+ * The copy comes from the same pool as the original, if any.
+ */
 extern struct packet *packet_copy(struct packet *old_packet);
 
+/* Create a copy of the given packet, allocated from the given pool. */
+extern struct packet *packet_copy_in_pool(struct packet_pool *pool,
+					  struct packet *old_packet);
+
 /* Return the number of headers in the given packet. */
 extern int packet_header_count(const struct packet *packet);
 
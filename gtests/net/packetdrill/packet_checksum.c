@@ -211,6 +211,33 @@ static void checksum_ipv6_packet(struct packet *packet)
 	}
 }
 
+/* Returns the start of the layer 4 header whose checksum we can
+ * maintain incrementally, or NULL if there is none.
+ */
+static u8 *incremental_l4_header(struct packet *packet)
+{
+	if (packet->flags & FLAGS_UDP_ENCAPSULATED)
+		return NULL;
+	if (packet->tcp != NULL)
+		return (u8 *)packet->tcp;
+	if (packet->udp != NULL)
+		return (u8 *)packet->udp;
+	if (packet->udplite != NULL)
+		return (u8 *)packet->udplite;
+	return NULL;
+}
+
+/* Returns the location of the layer 4 checksum field. */
+static __sum16 *l4_checksum(struct packet *packet)
+{
+	if (packet->tcp != NULL)
+		return &packet->tcp->check;
+	if (packet->udp != NULL)
+		return &packet->udp->check;
+	assert(packet->udplite != NULL);
+	return &packet->udplite->check;
+}
+
 void checksum_packet(struct packet *packet)
 {
 	int address_family = packet_address_family(packet);
@@ -220,4 +247,46 @@ void checksum_packet(struct packet *packet)
 		checksum_ipv6_packet(packet);
 	else
 		assert(!"bad ip version");
+
+	if (incremental_l4_header(packet) != NULL)
+		packet->flags |= FLAG_CHECKSUMS_VALID;
+	else
+		packet->flags &= ~FLAG_CHECKSUMS_VALID;
+}
+
+void checksum_packet_update_l4(struct packet *packet, const void *field,
+			       const void *old_bytes, int len)
+{
+	__sum16 *check;
+	u16 delta;
+	bool odd_offset;
+
+	if (!(packet->flags & FLAG_CHECKSUMS_VALID))
+		return;
+
+	odd_offset = (((const u8 *)field -
+		       incremental_l4_header(packet)) % 2) != 0;
+	delta = checksum_delta(old_bytes, field, len);
+	check = l4_checksum(packet);
+	*check = checksum_apply_delta(*check, delta, odd_offset);
+}
+
+void checksum_packet_update_ip(struct packet *packet, const void *field,
+			       const void *old_bytes, int len)
+{
+	__sum16 *check;
+	u16 delta;
+
+	if (!(packet->flags & FLAG_CHECKSUMS_VALID))
+		return;
+
+	/* Addresses sit at even offsets both in the IP header and in
+	 * the layer 4 pseudo-header.
+	 */
+	delta = checksum_delta(old_bytes, field, len);
+	if (packet->ipv4 != NULL)
+		packet->ipv4->check =
+			checksum_apply_delta(packet->ipv4->check, delta, false);
+	check = l4_checksum(packet);
+	*check = checksum_apply_delta(*check, delta, false);
 }
@@ -27,7 +27,28 @@
 
 #include "packet.h"
 
-/* Fill in layer 3 and layer 4 checksums for the given input 'packet'. */
+/* Fill in layer 3 and layer 4 checksums for the given input 'packet'.
+ * For plain (not UDP-encapsulated) TCP, UDP and UDPLite packets this
+ * also sets FLAG_CHECKSUMS_VALID, so that header fields can later be
+ * rewritten with the update helpers below without a full re-checksum.
+ */
 extern void checksum_packet(struct packet *packet);
 
+/* After rewriting 'len' bytes at 'field' inside the TCP, UDP or
+ * UDPLite header of a packet, whose previous contents were
+ * 'old_bytes', incrementally update the layer 4 checksum to match.
+ * A no-op unless the packet has FLAG_CHECKSUMS_VALID.
+ */
+extern void checksum_packet_update_l4(struct packet *packet,
+				      const void *field,
+				      const void *old_bytes, int len);
+
+/* Likewise, after rewriting an IP source or destination address,
+ * incrementally update the IPv4 header checksum (if any) and the
+ * layer 4 checksum, whose pseudo-header covers the address.
+ */
+extern void checksum_packet_update_ip(struct packet *packet,
+				      const void *field,
+				      const void *old_bytes, int len);
+
 #endif /* __PACKET_CHECKSUM_H__ */
@@ -27,6 +27,7 @@
 #include <arpa/inet.h>
 #include <errno.h>
 #include <netinet/in.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -345,7 +346,8 @@ error_out:
 static int parse_sctp(struct packet *packet, u8 *layer4_start, int layer4_bytes,
 		      u8 *packet_end, char **error)
 {
-	u32 received_crc32c, computed_crc32c;
+	static const u8 zero_crc32c[sizeof(__be32)];
+	u32 received_crc32c, computed_crc32c, crc;
 	struct header *sctp_header = NULL;
 	u8 *p = layer4_start;
 
@@ -356,10 +358,14 @@ static int parse_sctp(struct packet *packet, u8 *layer4_start, int layer4_bytes,
 	}
 	packet->sctp = (struct sctp_common_header *) p;
 
+	/* The CRC covers the packet with its own field taken as zero. */
 	received_crc32c = ntohl(packet->sctp->crc32c);
-	packet->sctp->crc32c = htonl(0);
-	computed_crc32c = ntohl(sctp_crc32c(packet->sctp, layer4_bytes));
-	packet->sctp->crc32c = htonl(received_crc32c);
+	crc = crc32c_update(crc32c_init(), p,
+			    offsetof(struct sctp_common_header, crc32c));
+	crc = crc32c_update(crc, zero_crc32c, sizeof(zero_crc32c));
+	crc = crc32c_update(crc, p + sizeof(struct sctp_common_header),
+			    layer4_bytes - sizeof(struct sctp_common_header));
+	computed_crc32c = ntohl(crc32c_final(crc));
 	if (received_crc32c != computed_crc32c) {
 		asprintf(error, "Bad SCTP checksum 0x%08x (expected 0x%08x)",
 			 received_crc32c, computed_crc32c);
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2013 Google Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+/*
+ * Implementation for a pool that recycles packets and their buffers.
+ *
+ * Buffers come in power-of-two size classes, and each class keeps a
+ * free list of packets with buffers of exactly that size. Requests
+ * larger than the largest class bypass the pool entirely. The pool is
+ * not thread-safe; callers are expected to hold the global run lock.
+ */
+
+#include "packet_pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "assert.h"
+#include "sctp_packet.h"
+
+/* Size classes run from 512 bytes up to 128KB. */
+#define PACKET_POOL_MIN_SHIFT	9
+#define PACKET_POOL_MAX_SHIFT	17
+#define PACKET_POOL_CLASSES	(PACKET_POOL_MAX_SHIFT - \
+				 PACKET_POOL_MIN_SHIFT + 1)
+
+struct packet_pool {
+	/* Free packets in each size class, linked through pool_next. */
+	struct packet *free_list[PACKET_POOL_CLASSES];
+	int outstanding;	/* number of packets handed out */
+	bool is_closed;		/* has the owner called packet_pool_free()? */
+};
+
+/* Return the index of the smallest size class that fits the given
+ * number of bytes.
+ */
+static int size_class(u32 buffer_bytes)
+{
+	int class = 0;
+
+	while ((1U << (class + PACKET_POOL_MIN_SHIFT)) < buffer_bytes)
+		++class;
+	assert(class < PACKET_POOL_CLASSES);
+	return class;
+}
+
+/* Return the number of buffer bytes for packets of the given class. */
+static inline u32 class_bytes(int class)
+{
+	return 1U << (class + PACKET_POOL_MIN_SHIFT);
+}
+
+/* Free a packet for real, bypassing the pool. */
+static void packet_release(struct packet *packet)
+{
+	packet->pool = NULL;
+	packet_free(packet);
+}
+
+struct packet_pool *packet_pool_new(void)
+{
+	return calloc(1, sizeof(struct packet_pool));
+}
+
+void packet_pool_free(struct packet_pool *pool)
+{
+	int class;
+
+	for (class = 0; class < PACKET_POOL_CLASSES; ++class) {
+		struct packet *packet = pool->free_list[class];
+
+		while (packet != NULL) {
+			struct packet *next = packet->pool_next;
+
+			packet_release(packet);
+			packet = next;
+		}
+		pool->free_list[class] = NULL;
+	}
+
+	if (pool->outstanding == 0) {
+		free(pool);
+		return;
+	}
+	pool->is_closed = true;
+}
+
+struct packet *packet_pool_get(struct packet_pool *pool, u32 buffer_bytes)
+{
+	struct packet *packet = NULL;
+	struct sctp_chunk_list *chunk_list = NULL;
+	u8 *buffer = NULL;
+	int class;
+
+	if (pool == NULL || buffer_bytes > class_bytes(PACKET_POOL_CLASSES - 1))
+		return packet_new(buffer_bytes);
+
+	class = size_class(buffer_bytes);
+	packet = pool->free_list[class];
+	if (packet == NULL) {
+		packet = packet_new(class_bytes(class));
+	} else {
+		pool->free_list[class] = packet->pool_next;
+
+		/* Start from a clean slate, but keep our allocations. */
+		buffer = packet->buffer;
+		chunk_list = packet->chunk_list;
+		memset(packet, 0, sizeof(*packet));
+		packet->buffer = buffer;
+		packet->buffer_bytes = class_bytes(class);
+		packet->chunk_list = (chunk_list != NULL) ?
+			chunk_list : sctp_chunk_list_new();
+	}
+
+	packet->pool = pool;
+	++pool->outstanding;
+	return packet;
+}
+
+void packet_pool_put(struct packet *packet)
+{
+	struct packet_pool *pool = packet->pool;
+	int class;
+
+	assert(pool != NULL);
+	assert(pool->outstanding > 0);
+	--pool->outstanding;
+
+	if (pool->is_closed) {
+		packet_release(packet);
+		if (pool->outstanding == 0)
+			free(pool);
+		return;
+	}
+
+	if (packet->chunk_list != NULL)
+		sctp_chunk_list_clear(packet->chunk_list);
+
+	class = size_class(packet->buffer_bytes);
+	assert(class_bytes(class) == packet->buffer_bytes);
+	packet->pool_next = pool->free_list[class];
+	pool->free_list[class] = packet;
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2013 Google Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+/*
+ * Interface for a pool that recycles packets and their buffers, so
+ * that the per-packet hot paths (sniffing, copying) need not malloc.
+ */
+
+#ifndef __PACKET_POOL_H__
+#define __PACKET_POOL_H__
+
+#include "types.h"
+
+#include "packet.h"
+
+struct packet_pool;
+
+/* Allocate and initialize an empty packet pool. */
+extern struct packet_pool *packet_pool_new(void);
+
+/* Free the pool and all the packets cached in it. Packets still in
+ * use may still be freed with packet_free() afterward; the pool is
+ * not really released until the last of them is.
+ */
+extern void packet_pool_free(struct packet_pool *pool);
+
+/* Return a packet with a buffer of at least buffer_bytes, recycling a
+ * previously freed one if we can. The packet should be freed with
+ * packet_free() as usual, which gives it back to the pool. If pool is
+ * NULL, this is just packet_new().
+ */
+extern struct packet *packet_pool_get(struct packet_pool *pool,
+				      u32 buffer_bytes);
+
+/* Give a packet from packet_pool_get() back to its pool. Called by
+ * packet_free(); other callers should use packet_free().
+ */
+extern void packet_pool_put(struct packet *packet);
+
+#endif /* __PACKET_POOL_H__ */
@@ -49,18 +49,45 @@ extern void packet_socket_set_filter(
 	const struct ether_addr *client_ether_addr,
 	const struct ip_address *client_live_ip);
 
+/* Switch the packet socket to reading sniffed packets and their
+ * kernel timestamps out of a ring buffer shared with the kernel,
+ * rather than paying for a recvmsg() and a SIOCGSTAMP ioctl per
+ * packet. On platforms without such a ring this is a no-op.
+ */
+extern void packet_socket_enable_ring(struct packet_socket *psock);
+
 /* Send the given packet using writev. Return STATUS_OK on success,
  * or STATUS_ERR if writev returns an error.
  */
 extern int packet_socket_writev(struct packet_socket *psock,
 				const struct iovec *iov, int iovcnt);
 
+/* Send 'num_frames' packets back to back, where packet i is the
+ * 'iovcnt' entries of 'iov' starting at iov[i * iovcnt]. Where the
+ * platform allows this uses one sendmmsg() for the whole train rather
+ * than a writev() per packet. Return STATUS_OK if all were sent, or
+ * STATUS_ERR on the first error.
+ */
+extern int packet_socket_writev_batch(struct packet_socket *psock,
+				      const struct iovec *iov, int iovcnt,
+				      int num_frames);
+
+/* Wait up to 'timeout_usecs' microseconds for a packet to be ready
+ * for packet_socket_receive(). Returns STATUS_OK if one may be ready;
+ * else returns STATUS_ERR (on timeout or if interrupted by a signal),
+ * in which case the caller should check its deadline and retry.
+ */
+extern int packet_socket_wait(struct packet_socket *psock,
+			      s64 timeout_usecs);
+
 /* Do a blocking sniff of the next packet going over the given device
  * in the given direction, fill in the given packet with the sniffed
  * packet info, and return the number of bytes in the packet in
  * *in_bytes. If we successfully read a matching packet, return
- * STATUS_OK; else return STATUS_ERR (in which case the caller can
- * retry).
+ * STATUS_OK. If there is no packet to read yet (only possible where
+ * packet_socket_wait() cannot wait), return STATUS_TIMEOUT. Else
+ * return STATUS_ERR, e.g. for a packet we filtered out (in which
+ * case the caller can retry).
  */
 extern int packet_socket_receive(struct packet_socket *psock,
 				 enum direction_t direction, u16 *ether_type,
@@ -26,16 +26,19 @@
 
 #include <errno.h>
 #include <net/if.h>
+#include <poll.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
 #include <sys/uio.h>
 #include <unistd.h>
 
 #ifdef linux
 
-#include <netpacket/packet.h>
 #include <linux/filter.h>
+#include <linux/if_packet.h>	/* for tpacket2_hdr, beyond netpacket/packet.h */
 
 #include "assert.h"
 #include "ethernet.h"
@@ -44,11 +47,30 @@
 /* Number of bytes to buffer in the packet socket we use for sniffing. */
 static const int PACKET_SOCKET_RCVBUF_BYTES = 2*1024*1024;
 
+/* Geometry of the optional TPACKET_V2 receive ring. We use V2 rather
+ * than V3 because V2 hands each frame to us as soon as the kernel has
+ * filled it in, while V3 only hands over whole blocks, when they fill
+ * up or their retire timer (at least a jiffy) fires; that would make
+ * every sniffed packet up to a jiffy late, eating into tolerance_usecs.
+ * Each frame (one per block) holds a maximal (GSO) packet of
+ * PACKET_READ_BYTES plus the frame header, so packets are truncated
+ * just as recvmsg() would truncate them.
+ */
+#define PACKET_RING_FRAME_BYTES	(128*1024)
+#define PACKET_RING_FRAMES	64
+
+/* Most packets we hand to one sendmmsg() call. */
+#define PACKET_SOCKET_BATCH_FRAMES	64
+
 struct packet_socket {
 	int packet_fd;	/* socket for sending, sniffing timestamped packets */
 	char *name;	/* malloc-allocated copy of interface name */
 	int index;	/* interface index from if_nametoindex */
 	bool trim_ethernet_header;
+
+	/* State for reading from a PACKET_RX_RING, if enabled. */
+	u8 *ring;		/* mmap-ed ring of frames, or NULL */
+	int ring_frame;		/* index of the next frame to read */
 };
 
 /* Set the receive buffer for a socket to the given size in bytes. */
@@ -191,6 +213,87 @@ void packet_socket_set_filter(struct packet_socket *psock,
 	psock->trim_ethernet_header = true;
 }
 
+/* Return the header of the frame with the given index in our ring. */
+static inline struct tpacket2_hdr *ring_frame(struct packet_socket *psock,
+					      int index)
+{
+	return (struct tpacket2_hdr *)
+		(psock->ring + index * PACKET_RING_FRAME_BYTES);
+}
+
+void packet_socket_enable_ring(struct packet_socket *psock)
+{
+	struct tpacket_req req;
+	int version = TPACKET_V2;
+
+	assert(PACKET_RING_FRAME_BYTES >=
+	       TPACKET2_HDRLEN + sizeof(struct ether_header) +
+	       PACKET_READ_BYTES);
+
+	if (setsockopt(psock->packet_fd, SOL_PACKET, PACKET_VERSION,
+		       &version, sizeof(version)) < 0)
+		die_perror("setsockopt SOL_PACKET PACKET_VERSION");
+
+	memset(&req, 0, sizeof(req));
+	req.tp_block_size	= PACKET_RING_FRAME_BYTES;
+	req.tp_block_nr		= PACKET_RING_FRAMES;
+	req.tp_frame_size	= PACKET_RING_FRAME_BYTES;
+	req.tp_frame_nr		= PACKET_RING_FRAMES;
+	if (setsockopt(psock->packet_fd, SOL_PACKET, PACKET_RX_RING,
+		       &req, sizeof(req)) < 0)
+		die_perror("setsockopt SOL_PACKET PACKET_RX_RING");
+
+	psock->ring = mmap(NULL, PACKET_RING_FRAME_BYTES * PACKET_RING_FRAMES,
+			   PROT_READ | PROT_WRITE, MAP_SHARED,
+			   psock->packet_fd, 0);
+	if (psock->ring == MAP_FAILED)
+		die_perror("mmap PACKET_RX_RING");
+
+	psock->ring_frame = 0;
+}
+
+/* Return true iff the kernel has handed us the next frame to read. */
+static bool ring_frame_ready(struct packet_socket *psock)
+{
+	struct tpacket2_hdr *frame = ring_frame(psock, psock->ring_frame);
+
+	return (__atomic_load_n(&frame->tp_status, __ATOMIC_ACQUIRE) &
+		TP_STATUS_USER) != 0;
+}
+
+/* Return the next unread frame in the ring, waiting for the kernel
+ * to fill it in if need be. Returns NULL if we were interrupted by a
+ * signal.
+ */
+static struct tpacket2_hdr *ring_next_frame(struct packet_socket *psock)
+{
+	struct pollfd pfd;
+
+	while (!ring_frame_ready(psock)) {
+		memset(&pfd, 0, sizeof(pfd));
+		pfd.fd = psock->packet_fd;
+		pfd.events = POLLIN | POLLERR;
+		if (poll(&pfd, 1, -1) < 0) {
+			if (errno == EINTR)
+				return NULL;
+			die_perror("poll packet socket");
+		}
+	}
+	return ring_frame(psock, psock->ring_frame);
+}
+
+/* We're done with the frame ring_next_frame() returned. Hand it back
+ * to the kernel and advance to the next one.
+ */
+static void ring_frame_done(struct packet_socket *psock)
+{
+	struct tpacket2_hdr *frame = ring_frame(psock, psock->ring_frame);
+
+	__atomic_store_n(&frame->tp_status, TP_STATUS_KERNEL,
+			 __ATOMIC_RELEASE);
+	psock->ring_frame = (psock->ring_frame + 1) % PACKET_RING_FRAMES;
+}
+
 struct packet_socket *packet_socket_new(const char *device_name)
 {
 	struct packet_socket *psock = calloc(1, sizeof(struct packet_socket));
@@ -206,6 +309,10 @@ struct packet_socket *packet_socket_new(const char *device_name)
 
 void packet_socket_free(struct packet_socket *psock)
 {
+	if (psock->ring != NULL)
+		munmap(psock->ring,
+		       PACKET_RING_FRAME_BYTES * PACKET_RING_FRAMES);
+
 	if (psock->packet_fd >= 0)
 		close(psock->packet_fd);
 
@@ -226,6 +333,154 @@ int packet_socket_writev(struct packet_socket *psock,
 	return STATUS_OK;
 }
 
+int packet_socket_writev_batch(struct packet_socket *psock,
+			       const struct iovec *iov, int iovcnt,
+			       int num_frames)
+{
+	struct mmsghdr msgs[PACKET_SOCKET_BATCH_FRAMES];
+	int i, num_msgs, sent;
+
+	while (num_frames > 0) {
+		num_msgs = min(num_frames, PACKET_SOCKET_BATCH_FRAMES);
+		memset(msgs, 0, num_msgs * sizeof(msgs[0]));
+		for (i = 0; i < num_msgs; ++i) {
+			msgs[i].msg_hdr.msg_iov = (struct iovec *)iov;
+			msgs[i].msg_hdr.msg_iovlen = iovcnt;
+			iov += iovcnt;
+		}
+
+		/* sendmmsg() may stop short; send what it left. */
+		for (i = 0; i < num_msgs; i += sent) {
+			sent = sendmmsg(psock->packet_fd, msgs + i,
+					num_msgs - i, 0);
+			if (sent < 0) {
+				perror("sendmmsg");
+				return STATUS_ERR;
+			}
+		}
+		num_frames -= num_msgs;
+	}
+	return STATUS_OK;
+}
+
+int packet_socket_wait(struct packet_socket *psock, s64 timeout_usecs)
+{
+	struct timespec timeout;
+	struct pollfd pfd;
+	int ready;
+
+	if (psock->ring != NULL && ring_frame_ready(psock))
+		return STATUS_OK;
+
+	if (timeout_usecs < 0)
+		timeout_usecs = 0;
+	timeout.tv_sec = timeout_usecs / 1000000;
+	timeout.tv_nsec = (timeout_usecs % 1000000) * 1000;
+
+	memset(&pfd, 0, sizeof(pfd));
+	pfd.fd = psock->packet_fd;
+	pfd.events = POLLIN | POLLERR;
+	ready = ppoll(&pfd, 1, &timeout, NULL);
+	if (ready < 0) {
+		if (errno == EINTR)
+			return STATUS_ERR;
+		die_perror("ppoll packet socket");
+	}
+	return (ready > 0) ? STATUS_OK : STATUS_ERR;
+}
+
+/* Return STATUS_OK if a packet sniffed with the given link-level
+ * address info is one we're looking for, else STATUS_ERR.
+ */
+static int check_sniffed_packet(struct packet_socket *psock,
+				enum direction_t direction,
+				const struct sockaddr_ll *from)
+{
+	/* We only want packets our kernel is sending out. */
+	if (direction == DIRECTION_OUTBOUND &&
+	    from->sll_pkttype != PACKET_OUTGOING) {
+		DEBUGP("not outbound\n");
+		return STATUS_ERR;
+	}
+	if (direction == DIRECTION_INBOUND &&
+	    from->sll_pkttype != PACKET_HOST) {
+		DEBUGP("not inbound\n");
+		return STATUS_ERR;
+	}
+
+	/* We only want packets on our tun device. The kernel
+	 * can put packets for other devices in our receive
+	 * buffer before we bind the packet socket to the tun
+	 * device.
+	 */
+	if (from->sll_ifindex != psock->index) {
+		DEBUGP("not correct index\n");
+		return STATUS_ERR;
+	}
+	return STATUS_OK;
+}
+
+/* Sniff the next packet out of our PACKET_RX_RING. Same contract as
+ * packet_socket_receive().
+ */
+static int packet_socket_ring_receive(struct packet_socket *psock,
+				      enum direction_t direction,
+				      u16 *ether_type, struct packet *packet,
+				      int *in_bytes)
+{
+	const struct ether_header *ether;
+	struct tpacket2_hdr *frame;
+	struct sockaddr_ll *from;
+	int result = STATUS_ERR;
+	u8 *data;
+	int len;
+
+	frame = ring_next_frame(psock);
+	if (frame == NULL) {
+		DEBUGP("EINTR\n");
+		return STATUS_ERR;
+	}
+	from = (struct sockaddr_ll *)
+		((u8 *)frame + TPACKET_ALIGN(sizeof(struct tpacket2_hdr)));
+	data = (u8 *)frame + frame->tp_mac;
+	len = frame->tp_snaplen;
+
+	if (check_sniffed_packet(psock, direction, from) != STATUS_OK)
+		goto out;
+
+	/* The kernel stamped the frame when it sniffed the packet. */
+	packet->time_usecs = ((s64)frame->tp_sec * 1000000LL +
+			      frame->tp_nsec / 1000);
+	DEBUGP("sniffed packet sent at %u.%09u = %lld\n",
+	       frame->tp_sec, frame->tp_nsec, packet->time_usecs);
+
+	DEBUGP("reported sll_protocol = 0x%04x\n", ntohs(from->sll_protocol));
+	if (psock->trim_ethernet_header) {
+		if (len < sizeof(struct ether_header)) {
+			DEBUGP("packet does not contain ethernet header\n");
+			goto out;
+		}
+		ether = (const struct ether_header *)data;
+		*ether_type = ntohs(ether->ether_type);
+		data += sizeof(struct ether_header);
+		len -= sizeof(struct ether_header);
+	} else {
+		*ether_type = ntohs(from->sll_protocol);
+	}
+	DEBUGP("ether_type is 0x%04x\n", *ether_type);
+
+	/* Truncate just like recvmsg() would. */
+	if (len > packet->buffer_bytes)
+		len = packet->buffer_bytes;
+	memcpy(packet->buffer, data, len);
+	*in_bytes = len;
+	result = STATUS_OK;
+
+out:
+	ring_frame_done(psock);
+	return result;
+}
+
 int packet_socket_receive(struct packet_socket *psock,
 			  enum direction_t direction, u16 *ether_type,
 			  struct packet *packet, int *in_bytes)
@@ -235,6 +490,10 @@ int packet_socket_receive(struct packet_socket *psock,
 	struct iovec iov[2];
 	struct msghdr msg;
 
+	if (psock->ring != NULL)
+		return packet_socket_ring_receive(psock, direction, ether_type,
+						  packet, in_bytes);
+
 	/* Read the packet out of our kernel packet socket buffer. */
 	memset(&from, 0, sizeof(from));
 	if (psock->trim_ethernet_header) {
@@ -269,27 +528,8 @@ int packet_socket_receive(struct packet_socket *psock,
 		}
 	}
 
-	/* We only want packets our kernel is sending out. */
-	if (direction == DIRECTION_OUTBOUND &&
-	    from.sll_pkttype != PACKET_OUTGOING) {
-		DEBUGP("not outbound\n");
-		return STATUS_ERR;
-	}
-	if (direction == DIRECTION_INBOUND &&
-	    from.sll_pkttype != PACKET_HOST) {
-		DEBUGP("not inbound\n");
-		return STATUS_ERR;
-	}
-
-	/* We only want packets on our tun device. The kernel
-	 * can put packets for other devices in our receive
-	 * buffer before we bind the packet socket to the tun
-	 * device.
-	 */
-	if (from.sll_ifindex != psock->index) {
-		DEBUGP("not correct index\n");
+	if (check_sniffed_packet(psock, direction, &from) != STATUS_OK)
 		return STATUS_ERR;
-	}
 
 	/* Get the time at which the kernel sniffed the packet. */
 	struct timeval tv;
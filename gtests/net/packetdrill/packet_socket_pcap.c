@@ -159,6 +159,11 @@ void packet_socket_set_filter(struct packet_socket *psock,
 	free(filter_str);
 }
 
+/* libpcap already does its own buffering, so there is nothing to do. */
+void packet_socket_enable_ring(struct packet_socket *psock)
+{
+}
+
 struct packet_socket *packet_socket_new(const char *device_name)
 {
 	struct packet_socket *psock = calloc(1, sizeof(struct packet_socket));
@@ -216,6 +221,29 @@ int packet_socket_writev(struct packet_socket *psock,
 	return STATUS_OK;
 }
 
+int packet_socket_writev_batch(struct packet_socket *psock,
+			       const struct iovec *iov, int iovcnt,
+			       int num_frames)
+{
+	/* pcap has no batched injection, so send them one at a time. */
+	int i;
+
+	for (i = 0; i < num_frames; ++i) {
+		if (packet_socket_writev(psock, iov + i * iovcnt, iovcnt))
+			return STATUS_ERR;
+	}
+	return STATUS_OK;
+}
+
+int packet_socket_wait(struct packet_socket *psock, s64 timeout_usecs)
+{
+	/* Our pcap_next_ex() calls do not block (see below), so the
+	 * caller spins on packet_socket_receive() and checks its
+	 * deadline each time around; there is nothing to wait for.
+	 */
+	return STATUS_OK;
+}
+
 int packet_socket_receive(struct packet_socket *psock,
 			  enum direction_t direction, u16 *ether_type,
 			  struct packet *packet, int *in_bytes)
@@ -244,7 +272,7 @@ int packet_socket_receive(struct packet_socket *psock,
 		if (status == 1)
 			break;		/* got a packet */
 		else if (status == 0)
-			return STATUS_ERR;	/* no packet yet */
+			return STATUS_TIMEOUT;	/* no packet yet */
 		else if (status == -1)
 			die("%s: %s\n", "pcap_inject", pcap_geterr(psock->pcap));
 		else if (status == -2)
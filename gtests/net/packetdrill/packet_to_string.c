@@ -315,14 +315,10 @@ static int encap_header_to_string(FILE *s, struct packet *packet, int layer,
 	return printer(s, packet, layer, format, error);
 }
 
-int packet_to_string(struct packet *packet,
-		     enum dump_format_t format,
-		     char **ascii_string, char **error)
+int packet_to_stream(FILE *s, struct packet *packet,
+		     enum dump_format_t format, char **error)
 {
 	assert(packet != NULL);
-	int result = STATUS_ERR;       /* return value */
-	size_t size = 0;
-	FILE *s = open_memstream(ascii_string, &size);  /* output string */
 	int i;
 	int header_count = packet_header_count(packet);
 	int limit;
@@ -336,7 +332,7 @@ int packet_to_string(struct packet *packet,
 		if (packet->headers[i].type == HEADER_NONE)
 			break;
 		if (encap_header_to_string(s, packet, i, format, error))
-			goto out;
+			return STATUS_ERR;
 	}
 
 	if ((packet->ipv4 == NULL) && (packet->ipv6 == NULL)) {
@@ -345,31 +341,39 @@ int packet_to_string(struct packet *packet,
 		if (packet->sctp != NULL) {
 			if (sctp_packet_to_string(s, packet, limit, format,
 						  error))
-				goto out;
+				return STATUS_ERR;
 		} else if (packet->tcp != NULL) {
 			if (tcp_packet_to_string(s, packet, limit, format,
 						 error))
-				goto out;
+				return STATUS_ERR;
 		} else if (packet->udp != NULL) {
 			if (udp_packet_to_string(s, packet, format, error))
-				goto out;
+				return STATUS_ERR;
 		} else if (packet->udplite != NULL) {
 			if (udplite_packet_to_string(s, packet, format, error))
-				goto out;
+				return STATUS_ERR;
 		} else if (packet->icmpv4 != NULL) {
 			if (icmpv4_packet_to_string(s, packet, format, error))
-				goto out;
+				return STATUS_ERR;
 		} else if (packet->icmpv6 != NULL) {
 			if (icmpv6_packet_to_string(s, packet, format, error))
-				goto out;
+				return STATUS_ERR;
 		} else {
 			fputs("[No SCTP, TCP, UDP, UDPLite or ICMP header]", s);
 		}
 	}
 
-	result = STATUS_OK;
+	return STATUS_OK;
+}
+
+int packet_to_string(struct packet *packet,
+		     enum dump_format_t format,
+		     char **ascii_string, char **error)
+{
+	size_t size = 0;
+	FILE *s = open_memstream(ascii_string, &size);  /* output string */
+	int result = packet_to_stream(s, packet, format, error);
 
-out:
 	fclose(s);
 	return result;
 }
@@ -25,6 +25,7 @@
 #ifndef __PACKET_TO_STRING_H__
 #define __PACKET_TO_STRING_H__
 
+#include <stdio.h>
 #include "packet.h"
 
 enum dump_format_t {
@@ -41,4 +42,11 @@ extern int packet_to_string(struct packet *packet,
 			    enum dump_format_t format,
 			    char **ascii_string, char **error);
 
+/* As packet_to_string(), but writes the representation to the given
+ * stream, so callers building up a larger message need not allocate
+ * a string per packet.
+ */
+extern int packet_to_stream(FILE *s, struct packet *packet,
+			    enum dump_format_t format, char **error);
+
 #endif /* __PACKET_TO_STRING_H__ */
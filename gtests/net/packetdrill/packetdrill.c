@@ -32,12 +32,17 @@
 #endif
 #include <stdlib.h>
 #include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 #include <unistd.h>
 #include "assert.h"
 #include "config.h"
+#include "logging.h"
+#include "net_utils.h"
 #include "parse.h"
 #include "run.h"
 #include "script.h"
+#include "stats.h"
 #include "system.h"
 #include "wire_server.h"
 
@@ -67,6 +72,102 @@ static void run_init_scripts(struct config *config)
 	free(scripts);
 }
 
+#if defined(linux)
+/* A script being executed by a child process in --parallel mode. */
+struct script_job {
+	pid_t pid;		/* child process running the script, or 0 */
+	const char *script_path;	/* path of the script it is running */
+};
+
+/* Fork a child process that runs the given script in a network
+ * namespace of its own, so that its tun device, addresses and routes
+ * cannot collide with those of the scripts running next to it. A
+ * --replay never touches the kernel, so it runs without one.
+ * Returns the pid of the child.
+ */
+static pid_t fork_script(int argc, char *argv[], const char *script_path)
+{
+	struct config config;
+	struct script script;
+	pid_t pid;
+
+	fflush(stdout);
+	fflush(stderr);
+	pid = fork();
+	if (pid < 0)
+		die_perror("fork");
+	if (pid > 0)
+		return pid;
+
+	if (parse_script_and_set_config(argc, argv, &config, &script,
+					script_path, NULL))
+		exit(EXIT_FAILURE);
+	if (!config.dry_run && config.replay != NULL) {
+		/* A replay never touches the kernel, so it needs neither
+		 * a namespace nor any kernel state set up.
+		 */
+		run_script(&config, &script);
+	} else if (!config.dry_run) {
+		net_setup_namespace();
+		run_init_scripts(&config);
+		run_script(&config, &script);
+	}
+	exit(EXIT_SUCCESS);
+}
+
+/* Run the given scripts with at most config->parallel of them in
+ * flight at any time. Unlike the serial loop in main(), a failing
+ * script does not stop the others; we report each failure as it
+ * happens and return the number of scripts that failed.
+ */
+static int run_scripts_in_parallel(int argc, char *argv[],
+				   struct config *config, char **arg)
+{
+	struct script_job *jobs = calloc(config->parallel,
+					 sizeof(struct script_job));
+	int num_running = 0, num_failed = 0;
+	int i, status;
+	pid_t pid;
+
+	while (*arg != NULL || num_running > 0) {
+		if (*arg != NULL && num_running < config->parallel) {
+			for (i = 0; jobs[i].pid != 0; ++i)
+				;
+			jobs[i].script_path = *arg++;
+			jobs[i].pid = fork_script(argc, argv,
+						  jobs[i].script_path);
+			++num_running;
+			continue;
+		}
+
+		pid = waitpid(-1, &status, 0);
+		if (pid < 0)
+			die_perror("waitpid");
+		for (i = 0; i < config->parallel; ++i) {
+			if (jobs[i].pid == pid)
+				break;
+		}
+		if (i == config->parallel)
+			continue;	/* not one of ours */
+
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+			if (WIFSIGNALED(status))
+				fprintf(stderr, "%s: killed by signal %d\n",
+					jobs[i].script_path, WTERMSIG(status));
+			else
+				fprintf(stderr, "%s: failed\n",
+					jobs[i].script_path);
+			++num_failed;
+		}
+		jobs[i].pid = 0;
+		--num_running;
+	}
+
+	free(jobs);
+	return num_failed;
+}
+#endif  /* linux */
+
 int main(int argc, char *argv[])
 {
 	struct config config;
@@ -111,6 +212,41 @@ int main(int argc, char *argv[])
 		exit(EXIT_FAILURE);
 	}
 
+	if (config.replay != NULL && config.is_wire_client) {
+		fprintf(stderr,
+			"error: --replay does not support --wire_client\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/* Make sure we can write the report; each script appends a line. */
+	if (config.stats_json != NULL)
+		stats_report_init(config.stats_json);
+
+#if defined(linux)
+	if (config.netns && config.is_wire_client) {
+		fprintf(stderr,
+			"error: --netns does not support --wire_client\n");
+		exit(EXIT_FAILURE);
+	}
+	if (config.parallel > 1) {
+		if (config.is_wire_client) {
+			fprintf(stderr,
+				"error: --parallel does not support "
+				"--wire_client\n");
+			exit(EXIT_FAILURE);
+		}
+		if (config.pcap_out != NULL) {
+			fprintf(stderr,
+				"error: --parallel does not support "
+				"--pcap_out\n");
+			exit(EXIT_FAILURE);
+		}
+		if (run_scripts_in_parallel(argc, argv, &config, arg))
+			exit(EXIT_FAILURE);
+		return 0;
+	}
+#endif
+
 	/* Parse and run each script on the command line. */
 	for (; *arg != NULL; ++arg) {
 		struct script script;
@@ -121,11 +257,25 @@ int main(int argc, char *argv[])
 			exit(EXIT_FAILURE);
 
 		/* If --dry_run, then don't actually execute the script. */
-		if (config.dry_run)
-			continue;
+		if (!config.dry_run && config.replay != NULL) {
+			/* A replay never touches the kernel, so there is
+			 * no kernel state to set up.
+			 */
+			run_script(&config, &script);
+		} else if (!config.dry_run) {
+#if defined(linux)
+			/* Give each script a namespace of its own, so it
+			 * starts from clean network state (e.g. no
+			 * tcp_metrics left over from earlier scripts).
+			 */
+			if (config.netns)
+				net_setup_namespace();
+#endif
+			run_init_scripts(&config);
+			run_script(&config, &script);
+		}
 
-		run_init_scripts(&config);
-		run_script(&config, &script);
+		script_free(&script);
 	}
 
 	return 0;
@@ -56,7 +56,32 @@ extern int parse_script(struct config *config,
 			struct script *script,
 			struct invocation *callback_invocation);
 
-/* Config for lexing and parsing. */
-extern struct config *in_config;
+/* Everything the lexer and parser need while parsing one script. Each
+ * call to parse_script() has its own, so that several threads (e.g.
+ * wire server connections) can parse scripts at the same time.
+ */
+struct parse_context {
+	struct config *config;		/* config info needed for parsing */
+	struct script *script;		/* the script we are filling in */
+	struct arena *arena;		/* script->arena */
+	struct invocation *invocation;	/* for parse_and_finalize_config() */
+	const char *script_path;	/* path name, for error messages */
+	int script_line;		/* line of the statement being parsed */
+	int last_ifdef_line;		/* line of the open #ifdef, or 0 */
+
+	/* Allow passing absolute or ignore timestamp flags from the
+	 * timestamp option to new_tcp_packet(). Adding fields to
+	 * struct tcp_option, which might be cleaner, affects the
+	 * on-wire format.
+	 */
+	bool ignore_ts_val;
+	bool absolute_ts_ecr;
+};
+
+/* Runs the bison parser over ctx->script->buffer, with a flex scanner
+ * of its own reading the buffer in place. Returns the yyparse() result.
+ * This is internal to the parser; it is implemented in lexer.l.
+ */
+extern int parse_script_buffer(struct parse_context *ctx);
 
 #endif /* __PARSER_H__ */
@@ -83,7 +83,6 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <netinet/in.h>
-#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -102,6 +101,7 @@
 #include "udp_packet.h"
 #include "udplite_packet.h"
 #include "parse.h"
+#include "run_system_call.h"
 #include "script.h"
 #include "tcp.h"
 #include "tcp_options.h"
@@ -117,58 +117,28 @@
 extern int yydebug;
 #endif
 
-extern FILE *yyin;
-extern int yylineno;
-extern char *yytext;
-extern int yylex(void);
-extern int yyparse(void);
-extern int yywrap(void);
-extern const char *cleanup_cmd;
-
-/* This mutex guards all parser global variables declared in this file. */
-pthread_mutex_t parser_mutex = PTHREAD_MUTEX_INITIALIZER;
-
-/* The input to the parser: the path name of the script file to parse. */
-const char* current_script_path = NULL;
-
-/* The starting line number of the input script statement that we're
- * currently parsing. This may be different than yylineno if bison had
- * to look ahead and lexically scan a token on the following line to
- * decide that the current statement is done.
- */
-static int current_script_line = -1;
-
-/*
- * We uses this object to look up configuration info needed during
- * parsing (such as whether packets are IPv4 or IPv6).
- */
-struct config *in_config = NULL;
-
-/* The output of the parser: an output script containing
- * 1) a linked list of options
- * 2) a linked list of events
+/* The flex scanner is reentrant, so its state lives behind an opaque
+ * handle (a yyscan_t, which is a void *) rather than in globals.
  */
-static struct script *out_script = NULL;
-
-/* The test invocation to pass back to parse_and_finalize_config(). */
-struct invocation *invocation;
+extern int yylex(YYSTYPE *lvalp, YYLTYPE *llocp, void *scanner);
+extern int yyget_lineno(void *scanner);
+extern char *yyget_text(void *scanner);
+extern const char *cleanup_cmd;
 
-/* Temporary variables to allow passing absolute or ignore timestamp flags to
- * the tcp_options struct from the timestamp options. Adding fields
- * to struct tcp_option, which might be cleaner, affects the on-wire format.
+/* Copy the script contents into our single linear buffer. The scanner
+ * reads this buffer in place, and needs two NUL bytes after the text.
  */
-bool ignore_ts_val = false;
-bool absolute_ts_ecr = false;
-
-/* Copy the script contents into our single linear buffer. */
 void copy_script(const char *script_buffer, struct script *script)
 {
 	DEBUGP("copy_script\n");
 
 	free(script->buffer);
 	script->length = strlen(script_buffer);
-	script->buffer = strdup(script_buffer);
+	script->buffer = malloc(script->length + 2);
 	assert(script->buffer != NULL);
+	memcpy(script->buffer, script_buffer, script->length);
+	script->buffer[script->length] = '\0';
+	script->buffer[script->length + 1] = '\0';
 
 	DEBUGP("copy_script: %d bytes\n", script->length);
 }
@@ -190,11 +160,12 @@ void read_script(const char *script_path, struct script *script)
 			    script_path, strerror(errno));
 
 		/* Pick a buffer size larger than the file, so we'll
-		 * know if the file grew.
+		 * know if the file grew. Leave room for the two NUL
+		 * bytes the scanner needs after the text.
 		 */
 		size = max((int)script_info.st_size, size) + 1;
 
-		script->buffer = malloc(size);
+		script->buffer = malloc(size + 1);
 		assert(script->buffer != NULL);
 
 		/* Read the file into our buffer. */
@@ -221,6 +192,8 @@ void read_script(const char *script_path, struct script *script)
 		if (close(fd))
 			die_perror("close");
 	}
+	script->buffer[script->length] = '\0';
+	script->buffer[script->length + 1] = '\0';
 	DEBUGP("read_script: %d bytes\n", script->length);
 }
 
@@ -233,43 +206,27 @@ int parse_script(struct config *config,
 		 struct script *script,
 		 struct invocation *callback_invocation)
 {
-	/* This bison-generated parser is not multi-thread safe, so we
-	 * have a lock to prevent more than one thread using the
-	 * parser at the same time. This is useful in the wire server
-	 * context, where in general we may have more than one test
-	 * thread running at the same time.
-	 */
-	if (pthread_mutex_lock(&parser_mutex) != 0)
-		die_perror("pthread_mutex_lock");
+	struct parse_context ctx;
 
 #if YYDEBUG
 	yydebug = 1;
 #endif
 
-	/* Now parse the script from our buffer. */
-	yyin = fmemopen(script->buffer, script->length, "r");
-	if (yyin == NULL)
-		die_perror("fmemopen: parse error opening script buffer");
-
-	current_script_path = config->script_path;
-	in_config = config;
-	out_script = script;
-	invocation = callback_invocation;
+	if (script->arena == NULL)
+		script->arena = arena_new();
 
-	/* We have to reset the line number here since the wire server
-	 * can do more than one yyparse().
+	/* All parser state lives in this context and in the scanner, so
+	 * any number of threads may parse scripts at the same time.
 	 */
-	yylineno = 1;
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.config = config;
+	ctx.script = script;
+	ctx.arena = script->arena;
+	ctx.invocation = callback_invocation;
+	ctx.script_path = config->script_path;
+	ctx.script_line = -1;
 
-	int result = yyparse();		/* invoke bison-generated parser */
-	current_script_path = NULL;
-
-	if (fclose(yyin))
-		die_perror("fclose: error closing script buffer");
-
-	/* Unlock parser. */
-	if (pthread_mutex_unlock(&parser_mutex) != 0)
-		die_perror("pthread_mutex_unlock");
+	int result = parse_script_buffer(&ctx);
 
 	return result ? STATUS_ERR : STATUS_OK;
 }
@@ -277,35 +234,36 @@ int parse_script(struct config *config,
 /* Bison emits code to call this method when there's a parse-time error.
  * We print the line number and the error message.
  */
-static void yyerror(const char *message)
+static void yyerror(YYLTYPE *llocp, void *scanner,
+		    struct parse_context *ctx, const char *message)
 {
 	fprintf(stderr, "%s:%d: parse error at '%s': %s\n",
-		current_script_path, yylineno, yytext, message);
+		ctx->script_path, yyget_lineno(scanner), yyget_text(scanner),
+		message);
 }
 
 /* After we finish parsing each line of a script, we analyze the
  * semantics of the line. If we encounter an error then we print the
  * error message to stderr and exit with an error.
  */
-static void semantic_error(const char* message)
+static void semantic_error(struct parse_context *ctx, const char* message)
 {
-	assert(current_script_line >= 0);
+	assert(ctx->script_line >= 0);
 	die("%s:%d: semantic error: %s\n",
-	    current_script_path, current_script_line, message);
+	    ctx->script_path, ctx->script_line, message);
 }
 
-/* This standard callback is invoked by flex when it encounters
- * the end of a file. We return 1 to tell flex to return EOF.
- */
-int yywrap(void)
+/* Return zeroed memory owned by the script being parsed. */
+static void *parse_alloc(struct parse_context *ctx, size_t bytes)
 {
-	return 1;
+	return arena_alloc(ctx->arena, bytes);
 }
 
 /* Create and initalize a new expression. */
-static struct expression *new_expression(enum expression_t type)
+static struct expression *new_expression(struct parse_context *ctx,
+					 enum expression_t type)
 {
-	struct expression *expression = calloc(1, sizeof(struct expression));
+	struct expression *expression = parse_alloc(ctx, sizeof(struct expression));
 	expression->type = type;
 	return expression;
 }
@@ -313,48 +271,73 @@ static struct expression *new_expression(enum expression_t type)
 /* Create and initalize a new integer expression with the given
  * literal value and format string.
  */
-static struct expression *new_integer_expression(s64 num, const char *format)
+static struct expression *new_integer_expression(struct parse_context *ctx,
+						 s64 num, const char *format)
 {
-	struct expression *expression = new_expression(EXPR_INTEGER);
+	struct expression *expression = new_expression(ctx, EXPR_INTEGER);
 	expression->value.num = num;
 	expression->format = format;
 	return expression;
 }
 
+/* Create a new expression for an unquoted word. Words naming a known
+ * symbol (e.g. SOL_SOCKET) are resolved to integers right here, so
+ * evaluating system call arguments on the timed path does no lookups.
+ * Other words stay words; evaluate() reports them if they are used.
+ */
+static struct expression *new_word_expression(struct parse_context *ctx,
+					      char *word)
+{
+	struct expression *expression;
+	char *error = NULL;
+	s64 value;
+
+	if (symbol_to_int(word, &value, &error) == STATUS_OK)
+		return new_integer_expression(ctx, value, "%ld");
+	free(error);
+
+	expression = new_expression(ctx, EXPR_WORD);
+	expression->value.string = word;
+	return expression;
+}
+
 /* Create and initalize a new one-element expression_list. */
 static struct expression_list *new_expression_list(
-	struct expression *expression)
+	struct parse_context *ctx, struct expression *expression)
 {
 	struct expression_list *list;
-	list = calloc(1, sizeof(struct expression_list));
+	list = parse_alloc(ctx, sizeof(struct expression_list));
 	list->expression = expression;
 	list->next = NULL;
 	return list;
 }
 
 /* Add the expression to the end of the list. */
-static void expression_list_append(struct expression_list *list,
+static void expression_list_append(struct parse_context *ctx,
+				   struct expression_list *list,
 				   struct expression *expression)
 {
 	while (list->next != NULL) {
 		list = list->next;
 	}
-	list->next = new_expression_list(expression);
+	list->next = new_expression_list(ctx, expression);
 }
 
 /* Create and initialize a new option. */
-static struct option_list *new_option(char *name, char *value)
+static struct option_list *new_option(struct parse_context *ctx,
+				      char *name, char *value)
 {
-	struct option_list *opt = calloc(1, sizeof(struct option_list));
+	struct option_list *opt = parse_alloc(ctx, sizeof(struct option_list));
 	opt->name = name;
 	opt->value = value;
 	return opt;
 }
 
 /* Create and initialize a new event. */
-static struct event *new_event(enum event_t type)
+static struct event *new_event(struct parse_context *ctx,
+			       enum event_t type)
 {
-	struct event *e = calloc(1, sizeof(struct event));
+	struct event *e = parse_alloc(ctx, sizeof(struct event));
 	e->type = type;
 	e->time_usecs_end = NO_TIME_RANGE;
 	e->offset_usecs = NO_TIME_RANGE;
@@ -479,6 +462,12 @@ static struct tcp_option *new_tcp_exp_fast_open_option(const char *cookie_string
 %}
 
 %locations
+%define api.pure full
+%code requires {
+struct parse_context;
+}
+%parse-param {void *scanner} {struct parse_context *ctx}
+%lex-param {void *scanner}
 %expect 1  /* we expect a shift/reduce conflict for the | binary expression */
 /* The %union section specifies the set of possible types for values
  * for all nonterminal and terminal symbols in the grammar.
@@ -526,11 +515,9 @@ static struct tcp_option *new_tcp_exp_fast_open_option(const char *cookie_string
 	struct packet *packet;
 	struct sctp_chunk_list_item *chunk_list_item;
 	struct sctp_chunk_list *chunk_list;
-	struct sctp_byte_list_item *byte_list_item;
 	struct sctp_byte_list *byte_list;
 	struct sctp_u16_list *u16_list;
-	struct sctp_u16_list_item *u16_item;
-	struct sctp_sack_block_list_item *sack_block_list_item;
+	union sctp_sack_block sack_block;
 	struct sctp_sack_block_list *sack_block_list;
 	struct sctp_forward_tsn_ids_list *forward_tsn_ids_list;
 	struct sctp_forward_tsn_ids_list_item  *forward_tsn_ids_list_item;
@@ -795,11 +782,11 @@ static struct tcp_option *new_tcp_exp_fast_open_option(const char *cookie_string
 %type <integer> opt_cum_tsn opt_ppid opt_sender_next_tsn opt_receiver_next_tsn
 %type <integer> opt_req_sn opt_resp_sn opt_last_tsn opt_result opt_number_of_new_streams
 %type <byte_list> opt_val opt_info byte_list chunk_types_list
-%type <byte_list_item> byte
+%type <integer> byte
 %type <u16_list> u16_list
-%type <u16_item> u16_item
+%type <integer> u16_item
 %type <sack_block_list> opt_gaps opt_nr_gaps gap_list opt_dups dup_list
-%type <sack_block_list_item> gap dup
+%type <sack_block> gap dup
 %type <forward_tsn_ids_list> opt_stream_identifier  ids_list
 %type <forward_tsn_ids_list_item> id
 %type <i_forward_tsn_ids_list> opt_i_forward_tsn_stream_identifier i_forward_tsn_ids_list
@@ -813,24 +800,24 @@ static struct tcp_option *new_tcp_exp_fast_open_option(const char *cookie_string
 
 script
 : opt_options opt_init_command events opt_cleanup_command {
-	$$ = NULL;		/* The parser output is in out_script */
+	$$ = NULL;		/* The parser output is in ctx->script */
 }
 ;
 
 opt_options
 :		{
 	$$ = NULL;
-	parse_and_finalize_config(invocation);
+	parse_and_finalize_config(ctx->invocation);
 }
 | options	{
 	$$ = $1;
-	parse_and_finalize_config(invocation);
+	parse_and_finalize_config(ctx->invocation);
 }
 ;
 
 options
 : option		{
-	out_script->option_list = $1;
+	ctx->script->option_list = $1;
 	$$ = $1;		/* return the tail so we can append to it */
 }
 | options option	{
@@ -841,10 +828,10 @@ options
 
 option
 : option_flag '=' option_value {
-	$$ = new_option($1, $3);
+	$$ = new_option(ctx, $1, $3);
 }
 | option_flag {
-	$$ = new_option($1, NULL);
+	$$ = new_option(ctx, $1, NULL);
 }
 
 option_flag
@@ -852,44 +839,37 @@ option_flag
 ;
 
 option_value
-: INTEGER	{ $$ = strdup(yytext); }
+: INTEGER	{ $$ = arena_strdup(ctx->arena, yyget_text(scanner)); }
 | WORD		{ $$ = $1; }
 | STRING	{ $$ = $1; }
 | IPV4_ADDR	{ $$ = $1; }
 | IPV6_ADDR	{ $$ = $1; }
-| IPV4		{ $$ = strdup("ipv4"); }
-| IPV6		{ $$ = strdup("ipv6"); }
+| IPV4		{ $$ = arena_strdup(ctx->arena, "ipv4"); }
+| IPV6		{ $$ = arena_strdup(ctx->arena, "ipv6"); }
 | WORD '=' INTEGER {
 	/* For consistency, allow syntax like: --define=PROTO=132 */
 	char *lhs = $1;
 	s64 rhs = $3;
 
-	asprintf(&($$), "%s=%lld", lhs, rhs);
-	free(lhs);
+	$$ = arena_asprintf(ctx->arena, "%s=%lld", lhs, rhs);
 }
 | WORD '=' WORD {
 	/* For consistency, allow syntax like: --define=PROTO=IPPROTO_TCP */
 	char *lhs = $1, *rhs = $3;
 
-	asprintf(&($$), "%s=%s", lhs, rhs);
-	free(lhs);
-	free(rhs);
+	$$ = arena_asprintf(ctx->arena, "%s=%s", lhs, rhs);
 }
 | WORD '=' STRING {
 	/* For consistency, allow syntax like: --define=CC="reno" */
 	char *lhs = $1, *rhs = $3;
 
-	asprintf(&($$), "%s=\"%s\"", lhs, rhs);
-	free(lhs);
-	free(rhs);
+	$$ = arena_asprintf(ctx->arena, "%s=\"%s\"", lhs, rhs);
 }
 | WORD '=' BACK_QUOTED {
 	/* For consistency, allow syntax like: --define=SCRIPT=`cleanup` */
 	char *lhs = $1, *rhs = $3;
 
-	asprintf(&($$), "%s=`%s`", lhs, rhs);
-	free(lhs);
-	free(rhs);
+	$$ = arena_asprintf(ctx->arena, "%s=`%s`", lhs, rhs);
 }
 ;
 
@@ -899,13 +879,13 @@ opt_init_command
 ;
 
 init_command
-: command_spec  { out_script->init_command = $1; }
+: command_spec  { ctx->script->init_command = $1; }
 ;
 
 events
 : event        {
-	out_script->event_list = $1;  /* save pointer to event list as output
-				       * of parser */
+	ctx->script->event_list = $1;  /* save pointer to event list as output
+				        * of parser */
 	$$ = $1;          /* return the tail so that we can append to it */
 }
 | events event {
@@ -924,52 +904,51 @@ event
 
 	if ($$->time_usecs_end != NO_TIME_RANGE) {
 		if ($$->time_usecs_end < $$->time_usecs)
-			semantic_error("time range is backwards");
+			semantic_error(ctx, "time range is backwards");
 	}
 	if ($$->time_type == ANY_TIME &&  ($$->type != PACKET_EVENT ||
 	    packet_direction($$->event.packet) != DIRECTION_OUTBOUND)) {
-		yylineno = $$->line_number;
-		semantic_error("event time <star> can only be used with "
+		ctx->script_line = $$->line_number;
+		semantic_error(ctx, "event time <star> can only be used with "
 			       "outbound packets");
 	} else if (($$->time_type == ABSOLUTE_RANGE_TIME ||
 		    $$->time_type == RELATIVE_RANGE_TIME) &&
 	           ($$->type != PACKET_EVENT ||
 		    packet_direction($$->event.packet) != DIRECTION_OUTBOUND)) {
-		yylineno = $$->line_number;
-		semantic_error("event time range can only be used with "
+		ctx->script_line = $$->line_number;
+		semantic_error(ctx, "event time range can only be used with "
 			       "outbound packets");
 	}
-	free($1);
 }
 ;
 
 event_time
 : '+' time	{
-	$$ = new_event(INVALID_EVENT);
+	$$ = new_event(ctx, INVALID_EVENT);
 	$$->line_number = @2.first_line;
 	$$->time_usecs = $2;
 	$$->time_type = RELATIVE_TIME;
 }
 | time         {
-	$$ = new_event(INVALID_EVENT);
+	$$ = new_event(ctx, INVALID_EVENT);
 	$$->line_number = @1.first_line;
 	$$->time_usecs = $1;
 	$$->time_type = ABSOLUTE_TIME;
 }
 | '*'		{
-	$$ = new_event(INVALID_EVENT);
+	$$ = new_event(ctx, INVALID_EVENT);
 	$$->line_number = @1.first_line;
 	$$->time_type = ANY_TIME;
 }
 | time '~' time	{
-	$$ = new_event(INVALID_EVENT);
+	$$ = new_event(ctx, INVALID_EVENT);
 	$$->line_number = @1.first_line;
 	$$->time_type = ABSOLUTE_RANGE_TIME;
 	$$->time_usecs = $1;
 	$$->time_usecs_end = $3;
 }
 | '+' time '~' '+' time {
-	$$ = new_event(INVALID_EVENT);
+	$$ = new_event(ctx, INVALID_EVENT);
 	$$->line_number = @1.first_line;
 	$$->time_type = RELATIVE_RANGE_TIME;
 	$$->time_usecs = $2;
@@ -980,23 +959,23 @@ event_time
 time
 : FLOAT        {
 	if ($1 < 0) {
-		semantic_error("negative time");
+		semantic_error(ctx, "negative time");
 	}
 	$$ = (s64)($1 * 1.0e6); /* convert float secs to s64 microseconds */
 }
 | INTEGER	{
 	if ($1 < 0) {
-		semantic_error("negative time");
+		semantic_error(ctx, "negative time");
 	}
 	$$ = (s64)($1 * 1000000); /* convert int secs to s64 microseconds */
 }
 ;
 
 action
-: packet_spec  { $$ = new_event(PACKET_EVENT);  $$->event.packet  = $1; }
-| syscall_spec { $$ = new_event(SYSCALL_EVENT); $$->event.syscall = $1; }
-| command_spec { $$ = new_event(COMMAND_EVENT); $$->event.command = $1; }
-| code_spec    { $$ = new_event(CODE_EVENT);    $$->event.code    = $1; }
+: packet_spec  { $$ = new_event(ctx, PACKET_EVENT);  $$->event.packet  = $1; }
+| syscall_spec { $$ = new_event(ctx, SYSCALL_EVENT); $$->event.syscall = $1; }
+| command_spec { $$ = new_event(ctx, COMMAND_EVENT); $$->event.command = $1; }
+| code_spec    { $$ = new_event(ctx, CODE_EVENT);    $$->event.code    = $1; }
 ;
 
 packet_spec
@@ -1014,10 +993,10 @@ opt_udp_encaps_info
 }
 | '/' UDP '(' INTEGER '>' INTEGER ')' {
 	if (!is_valid_u16($4)) {
-		semantic_error("UDP source port out of range");
+		semantic_error(ctx, "UDP source port out of range");
 	}
 	if (!is_valid_u16($6)) {
-		semantic_error("UDP destination port out of range");
+		semantic_error(ctx, "UDP destination port out of range");
 	}
 	$$.udp_src_port = $4;
 	$$.udp_dst_port = $6;
@@ -1035,14 +1014,14 @@ sctp_header_spec
 }
 | SCTP '(' TAG '=' INTEGER ')' {
 	if (!is_valid_u32($5)) {
-		semantic_error("tag value out of range");
+		semantic_error(ctx, "tag value out of range");
 	}
 	$$.bad_crc32c = false;
 	$$.tag = $5;
 }
 | SCTP '(' BAD_CRC32C ',' TAG '=' INTEGER ')' {
 	if (!is_valid_u32($7)) {
-		semantic_error("tag value out of range");
+		semantic_error(ctx, "tag value out of range");
 	}
 	$$.bad_crc32c = true;
 	$$.tag = $7;
@@ -1055,13 +1034,13 @@ sctp_packet_spec
 	struct packet *outer = $1, *inner = NULL;
 	enum direction_t direction = outer->direction;
 
-	inner = new_sctp_packet(in_config->wire_protocol, direction, $2,
+	inner = new_sctp_packet(ctx->config->wire_protocol, direction, $2,
 	                        $3.tag, $3.bad_crc32c, $6,
 	                        $4.udp_src_port, $4.udp_dst_port,
 	                        &error);
 	if (inner == NULL) {
 		assert(error != NULL);
-		semantic_error(error);
+		semantic_error(ctx, error);
 		free(error);
 	}
 
@@ -1072,13 +1051,13 @@ sctp_packet_spec
 	struct packet *outer = $1, *inner = NULL;
 	enum direction_t direction = outer->direction;
 
-	inner = new_sctp_generic_packet(in_config->wire_protocol, direction, $2,
+	inner = new_sctp_generic_packet(ctx->config->wire_protocol, direction, $2,
 	                                $3.tag, $3.bad_crc32c, $7,
 	                                $4.udp_src_port, $4.udp_dst_port,
 	                                &error);
 	if (inner == NULL) {
 		assert(error != NULL);
-		semantic_error(error);
+		semantic_error(ctx, error);
 		free(error);
 	}
 
@@ -1122,13 +1101,13 @@ sctp_chunk_spec
 chunk_type
 : HEX_INTEGER {
 	if (!is_valid_u8($1)) {
-		semantic_error("type value out of range");
+		semantic_error(ctx, "type value out of range");
 	}
 	$$ = $1;
 }
 | INTEGER {
 	if (!is_valid_u8($1)) {
-		semantic_error("type value out of range");
+		semantic_error(ctx, "type value out of range");
 	}
 	$$ = $1;
 }
@@ -1217,13 +1196,13 @@ opt_flags
 : FLAGS '=' ELLIPSIS    { $$ = -1; }
 | FLAGS '=' HEX_INTEGER {
 	if (!is_valid_u8($3)) {
-		semantic_error("flags value out of range");
+		semantic_error(ctx, "flags value out of range");
 	}
 	$$ = $3;
 }
 | FLAGS '=' INTEGER     {
 	if (!is_valid_u8($3)) {
-		semantic_error("flags value out of range");
+		semantic_error(ctx, "flags value out of range");
 	}
 	$$ = $3;
 }
@@ -1233,7 +1212,7 @@ opt_len
 : LEN '=' ELLIPSIS { $$ = -1; }
 | LEN '=' INTEGER  {
 	if (!is_valid_u16($3)) {
-		semantic_error("length value out of range");
+		semantic_error(ctx, "length value out of range");
 	}
 	$$ = $3;
 }
@@ -1262,15 +1241,15 @@ byte_list
 byte
 : HEX_INTEGER {
 	if (!is_valid_u8($1)) {
-		semantic_error("byte value out of range");
+		semantic_error(ctx, "byte value out of range");
 	}
-	$$ = sctp_byte_list_item_new($1);
+	$$ = $1;
 }
 | INTEGER {
 	if (!is_valid_u8($1)) {
-		semantic_error("byte value out of range");
+		semantic_error(ctx, "byte value out of range");
 	}
-	$$ = sctp_byte_list_item_new($1);
+	$$ = $1;
 }
 ;
 
@@ -1285,9 +1264,9 @@ u16_list
 u16_item
 : INTEGER {
 	if (!is_valid_u16($1)) {
-		semantic_error("Integer value out of range");
+		semantic_error(ctx, "Integer value out of range");
 	}
-	$$ = sctp_u16_list_item_new($1);
+	$$ = $1;
 }
 ;
 
@@ -1295,13 +1274,13 @@ opt_data_flags
 : FLAGS '=' ELLIPSIS    { $$ = -1; }
 | FLAGS '=' HEX_INTEGER {
 	if (!is_valid_u8($3)) {
-		semantic_error("flags value out of range");
+		semantic_error(ctx, "flags value out of range");
 	}
 	$$ = $3;
 }
 | FLAGS '=' INTEGER     {
 	if (!is_valid_u8($3)) {
-		semantic_error("flags value out of range");
+		semantic_error(ctx, "flags value out of range");
 	}
 	$$ = $3;
 }
@@ -1314,34 +1293,34 @@ opt_data_flags
 		switch (*c) {
 		case 'I':
 			if (flags & SCTP_DATA_CHUNK_I_BIT) {
-				semantic_error("I-bit specified multiple times");
+				semantic_error(ctx, "I-bit specified multiple times");
 			} else {
 				flags |= SCTP_DATA_CHUNK_I_BIT;
 			}
 			break;
 		case 'U':
 			if (flags & SCTP_DATA_CHUNK_U_BIT) {
-				semantic_error("U-bit specified multiple times");
+				semantic_error(ctx, "U-bit specified multiple times");
 			} else {
 				flags |= SCTP_DATA_CHUNK_U_BIT;
 			}
 			break;
 		case 'B':
 			if (flags & SCTP_DATA_CHUNK_B_BIT) {
-				semantic_error("B-bit specified multiple times");
+				semantic_error(ctx, "B-bit specified multiple times");
 			} else {
 				flags |= SCTP_DATA_CHUNK_B_BIT;
 			}
 			break;
 		case 'E':
 			if (flags & SCTP_DATA_CHUNK_E_BIT) {
-				semantic_error("E-bit specified multiple times");
+				semantic_error(ctx, "E-bit specified multiple times");
 			} else {
 				flags |= SCTP_DATA_CHUNK_E_BIT;
 			}
 			break;
 		default:
-			semantic_error("Only expecting IUBE as flags");
+			semantic_error(ctx, "Only expecting IUBE as flags");
 			break;
 		}
 	}
@@ -1353,13 +1332,13 @@ opt_abort_flags
 : FLAGS '=' ELLIPSIS    { $$ = -1; }
 | FLAGS '=' HEX_INTEGER {
 	if (!is_valid_u8($3)) {
-		semantic_error("flags value out of range");
+		semantic_error(ctx, "flags value out of range");
 	}
 	$$ = $3;
 }
 | FLAGS '=' INTEGER     {
 	if (!is_valid_u8($3)) {
-		semantic_error("flags value out of range");
+		semantic_error(ctx, "flags value out of range");
 	}
 	$$ = $3;
 }
@@ -1372,13 +1351,13 @@ opt_abort_flags
 		switch (*c) {
 		case 'T':
 			if (flags & SCTP_ABORT_CHUNK_T_BIT) {
-				semantic_error("T-bit specified multiple times");
+				semantic_error(ctx, "T-bit specified multiple times");
 			} else {
 				flags |= SCTP_ABORT_CHUNK_T_BIT;
 			}
 			break;
 		default:
-			semantic_error("Only expecting T as flags");
+			semantic_error(ctx, "Only expecting T as flags");
 			break;
 		}
 	}
@@ -1390,13 +1369,13 @@ opt_shutdown_complete_flags
 : FLAGS '=' ELLIPSIS    { $$ = -1; }
 | FLAGS '=' HEX_INTEGER {
 	if (!is_valid_u8($3)) {
-		semantic_error("flags value out of range");
+		semantic_error(ctx, "flags value out of range");
 	}
 	$$ = $3;
 }
 | FLAGS '=' INTEGER     {
 	if (!is_valid_u8($3)) {
-		semantic_error("flags value out of range");
+		semantic_error(ctx, "flags value out of range");
 	}
 	$$ = $3;
 }
@@ -1409,13 +1388,13 @@ opt_shutdown_complete_flags
 		switch (*c) {
 		case 'T':
 			if (flags & SCTP_SHUTDOWN_COMPLETE_CHUNK_T_BIT) {
-				semantic_error("T-bit specified multiple times");
+				semantic_error(ctx, "T-bit specified multiple times");
 			} else {
 				flags |= SCTP_SHUTDOWN_COMPLETE_CHUNK_T_BIT;
 			}
 			break;
 		default:
-			semantic_error("Only expecting T as flags");
+			semantic_error(ctx, "Only expecting T as flags");
 			break;
 		}
 	}
@@ -1427,13 +1406,13 @@ opt_i_data_flags
 : FLAGS '=' ELLIPSIS    { $$ = -1; }
 | FLAGS '=' HEX_INTEGER {
 	if (!is_valid_u8($3)) {
-		semantic_error("flags value out of range");
+		semantic_error(ctx, "flags value out of range");
 	}
 	$$ = $3;
 }
 | FLAGS '=' INTEGER     {
 	if (!is_valid_u8($3)) {
-		semantic_error("flags value out of range");
+		semantic_error(ctx, "flags value out of range");
 	}
 	$$ = $3;
 }
@@ -1446,34 +1425,34 @@ opt_i_data_flags
 		switch (*c) {
 		case 'I':
 			if (flags & SCTP_I_DATA_CHUNK_I_BIT) {
-				semantic_error("I-bit specified multiple times");
+				semantic_error(ctx, "I-bit specified multiple times");
 			} else {
 				flags |= SCTP_I_DATA_CHUNK_I_BIT;
 			}
 			break;
 		case 'U':
 			if (flags & SCTP_I_DATA_CHUNK_U_BIT) {
-				semantic_error("U-bit specified multiple times");
+				semantic_error(ctx, "U-bit specified multiple times");
 			} else {
 				flags |= SCTP_I_DATA_CHUNK_U_BIT;
 			}
 			break;
 		case 'B':
 			if (flags & SCTP_I_DATA_CHUNK_B_BIT) {
-				semantic_error("B-bit specified multiple times");
+				semantic_error(ctx, "B-bit specified multiple times");
 			} else {
 				flags |= SCTP_I_DATA_CHUNK_B_BIT;
 			}
 			break;
 		case 'E':
 			if (flags & SCTP_I_DATA_CHUNK_E_BIT) {
-				semantic_error("E-bit specified multiple times");
+				semantic_error(ctx, "E-bit specified multiple times");
 			} else {
 				flags |= SCTP_I_DATA_CHUNK_E_BIT;
 			}
 			break;
 		default:
-			semantic_error("Only expecting IUBE as flags");
+			semantic_error(ctx, "Only expecting IUBE as flags");
 			break;
 		}
 	}
@@ -1485,7 +1464,7 @@ opt_tag
 : TAG '=' ELLIPSIS { $$ = -1; }
 | TAG '=' INTEGER  {
 	if (!is_valid_u32($3)) {
-		semantic_error("tag value out of range");
+		semantic_error(ctx, "tag value out of range");
 	}
 	$$ = $3;
 }
@@ -1495,7 +1474,7 @@ opt_a_rwnd
 : A_RWND '=' ELLIPSIS   { $$ = -1; }
 | A_RWND '=' INTEGER    {
 	if (!is_valid_u32($3)) {
-		semantic_error("a_rwnd value out of range");
+		semantic_error(ctx, "a_rwnd value out of range");
 	}
 	$$ = $3;
 }
@@ -1505,7 +1484,7 @@ opt_os
 : OS '=' ELLIPSIS { $$ = -1; }
 | OS '=' INTEGER  {
 	if (!is_valid_u16($3)) {
-		semantic_error("os value out of range");
+		semantic_error(ctx, "os value out of range");
 	}
 	$$ = $3;
 }
@@ -1515,7 +1494,7 @@ opt_is
 : IS '=' ELLIPSIS { $$ = -1; }
 | IS '=' INTEGER  {
 	if (!is_valid_u16($3)) {
-		semantic_error("is value out of range");
+		semantic_error(ctx, "is value out of range");
 	}
 	$$ = $3;
 }
@@ -1525,7 +1504,7 @@ opt_tsn
 : TSN '=' ELLIPSIS { $$ = -1; }
 | TSN '=' INTEGER  {
 	if (!is_valid_u32($3)) {
-		semantic_error("tsn value out of range");
+		semantic_error(ctx, "tsn value out of range");
 	}
 	$$ = $3;
 }
@@ -1535,7 +1514,7 @@ opt_sid
 : SID '=' ELLIPSIS { $$ = -1; }
 | SID '=' INTEGER  {
 	if (!is_valid_u16($3)) {
-		semantic_error("sid value out of range");
+		semantic_error(ctx, "sid value out of range");
 	}
 	$$ = $3;
 }
@@ -1545,7 +1524,7 @@ opt_ssn
 : SSN '=' ELLIPSIS { $$ = -1; }
 | SSN '=' INTEGER  {
 	if (!is_valid_u16($3)) {
-		semantic_error("ssn value out of range");
+		semantic_error(ctx, "ssn value out of range");
 	}
 	$$ = $3;
 }
@@ -1555,7 +1534,7 @@ opt_mid
 : MID '=' ELLIPSIS { $$ = -1; }
 | MID '=' INTEGER  {
 	if (!is_valid_u32($3)) {
-		semantic_error("mid value out of range");
+		semantic_error(ctx, "mid value out of range");
 	}
 	$$ = $3;
 }
@@ -1565,13 +1544,13 @@ opt_ppid
 : PPID '=' ELLIPSIS { $$ = -1; }
 | PPID '=' INTEGER  {
 	if (!is_valid_u32($3)) {
-		semantic_error("ppid value out of range");
+		semantic_error(ctx, "ppid value out of range");
 	}
 	$$ = $3;
 }
 | PPID '=' HEX_INTEGER  {
 	if (!is_valid_u32($3)) {
-		semantic_error("ppid value out of range");
+		semantic_error(ctx, "ppid value out of range");
 	}
 	$$ = $3;
 }
@@ -1581,7 +1560,7 @@ opt_fsn
 : FSN '=' ELLIPSIS { $$ = -1; }
 | FSN '=' INTEGER  {
 	if (!is_valid_u32($3)) {
-		semantic_error("fsn value out of range");
+		semantic_error(ctx, "fsn value out of range");
 	}
 	$$ = $3;
 }
@@ -1591,7 +1570,7 @@ opt_cum_tsn
 : CUM_TSN '=' ELLIPSIS { $$ = -1; }
 | CUM_TSN '=' INTEGER  {
 	if (!is_valid_u32($3)) {
-		semantic_error("cum_tsn value out of range");
+		semantic_error(ctx, "cum_tsn value out of range");
 	}
 	$$ = $3;
 }
@@ -1620,12 +1599,13 @@ gap_list
 gap
 : INTEGER ':' INTEGER {
 	if (!is_valid_u16($1)) {
-		semantic_error("start value out of range");
+		semantic_error(ctx, "start value out of range");
 	}
 	if (!is_valid_u16($3)) {
-		semantic_error("end value out of range");
+		semantic_error(ctx, "end value out of range");
 	}
-	$$ = sctp_sack_block_list_item_gap_new($1, $3);
+	$$.gap.start = $1;
+	$$.gap.end = $3;
 }
 ;
 
@@ -1646,9 +1626,9 @@ dup_list
 dup
 : INTEGER {
 	if (!is_valid_u32($1)) {
-		semantic_error("tsn value out of range");
+		semantic_error(ctx, "tsn value out of range");
 	}
-	$$ = sctp_sack_block_list_item_dup_new($1);
+	$$.tsn = $1;
 }
 ;
 
@@ -1669,10 +1649,10 @@ ids_list
 id
 : '{' INTEGER ',' INTEGER '}' {
 	if (!is_valid_u16($2)) {
-		semantic_error("stream identifier out of range");
+		semantic_error(ctx, "stream identifier out of range");
 	}
 	if (!is_valid_u16($4)) {
-		semantic_error("stream sequence number out of range");
+		semantic_error(ctx, "stream sequence number out of range");
 	}
 	$$ = sctp_forward_tsn_ids_list_item_new($2, $4);
 }
@@ -1695,13 +1675,13 @@ i_forward_tsn_ids_list
 i_forward_tsn_id
 : '{' INTEGER ',' INTEGER ',' INTEGER '}' {
 	if (!is_valid_u16($2)) {
-		semantic_error("stream identifier out of range");
+		semantic_error(ctx, "stream identifier out of range");
 	}
 	if (!is_valid_u16($4)) {
-		semantic_error("reserved out of range");
+		semantic_error(ctx, "reserved out of range");
 	}
 	if (!is_valid_u32($6)) {
-		semantic_error("message identifier number out of range");
+		semantic_error(ctx, "message identifier number out of range");
 	}
 	$$ = sctp_i_forward_tsn_ids_list_item_new($2, $4, $6);
 }
@@ -1711,14 +1691,14 @@ sctp_generic_chunk_spec
 : CHUNK '[' opt_chunk_type ',' opt_flags ',' opt_len ',' opt_val ']' {
 	if (($7 != -1) &&
 	    (!is_valid_u16($7) || ($7 < sizeof(struct sctp_chunk)))) {
-		semantic_error("length value out of range");
+		semantic_error(ctx, "length value out of range");
 	}
 	if (($7 != -1) && ($9 != NULL) &&
 	    ($7 < sizeof(struct sctp_chunk) + $9->nr_entries)) {
-		semantic_error("length value incompatible with val");
+		semantic_error(ctx, "length value incompatible with val");
 	}
 	if (($7 == -1) && ($9 != NULL)) {
-		semantic_error("length needs to be specified");
+		semantic_error(ctx, "length needs to be specified");
 	}
 	$$ = sctp_generic_chunk_new($3, $5, $7, $9);
 }
@@ -1727,7 +1707,7 @@ sctp_data_chunk_spec
 : DATA '[' opt_data_flags ',' opt_len ',' opt_tsn ',' opt_sid ',' opt_ssn ',' opt_ppid ']' {
 	if (($5 != -1) &&
 	    (!is_valid_u16($5) || ($5 < sizeof(struct _sctp_data_chunk)))) {
-		semantic_error("length value out of range");
+		semantic_error(ctx, "length value out of range");
 	}
 	$$ = sctp_data_chunk_new($3, $5, $7, $9, $11, $13);
 }
@@ -1787,14 +1767,14 @@ sctp_cookie_echo_chunk_spec
 : COOKIE_ECHO '[' opt_flags ',' opt_len ',' opt_val ']' {
 	if (($5 != -1) &&
 	    (!is_valid_u16($5) || ($5 < sizeof(struct _sctp_cookie_echo_chunk)))) {
-		semantic_error("length value out of range");
+		semantic_error(ctx, "length value out of range");
 	}
 	if (($5 != -1) && ($7 != NULL) &&
 	    ($5 != sizeof(struct _sctp_cookie_echo_chunk) + $7->nr_entries)) {
-		semantic_error("length value incompatible with val");
+		semantic_error(ctx, "length value incompatible with val");
 	}
 	if (($5 == -1) && ($7 != NULL)) {
-		semantic_error("length needs to be specified");
+		semantic_error(ctx, "length needs to be specified");
 	}
 	$$ = sctp_cookie_echo_chunk_new($3, $5, $7);
 }
@@ -1823,14 +1803,14 @@ sctp_i_data_chunk_spec
 : I_DATA '[' opt_i_data_flags ',' opt_len ',' opt_tsn ',' opt_sid ',' opt_mid ',' opt_ppid ']' {
 	if (($5 != -1) &&
 	    (!is_valid_u16($5) || ($5 < sizeof(struct _sctp_i_data_chunk)))) {
-		semantic_error("length value out of range");
+		semantic_error(ctx, "length value out of range");
 	}
 	$$ = sctp_i_data_chunk_new($3, $5, $7, $9, 0, $11, $13, -1);
 }
 | I_DATA '[' opt_i_data_flags ',' opt_len ',' opt_tsn ',' opt_sid ',' opt_mid ',' opt_fsn ']' {
 	if (($5 != -1) &&
 	    (!is_valid_u16($5) || ($5 < sizeof(struct _sctp_i_data_chunk)))) {
-		semantic_error("length value out of range");
+		semantic_error(ctx, "length value out of range");
 	}
 	$$ = sctp_i_data_chunk_new($3, $5, $7, $9, 0, $11, -1, $13);
 }
@@ -1839,7 +1819,7 @@ sctp_pad_chunk_spec
 : PAD '[' opt_flags ',' opt_len ',' VAL '=' ELLIPSIS ']' {
 	if (($5 != -1) &&
 	    (!is_valid_u16($5) || ($5 < sizeof(struct _sctp_pad_chunk)))) {
-		semantic_error("length value out of range");
+		semantic_error(ctx, "length value out of range");
 	}
 	$$ = sctp_pad_chunk_new($3, $5, NULL);
 }
@@ -1857,7 +1837,7 @@ sctp_i_forward_tsn_spec
 opt_req_sn
 : REQ_SN '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("req_sn out of range");
+		semantic_error(ctx, "req_sn out of range");
 	}
 	$$ = $3;
 }
@@ -1867,7 +1847,7 @@ opt_req_sn
 opt_resp_sn
 : RESP_SN '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("resp_sn out of range");
+		semantic_error(ctx, "resp_sn out of range");
 	}
 	$$ = $3;
 }
@@ -1877,7 +1857,7 @@ opt_resp_sn
 opt_last_tsn
 : LAST_TSN '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("last_tsn out of range");
+		semantic_error(ctx, "last_tsn out of range");
 	}
 	$$ = $3;
 }
@@ -1887,7 +1867,7 @@ opt_last_tsn
 opt_result
 : RESULT '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("result out of range");
+		semantic_error(ctx, "result out of range");
 	}
 	$$ = $3;
 }
@@ -1897,13 +1877,13 @@ opt_result
 opt_sender_next_tsn
 : SENDER_NEXT_TSN '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("sender_next_tsn out of range");
+		semantic_error(ctx, "sender_next_tsn out of range");
 	}
 	$$ = $3;
 }
 | SENDER_NEXT_TSN '=' HEX_INTEGER { 
 	if (!is_valid_u32($3)) {
-		semantic_error("sender_next_tsn out of range");
+		semantic_error(ctx, "sender_next_tsn out of range");
 	}
 	$$ = $3;
 }
@@ -1913,13 +1893,13 @@ opt_sender_next_tsn
 opt_receiver_next_tsn
 : RECEIVER_NEXT_TSN '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("receiver_next_tsn out of range");
+		semantic_error(ctx, "receiver_next_tsn out of range");
 	}
 	$$ = $3;
 }
 | RECEIVER_NEXT_TSN '=' HEX_INTEGER { 
 	if (!is_valid_u32($3)) {
-		semantic_error("receiver_next_tsn out of range");
+		semantic_error(ctx, "receiver_next_tsn out of range");
 	}
 	$$ = $3;
 }
@@ -1929,7 +1909,7 @@ opt_receiver_next_tsn
 opt_number_of_new_streams
 : NUMBER_OF_NEW_STREAMS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("number_of_new_streams out of range");
+		semantic_error(ctx, "number_of_new_streams out of range");
 	}
 	$$ = $3;
 }
@@ -2034,13 +2014,13 @@ opt_parameter_type
 : TYPE '=' ELLIPSIS    { $$ = -1; }
 | TYPE '=' HEX_INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("type value out of range");
+		semantic_error(ctx, "type value out of range");
 	}
 	$$ = $3;
 }
 | TYPE '=' INTEGER     {
 	if (!is_valid_u16($3)) {
-		semantic_error("type value out of range");
+		semantic_error(ctx, "type value out of range");
 	}
 	$$ = $3;
 }
@@ -2050,14 +2030,14 @@ sctp_generic_parameter_spec
 : PARAMETER '[' opt_parameter_type ',' opt_len ',' opt_val ']' {
 	if (($5 != -1) &&
 	    (!is_valid_u16($5) || ($5 < sizeof(struct sctp_parameter)))) {
-		semantic_error("length value out of range");
+		semantic_error(ctx, "length value out of range");
 	}
 	if (($5 != -1) && ($7 != NULL) &&
 	    ($5 < sizeof(struct sctp_parameter) + $7->nr_entries)) {
-		semantic_error("length value incompatible with val");
+		semantic_error(ctx, "length value incompatible with val");
 	}
 	if (($5 == -1) && ($7 != NULL)) {
-		semantic_error("length needs to be specified");
+		semantic_error(ctx, "length needs to be specified");
 	}
 	$$ = sctp_generic_parameter_new($3, $5, $7);
 }
@@ -2069,14 +2049,14 @@ sctp_heartbeat_information_parameter_spec
 | HEARTBEAT_INFORMATION '[' opt_len ',' opt_val ']' {
 	if (($3 != -1) &&
 	    (!is_valid_u16($3) || ($3 < sizeof(struct sctp_heartbeat_information_parameter)))) {
-		semantic_error("length value out of range");
+		semantic_error(ctx, "length value out of range");
 	}
 	if (($3 != -1) && ($5 != NULL) &&
 	    ($3 != sizeof(struct sctp_heartbeat_information_parameter) + $5->nr_entries)) {
-		semantic_error("length value incompatible with val");
+		semantic_error(ctx, "length value incompatible with val");
 	}
 	if (($3 == -1) && ($5 != NULL)) {
-		semantic_error("length needs to be specified");
+		semantic_error(ctx, "length needs to be specified");
 	}
 	$$ = sctp_heartbeat_information_parameter_new($3, $5);
 }
@@ -2086,7 +2066,7 @@ sctp_ipv4_address_parameter_spec
 	struct in_addr addr;
 
 	if (inet_pton(AF_INET, $5, &addr) != 1) {
-		semantic_error("Invalid address");
+		semantic_error(ctx, "Invalid address");
 	}
 	$$ = sctp_ipv4_address_parameter_new(&addr);
 }
@@ -2099,7 +2079,7 @@ sctp_ipv6_address_parameter_spec
 	struct in6_addr addr;
 
 	if (inet_pton(AF_INET6, $5, &addr) != 1) {
-		semantic_error("Invalid address");
+		semantic_error(ctx, "Invalid address");
 	}
 	$$ = sctp_ipv6_address_parameter_new(&addr);
 }
@@ -2117,7 +2097,7 @@ sctp_state_cookie_parameter_spec
 | STATE_COOKIE '[' LEN '=' INTEGER ',' VAL '=' ELLIPSIS ']' {
 	if (($5 < sizeof(struct sctp_state_cookie_parameter)) ||
 	    !is_valid_u32($5)) {
-		semantic_error("len value out of range");
+		semantic_error(ctx, "len value out of range");
 	}
 	$$ = sctp_state_cookie_parameter_new($5, NULL);
 }
@@ -2133,7 +2113,7 @@ sctp_unrecognized_parameter_parameter_spec
 sctp_cookie_preservative_parameter_spec
 : COOKIE_PRESERVATIVE '[' INCR '=' INTEGER ']' {
 	if (!is_valid_u32($5)) {
-		semantic_error("increment value out of range");
+		semantic_error(ctx, "increment value out of range");
 	}
 	$$ = sctp_cookie_preservative_parameter_new($5);
 }
@@ -2159,7 +2139,7 @@ address_types_list
 
 address_type
 : INTEGER       { if (!is_valid_u16($1)) {
-                  semantic_error("address type value out of range");
+                  semantic_error(ctx, "address type value out of range");
                   }
                   $$ = sctp_address_type_list_item_new($1); }
 | IPV4_TYPE     { $$ = sctp_address_type_list_item_new(SCTP_IPV4_ADDRESS_PARAMETER_TYPE); }
@@ -2192,18 +2172,18 @@ chunk_types_list
 }
 | chunk_type {
 	$$ = sctp_byte_list_new();
-	sctp_byte_list_append($$, sctp_byte_list_item_new($1));
+	sctp_byte_list_append($$, $1);
 }
 | chunk_types_list ',' chunk_type {
 	$$ = $1;
-	sctp_byte_list_append($1, sctp_byte_list_item_new($3));
+	sctp_byte_list_append($1, $3);
 }
 ;
 
 sctp_adaptation_indication_parameter_spec
 : ADAPTATION_INDICATION '[' ADAPTATION_CODE_POINT '=' INTEGER ']' {
 	if (!is_valid_u32($5))
-		semantic_error("adaptation_indication_code ot of range");
+		semantic_error(ctx, "adaptation_indication_code ot of range");
 	$$ = sctp_adaptation_indication_parameter_new($5);
 };
 
@@ -2225,7 +2205,7 @@ sctp_pad_parameter_spec
 | PAD '[' LEN '=' INTEGER ',' VAL '=' ELLIPSIS ']' {
 	if (($5 < sizeof(struct sctp_pad_parameter)) ||
 	    !is_valid_u32($5)) {
-		semantic_error("len value out of range");
+		semantic_error(ctx, "len value out of range");
 	}
 	$$ = sctp_pad_parameter_new($5, NULL);
 }
@@ -2264,13 +2244,13 @@ opt_cause_code
 : CAUSE_CODE '=' ELLIPSIS    { $$ = -1; }
 | CAUSE_CODE '=' HEX_INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("cause value out of range");
+		semantic_error(ctx, "cause value out of range");
 	}
 	$$ = $3;
 }
 | CAUSE_CODE '=' INTEGER     {
 	if (!is_valid_u16($3)) {
-		semantic_error("cause value out of range");
+		semantic_error(ctx, "cause value out of range");
 	}
 	$$ = $3;
 }
@@ -2280,14 +2260,14 @@ sctp_generic_cause_spec
 : CAUSE '[' opt_cause_code ',' opt_len ',' opt_info ']' {
 	if (($5 != -1) &&
 	    (!is_valid_u16($5) || ($5 < sizeof(struct sctp_cause)))) {
-		semantic_error("length value out of range");
+		semantic_error(ctx, "length value out of range");
 	}
 	if (($5 != -1) && ($7 != NULL) &&
 	    ($5 < sizeof(struct sctp_cause) + $7->nr_entries)) {
-		semantic_error("length value incompatible with val");
+		semantic_error(ctx, "length value incompatible with val");
 	}
 	if (($5 == -1) && ($7 != NULL)) {
-		semantic_error("length needs to be specified");
+		semantic_error(ctx, "length needs to be specified");
 	}
 	$$ = sctp_generic_cause_new($3, $5, $7);
 }
@@ -2295,7 +2275,7 @@ sctp_generic_cause_spec
 sctp_invalid_stream_identifier_cause_spec
 : INVALID_STREAM_IDENTIFIER '[' SID '=' INTEGER ']' {
 	if (!is_valid_u16($5)) {
-		semantic_error("stream identifier out of range");
+		semantic_error(ctx, "stream identifier out of range");
 	}
 	$$ = sctp_invalid_stream_identifier_cause_new($5);
 }
@@ -2313,7 +2293,7 @@ parameter_types_list
 
 parameter_type
 : INTEGER       { if (!is_valid_u16($1)) {
-                  semantic_error("parameter type value out of range");
+                  semantic_error(ctx, "parameter type value out of range");
                   }
                   $$ = sctp_parameter_type_list_item_new($1); }
 ;
@@ -2329,7 +2309,7 @@ sctp_missing_mandatory_parameter_cause_spec
 sctp_stale_cookie_error_cause_spec
 : STALE_COOKIE_ERROR '[' STALENESS '=' INTEGER ']' {
 	if (!is_valid_u32($5)) {
-		semantic_error("staleness out of range");
+		semantic_error(ctx, "staleness out of range");
 	}
 	$$ = sctp_stale_cookie_error_cause_new($5);
 }
@@ -2374,7 +2354,7 @@ sctp_unrecognized_parameters_cause_spec
 sctp_no_user_data_cause_spec
 : NO_USER_DATA '[' TSN '=' INTEGER ']' {
 	if (!is_valid_u32($5)) {
-		semantic_error("tsn out of range");
+		semantic_error(ctx, "tsn out of range");
 	}
 	$$ = sctp_no_user_data_cause_new($5);
 }
@@ -2418,28 +2398,27 @@ tcp_packet_spec
 	enum direction_t direction = outer->direction;
 
 	if (($7 == NULL) && (direction != DIRECTION_OUTBOUND)) {
-		yylineno = @7.first_line;
-		semantic_error("<...> for TCP options can only be used with "
+		ctx->script_line = @7.first_line;
+		semantic_error(ctx, "<...> for TCP options can only be used with "
 			       "outbound packets");
 	}
 
-	inner = new_tcp_packet(in_config->wire_protocol,
+	inner = new_tcp_packet(ctx->config->wire_protocol,
 			       direction, $2, $3,
 			       $4.start_sequence, $4.payload_bytes,
 			       $5, $6, $7,
-			       ignore_ts_val,
-			       absolute_ts_ecr,
+			       ctx->ignore_ts_val,
+			       ctx->absolute_ts_ecr,
 			       $4.absolute,
 			       $4.ignore,
 			       $8.udp_src_port, $8.udp_dst_port,
 			       &error);
-	ignore_ts_val = false;
-	absolute_ts_ecr = false;
-	free($3);
+	ctx->ignore_ts_val = false;
+	ctx->absolute_ts_ecr = false;
 	free($7);
 	if (inner == NULL) {
 		assert(error != NULL);
-		semantic_error(error);
+		semantic_error(ctx, error);
 		free(error);
 	}
 
@@ -2454,13 +2433,13 @@ udp_packet_spec
 	enum direction_t direction = outer->direction;
 
 	if (!is_valid_u16($4)) {
-		semantic_error("UDP payload size out of range");
+		semantic_error(ctx, "UDP payload size out of range");
 	}
 
-	inner = new_udp_packet(in_config->wire_protocol, direction, $4, &error);
+	inner = new_udp_packet(ctx->config->wire_protocol, direction, $4, &error);
 	if (inner == NULL) {
 		assert(error != NULL);
-		semantic_error(error);
+		semantic_error(ctx, error);
 		free(error);
 	}
 
@@ -2475,17 +2454,17 @@ udplite_packet_spec
 	enum direction_t direction = outer->direction;
 
 	if (!is_valid_u16($4)) {
-		semantic_error("UDPLite payload size out of range");
+		semantic_error(ctx, "UDPLite payload size out of range");
 	}
 	if (!is_valid_u16($6)) {
-		semantic_error("UDPLite checksum coverage out of range");
+		semantic_error(ctx, "UDPLite checksum coverage out of range");
 	}
 
-	inner = new_udplite_packet(in_config->wire_protocol, direction, $4, $6,
+	inner = new_udplite_packet(ctx->config->wire_protocol, direction, $4, $6,
 				   &error);
 	if (inner == NULL) {
 		assert(error != NULL);
-		semantic_error(error);
+		semantic_error(ctx, error);
 		free(error);
 	}
 
@@ -2499,15 +2478,13 @@ icmp_packet_spec
 	struct packet *outer = $1, *inner = NULL;
 	enum direction_t direction = outer->direction;
 
-	inner = new_icmp_packet(in_config->wire_protocol, direction, $4, $5,
+	inner = new_icmp_packet(ctx->config->wire_protocol, direction, $4, $5,
 				$2.protocol, $2.payload_bytes,
 				$2.start_sequence, $2.checksum_coverage,
 				$2.verification_tag, $6,
 				$2.udp_src_port, $2.udp_dst_port, &error);
-	free($4);
-	free($5);
 	if (inner == NULL) {
-		semantic_error(error);
+		semantic_error(ctx, error);
 		free(error);
 	}
 
@@ -2527,9 +2504,7 @@ packet_prefix
 	char *ip_src = $3;
 	char *ip_dst = $5;
 	if (ipv4_header_append(packet, ip_src, ip_dst, &error))
-		semantic_error(error);
-	free(ip_src);
-	free(ip_dst);
+		semantic_error(ctx, error);
 	$$ = packet;
 }
 | packet_prefix IPV6 IPV6_ADDR '>' IPV6_ADDR ':' {
@@ -2538,16 +2513,14 @@ packet_prefix
 	char *ip_src = $3;
 	char *ip_dst = $5;
 	if (ipv6_header_append(packet, ip_src, ip_dst, &error))
-		semantic_error(error);
-	free(ip_src);
-	free(ip_dst);
+		semantic_error(ctx, error);
 	$$ = packet;
 }
 | packet_prefix GRE ':' {
 	char *error = NULL;
 	struct packet *packet = $1;
 	if (gre_header_append(packet, &error))
-		semantic_error(error);
+		semantic_error(ctx, error);
 	$$ = packet;
 }
 | packet_prefix MPLS mpls_stack ':' {
@@ -2556,7 +2529,7 @@ packet_prefix
 	struct mpls_stack *mpls_stack = $3;
 
 	if (mpls_header_append(packet, mpls_stack, &error))
-		semantic_error(error);
+		semantic_error(ctx, error);
 	free(mpls_stack);
 	$$ = packet;
 }
@@ -2568,7 +2541,7 @@ mpls_stack
 }
 | mpls_stack mpls_stack_entry	{
 	if (mpls_stack_append($1, $2))
-		semantic_error("too many MPLS labels");
+		semantic_error(ctx, "too many MPLS labels");
 	$$ = $1;
 }
 ;
@@ -2585,7 +2558,7 @@ mpls_stack_entry
 
 	if (new_mpls_stack_entry(label, traffic_class, is_stack_bottom, ttl,
 				 &mpls, &error))
-		semantic_error(error);
+		semantic_error(ctx, error);
 	$$ = mpls;
 }
 ;
@@ -2594,8 +2567,7 @@ opt_mpls_stack_bottom
 :			{ $$ = 0; }
 | '[' WORD ']' ','	{
 	if (strcmp($2, "S") != 0)
-		semantic_error("expected [S] for MPLS label stack bottom");
-	free($2);
+		semantic_error(ctx, "expected [S] for MPLS label stack bottom");
 	$$ = 1;
 }
 ;
@@ -2654,8 +2626,14 @@ opt_icmp_mtu
 ;
 
 direction
-: '<'          { $$ = DIRECTION_INBOUND;  current_script_line = yylineno; }
-| '>'          { $$ = DIRECTION_OUTBOUND; current_script_line = yylineno; }
+: '<'          {
+	$$ = DIRECTION_INBOUND;
+	ctx->script_line = yyget_lineno(scanner);
+}
+| '>'          {
+	$$ = DIRECTION_OUTBOUND;
+	ctx->script_line = yyget_lineno(scanner);
+}
 ;
 
 opt_ip_info
@@ -2673,24 +2651,24 @@ ip_ecn
 
 flags
 : WORD         { $$ = $1; }
-| '.'          { $$ = strdup("."); }
-| WORD '.'     { asprintf(&($$), "%s.", $1); free($1); }
-| '-'          { $$ = strdup(""); }  /* no TCP flags set in segment */
+| '.'          { $$ = arena_strdup(ctx->arena, "."); }
+| WORD '.'     { $$ = arena_asprintf(ctx->arena, "%s.", $1); }
+| '-'          { $$ = arena_strdup(ctx->arena, ""); }  /* no TCP flags set in segment */
 ;
 
 seq
 : INTEGER ':' INTEGER '(' INTEGER ')' {
 	if (!is_valid_u32($1)) {
-		semantic_error("TCP start sequence number out of range");
+		semantic_error(ctx, "TCP start sequence number out of range");
 	}
 	if (!is_valid_u32($3)) {
-		semantic_error("TCP end sequence number out of range");
+		semantic_error(ctx, "TCP end sequence number out of range");
 	}
 	if (!is_valid_u16($5)) {
-		semantic_error("TCP payload size out of range");
+		semantic_error(ctx, "TCP payload size out of range");
 	}
 	if ($3 != ($1 +$5)) {
-		semantic_error("inconsistent TCP sequence numbers and "
+		semantic_error(ctx, "inconsistent TCP sequence numbers and "
 			       "payload size");
 	}
 	$$.start_sequence = $1;
@@ -2699,16 +2677,16 @@ seq
 }
 | INTEGER ':' INTEGER '(' INTEGER ')' '!' {
 	if (!is_valid_u32($1)) {
-		semantic_error("TCP start sequence number out of range");
+		semantic_error(ctx, "TCP start sequence number out of range");
 	}
 	if (!is_valid_u32($3)) {
-		semantic_error("TCP end sequence number out of range");
+		semantic_error(ctx, "TCP end sequence number out of range");
 	}
 	if (!is_valid_u16($5)) {
-		semantic_error("TCP payload size out of range");
+		semantic_error(ctx, "TCP payload size out of range");
 	}
 	if ($3 != ($1 +$5)) {
-		semantic_error("inconsistent TCP sequence numbers and "
+		semantic_error(ctx, "inconsistent TCP sequence numbers and "
 			       "payload size");
 	}
 	$$.start_sequence = $1;
@@ -2717,7 +2695,7 @@ seq
 }
 | ELLIPSIS '(' INTEGER ')' {
 	if (!is_valid_u16($3)) {
-		semantic_error("TCP payload size out of range");
+		semantic_error(ctx, "TCP payload size out of range");
 	}
 	$$.start_sequence = 0;
 	$$.payload_bytes = $3;
@@ -2729,7 +2707,7 @@ opt_ack
 :              { $$ = 0; }
 | ACK INTEGER  {
 	if (!is_valid_u32($2)) {
-		semantic_error("TCP ack sequence number out of range");
+		semantic_error(ctx, "TCP ack sequence number out of range");
 	}
 	$$ = $2;
 }
@@ -2739,7 +2717,7 @@ opt_window
 :		{ $$ = -1; }
 | WIN INTEGER	{
 	if (!is_valid_u16($2)) {
-		semantic_error("TCP window value out of range");
+		semantic_error(ctx, "TCP window value out of range");
 	}
 	$$ = $2;
 }
@@ -2755,25 +2733,25 @@ tcp_option_list
 : tcp_option                       {
 	$$ = tcp_options_new();
 	if (tcp_options_append($$, $1)) {
-		semantic_error("TCP option list too long");
+		semantic_error(ctx, "TCP option list too long");
 	}
 }
 | tcp_option_list ',' tcp_option   {
 	$$ = $1;
 	if (tcp_options_append($$, $3)) {
-		semantic_error("TCP option list too long");
+		semantic_error(ctx, "TCP option list too long");
 	}
 }
 ;
 
 opt_tcp_fast_open_cookie
-:			{ $$ = strdup(""); }
+:			{ $$ = arena_strdup(ctx->arena, ""); }
 | tcp_fast_open_cookie	{ $$ = $1; }
 ;
 
 tcp_fast_open_cookie
-: WORD    { $$ = strdup(yytext); }
-| INTEGER { $$ = strdup(yytext); }
+: WORD    { $$ = arena_strdup(ctx->arena, yyget_text(scanner)); }
+| INTEGER { $$ = arena_strdup(ctx->arena, yyget_text(scanner)); }
 ;
 
 tcp_option
@@ -2782,14 +2760,14 @@ tcp_option
 | MSS INTEGER      {
 	$$ = tcp_option_new(TCPOPT_MAXSEG, TCPOLEN_MAXSEG);
 	if (!is_valid_u16($2)) {
-		semantic_error("mss value out of range");
+		semantic_error(ctx, "mss value out of range");
 	}
 	$$->data.mss.bytes = htons($2);
 }
 | WSCALE INTEGER   {
 	$$ = tcp_option_new(TCPOPT_WINDOW, TCPOLEN_WINDOW);
 	if (!is_valid_u8($2)) {
-		semantic_error("window scale shift count out of range");
+		semantic_error(ctx, "window scale shift count out of range");
 	}
 	$$->data.window_scale.shift_count = $2;
 }
@@ -2802,16 +2780,16 @@ tcp_option
 }
 | TIMESTAMP VAL ignore_integer ECR abs_integer  {
 	u32 val, ecr;
-	ignore_ts_val = $3.ignore;
-	absolute_ts_ecr = $5.absolute;
+	ctx->ignore_ts_val = $3.ignore;
+	ctx->absolute_ts_ecr = $5.absolute;
 	$$ = tcp_option_new(TCPOPT_TIMESTAMP, TCPOLEN_TIMESTAMP);
 	val = $3.integer;
 	ecr = $5.integer;
 	if (!is_valid_u32(val)) {
-		semantic_error("ts val out of range");
+		semantic_error(ctx, "ts val out of range");
 	}
 	if (!is_valid_u32(ecr)) {
-		semantic_error("ecr val out of range");
+		semantic_error(ctx, "ecr val out of range");
 	}
 	$$->data.time_stamp.val = htonl(val);
 	$$->data.time_stamp.ecr = htonl(ecr);
@@ -2819,20 +2797,18 @@ tcp_option
 | FAST_OPEN opt_tcp_fast_open_cookie  {
 	char *error = NULL;
 	$$ = new_tcp_fast_open_option($2, &error);
-	free($2);
 	if ($$ == NULL) {
 		assert(error != NULL);
-		semantic_error(error);
+		semantic_error(ctx, error);
 		free(error);
 	}
 }
 | EXP_FAST_OPEN opt_tcp_fast_open_cookie  {
 	char *error = NULL;
 	$$ = new_tcp_exp_fast_open_option($2, &error);
-	free($2);
 	if ($$ == NULL) {
 		assert(error != NULL);
-		semantic_error(error);
+		semantic_error(ctx, error);
 		free(error);
 	}
 }
@@ -2868,10 +2844,10 @@ sack_block
 : INTEGER ':' INTEGER {
 	$$ = tcp_option_new(TCPOPT_SACK, 2 + sizeof(struct sack_block));
 	if (!is_valid_u32($1)) {
-		semantic_error("TCP SACK left sequence number out of range");
+		semantic_error(ctx, "TCP SACK left sequence number out of range");
 	}
 	if (!is_valid_u32($3)) {
-		semantic_error("TCP SACK right sequence number out of range");
+		semantic_error(ctx, "TCP SACK right sequence number out of range");
 	}
 	$$->data.sack.block[0].left = htonl($1);
 	$$->data.sack.block[0].right = htonl($3);
@@ -2881,13 +2857,14 @@ sack_block
 syscall_spec
 : opt_end_time function_name function_arguments '='
   expression opt_errno opt_note  {
-	$$ = calloc(1, sizeof(struct syscall_spec));
+	$$ = parse_alloc(ctx, sizeof(struct syscall_spec));
 	$$->end_usecs	= $1;
 	$$->name	= $2;
 	$$->arguments	= $3;
 	$$->result	= $5;
 	$$->error	= $6;
 	$$->note	= $7;
+	prepare_system_call($$);
 }
 ;
 
@@ -2897,7 +2874,10 @@ opt_end_time
 ;
 
 function_name
-: WORD                    { $$ = $1; current_script_line = yylineno; }
+: WORD                    {
+	$$ = $1;
+	ctx->script_line = yyget_lineno(scanner);
+}
 ;
 
 function_arguments
@@ -2906,39 +2886,38 @@ function_arguments
 ;
 
 expression_list
-: expression                     { $$ = new_expression_list($1); }
-| expression_list ',' expression { $$ = $1; expression_list_append($1, $3); }
+: expression                     { $$ = new_expression_list(ctx, $1); }
+| expression_list ',' expression { $$ = $1; expression_list_append(ctx, $1, $3); }
 ;
 
 expression
 : ELLIPSIS          {
-	$$ = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_ELLIPSIS);
 }
 | decimal_integer   { $$ = $1; }
 | hex_integer       { $$ = $1; }
 | _HTONL_ '(' INTEGER ')' {
 	if (!is_valid_u32($3)) {
-		semantic_error("number out of range");
+		semantic_error(ctx, "number out of range");
 	}
-	$$ = new_integer_expression(htonl((u32)$3), "%lu");
+	$$ = new_integer_expression(ctx, htonl((u32)$3), "%lu");
 }
 | _HTONL_ '(' HEX_INTEGER ')' {
 	if (!is_valid_u32($3)) {
-		semantic_error("number out of range");
+		semantic_error(ctx, "number out of range");
 	}
-	$$ = new_integer_expression(htonl((u32)$3), "%#lx");
+	$$ = new_integer_expression(ctx, htonl((u32)$3), "%#lx");
 }
 | WORD              {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $1;
+	$$ = new_word_expression(ctx, $1);
 }
 | STRING            {
-	$$ = new_expression(EXPR_STRING);
+	$$ = new_expression(ctx, EXPR_STRING);
 	$$->value.string = $1;
 	$$->format = "\"%s\"";
 }
 | STRING ELLIPSIS   {
-	$$ = new_expression(EXPR_STRING);
+	$$ = new_expression(ctx, EXPR_STRING);
 	$$->value.string = $1;
 	$$->format = "\"%s\"...";
 }
@@ -3081,22 +3060,22 @@ expression
 
 decimal_integer
 : INTEGER           {
-	$$ = new_integer_expression($1, "%ld");
+	$$ = new_integer_expression(ctx, $1, "%ld");
 }
 ;
 
 hex_integer
 : HEX_INTEGER       {
-	$$ = new_integer_expression($1, "%#lx");
+	$$ = new_integer_expression(ctx, $1, "%#lx");
 }
 ;
 
 binary_expression
 : expression '|' expression {       /* bitwise OR */
-	$$ = new_expression(EXPR_BINARY);
+	$$ = new_expression(ctx, EXPR_BINARY);
 	struct binary_expression *binary =
-			  malloc(sizeof(struct binary_expression));
-	binary->op = strdup("|");
+			  parse_alloc(ctx, sizeof(struct binary_expression));
+	binary->op = arena_strdup(ctx->arena, "|");
 	binary->lhs = $1;
 	binary->rhs = $3;
 	$$->value.binary = binary;
@@ -3105,11 +3084,11 @@ binary_expression
 
 array
 : '[' ']'                 {
-	$$ = new_expression(EXPR_LIST);
+	$$ = new_expression(ctx, EXPR_LIST);
 	$$->value.list = NULL;
 }
 | '[' expression_list ']' {
-	$$ = new_expression(EXPR_LIST);
+	$$ = new_expression(ctx, EXPR_LIST);
 	$$->value.list = $2;
 }
 ;
@@ -3117,7 +3096,7 @@ array
 inaddr
 : INET_ADDR '(' STRING ')' {
 	__be32 ip_address = inet_addr($3);
-	$$ = new_integer_expression(ip_address, "%#lx");
+	$$ = new_integer_expression(ctx, ip_address, "%#lx");
 }
 ;
 
@@ -3126,41 +3105,37 @@ sockaddr
 	SIN_PORT '=' _HTONS_ '(' INTEGER ')' ','
 	SIN_ADDR '=' INET_ADDR '(' STRING ')' '}' {
 	if (strcmp($4, "AF_INET") == 0) {
-		struct sockaddr_in *ipv4 = malloc(sizeof(struct sockaddr_in));
-		memset(ipv4, 0, sizeof(*ipv4));
+		struct sockaddr_in *ipv4 = parse_alloc(ctx, sizeof(struct sockaddr_in));
 		ipv4->sin_family = AF_INET;
 #if defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__) || defined(__APPLE__)
 		ipv4->sin_len = sizeof(*ipv4);
 #endif
 		ipv4->sin_port = htons($10);
 		if (inet_pton(AF_INET, $17, &ipv4->sin_addr) == 1) {
-			$$ = new_expression(EXPR_SOCKET_ADDRESS_IPV4);
+			$$ = new_expression(ctx, EXPR_SOCKET_ADDRESS_IPV4);
 			$$->value.socket_address_ipv4 = ipv4;
 		} else {
-			free(ipv4);
-			semantic_error("invalid IPv4 address");
+			semantic_error(ctx, "invalid IPv4 address");
 		}
 	} else if (strcmp($4, "AF_INET6") == 0) {
-		struct sockaddr_in6 *ipv6 = malloc(sizeof(struct sockaddr_in6));
-		memset(ipv6, 0, sizeof(*ipv6));
+		struct sockaddr_in6 *ipv6 = parse_alloc(ctx, sizeof(struct sockaddr_in6));
 		ipv6->sin6_family = AF_INET6;
 #if defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__) || defined(__APPLE__)
 		ipv6->sin6_len = sizeof(*ipv6);
 #endif
 		ipv6->sin6_port = htons($10);
 		if (inet_pton(AF_INET6, $17, &ipv6->sin6_addr) == 1) {
-			$$ = new_expression(EXPR_SOCKET_ADDRESS_IPV6);
+			$$ = new_expression(ctx, EXPR_SOCKET_ADDRESS_IPV6);
 			$$->value.socket_address_ipv6 = ipv6;
 		} else {
-			free(ipv6);
-			semantic_error("invalid IPv6 address");
+			semantic_error(ctx, "invalid IPv6 address");
 		}
 	}
 }
 ;
 
 data
-: ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+: ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 | sctp_assoc_change         { $$ = $1; }
 | sctp_paddr_change         { $$ = $1; }
 | sctp_remote_error         { $$ = $1; }
@@ -3182,11 +3157,11 @@ msghdr
       MSG_IOV '(' decimal_integer ')' '=' array ','
       MSG_CONTROL '('decimal_integer ')' '=' array ','
       MSG_FLAGS '=' expression '}' {
-	struct msghdr_expr *msg_expr = calloc(1, sizeof(struct msghdr_expr));
-	$$ = new_expression(EXPR_MSGHDR);
+	struct msghdr_expr *msg_expr = parse_alloc(ctx, sizeof(struct msghdr_expr));
+	$$ = new_expression(ctx, EXPR_MSGHDR);
 	$$->value.msghdr = msg_expr;
-	msg_expr->msg_name	= new_expression(EXPR_ELLIPSIS);
-	msg_expr->msg_namelen	= new_expression(EXPR_ELLIPSIS);
+	msg_expr->msg_name	= new_expression(ctx, EXPR_ELLIPSIS);
+	msg_expr->msg_namelen	= new_expression(ctx, EXPR_ELLIPSIS);
 	msg_expr->msg_iov	= $14;
 	msg_expr->msg_iovlen	= $11;
 	msg_expr->msg_controllen= $18;
@@ -3198,29 +3173,27 @@ msghdr
 cmsg_level
 : CMSG_LEVEL '=' INTEGER {
 	if (!is_valid_s32($3)) {
-		semantic_error("cmsg_level out of range");
+		semantic_error(ctx, "cmsg_level out of range");
 	}
-	$$ = new_integer_expression($3, "%d");
+	$$ = new_integer_expression(ctx, $3, "%d");
 }
 | CMSG_LEVEL '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| CMSG_LEVEL '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| CMSG_LEVEL '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 cmsg_type
 : CMSG_TYPE '=' INTEGER {
 	if (!is_valid_s32($3)) {
-		semantic_error("cmsg_level out of range");
+		semantic_error(ctx, "cmsg_level out of range");
 	}
-	$$ = new_integer_expression($3, "%d");
+	$$ = new_integer_expression(ctx, $3, "%d");
 }
 | CMSG_TYPE '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| CMSG_TYPE '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| CMSG_TYPE '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 cmsg_data
@@ -3237,12 +3210,12 @@ cmsg_data
 
 cmsghdr
 : '{' _CMSG_LEN_ '=' INTEGER ',' cmsg_level ',' cmsg_type ',' cmsg_data '}' {
-	$$ = new_expression(EXPR_CMSGHDR);
-	$$->value.cmsghdr = calloc(1, sizeof(struct cmsghdr_expr));
+	$$ = new_expression(ctx, EXPR_CMSGHDR);
+	$$->value.cmsghdr = parse_alloc(ctx, sizeof(struct cmsghdr_expr));
 	if (!is_valid_s32($4)) {
-		semantic_error("cmsg_len out of range");
+		semantic_error(ctx, "cmsg_len out of range");
 	}
-	$$->value.cmsghdr->cmsg_len = new_integer_expression($4, "%u");
+	$$->value.cmsghdr->cmsg_len = new_integer_expression(ctx, $4, "%u");
 	$$->value.cmsghdr->cmsg_level = $6;
 	$$->value.cmsghdr->cmsg_type = $8;
 	$$->value.cmsghdr->cmsg_data = $10;
@@ -3250,15 +3223,15 @@ cmsghdr
 
 iovec
 : '{' data ',' decimal_integer '}' {
-	struct iovec_expr *iov_expr = calloc(1, sizeof(struct iovec_expr));
-	$$ = new_expression(EXPR_IOVEC);
+	struct iovec_expr *iov_expr = parse_alloc(ctx, sizeof(struct iovec_expr));
+	$$ = new_expression(ctx, EXPR_IOVEC);
 	$$->value.iovec = iov_expr;
 	iov_expr->iov_base = $2;
 	iov_expr->iov_len = $4;
 }
 | '{' IOV_BASE '=' data ',' IOV_LEN '=' decimal_integer '}' {
-	struct iovec_expr *iov_expr = calloc(1, sizeof(struct iovec_expr));
-	$$ = new_expression(EXPR_IOVEC);
+	struct iovec_expr *iov_expr = parse_alloc(ctx, sizeof(struct iovec_expr));
+	$$ = new_expression(ctx, EXPR_IOVEC);
 	$$->value.iovec = iov_expr;
 	iov_expr->iov_base = $4;
 	iov_expr->iov_len = $8;
@@ -3267,8 +3240,8 @@ iovec
 
 pollfd
 : '{' FD '=' expression ',' EVENTS '=' expression opt_revents '}' {
-	struct pollfd_expr *pollfd_expr = calloc(1, sizeof(struct pollfd_expr));
-	$$ = new_expression(EXPR_POLLFD);
+	struct pollfd_expr *pollfd_expr = parse_alloc(ctx, sizeof(struct pollfd_expr));
+	$$ = new_expression(ctx, EXPR_POLLFD);
 	$$->value.pollfd = pollfd_expr;
 	pollfd_expr->fd = $4;
 	pollfd_expr->events = $8;
@@ -3277,38 +3250,38 @@ pollfd
 ;
 
 opt_revents
-:                                { $$ = new_integer_expression(0, "%ld"); }
+:                                { $$ = new_integer_expression(ctx, 0, "%ld"); }
 | ',' REVENTS '=' expression     { $$ = $4; }
 ;
 
 l_onoff
 : ONOFF '=' INTEGER {
 	if (!is_valid_s32($3)) {
-		semantic_error("linger onoff out of range");
+		semantic_error(ctx, "linger onoff out of range");
 	}
-	$$ = new_integer_expression($3, "%ld");
+	$$ = new_integer_expression(ctx, $3, "%ld");
 }
 | ONOFF '=' ELLIPSIS {
-	$$ = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_ELLIPSIS);
 }
 ;
 
 l_linger
 : LINGER '=' INTEGER {
 	if (!is_valid_s32($3)) {
-		semantic_error("linger out of range");
+		semantic_error(ctx, "linger out of range");
 	}
-	$$ = new_integer_expression($3, "%ld");
+	$$ = new_integer_expression(ctx, $3, "%ld");
 }
 | LINGER '=' ELLIPSIS {
-	$$ = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_ELLIPSIS);
 }
 ;
 
 linger
 : '{' l_onoff ',' l_linger '}' {
-	$$ = new_expression(EXPR_LINGER);
-	$$->value.linger = calloc(1, sizeof(struct linger_expr));
+	$$ = new_expression(ctx, EXPR_LINGER);
+	$$->value.linger = parse_alloc(ctx, sizeof(struct linger_expr));
 	$$->value.linger->l_onoff  = $2;
 	$$->value.linger->l_linger = $4;
 }
@@ -3316,31 +3289,31 @@ linger
 
 af_name
 : AF_NAME '=' STRING {
-	$$ = new_expression(EXPR_STRING);
+	$$ = new_expression(ctx, EXPR_STRING);
 	$$->value.string = $3;
 	$$->format = "\"%s\"";
 }
 | AF_NAME '=' ELLIPSIS {
-	$$ = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_ELLIPSIS);
 }
 ;
 
 af_arg
 : AF_ARG '=' STRING {
-	$$ = new_expression(EXPR_STRING);
+	$$ = new_expression(ctx, EXPR_STRING);
 	$$->value.string = $3;
 	$$->format = "\"%s\"";
 }
 | AF_ARG '=' ELLIPSIS {
-	$$ = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_ELLIPSIS);
 }
 ;
 
 accept_filter_arg
 : '{' af_name '}' {
 #if defined(__FreeBSD__) || defined(__NetBSD__)
-	$$ = new_expression(EXPR_ACCEPT_FILTER_ARG);
-	$$->value.accept_filter_arg = calloc(1, sizeof(struct accept_filter_arg_expr));
+	$$ = new_expression(ctx, EXPR_ACCEPT_FILTER_ARG);
+	$$->value.accept_filter_arg = parse_alloc(ctx, sizeof(struct accept_filter_arg_expr));
 	$$->value.accept_filter_arg->af_name = $2;
 	$$->value.accept_filter_arg->af_arg = NULL;
 #else
@@ -3349,8 +3322,8 @@ accept_filter_arg
 }
 | '{' af_name ',' af_arg '}' {
 #if defined(__FreeBSD__) || defined(__NetBSD__)
-	$$ = new_expression(EXPR_ACCEPT_FILTER_ARG);
-	$$->value.accept_filter_arg = calloc(1, sizeof(struct accept_filter_arg_expr));
+	$$ = new_expression(ctx, EXPR_ACCEPT_FILTER_ARG);
+	$$->value.accept_filter_arg = parse_alloc(ctx, sizeof(struct accept_filter_arg_expr));
 	$$->value.accept_filter_arg->af_name = $2;
 	$$->value.accept_filter_arg->af_arg = $4;
 #else
@@ -3360,32 +3333,32 @@ accept_filter_arg
 
 function_set_name
 : FUNCTION_SET_NAME '=' STRING {
-	$$ = new_expression(EXPR_STRING);
+	$$ = new_expression(ctx, EXPR_STRING);
 	$$->value.string = $3;
 	$$->format = "\"%s\"";
 }
 | FUNCTION_SET_NAME '=' ELLIPSIS {
-	$$ = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_ELLIPSIS);
 }
 ;
 
 pcbcnt
 : PCBCNT '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("linger out of range");
+		semantic_error(ctx, "linger out of range");
 	}
-	$$ = new_integer_expression($3, "%lu");
+	$$ = new_integer_expression(ctx, $3, "%lu");
 }
 | PCBCNT '=' ELLIPSIS {
-	$$ = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_ELLIPSIS);
 }
 ;
 
 tcp_function_set
 : '{' function_set_name ',' pcbcnt '}' {
 #if defined(__FreeBSD__)
-	$$ = new_expression(EXPR_TCP_FUNCTION_SET);
-	$$->value.tcp_function_set = calloc(1, sizeof(struct tcp_function_set_expr));
+	$$ = new_expression(ctx, EXPR_TCP_FUNCTION_SET);
+	$$->value.tcp_function_set = parse_alloc(ctx, sizeof(struct tcp_function_set_expr));
 	$$->value.tcp_function_set->function_set_name = $2;
 	$$->value.tcp_function_set->pcbcnt = $4;
 #else
@@ -3398,8 +3371,8 @@ sf_hdtr
 : '{' SF_HDTR_HEADERS '(' decimal_integer ')' '=' array ','
       SF_HDTR_TRAILERS '('decimal_integer ')' '=' array '}' {
 #if defined(__FreeBSD__)
-	struct sf_hdtr_expr *sf_hdtr_expr = calloc(1, sizeof(struct sf_hdtr_expr));
-	$$ = new_expression(EXPR_SF_HDTR);
+	struct sf_hdtr_expr *sf_hdtr_expr = parse_alloc(ctx, sizeof(struct sf_hdtr_expr));
+	$$ = new_expression(ctx, EXPR_SF_HDTR);
 	$$->value.sf_hdtr = sf_hdtr_expr;
 	sf_hdtr_expr->headers	= $7;
 	sf_hdtr_expr->hdr_cnt	= $4;
@@ -3414,60 +3387,59 @@ sf_hdtr
 srto_initial
 : SRTO_INITIAL '=' INTEGER {
 	if (!is_valid_u32($3)){
-		semantic_error("srto_initial out of range");
+		semantic_error(ctx, "srto_initial out of range");
 	}
-        $$ = new_integer_expression($3, "%u");
+        $$ = new_integer_expression(ctx, $3, "%u");
 }
-| SRTO_INITIAL '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SRTO_INITIAL '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 srto_max
 : SRTO_MAX '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("srto_max out of range");
+		semantic_error(ctx, "srto_max out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SRTO_MAX '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SRTO_MAX '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 srto_min
 : SRTO_MIN '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("srto_min out of range");
+		semantic_error(ctx, "srto_min out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SRTO_MIN '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SRTO_MIN '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_assoc_id
 : INTEGER {
 	if (!is_valid_u32($1)) {
-		semantic_error("value for sctp_assoc_t out of range");
+		semantic_error(ctx, "value for sctp_assoc_t out of range");
 	}
-	$$ = new_integer_expression($1, "%u");
+	$$ = new_integer_expression(ctx, $1, "%u");
 }
 | WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $1;
+	$$ = new_word_expression(ctx, $1);
 }
-| ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_rtoinfo
 : '{' SRTO_ASSOC_ID '=' sctp_assoc_id ',' srto_initial ',' srto_max ',' srto_min '}' {
-	$$ = new_expression(EXPR_SCTP_RTOINFO);
-	$$->value.sctp_rtoinfo = calloc(1, sizeof(struct sctp_rtoinfo_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_RTOINFO);
+	$$->value.sctp_rtoinfo = parse_alloc(ctx, sizeof(struct sctp_rtoinfo_expr));
 	$$->value.sctp_rtoinfo->srto_assoc_id = $4;
 	$$->value.sctp_rtoinfo->srto_initial = $6;
 	$$->value.sctp_rtoinfo->srto_max = $8;
 	$$->value.sctp_rtoinfo->srto_min = $10;
 }
 | '{' srto_initial ',' srto_max ',' srto_min '}' {
-	$$ = new_expression(EXPR_SCTP_RTOINFO);
-	$$->value.sctp_rtoinfo = calloc(1, sizeof(struct sctp_rtoinfo_expr));
-	$$->value.sctp_rtoinfo->srto_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_SCTP_RTOINFO);
+	$$->value.sctp_rtoinfo = parse_alloc(ctx, sizeof(struct sctp_rtoinfo_expr));
+	$$->value.sctp_rtoinfo->srto_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 	$$->value.sctp_rtoinfo->srto_initial = $2;
 	$$->value.sctp_rtoinfo->srto_max = $4;
 	$$->value.sctp_rtoinfo->srto_min = $6;
@@ -3477,48 +3449,48 @@ sctp_rtoinfo
 sinit_num_ostreams
 : SINIT_NUM_OSTREAMS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sinit_num_ostreams out of range");
+		semantic_error(ctx, "sinit_num_ostreams out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SINIT_NUM_OSTREAMS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SINIT_NUM_OSTREAMS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sinit_max_instreams
 : SINIT_MAX_INSTREAMS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sinit_max_instreams out of range");
+		semantic_error(ctx, "sinit_max_instreams out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SINIT_MAX_INSTREAMS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SINIT_MAX_INSTREAMS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sinit_max_attempts
 : SINIT_MAX_ATTEMPTS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sinit_max_attempts out of range");
+		semantic_error(ctx, "sinit_max_attempts out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SINIT_MAX_ATTEMPTS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SINIT_MAX_ATTEMPTS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sinit_max_init_timeo
 : SINIT_MAX_INIT_TIMEO '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sinit_max_init_timeo out of range");
+		semantic_error(ctx, "sinit_max_init_timeo out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SINIT_MAX_INIT_TIMEO '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SINIT_MAX_INIT_TIMEO '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_initmsg
 : '{' sinit_num_ostreams ',' sinit_max_instreams ',' sinit_max_attempts ',' sinit_max_init_timeo '}'
 {
-	$$ = new_expression(EXPR_SCTP_INITMSG);
-	$$->value.sctp_initmsg = calloc(1, sizeof(struct sctp_initmsg_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_INITMSG);
+	$$->value.sctp_initmsg = parse_alloc(ctx, sizeof(struct sctp_initmsg_expr));
 	$$->value.sctp_initmsg->sinit_num_ostreams = $2;
 	$$->value.sctp_initmsg->sinit_max_instreams = $4;
 	$$->value.sctp_initmsg->sinit_max_attempts = $6;
@@ -3528,8 +3500,8 @@ sctp_initmsg
 
 sctp_stream_value
 : '{' STREAM_ID '=' expression ',' STREAM_VALUE '=' expression '}' {
-	$$ = new_expression(EXPR_SCTP_STREAM_VALUE);
-	$$->value.sctp_stream_value = calloc(1, sizeof(struct sctp_stream_value_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_STREAM_VALUE);
+	$$->value.sctp_stream_value = parse_alloc(ctx, sizeof(struct sctp_stream_value_expr));
 	$$->value.sctp_stream_value->stream_id = $4;
 	$$->value.sctp_stream_value->stream_value = $8;
 }
@@ -3537,15 +3509,15 @@ sctp_stream_value
 
 sctp_assoc_value
 : '{' ASSOC_ID '=' sctp_assoc_id ',' ASSOC_VALUE '=' expression '}' {
-	$$ = new_expression(EXPR_SCTP_ASSOC_VALUE);
-	$$->value.sctp_assoc_value = calloc(1, sizeof(struct sctp_assoc_value_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_ASSOC_VALUE);
+	$$->value.sctp_assoc_value = parse_alloc(ctx, sizeof(struct sctp_assoc_value_expr));
 	$$->value.sctp_assoc_value->assoc_id = $4;
 	$$->value.sctp_assoc_value->assoc_value = $8;
 }
 | '{' ASSOC_VALUE '=' expression '}' {
-	$$ = new_expression(EXPR_SCTP_ASSOC_VALUE);
-	$$->value.sctp_assoc_value = calloc(1, sizeof(struct sctp_assoc_value_expr));
-	$$->value.sctp_assoc_value->assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_SCTP_ASSOC_VALUE);
+	$$->value.sctp_assoc_value = parse_alloc(ctx, sizeof(struct sctp_assoc_value_expr));
+	$$->value.sctp_assoc_value->assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 	$$->value.sctp_assoc_value->assoc_value = $4;
 }
 ;
@@ -3553,17 +3525,17 @@ sctp_assoc_value
 shmac_number_of_idents
 : SHMAC_NUMBER_OF_IDENTS '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("shmac_number_of_idents out of range");
+		semantic_error(ctx, "shmac_number_of_idents out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SHMAC_NUMBER_OF_IDENTS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SHMAC_NUMBER_OF_IDENTS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_hmacalgo
 : '{' shmac_number_of_idents ',' SHMAC_IDENTS '=' array '}' {
-	$$ = new_expression(EXPR_SCTP_HMACALGO);
-	$$->value.sctp_hmacalgo = calloc(1, sizeof(struct sctp_assoc_value_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_HMACALGO);
+	$$->value.sctp_hmacalgo = parse_alloc(ctx, sizeof(struct sctp_assoc_value_expr));
 	$$->value.sctp_hmacalgo->shmac_number_of_idents = $2;
 	$$->value.sctp_hmacalgo->shmac_idents = $6;
 }
@@ -3571,56 +3543,56 @@ sctp_hmacalgo
 scact_keynumber
 : SCACT_KEYNUMBER '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("scact_keynumber out of range");
+		semantic_error(ctx, "scact_keynumber out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SCACT_KEYNUMBER '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SCACT_KEYNUMBER '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 
 sctp_authkeyid
 : '{' SCACT_ASSOC_ID '=' sctp_assoc_id ',' scact_keynumber '}' {
-	$$ = new_expression(EXPR_SCTP_AUTHKEYID);
-	$$->value.sctp_authkeyid = calloc(1, sizeof(struct sctp_authkeyid_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_AUTHKEYID);
+	$$->value.sctp_authkeyid = parse_alloc(ctx, sizeof(struct sctp_authkeyid_expr));
 	$$->value.sctp_authkeyid->scact_assoc_id = $4;
 	$$->value.sctp_authkeyid->scact_keynumber = $6;
 }
 | '{' scact_keynumber '}'{ 
-	$$ = new_expression(EXPR_SCTP_AUTHKEYID);
-	$$->value.sctp_authkeyid = calloc(1, sizeof(struct sctp_authkeyid_expr));
-	$$->value.sctp_authkeyid->scact_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_SCTP_AUTHKEYID);
+	$$->value.sctp_authkeyid = parse_alloc(ctx, sizeof(struct sctp_authkeyid_expr));
+	$$->value.sctp_authkeyid->scact_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 	$$->value.sctp_authkeyid->scact_keynumber = $2;
 }
 
 sack_delay
 : SACK_DELAY '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("sack_delay out of range");
+		semantic_error(ctx, "sack_delay out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SACK_DELAY '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SACK_DELAY '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 
 sack_freq
 : SACK_FREQ '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("sack_freq out of range");
+		semantic_error(ctx, "sack_freq out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SACK_FREQ '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SACK_FREQ '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 
 sctp_sackinfo
 : '{' SACK_ASSOC_ID '=' sctp_assoc_id ',' sack_delay ',' sack_freq '}' {
-	$$ = new_expression(EXPR_SCTP_SACKINFO);
-	$$->value.sctp_sack_info = calloc(1, sizeof(struct sctp_sack_info_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_SACKINFO);
+	$$->value.sctp_sack_info = parse_alloc(ctx, sizeof(struct sctp_sack_info_expr));
 	$$->value.sctp_sack_info->sack_assoc_id = $4;
 	$$->value.sctp_sack_info->sack_delay = $6;
 	$$->value.sctp_sack_info->sack_freq = $8;
 }
 | '{' sack_delay ',' sack_freq '}' {
-	$$ = new_expression(EXPR_SCTP_SACKINFO);
-	$$->value.sctp_sack_info = calloc(1, sizeof(struct sctp_sack_info_expr));
-	$$->value.sctp_sack_info->sack_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_SCTP_SACKINFO);
+	$$->value.sctp_sack_info = parse_alloc(ctx, sizeof(struct sctp_sack_info_expr));
+	$$->value.sctp_sack_info->sack_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 	$$->value.sctp_sack_info->sack_delay = $2;
 	$$->value.sctp_sack_info->sack_freq = $4;
 }
@@ -3633,132 +3605,131 @@ sstat_state
 sstat_rwnd
 : SSTAT_RWND '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("sstat_rwnd out of range");
+		semantic_error(ctx, "sstat_rwnd out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SSTAT_RWND '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SSTAT_RWND '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sstat_unackdata
 : SSTAT_UNACKDATA '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sstat_unackdata out of range");
+		semantic_error(ctx, "sstat_unackdata out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SSTAT_UNACKDATA '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SSTAT_UNACKDATA '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sstat_penddata
 : SSTAT_PENDDATA '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sstat_penddata out of range");
+		semantic_error(ctx, "sstat_penddata out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SSTAT_PENDDATA '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SSTAT_PENDDATA '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sstat_instrms
 : SSTAT_INSTRMS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sstat_instrms out of range");
+		semantic_error(ctx, "sstat_instrms out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SSTAT_INSTRMS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SSTAT_INSTRMS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sstat_outstrms
 : SSTAT_OUTSTRMS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sstat_outstrms out of range");
+		semantic_error(ctx, "sstat_outstrms out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SSTAT_OUTSTRMS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SSTAT_OUTSTRMS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sstat_fragmentation_point
 : SSTAT_FRAGMENTATION_POINT '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("sstat_fragmentation_point out of range");
+		semantic_error(ctx, "sstat_fragmentation_point out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SSTAT_FRAGMENTATION_POINT '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SSTAT_FRAGMENTATION_POINT '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sstat_primary
-: SSTAT_PRIMARY '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+: SSTAT_PRIMARY '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 | SSTAT_PRIMARY '=' sctp_paddrinfo  { $$ = $3; }
 ;
 
 spinfo_address
-: SPINFO_ADDRESS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+: SPINFO_ADDRESS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 | SPINFO_ADDRESS '=' sockaddr { $$ = $3; }
 ;
 
 spinfo_state
 : SPINFO_STATE '=' INTEGER {
 	if (!is_valid_s32($3)) {
-		semantic_error("spinfo_state out of range");
+		semantic_error(ctx, "spinfo_state out of range");
 	}
-	$$ = new_integer_expression($3, "%d");
+	$$ = new_integer_expression(ctx, $3, "%d");
 }
 | SPINFO_STATE '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| SPINFO_STATE '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SPINFO_STATE '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 spinfo_cwnd
 : SPINFO_CWND '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("spinfo_cwnd out of range");
+		semantic_error(ctx, "spinfo_cwnd out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SPINFO_CWND '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SPINFO_CWND '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 spinfo_srtt
 : SPINFO_SRTT '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("spinfo_srtt out of range");
+		semantic_error(ctx, "spinfo_srtt out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SPINFO_SRTT '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SPINFO_SRTT '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 spinfo_rto
 : SPINFO_RTO '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("spinfo_rto out of range");
+		semantic_error(ctx, "spinfo_rto out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SPINFO_RTO '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SPINFO_RTO '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 spinfo_mtu
 : SPINFO_MTU '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("spinfo_mtu out of range");
+		semantic_error(ctx, "spinfo_mtu out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SPINFO_MTU '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SPINFO_MTU '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_paddrinfo
 : '{' SPINFO_ASSOC_ID '=' sctp_assoc_id ',' spinfo_address ',' spinfo_state ',' spinfo_cwnd ','
       spinfo_srtt ',' spinfo_rto ',' spinfo_mtu '}' {
-	$$ = new_expression(EXPR_SCTP_PADDRINFO);
-	$$->value.sctp_paddrinfo = calloc(1, sizeof(struct sctp_paddrinfo_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_PADDRINFO);
+	$$->value.sctp_paddrinfo = parse_alloc(ctx, sizeof(struct sctp_paddrinfo_expr));
 	$$->value.sctp_paddrinfo->spinfo_assoc_id = $4;
 	$$->value.sctp_paddrinfo->spinfo_address = $6;
 	$$->value.sctp_paddrinfo->spinfo_state = $8;
@@ -3769,9 +3740,9 @@ sctp_paddrinfo
 }
 | '{' spinfo_address ',' spinfo_state ',' spinfo_cwnd ','
       spinfo_srtt ',' spinfo_rto ',' spinfo_mtu '}' {
-	$$ = new_expression(EXPR_SCTP_PADDRINFO);
-	$$->value.sctp_paddrinfo = calloc(1, sizeof(struct sctp_paddrinfo_expr));
-	$$->value.sctp_paddrinfo->spinfo_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_SCTP_PADDRINFO);
+	$$->value.sctp_paddrinfo = parse_alloc(ctx, sizeof(struct sctp_paddrinfo_expr));
+	$$->value.sctp_paddrinfo->spinfo_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 	$$->value.sctp_paddrinfo->spinfo_address = $2;
 	$$->value.sctp_paddrinfo->spinfo_state = $4;
 	$$->value.sctp_paddrinfo->spinfo_cwnd = $6;
@@ -3784,8 +3755,8 @@ sctp_paddrinfo
 sctp_status
 : '{' SSTAT_ASSOC_ID '=' sctp_assoc_id ',' sstat_state ',' sstat_rwnd ',' sstat_unackdata ',' sstat_penddata ',' sstat_instrms ',' sstat_outstrms ','
 	sstat_fragmentation_point ',' sstat_primary '}' {
-	$$ = new_expression(EXPR_SCTP_STATUS);
-	$$->value.sctp_status = calloc(1, sizeof(struct sctp_status_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_STATUS);
+	$$->value.sctp_status = parse_alloc(ctx, sizeof(struct sctp_status_expr));
 	$$->value.sctp_status->sstat_assoc_id = $4;
 	$$->value.sctp_status->sstat_state = $6;
 	$$->value.sctp_status->sstat_rwnd = $8;
@@ -3798,9 +3769,9 @@ sctp_status
 }
 | '{' sstat_state ',' sstat_rwnd ',' sstat_unackdata ',' sstat_penddata ',' sstat_instrms ',' sstat_outstrms ','
 	sstat_fragmentation_point ',' sstat_primary '}' {
-	$$ = new_expression(EXPR_SCTP_STATUS);
-	$$->value.sctp_status = calloc(1, sizeof(struct sctp_status_expr));
-	$$->value.sctp_status->sstat_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_SCTP_STATUS);
+	$$->value.sctp_status = parse_alloc(ctx, sizeof(struct sctp_status_expr));
+	$$->value.sctp_status->sstat_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 	$$->value.sctp_status->sstat_state = $2;
 	$$->value.sctp_status->sstat_rwnd = $4;
 	$$->value.sctp_status->sstat_unackdata = $6;
@@ -3813,38 +3784,38 @@ sctp_status
 ;
 
 spp_address
-: SPP_ADDRESS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+: SPP_ADDRESS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 | SPP_ADDRESS '=' sockaddr { $$ = $3; }
 ;
 
 spp_hbinterval
 : SPP_HBINTERVAL '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("spp_hbinterval out of range");
+		semantic_error(ctx, "spp_hbinterval out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SPP_HBINTERVAL '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SPP_HBINTERVAL '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 spp_pathmtu
 : SPP_PATHMTU '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("spp_pathmtu out of range");
+		semantic_error(ctx, "spp_pathmtu out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SPP_PATHMTU '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SPP_PATHMTU '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 spp_pathmaxrxt
 : SPP_PATHMAXRXT '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("spp_pathmaxrxt out of range");
+		semantic_error(ctx, "spp_pathmaxrxt out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SPP_PATHMAXRXT '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SPP_PATHMAXRXT '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 spp_flags
@@ -3854,28 +3825,28 @@ spp_flags
 spp_ipv6_flowlabel
 : SPP_IPV6_FLOWLABEL_ '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("spp_ipv6_flowlabel out of range");
+		semantic_error(ctx, "spp_ipv6_flowlabel out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SPP_IPV6_FLOWLABEL_ '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SPP_IPV6_FLOWLABEL_ '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 spp_dscp
 : SPP_DSCP_ '=' INTEGER {
 	if (!is_valid_u8($3)) {
-		semantic_error("spp_dscp out of range");
+		semantic_error(ctx, "spp_dscp out of range");
 	}
-	$$ = new_integer_expression($3, "%hhu");
+	$$ = new_integer_expression(ctx, $3, "%hhu");
 }
-| SPP_DSCP_ '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SPP_DSCP_ '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_paddrparams
 : '{' SPP_ASSOC_ID '=' sctp_assoc_id ',' spp_address ',' spp_hbinterval ',' spp_pathmaxrxt ',' spp_pathmtu ','spp_flags ','
       spp_ipv6_flowlabel ',' spp_dscp'}' {
-	$$ = new_expression(EXPR_SCTP_PEER_ADDR_PARAMS);
-	$$->value.sctp_paddrparams = calloc(1, sizeof(struct sctp_paddrparams_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_PEER_ADDR_PARAMS);
+	$$->value.sctp_paddrparams = parse_alloc(ctx, sizeof(struct sctp_paddrparams_expr));
 	$$->value.sctp_paddrparams->spp_assoc_id = $4;
 	$$->value.sctp_paddrparams->spp_address = $6;
 	$$->value.sctp_paddrparams->spp_hbinterval = $8;
@@ -3887,9 +3858,9 @@ sctp_paddrparams
 }
 | '{' spp_address ',' spp_hbinterval ',' spp_pathmaxrxt ',' spp_pathmtu ','spp_flags ','
       spp_ipv6_flowlabel ',' spp_dscp'}' {
-	$$ = new_expression(EXPR_SCTP_PEER_ADDR_PARAMS);
-	$$->value.sctp_paddrparams = calloc(1, sizeof(struct sctp_paddrparams_expr));
-	$$->value.sctp_paddrparams->spp_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_SCTP_PEER_ADDR_PARAMS);
+	$$->value.sctp_paddrparams = parse_alloc(ctx, sizeof(struct sctp_paddrparams_expr));
+	$$->value.sctp_paddrparams->spp_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 	$$->value.sctp_paddrparams->spp_address = $2;
 	$$->value.sctp_paddrparams->spp_hbinterval = $4;
 	$$->value.sctp_paddrparams->spp_pathmaxrxt = $6;
@@ -3903,58 +3874,58 @@ sctp_paddrparams
 sasoc_asocmaxrxt
 : SASOC_ASOCMAXRXT '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sasoc_asocmaxrxt out of range");
+		semantic_error(ctx, "sasoc_asocmaxrxt out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SASOC_ASOCMAXRXT '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SASOC_ASOCMAXRXT '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sasoc_number_peer_destinations
 : SASOC_NUMBER_PEER_DESTINATIONS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sasoc_number_peer_destinations out of range");
+		semantic_error(ctx, "sasoc_number_peer_destinations out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SASOC_NUMBER_PEER_DESTINATIONS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SASOC_NUMBER_PEER_DESTINATIONS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sasoc_peer_rwnd
 : SASOC_PEER_RWND '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("sasoc_peer_rwnd out of range");
+		semantic_error(ctx, "sasoc_peer_rwnd out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SASOC_PEER_RWND '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SASOC_PEER_RWND '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sasoc_local_rwnd
 : SASOC_LOCAL_RWND '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("sasoc_local_rwnd out of range");
+		semantic_error(ctx, "sasoc_local_rwnd out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SASOC_LOCAL_RWND '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SASOC_LOCAL_RWND '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sasoc_cookie_life
 : SASOC_COOKIE_LIFE '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("sasoc_cookie_life out of range");
+		semantic_error(ctx, "sasoc_cookie_life out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SASOC_COOKIE_LIFE '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SASOC_COOKIE_LIFE '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_assocparams
 : '{' SASOC_ASSOC_ID '=' sctp_assoc_id ',' sasoc_asocmaxrxt ',' sasoc_number_peer_destinations ','
       sasoc_peer_rwnd ',' sasoc_local_rwnd ',' sasoc_cookie_life '}' {
-	$$ = new_expression(EXPR_SCTP_ASSOCPARAMS);
-        $$->value.sctp_assocparams = calloc(1, sizeof(struct sctp_assocparams_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_ASSOCPARAMS);
+        $$->value.sctp_assocparams = parse_alloc(ctx, sizeof(struct sctp_assocparams_expr));
         $$->value.sctp_assocparams->sasoc_assoc_id = $4;
         $$->value.sctp_assocparams->sasoc_asocmaxrxt = $6;
         $$->value.sctp_assocparams->sasoc_number_peer_destinations = $8;
@@ -3964,9 +3935,9 @@ sctp_assocparams
 }
 | '{' sasoc_asocmaxrxt ',' sasoc_number_peer_destinations ','
       sasoc_peer_rwnd ',' sasoc_local_rwnd ',' sasoc_cookie_life '}' {
-	$$ = new_expression(EXPR_SCTP_ASSOCPARAMS);
-        $$->value.sctp_assocparams = calloc(1, sizeof(struct sctp_assocparams_expr));
-        $$->value.sctp_assocparams->sasoc_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_SCTP_ASSOCPARAMS);
+        $$->value.sctp_assocparams = parse_alloc(ctx, sizeof(struct sctp_assocparams_expr));
+        $$->value.sctp_assocparams->sasoc_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
         $$->value.sctp_assocparams->sasoc_asocmaxrxt = $2;
         $$->value.sctp_assocparams->sasoc_number_peer_destinations = $4;
         $$->value.sctp_assocparams->sasoc_peer_rwnd = $6;
@@ -3978,38 +3949,37 @@ sctp_assocparams
 se_type
 : SE_TYPE '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("se_type out of range");
+		semantic_error(ctx, "se_type out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
 | SE_TYPE '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
 ;
 
 se_on
 : SE_ON '=' INTEGER {
 	if (!is_valid_u8($3)) {
-		semantic_error("se_on out of range");
+		semantic_error(ctx, "se_on out of range");
 	}
-	$$ = new_integer_expression($3, "%hhu");
+	$$ = new_integer_expression(ctx, $3, "%hhu");
 }
-| SE_ON '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SE_ON '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_event
 : '{' SE_ASSOC_ID '=' sctp_assoc_id ',' se_type ',' se_on '}' {
-	$$ = new_expression(EXPR_SCTP_EVENT);
-	$$->value.sctp_event = calloc(1, sizeof(struct sctp_event_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_EVENT);
+	$$->value.sctp_event = parse_alloc(ctx, sizeof(struct sctp_event_expr));
 	$$->value.sctp_event->se_assoc_id = $4;
 	$$->value.sctp_event->se_type = $6;
 	$$->value.sctp_event->se_on = $8;
 }
 | '{' se_type ',' se_on '}' {
-	$$ = new_expression(EXPR_SCTP_EVENT);
-	$$->value.sctp_event = calloc(1, sizeof(struct sctp_event_expr));
-	$$->value.sctp_event->se_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_SCTP_EVENT);
+	$$->value.sctp_event = parse_alloc(ctx, sizeof(struct sctp_event_expr));
+	$$->value.sctp_event->se_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 	$$->value.sctp_event->se_type = $2;
 	$$->value.sctp_event->se_on = $4;
 }
@@ -4021,59 +3991,59 @@ sctp_event_subscribe
       _SCTP_PEER_ERROR_EVENT_       '=' INTEGER ',' _SCTP_SHUTDOWN_EVENT_         '=' INTEGER ','
       _SCTP_PARTIAL_DELIVERY_EVENT_ '=' INTEGER ',' _SCTP_ADAPTATION_LAYER_EVENT_ '=' INTEGER ','
       _SCTP_AUTHENTICATION_EVENT_   '=' INTEGER ',' _SCTP_SENDER_DRY_EVENT_       '=' INTEGER '}' {
-	$$ = new_expression(EXPR_SCTP_EVENT_SUBSCRIBE);
-	$$->value.sctp_event_subscribe = calloc(1, sizeof(struct sctp_event_subscribe_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_EVENT_SUBSCRIBE);
+	$$->value.sctp_event_subscribe = parse_alloc(ctx, sizeof(struct sctp_event_subscribe_expr));
 	if (!is_valid_u8($4)) {
-		semantic_error("sctp_data_io_event out of range");
+		semantic_error(ctx, "sctp_data_io_event out of range");
 	}
-	$$->value.sctp_event_subscribe->sctp_data_io_event =  new_integer_expression($4, "%hhu");
+	$$->value.sctp_event_subscribe->sctp_data_io_event =  new_integer_expression(ctx, $4, "%hhu");
 	if (!is_valid_u8($8)) {
-		semantic_error("sctp_association_event out of range");
+		semantic_error(ctx, "sctp_association_event out of range");
 	}
-	$$->value.sctp_event_subscribe->sctp_association_event =  new_integer_expression($8, "%hhu");
+	$$->value.sctp_event_subscribe->sctp_association_event =  new_integer_expression(ctx, $8, "%hhu");
 	if (!is_valid_u8($12)) {
-		semantic_error("sctp_address_event out of range");
+		semantic_error(ctx, "sctp_address_event out of range");
 	}
-	$$->value.sctp_event_subscribe->sctp_address_event =  new_integer_expression($12, "%hhu");
+	$$->value.sctp_event_subscribe->sctp_address_event =  new_integer_expression(ctx, $12, "%hhu");
 	if (!is_valid_u8($16)) {
-		semantic_error("sctp_send_failure_event out of range");
+		semantic_error(ctx, "sctp_send_failure_event out of range");
 	}
-	$$->value.sctp_event_subscribe->sctp_send_failure_event =  new_integer_expression($16, "%hhu");
+	$$->value.sctp_event_subscribe->sctp_send_failure_event =  new_integer_expression(ctx, $16, "%hhu");
 	if (!is_valid_u8($20)) {
-		semantic_error("sctp_peer_error_event out of range");
+		semantic_error(ctx, "sctp_peer_error_event out of range");
 	}
-	$$->value.sctp_event_subscribe->sctp_peer_error_event =  new_integer_expression($20, "%hhu");
+	$$->value.sctp_event_subscribe->sctp_peer_error_event =  new_integer_expression(ctx, $20, "%hhu");
 	if (!is_valid_u8($24)) {
-		semantic_error("sctp_shutdown_event out of range");
+		semantic_error(ctx, "sctp_shutdown_event out of range");
 	}
-	$$->value.sctp_event_subscribe->sctp_shutdown_event =  new_integer_expression($24, "%hhu");
+	$$->value.sctp_event_subscribe->sctp_shutdown_event =  new_integer_expression(ctx, $24, "%hhu");
 	if (!is_valid_u8($28)) {
-		semantic_error("sctp_partial_delivery_event out of range");
+		semantic_error(ctx, "sctp_partial_delivery_event out of range");
 	}
-	$$->value.sctp_event_subscribe->sctp_partial_delivery_event =  new_integer_expression($28, "%hhu");
+	$$->value.sctp_event_subscribe->sctp_partial_delivery_event =  new_integer_expression(ctx, $28, "%hhu");
 	if (!is_valid_u8($32)) {
-		semantic_error("sctp_adaptation_layer_event out of range");
+		semantic_error(ctx, "sctp_adaptation_layer_event out of range");
 	}
-	$$->value.sctp_event_subscribe->sctp_adaptation_layer_event =  new_integer_expression($32, "%hhu");
+	$$->value.sctp_event_subscribe->sctp_adaptation_layer_event =  new_integer_expression(ctx, $32, "%hhu");
 	if (!is_valid_u8($36)) {
-		semantic_error("sctp_authentication_event out of range");
+		semantic_error(ctx, "sctp_authentication_event out of range");
 	}
-	$$->value.sctp_event_subscribe->sctp_authentication_event =  new_integer_expression($36, "%hhu");
+	$$->value.sctp_event_subscribe->sctp_authentication_event =  new_integer_expression(ctx, $36, "%hhu");
 	if (!is_valid_u8($40)) {
-		semantic_error("sctp_sender_dry_event out of range");
+		semantic_error(ctx, "sctp_sender_dry_event out of range");
 	}
-	$$->value.sctp_event_subscribe->sctp_sender_dry_event =  new_integer_expression($40, "%hhu");
+	$$->value.sctp_event_subscribe->sctp_sender_dry_event =  new_integer_expression(ctx, $40, "%hhu");
 }
 ;
 
 snd_sid
 : SND_SID '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("snd_sid out of range");
+		semantic_error(ctx, "snd_sid out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SND_SID '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SND_SID '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 snd_flags
@@ -4083,27 +4053,27 @@ snd_flags
 snd_ppid
 : SND_PPID '=' _HTONL_ '(' INTEGER ')'{
 	if (!is_valid_u32($5)) {
-		semantic_error("snd_ppid out of range");
+		semantic_error(ctx, "snd_ppid out of range");
 	}
-	$$ = new_integer_expression(htonl((u32)$5), "%u");
+	$$ = new_integer_expression(ctx, htonl((u32)$5), "%u");
 }
-| SND_PPID '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SND_PPID '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 snd_context
 : SND_CONTEXT '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("snd_context out of range");
+		semantic_error(ctx, "snd_context out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SND_CONTEXT '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SND_CONTEXT '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_sndinfo
 : '{' snd_sid ',' snd_flags ',' snd_ppid ',' snd_context ',' SND_ASSOC_ID '=' sctp_assoc_id'}' {
-	$$ = new_expression(EXPR_SCTP_SNDINFO);
-	$$->value.sctp_sndinfo = calloc(1, sizeof(struct sctp_sndinfo_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_SNDINFO);
+	$$->value.sctp_sndinfo = parse_alloc(ctx, sizeof(struct sctp_sndinfo_expr));
 	$$->value.sctp_sndinfo->snd_sid = $2;
 	$$->value.sctp_sndinfo->snd_flags = $4;
 	$$->value.sctp_sndinfo->snd_ppid = $6;
@@ -4111,69 +4081,69 @@ sctp_sndinfo
 	$$->value.sctp_sndinfo->snd_assoc_id = $12;
 }
 | '{' snd_sid ',' snd_flags ',' snd_ppid ',' snd_context '}' {
-	$$ = new_expression(EXPR_SCTP_SNDINFO);
-	$$->value.sctp_sndinfo = calloc(1, sizeof(struct sctp_sndinfo_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_SNDINFO);
+	$$->value.sctp_sndinfo = parse_alloc(ctx, sizeof(struct sctp_sndinfo_expr));
 	$$->value.sctp_sndinfo->snd_sid = $2;
 	$$->value.sctp_sndinfo->snd_flags = $4;
 	$$->value.sctp_sndinfo->snd_ppid = $6;
 	$$->value.sctp_sndinfo->snd_context = $8;
-	$$->value.sctp_sndinfo->snd_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$->value.sctp_sndinfo->snd_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 }
 ;
 ssp_addr
 : SSP_ADDR '=' sockaddr { $$ = $3; }
-| SSP_ADDR '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SSP_ADDR '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_setprim
 : '{' SSP_ASSOC_ID '=' sctp_assoc_id ',' ssp_addr '}' {
-	$$ = new_expression(EXPR_SCTP_SETPRIM);
-	$$->value.sctp_setprim = calloc(1, sizeof(struct sctp_setprim_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_SETPRIM);
+	$$->value.sctp_setprim = parse_alloc(ctx, sizeof(struct sctp_setprim_expr));
 	$$->value.sctp_setprim->ssp_assoc_id = $4;
 	$$->value.sctp_setprim->ssp_addr = $6;
 }
 | '{' ssp_addr '}' {
-	$$ = new_expression(EXPR_SCTP_SETPRIM);
-	$$->value.sctp_setprim = calloc(1, sizeof(struct sctp_setprim_expr));
-	$$->value.sctp_setprim->ssp_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_SCTP_SETPRIM);
+	$$->value.sctp_setprim = parse_alloc(ctx, sizeof(struct sctp_setprim_expr));
+	$$->value.sctp_setprim->ssp_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 	$$->value.sctp_setprim->ssp_addr = $2;
 }
 ;
 
 sctp_setadaptation
 : '{' SSB_ADAPTATION_IND '=' INTEGER '}' {
-	$$ = new_expression(EXPR_SCTP_SETADAPTATION);
-	$$->value.sctp_setadaptation = calloc(1, sizeof(struct sctp_setadaptation_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_SETADAPTATION);
+	$$->value.sctp_setadaptation = parse_alloc(ctx, sizeof(struct sctp_setadaptation_expr));
 	if (!is_valid_u32($4)) {
-		semantic_error("ssb_adaptation_ind out of range");
+		semantic_error(ctx, "ssb_adaptation_ind out of range");
 	}
-	$$->value.sctp_setadaptation->ssb_adaptation_ind = new_integer_expression($4, "%u");
+	$$->value.sctp_setadaptation->ssb_adaptation_ind = new_integer_expression(ctx, $4, "%u");
 }
 | '{' SSB_ADAPTATION_IND '=' ELLIPSIS '}' {
-	$$ = new_expression(EXPR_SCTP_SETADAPTATION);
-	$$->value.sctp_setadaptation = calloc(1, sizeof(struct sctp_setadaptation_expr));
-	$$->value.sctp_setadaptation->ssb_adaptation_ind = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_SCTP_SETADAPTATION);
+	$$->value.sctp_setadaptation = parse_alloc(ctx, sizeof(struct sctp_setadaptation_expr));
+	$$->value.sctp_setadaptation->ssb_adaptation_ind = new_expression(ctx, EXPR_ELLIPSIS);
 }
 ;
 
 sinfo_stream
 : SINFO_STREAM '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sinfo_stream out of range");
+		semantic_error(ctx, "sinfo_stream out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SINFO_STREAM '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SINFO_STREAM '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sinfo_ssn
 : SINFO_SSN '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sinfo_ssn out of range");
+		semantic_error(ctx, "sinfo_ssn out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SINFO_SSN '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SINFO_SSN '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sinfo_flags
@@ -4183,58 +4153,58 @@ sinfo_flags
 sinfo_ppid
 : SINFO_PPID '=' _HTONL_ '(' INTEGER ')' {
 	if (!is_valid_u32($5)) {
-		semantic_error("sinfo_ppid out of range");
+		semantic_error(ctx, "sinfo_ppid out of range");
 	}
-	$$ = new_integer_expression(htonl((u32)$5), "%u");
+	$$ = new_integer_expression(ctx, htonl((u32)$5), "%u");
 }
-| SINFO_PPID '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SINFO_PPID '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sinfo_context
 : SINFO_CONTEXT '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("sinfo_context out of range");
+		semantic_error(ctx, "sinfo_context out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SINFO_CONTEXT '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SINFO_CONTEXT '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sinfo_timetolive
 : SINFO_TIMETOLIVE '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("sinfo_timetolive out of range");
+		semantic_error(ctx, "sinfo_timetolive out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SINFO_TIMETOLIVE '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SINFO_TIMETOLIVE '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sinfo_tsn
 : SINFO_TSN '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("sinfo_tsn out of range");
+		semantic_error(ctx, "sinfo_tsn out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SINFO_TSN '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SINFO_TSN '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sinfo_cumtsn
 : SINFO_CUMTSN '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("sinfo_cumtsn out of range");
+		semantic_error(ctx, "sinfo_cumtsn out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SINFO_CUMTSN '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SINFO_CUMTSN '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_sndrcvinfo
 : '{' sinfo_stream ',' sinfo_ssn ',' sinfo_flags ',' sinfo_ppid ',' sinfo_context ',' sinfo_timetolive ','
       sinfo_tsn ',' sinfo_cumtsn ',' SINFO_ASSOC_ID '=' sctp_assoc_id '}' {
-	$$ = new_expression(EXPR_SCTP_SNDRCVINFO);
-	$$->value.sctp_sndrcvinfo = calloc(1, sizeof(struct sctp_sndrcvinfo_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_SNDRCVINFO);
+	$$->value.sctp_sndrcvinfo = parse_alloc(ctx, sizeof(struct sctp_sndrcvinfo_expr));
 	$$->value.sctp_sndrcvinfo->sinfo_stream = $2;
 	$$->value.sctp_sndrcvinfo->sinfo_ssn = $4;
 	$$->value.sctp_sndrcvinfo->sinfo_flags = $6;
@@ -4247,8 +4217,8 @@ sctp_sndrcvinfo
 }
 | '{' sinfo_stream ',' sinfo_ssn ',' sinfo_flags ',' sinfo_ppid ',' sinfo_context ',' sinfo_timetolive ','
       sinfo_tsn ',' sinfo_cumtsn '}' {
-	$$ = new_expression(EXPR_SCTP_SNDRCVINFO);
-	$$->value.sctp_sndrcvinfo = calloc(1, sizeof(struct sctp_sndrcvinfo_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_SNDRCVINFO);
+	$$->value.sctp_sndrcvinfo = parse_alloc(ctx, sizeof(struct sctp_sndrcvinfo_expr));
 	$$->value.sctp_sndrcvinfo->sinfo_stream = $2;
 	$$->value.sctp_sndrcvinfo->sinfo_ssn = $4;
 	$$->value.sctp_sndrcvinfo->sinfo_flags = $6;
@@ -4257,27 +4227,27 @@ sctp_sndrcvinfo
 	$$->value.sctp_sndrcvinfo->sinfo_timetolive = $12;
 	$$->value.sctp_sndrcvinfo->sinfo_tsn = $14;
 	$$->value.sctp_sndrcvinfo->sinfo_cumtsn = $16;
-	$$->value.sctp_sndrcvinfo->sinfo_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$->value.sctp_sndrcvinfo->sinfo_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 };
 
 sinfo_pr_value
 : SINFO_PR_VALUE '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("sinfo_pr_value out of range");
+		semantic_error(ctx, "sinfo_pr_value out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SINFO_PR_VALUE '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SINFO_PR_VALUE '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 serinfo_next_stream
 : SERINFO_NEXT_STREAM '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("serinfo_next_stream out of range");
+		semantic_error(ctx, "serinfo_next_stream out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SERINFO_NEXT_STREAM '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SERINFO_NEXT_STREAM '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 serinfo_next_flags
@@ -4286,37 +4256,37 @@ serinfo_next_flags
 serinfo_next_aid
 : SERINFO_NEXT_AID '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("serinfo_next_aid out of range");
+		semantic_error(ctx, "serinfo_next_aid out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SERINFO_NEXT_AID '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SERINFO_NEXT_AID '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 serinfo_next_length
 : SERINFO_NEXT_LENGTH '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("serinfo_next_length out of range");
+		semantic_error(ctx, "serinfo_next_length out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SERINFO_NEXT_LENGTH '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SERINFO_NEXT_LENGTH '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 serinfo_next_ppid
 : SERINFO_NEXT_PPID '=' _HTONL_ '(' INTEGER ')' {
 	if (!is_valid_u32($5)) {
-		semantic_error("serinfo_next_ppid out of range");
+		semantic_error(ctx, "serinfo_next_ppid out of range");
 	}
-	$$ = new_integer_expression(htonl((u32)$5), "%u");
+	$$ = new_integer_expression(ctx, htonl((u32)$5), "%u");
 }
-| SERINFO_NEXT_PPID '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SERINFO_NEXT_PPID '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_extrcvinfo
 : '{' sinfo_stream ',' sinfo_ssn ',' sinfo_flags ',' sinfo_ppid ',' sinfo_context ',' sinfo_pr_value ',' sinfo_tsn ',' sinfo_cumtsn ','
 serinfo_next_flags ',' serinfo_next_stream ',' serinfo_next_aid ',' serinfo_next_length ',' serinfo_next_ppid ',' SINFO_ASSOC_ID '=' sctp_assoc_id '}' {
-	$$ = new_expression(EXPR_SCTP_EXTRCVINFO);
-	$$->value.sctp_extrcvinfo = calloc(1, sizeof(struct sctp_extrcvinfo_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_EXTRCVINFO);
+	$$->value.sctp_extrcvinfo = parse_alloc(ctx, sizeof(struct sctp_extrcvinfo_expr));
 	$$->value.sctp_extrcvinfo->sinfo_stream = $2;
 	$$->value.sctp_extrcvinfo->sinfo_ssn = $4;
 	$$->value.sctp_extrcvinfo->sinfo_flags = $6;
@@ -4334,8 +4304,8 @@ serinfo_next_flags ',' serinfo_next_stream ',' serinfo_next_aid ',' serinfo_next
 }
 | '{' sinfo_stream ',' sinfo_ssn ',' sinfo_flags ',' sinfo_ppid ',' sinfo_context ',' sinfo_pr_value ',' sinfo_tsn ',' sinfo_cumtsn ','
 serinfo_next_flags ',' serinfo_next_stream ',' serinfo_next_aid ',' serinfo_next_length ',' serinfo_next_ppid '}' {
-	$$ = new_expression(EXPR_SCTP_EXTRCVINFO);
-	$$->value.sctp_extrcvinfo = calloc(1, sizeof(struct sctp_extrcvinfo_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_EXTRCVINFO);
+	$$->value.sctp_extrcvinfo = parse_alloc(ctx, sizeof(struct sctp_extrcvinfo_expr));
 	$$->value.sctp_extrcvinfo->sinfo_stream = $2;
 	$$->value.sctp_extrcvinfo->sinfo_ssn = $4;
 	$$->value.sctp_extrcvinfo->sinfo_flags = $6;
@@ -4349,27 +4319,27 @@ serinfo_next_flags ',' serinfo_next_stream ',' serinfo_next_aid ',' serinfo_next
 	$$->value.sctp_extrcvinfo->serinfo_next_aid = $22;
 	$$->value.sctp_extrcvinfo->serinfo_next_length = $24;
 	$$->value.sctp_extrcvinfo->serinfo_next_ppid = $26;
-	$$->value.sctp_extrcvinfo->sinfo_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$->value.sctp_extrcvinfo->sinfo_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 };
 
 rcv_sid
 : RCV_SID '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("rcv_sid out of range");
+		semantic_error(ctx, "rcv_sid out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| RCV_SID '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| RCV_SID '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 rcv_ssn
 : RCV_SSN '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("rcv_ssn out of range");
+		semantic_error(ctx, "rcv_ssn out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| RCV_SSN '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| RCV_SSN '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 rcv_flags
@@ -4379,47 +4349,47 @@ rcv_flags
 rcv_ppid
 : RCV_PPID '=' _HTONL_ '(' INTEGER ')' {
 	if (!is_valid_u32($5)) {
-		semantic_error("rcv_ppid out of range");
+		semantic_error(ctx, "rcv_ppid out of range");
 	}
-	$$ = new_integer_expression(htonl($5), "%u");
+	$$ = new_integer_expression(ctx, htonl($5), "%u");
 }
-| RCV_PPID '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| RCV_PPID '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 rcv_tsn
 : RCV_TSN '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("rcv_tsn out of range");
+		semantic_error(ctx, "rcv_tsn out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| RCV_TSN '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| RCV_TSN '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 rcv_cumtsn
 : RCV_CUMTSN '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("rcv_cumtsn out of range");
+		semantic_error(ctx, "rcv_cumtsn out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| RCV_CUMTSN '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| RCV_CUMTSN '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 rcv_context
 : RCV_CONTEXT '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("rcv_context out of range");
+		semantic_error(ctx, "rcv_context out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| RCV_CONTEXT '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| RCV_CONTEXT '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_rcvinfo
 : '{' rcv_sid ',' rcv_ssn ',' rcv_flags ',' rcv_ppid ',' rcv_tsn ',' rcv_cumtsn ',' rcv_context ',' RCV_ASSOC_ID '=' sctp_assoc_id'}' {
-	$$ = new_expression(EXPR_SCTP_RCVINFO);
-	$$->value.sctp_rcvinfo = calloc(1, sizeof(struct sctp_rcvinfo_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_RCVINFO);
+	$$->value.sctp_rcvinfo = parse_alloc(ctx, sizeof(struct sctp_rcvinfo_expr));
 	$$->value.sctp_rcvinfo->rcv_sid = $2;
 	$$->value.sctp_rcvinfo->rcv_ssn = $4;
 	$$->value.sctp_rcvinfo->rcv_flags = $6;
@@ -4430,8 +4400,8 @@ sctp_rcvinfo
 	$$->value.sctp_rcvinfo->rcv_assoc_id = $18;
 }
 | '{' rcv_sid ',' rcv_ssn ',' rcv_flags ',' rcv_ppid ',' rcv_tsn ',' rcv_cumtsn ',' rcv_context '}' {
-	$$ = new_expression(EXPR_SCTP_RCVINFO);
-	$$->value.sctp_rcvinfo = calloc(1, sizeof(struct sctp_rcvinfo_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_RCVINFO);
+	$$->value.sctp_rcvinfo = parse_alloc(ctx, sizeof(struct sctp_rcvinfo_expr));
 	$$->value.sctp_rcvinfo->rcv_sid = $2;
 	$$->value.sctp_rcvinfo->rcv_ssn = $4;
 	$$->value.sctp_rcvinfo->rcv_flags = $6;
@@ -4439,62 +4409,61 @@ sctp_rcvinfo
 	$$->value.sctp_rcvinfo->rcv_tsn = $10;
 	$$->value.sctp_rcvinfo->rcv_cumtsn = $12;
 	$$->value.sctp_rcvinfo->rcv_context = $14;
-	$$->value.sctp_rcvinfo->rcv_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$->value.sctp_rcvinfo->rcv_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 }
 ;
 
 pr_policy
 : PR_POLICY '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
 | PR_POLICY '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("pr_policy out of range");
+		semantic_error(ctx, "pr_policy out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 };
 
 sctp_default_prinfo
 : '{' pr_policy ',' PR_VALUE '=' INTEGER ',' PR_ASSOC_ID '=' sctp_assoc_id '}' {
-	$$ = new_expression(EXPR_SCTP_DEFAULT_PRINFO);
-	$$->value.sctp_default_prinfo = calloc(1, sizeof(struct sctp_default_prinfo_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_DEFAULT_PRINFO);
+	$$->value.sctp_default_prinfo = parse_alloc(ctx, sizeof(struct sctp_default_prinfo_expr));
 	$$->value.sctp_default_prinfo->pr_policy = $2;
 	if (!is_valid_u32($6)) {
-		semantic_error("pr_value out of range");
+		semantic_error(ctx, "pr_value out of range");
 	}
-	$$->value.sctp_default_prinfo->pr_value = new_integer_expression($6, "%u");
+	$$->value.sctp_default_prinfo->pr_value = new_integer_expression(ctx, $6, "%u");
 	$$->value.sctp_default_prinfo->pr_assoc_id = $10;
 }
 ;
 
 sctp_prinfo
 : '{' pr_policy ',' PR_VALUE '=' INTEGER '}' {
-	$$ = new_expression(EXPR_SCTP_PRINFO);
-	$$->value.sctp_prinfo = calloc(1, sizeof(struct sctp_prinfo_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_PRINFO);
+	$$->value.sctp_prinfo = parse_alloc(ctx, sizeof(struct sctp_prinfo_expr));
 	$$->value.sctp_prinfo->pr_policy = $2;
 	if (!is_valid_u32($6)) {
-		semantic_error("pr_value out of range");
+		semantic_error(ctx, "pr_value out of range");
 	}
-	$$->value.sctp_prinfo->pr_value = new_integer_expression($6, "%u");
+	$$->value.sctp_prinfo->pr_value = new_integer_expression(ctx, $6, "%u");
 }
 ;
 
 sctp_authinfo
 : '{' AUTH_KEYNUMBER '=' INTEGER '}' {
-	$$ = new_expression(EXPR_SCTP_AUTHINFO);
-	$$->value.sctp_authinfo = calloc(1, sizeof(struct sctp_authinfo_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_AUTHINFO);
+	$$->value.sctp_authinfo = parse_alloc(ctx, sizeof(struct sctp_authinfo_expr));
 	if (!is_valid_u16($4)) {
-		semantic_error("auth_keynumber out of range");
+		semantic_error(ctx, "auth_keynumber out of range");
 	}
-	$$->value.sctp_authinfo->auth_keynumber = new_integer_expression($4, "%hu");
+	$$->value.sctp_authinfo->auth_keynumber = new_integer_expression(ctx, $4, "%hu");
 }
 ;
 
 sctp_sendv_spa
 : '{' SENDV_FLAGS '=' expression ',' SENDV_SNDINFO '=' expression ',' SENDV_PRINFO '=' expression ',' SENDV_AUTHINFO '=' expression '}' {
-	$$ = new_expression(EXPR_SCTP_SENDV_SPA);
-	$$->value.sctp_sendv_spa = calloc(1, sizeof(struct sctp_sendv_spa_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_SENDV_SPA);
+	$$->value.sctp_sendv_spa = parse_alloc(ctx, sizeof(struct sctp_sendv_spa_expr));
 	$$->value.sctp_sendv_spa->sendv_flags = $4;
 	$$->value.sctp_sendv_spa->sendv_sndinfo = $8;
 	$$->value.sctp_sendv_spa->sendv_prinfo = $12;
@@ -4505,11 +4474,11 @@ sctp_sendv_spa
 nxt_sid
 : NXT_SID '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("nxt_sid out of range");
+		semantic_error(ctx, "nxt_sid out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| NXT_SID '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| NXT_SID '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 nxt_flags
@@ -4519,27 +4488,27 @@ nxt_flags
 nxt_ppid
 : NXT_PPID '=' _HTONL_ '(' INTEGER ')' {
 	if (!is_valid_u32($5)) {
-		semantic_error("nxt_ppid out of range");
+		semantic_error(ctx, "nxt_ppid out of range");
 	}
-	$$ = new_integer_expression(htonl((u32)$5), "%u");
+	$$ = new_integer_expression(ctx, htonl((u32)$5), "%u");
 }
-| NXT_PPID '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| NXT_PPID '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 nxt_length
 : NXT_LENGTH '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("nxt_length out of range");
+		semantic_error(ctx, "nxt_length out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| NXT_LENGTH '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| NXT_LENGTH '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_nxtinfo
 : '{' nxt_sid ',' nxt_flags ',' nxt_ppid ',' nxt_length ',' NXT_ASSOC_ID '=' sctp_assoc_id '}' {
-	$$ = new_expression(EXPR_SCTP_NXTINFO);
-	$$->value.sctp_nxtinfo = calloc(1, sizeof(struct sctp_nxtinfo_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_NXTINFO);
+	$$->value.sctp_nxtinfo = parse_alloc(ctx, sizeof(struct sctp_nxtinfo_expr));
 	$$->value.sctp_nxtinfo->nxt_sid = $2;
 	$$->value.sctp_nxtinfo->nxt_flags = $4;
 	$$->value.sctp_nxtinfo->nxt_ppid = $6;
@@ -4547,20 +4516,20 @@ sctp_nxtinfo
 	$$->value.sctp_nxtinfo->nxt_assoc_id = $12;
 }
 | '{' nxt_sid ',' nxt_flags ',' nxt_ppid ',' nxt_length '}' {
-	$$ = new_expression(EXPR_SCTP_NXTINFO);
-	$$->value.sctp_nxtinfo = calloc(1, sizeof(struct sctp_nxtinfo_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_NXTINFO);
+	$$->value.sctp_nxtinfo = parse_alloc(ctx, sizeof(struct sctp_nxtinfo_expr));
 	$$->value.sctp_nxtinfo->nxt_sid = $2;
 	$$->value.sctp_nxtinfo->nxt_flags = $4;
 	$$->value.sctp_nxtinfo->nxt_ppid = $6;
 	$$->value.sctp_nxtinfo->nxt_length = $8;
-	$$->value.sctp_nxtinfo->nxt_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$->value.sctp_nxtinfo->nxt_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 }
 ;
 
 sctp_recvv_rn
 : '{' RECVV_RCVINFO '=' expression ',' RECVV_NXTINFO '=' expression '}' {
-	$$ = new_expression(EXPR_SCTP_RECVV_RN);
-	$$->value.sctp_recvv_rn = calloc(1, sizeof(struct sctp_recvv_rn_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_RECVV_RN);
+	$$->value.sctp_recvv_rn = parse_alloc(ctx, sizeof(struct sctp_recvv_rn_expr));
 	$$->value.sctp_recvv_rn->recvv_rcvinfo = $4;
 	$$->value.sctp_recvv_rn->recvv_nxtinfo = $8;
 }
@@ -4569,126 +4538,123 @@ sctp_recvv_rn
 sse_type
 : SSE_TYPE '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sse_type out of range");
+		semantic_error(ctx, "sse_type out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
 | SSE_TYPE '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| SSE_TYPE '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SSE_TYPE '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sse_flags
 : SSE_FLAGS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sse_flags out of range");
+		semantic_error(ctx, "sse_flags out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SSE_FLAGS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SSE_FLAGS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sse_length
 : SSE_LENGTH '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("sse_length out of range");
+		semantic_error(ctx, "sse_length out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SSE_LENGTH '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SSE_LENGTH '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_shutdown_event
 : '{' sse_type ',' sse_flags ',' sse_length ',' SSE_ASSOC_ID '=' sctp_assoc_id '}' {
-	$$ = new_expression(EXPR_SCTP_SHUTDOWN_EVENT);
-	$$->value.sctp_shutdown_event = calloc(1, sizeof(struct sctp_shutdown_event_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_SHUTDOWN_EVENT);
+	$$->value.sctp_shutdown_event = parse_alloc(ctx, sizeof(struct sctp_shutdown_event_expr));
 	$$->value.sctp_shutdown_event->sse_type = $2;
 	$$->value.sctp_shutdown_event->sse_flags = $4;
 	$$->value.sctp_shutdown_event->sse_length = $6;
 	$$->value.sctp_shutdown_event->sse_assoc_id = $10;
 }
 | '{' sse_type ',' sse_flags ',' sse_length '}' {
-	$$ = new_expression(EXPR_SCTP_SHUTDOWN_EVENT);
-	$$->value.sctp_shutdown_event = calloc(1, sizeof(struct sctp_shutdown_event_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_SHUTDOWN_EVENT);
+	$$->value.sctp_shutdown_event = parse_alloc(ctx, sizeof(struct sctp_shutdown_event_expr));
 	$$->value.sctp_shutdown_event->sse_type = $2;
 	$$->value.sctp_shutdown_event->sse_flags = $4;
 	$$->value.sctp_shutdown_event->sse_length = $6;
-	$$->value.sctp_shutdown_event->sse_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$->value.sctp_shutdown_event->sse_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 };
 
 pdapi_type
 : PDAPI_TYPE '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("pdapi_type out of range");
+		semantic_error(ctx, "pdapi_type out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
 | PDAPI_TYPE '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| PDAPI_TYPE '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| PDAPI_TYPE '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 pdapi_flags
 : PDAPI_FLAGS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("pdapi_flags out of range");
+		semantic_error(ctx, "pdapi_flags out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| PDAPI_FLAGS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| PDAPI_FLAGS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 pdapi_length
 : PDAPI_LENGTH '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("pdapi_length out of range");
+		semantic_error(ctx, "pdapi_length out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| PDAPI_LENGTH '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| PDAPI_LENGTH '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 pdapi_indication
 : PDAPI_INDICATION '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("pdapi_indication out of range");
+		semantic_error(ctx, "pdapi_indication out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
 | PDAPI_INDICATION '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| PDAPI_INDICATION '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| PDAPI_INDICATION '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 pdapi_stream
 : PDAPI_STREAM '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("pdapi_stream out of range");
+		semantic_error(ctx, "pdapi_stream out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| PDAPI_STREAM '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| PDAPI_STREAM '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 pdapi_seq
 : PDAPI_SEQ '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("pdapi_seq out of range");
+		semantic_error(ctx, "pdapi_seq out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| PDAPI_SEQ '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| PDAPI_SEQ '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_pdapi_event
 : '{' pdapi_type',' pdapi_flags ',' pdapi_length ',' pdapi_indication ',' pdapi_stream ',' pdapi_seq ',' PDAPI_ASSOC_ID '=' sctp_assoc_id '}' {
-	$$ = new_expression(EXPR_SCTP_PDAPI_EVENT);
-	$$->value.sctp_pdapi_event = calloc(1, sizeof(struct sctp_pdapi_event_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_PDAPI_EVENT);
+	$$->value.sctp_pdapi_event = parse_alloc(ctx, sizeof(struct sctp_pdapi_event_expr));
 	$$->value.sctp_pdapi_event->pdapi_type = $2;
 	$$->value.sctp_pdapi_event->pdapi_flags = $4;
 	$$->value.sctp_pdapi_event->pdapi_length = $6;
@@ -4698,80 +4664,78 @@ sctp_pdapi_event
 	$$->value.sctp_pdapi_event->pdapi_assoc_id = $16;
 }
 | '{' pdapi_type',' pdapi_flags ',' pdapi_length ',' pdapi_indication ',' pdapi_stream ',' pdapi_seq '}' {
-	$$ = new_expression(EXPR_SCTP_PDAPI_EVENT);
-	$$->value.sctp_pdapi_event = calloc(1, sizeof(struct sctp_pdapi_event_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_PDAPI_EVENT);
+	$$->value.sctp_pdapi_event = parse_alloc(ctx, sizeof(struct sctp_pdapi_event_expr));
 	$$->value.sctp_pdapi_event->pdapi_type = $2;
 	$$->value.sctp_pdapi_event->pdapi_flags = $4;
 	$$->value.sctp_pdapi_event->pdapi_length = $6;
 	$$->value.sctp_pdapi_event->pdapi_indication = $8;
 	$$->value.sctp_pdapi_event->pdapi_stream = $10;
 	$$->value.sctp_pdapi_event->pdapi_seq = $12;
-	$$->value.sctp_pdapi_event->pdapi_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$->value.sctp_pdapi_event->pdapi_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 }
 ;
 
 auth_type
 : AUTH_TYPE '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("auth_type out of range");
+		semantic_error(ctx, "auth_type out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
 | AUTH_TYPE '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| AUTH_TYPE '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| AUTH_TYPE '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 auth_flags
 : AUTH_FLAGS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("auth_flags out of range");
+		semantic_error(ctx, "auth_flags out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| AUTH_FLAGS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| AUTH_FLAGS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 auth_length
 : AUTH_LENGTH '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("auth_length out of range");
+		semantic_error(ctx, "auth_length out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| AUTH_LENGTH '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| AUTH_LENGTH '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 auth_keynumber
 : AUTH_KEYNUMBER '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("auth_keynumber out of range");
+		semantic_error(ctx, "auth_keynumber out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| AUTH_KEYNUMBER '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| AUTH_KEYNUMBER '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 auth_indication
 : AUTH_INDICATION '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("auth_indication out of range");
+		semantic_error(ctx, "auth_indication out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
 | AUTH_INDICATION '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| AUTH_INDICATION '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| AUTH_INDICATION '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_authkey_event
 : '{' auth_type ',' auth_flags ',' auth_length ',' auth_keynumber ',' auth_indication ',' AUTH_ASSOC_ID '=' sctp_assoc_id '}' {
-	$$ = new_expression(EXPR_SCTP_AUTHKEY_EVENT);
-	$$->value.sctp_authkey_event = calloc(1, sizeof(struct sctp_authkey_event_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_AUTHKEY_EVENT);
+	$$->value.sctp_authkey_event = parse_alloc(ctx, sizeof(struct sctp_authkey_event_expr));
 	$$->value.sctp_authkey_event->auth_type = $2;
 	$$->value.sctp_authkey_event->auth_flags = $4;
 	$$->value.sctp_authkey_event->auth_length = $6;
@@ -4780,127 +4744,124 @@ sctp_authkey_event
 	$$->value.sctp_authkey_event->auth_assoc_id = $14;
 }
 | '{' auth_type ',' auth_flags ',' auth_length ',' auth_keynumber ',' auth_indication '}' {
-	$$ = new_expression(EXPR_SCTP_AUTHKEY_EVENT);
-	$$->value.sctp_authkey_event = calloc(1, sizeof(struct sctp_authkey_event_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_AUTHKEY_EVENT);
+	$$->value.sctp_authkey_event = parse_alloc(ctx, sizeof(struct sctp_authkey_event_expr));
 	$$->value.sctp_authkey_event->auth_type = $2;
 	$$->value.sctp_authkey_event->auth_flags = $4;
 	$$->value.sctp_authkey_event->auth_length = $6;
 	$$->value.sctp_authkey_event->auth_keynumber = $8;
 	$$->value.sctp_authkey_event->auth_indication = $10;
-	$$->value.sctp_authkey_event->auth_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$->value.sctp_authkey_event->auth_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 }
 ;
 
 sender_dry_type
 : SENDER_DRY_TYPE '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sender_dry_type out of range");
+		semantic_error(ctx, "sender_dry_type out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
 | SENDER_DRY_TYPE '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| SENDER_DRY_TYPE '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SENDER_DRY_TYPE '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sender_dry_flags
 : SENDER_DRY_FLAGS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sender_dry_flags out of range");
+		semantic_error(ctx, "sender_dry_flags out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SENDER_DRY_FLAGS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SENDER_DRY_FLAGS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sender_dry_length
 : SENDER_DRY_LENGTH '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("sender_dry_length out of range");
+		semantic_error(ctx, "sender_dry_length out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SENDER_DRY_LENGTH '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SENDER_DRY_LENGTH '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_sender_dry_event
 : '{'sender_dry_type ',' sender_dry_flags ',' sender_dry_length ',' SENDER_DRY_ASSOC_ID '=' sctp_assoc_id '}' {
-	$$ = new_expression(EXPR_SCTP_SENDER_DRY_EVENT);
-	$$->value.sctp_sender_dry_event = calloc(1, sizeof(struct sctp_sender_dry_event_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_SENDER_DRY_EVENT);
+	$$->value.sctp_sender_dry_event = parse_alloc(ctx, sizeof(struct sctp_sender_dry_event_expr));
 	$$->value.sctp_sender_dry_event->sender_dry_type = $2;
 	$$->value.sctp_sender_dry_event->sender_dry_flags = $4;
 	$$->value.sctp_sender_dry_event->sender_dry_length = $6;
 	$$->value.sctp_sender_dry_event->sender_dry_assoc_id = $10;
 }
 | '{'sender_dry_type ',' sender_dry_flags ',' sender_dry_length '}' {
-	$$ = new_expression(EXPR_SCTP_SENDER_DRY_EVENT);
-	$$->value.sctp_sender_dry_event = calloc(1, sizeof(struct sctp_sender_dry_event_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_SENDER_DRY_EVENT);
+	$$->value.sctp_sender_dry_event = parse_alloc(ctx, sizeof(struct sctp_sender_dry_event_expr));
 	$$->value.sctp_sender_dry_event->sender_dry_type = $2;
 	$$->value.sctp_sender_dry_event->sender_dry_flags = $4;
 	$$->value.sctp_sender_dry_event->sender_dry_length = $6;
-	$$->value.sctp_sender_dry_event->sender_dry_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$->value.sctp_sender_dry_event->sender_dry_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 }
 ;
 
 ssfe_type
 : SSFE_TYPE '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("ssfe_type out of range");
+		semantic_error(ctx, "ssfe_type out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
 | SSFE_TYPE '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| SSFE_TYPE '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SSFE_TYPE '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 ssfe_flags
 : SSFE_FLAGS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("ssfe_flags out of range");
+		semantic_error(ctx, "ssfe_flags out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
 | SSFE_FLAGS '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| SSFE_FLAGS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SSFE_FLAGS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 ssfe_length
 : SSFE_LENGTH '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("ssfe_length out of range");
+		semantic_error(ctx, "ssfe_length out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SSFE_LENGTH '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SSFE_LENGTH '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 ssfe_error
 : SSFE_ERROR '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("ssfe_error out of range");
+		semantic_error(ctx, "ssfe_error out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SSFE_ERROR '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SSFE_ERROR '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 ssfe_data
-: SSFE_DATA '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+: SSFE_DATA '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 | SSFE_DATA '=' array    { $$ = $3; }
 ;
 
 sctp_send_failed_event
 : '{' ssfe_type ',' ssfe_flags ',' ssfe_length ',' ssfe_error ',' SSFE_INFO '=' sctp_sndinfo ',' SSFE_ASSOC_ID '=' sctp_assoc_id ',' ssfe_data '}' {
-	$$ = new_expression(EXPR_SCTP_SEND_FAILED_EVENT);
-	$$->value.sctp_send_failed_event = calloc(1, sizeof(struct sctp_send_failed_event_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_SEND_FAILED_EVENT);
+	$$->value.sctp_send_failed_event = parse_alloc(ctx, sizeof(struct sctp_send_failed_event_expr));
 	$$->value.sctp_send_failed_event->ssfe_type = $2;
 	$$->value.sctp_send_failed_event->ssfe_flags = $4;
 	$$->value.sctp_send_failed_event->ssfe_length = $6;
@@ -4910,105 +4871,103 @@ sctp_send_failed_event
 	$$->value.sctp_send_failed_event->ssfe_data = $18;
 }
 | '{' ssfe_type ',' ssfe_flags ',' ssfe_length ',' ssfe_error ',' SSFE_INFO '=' sctp_sndinfo ',' ssfe_data '}' {
-	$$ = new_expression(EXPR_SCTP_SEND_FAILED_EVENT);
-	$$->value.sctp_send_failed_event = calloc(1, sizeof(struct sctp_send_failed_event_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_SEND_FAILED_EVENT);
+	$$->value.sctp_send_failed_event = parse_alloc(ctx, sizeof(struct sctp_send_failed_event_expr));
 	$$->value.sctp_send_failed_event->ssfe_type = $2;
 	$$->value.sctp_send_failed_event->ssfe_flags = $4;
 	$$->value.sctp_send_failed_event->ssfe_length = $6;
 	$$->value.sctp_send_failed_event->ssfe_error = $8;
 	$$->value.sctp_send_failed_event->ssfe_info = $12;
-	$$->value.sctp_send_failed_event->ssfe_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$->value.sctp_send_failed_event->ssfe_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 	$$->value.sctp_send_failed_event->ssfe_data = $14;
 };
 
 sac_type
 : SAC_TYPE '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sac_type out of range");
+		semantic_error(ctx, "sac_type out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
 | SAC_TYPE '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| SAC_TYPE '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SAC_TYPE '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sac_flags
 : SAC_FLAGS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sac_flags out of range");
+		semantic_error(ctx, "sac_flags out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SAC_FLAGS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SAC_FLAGS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sac_length
 : SAC_LENGTH '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sac_length out of range");
+		semantic_error(ctx, "sac_length out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SAC_LENGTH '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SAC_LENGTH '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sac_state
 : SAC_STATE '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sac_state out of range");
+		semantic_error(ctx, "sac_state out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
 | SAC_STATE '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| SAC_STATE '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SAC_STATE '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sac_error
 : SAC_ERROR '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sac_error out of range");
+		semantic_error(ctx, "sac_error out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SAC_ERROR '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SAC_ERROR '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sac_outbound_streams
 : SAC_OUTBOUND_STREAMS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sac_outbound_streams out of range");
+		semantic_error(ctx, "sac_outbound_streams out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SAC_OUTBOUND_STREAMS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SAC_OUTBOUND_STREAMS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sac_inbound_streams
 : SAC_INBOUND_STREAMS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sac_inbound_streams out of range");
+		semantic_error(ctx, "sac_inbound_streams out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SAC_INBOUND_STREAMS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SAC_INBOUND_STREAMS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sac_info
-: SAC_INFO '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+: SAC_INFO '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 | SAC_INFO '=' array { $$ = $3; }
 ;
 
 sctp_assoc_change
 : '{' sac_type ',' sac_flags ',' sac_length ',' sac_state ',' sac_error ',' sac_outbound_streams ','
 sac_inbound_streams ',' SAC_ASSOC_ID '=' sctp_assoc_id ',' sac_info '}' {
-	$$ = new_expression(EXPR_SCTP_ASSOC_CHANGE);
-	$$->value.sctp_assoc_change = calloc(1, sizeof(struct sctp_assoc_change_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_ASSOC_CHANGE);
+	$$->value.sctp_assoc_change = parse_alloc(ctx, sizeof(struct sctp_assoc_change_expr));
 	$$->value.sctp_assoc_change->sac_type = $2;
 	$$->value.sctp_assoc_change->sac_flags = $4;
 	$$->value.sctp_assoc_change->sac_length = $6;
@@ -5021,8 +4980,8 @@ sac_inbound_streams ',' SAC_ASSOC_ID '=' sctp_assoc_id ',' sac_info '}' {
 }
 | '{' sac_type ',' sac_flags ',' sac_length ',' sac_state ',' sac_error ',' sac_outbound_streams ','
 sac_inbound_streams ',' sac_info '}' {
-	$$ = new_expression(EXPR_SCTP_ASSOC_CHANGE);
-	$$->value.sctp_assoc_change = calloc(1, sizeof(struct sctp_assoc_change_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_ASSOC_CHANGE);
+	$$->value.sctp_assoc_change = parse_alloc(ctx, sizeof(struct sctp_assoc_change_expr));
 	$$->value.sctp_assoc_change->sac_type = $2;
 	$$->value.sctp_assoc_change->sac_flags = $4;
 	$$->value.sctp_assoc_change->sac_length = $6;
@@ -5030,7 +4989,7 @@ sac_inbound_streams ',' sac_info '}' {
 	$$->value.sctp_assoc_change->sac_error = $10;
 	$$->value.sctp_assoc_change->sac_outbound_streams = $12;
 	$$->value.sctp_assoc_change->sac_inbound_streams = $14;
-	$$->value.sctp_assoc_change->sac_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$->value.sctp_assoc_change->sac_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 	$$->value.sctp_assoc_change->sac_info = $16;
 }
 ;
@@ -5038,56 +4997,55 @@ sac_inbound_streams ',' sac_info '}' {
 sre_type
 : SRE_TYPE '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sre_type out of range");
+		semantic_error(ctx, "sre_type out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
 | SRE_TYPE '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| SRE_TYPE '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SRE_TYPE '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sre_flags
 : SRE_FLAGS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sre_flags out of range");
+		semantic_error(ctx, "sre_flags out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SRE_FLAGS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SRE_FLAGS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sre_length
 : SRE_LENGTH '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("sre_length out of range");
+		semantic_error(ctx, "sre_length out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SRE_LENGTH '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SRE_LENGTH '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sre_error
 : SRE_ERROR '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sre_error out of range");
+		semantic_error(ctx, "sre_error out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SRE_ERROR '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SRE_ERROR '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sre_data
-: SRE_DATA '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+: SRE_DATA '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 | SRE_DATA '=' array { $$ = $3; }
 ;
 
 sctp_remote_error
 : '{' sre_type ',' sre_flags ',' sre_length ',' sre_error ',' SRE_ASSOC_ID '=' sctp_assoc_id ',' sre_data '}' {
-	$$ = new_expression(EXPR_SCTP_REMOTE_ERROR);
-	$$->value.sctp_remote_error = calloc(1, sizeof(struct sctp_remote_error_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_REMOTE_ERROR);
+	$$->value.sctp_remote_error = parse_alloc(ctx, sizeof(struct sctp_remote_error_expr));
 	$$->value.sctp_remote_error->sre_type = $2;
 	$$->value.sctp_remote_error->sre_flags = $4;
 	$$->value.sctp_remote_error->sre_length = $6;
@@ -5096,13 +5054,13 @@ sctp_remote_error
 	$$->value.sctp_remote_error->sre_data = $14;
 }
 | '{' sre_type ',' sre_flags ',' sre_length ',' sre_error ',' sre_data '}' {
-	$$ = new_expression(EXPR_SCTP_REMOTE_ERROR);
-	$$->value.sctp_remote_error = calloc(1, sizeof(struct sctp_remote_error_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_REMOTE_ERROR);
+	$$->value.sctp_remote_error = parse_alloc(ctx, sizeof(struct sctp_remote_error_expr));
 	$$->value.sctp_remote_error->sre_type = $2;
 	$$->value.sctp_remote_error->sre_flags = $4;
 	$$->value.sctp_remote_error->sre_length = $6;
 	$$->value.sctp_remote_error->sre_error = $8;
-	$$->value.sctp_remote_error->sre_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$->value.sctp_remote_error->sre_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 	$$->value.sctp_remote_error->sre_data = $10;
 }
 ;
@@ -5110,74 +5068,71 @@ sctp_remote_error
 spc_type
 : SPC_TYPE '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("spc_type out of range");
+		semantic_error(ctx, "spc_type out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
 | SPC_TYPE '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| SPC_TYPE '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SPC_TYPE '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 spc_flags
 : SPC_FLAGS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("spc_flags out of range");
+		semantic_error(ctx, "spc_flags out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SPC_FLAGS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SPC_FLAGS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 spc_length
 : SPC_LENGTH '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("spc_length out of range");
+		semantic_error(ctx, "spc_length out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SPC_LENGTH '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SPC_LENGTH '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 spc_aaddr
-: SPC_AADDR '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+: SPC_AADDR '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 | SPC_AADDR '=' sockaddr { $$ = $3; }
 ;
 
 spc_state
 : SPC_STATE '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("spc_state out of range");
+		semantic_error(ctx, "spc_state out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
 | SPC_STATE '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| SPC_STATE '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SPC_STATE '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 spc_error
 : SPC_ERROR '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("spc_error out of range");
+		semantic_error(ctx, "spc_error out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
 | SPC_ERROR '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| SPC_ERROR '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SPC_ERROR '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_paddr_change
 : '{' spc_type ',' spc_flags ',' spc_length ',' spc_aaddr ',' spc_state ',' spc_error ',' SPC_ASSOC_ID '=' sctp_assoc_id '}' {
-	$$ = new_expression(EXPR_SCTP_PADDR_CHANGE);
-	$$->value.sctp_paddr_change = calloc(1, sizeof(struct sctp_paddr_change_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_PADDR_CHANGE);
+	$$->value.sctp_paddr_change = parse_alloc(ctx, sizeof(struct sctp_paddr_change_expr));
 	$$->value.sctp_paddr_change->spc_type = $2;
 	$$->value.sctp_paddr_change->spc_flags = $4;
 	$$->value.sctp_paddr_change->spc_length = $6;
@@ -5187,83 +5142,80 @@ sctp_paddr_change
 	$$->value.sctp_paddr_change->spc_assoc_id = $16;
 }
 | '{' spc_type ',' spc_flags ',' spc_length ',' spc_aaddr ',' spc_state ',' spc_error '}' {
-	$$ = new_expression(EXPR_SCTP_PADDR_CHANGE);
-	$$->value.sctp_paddr_change = calloc(1, sizeof(struct sctp_paddr_change_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_PADDR_CHANGE);
+	$$->value.sctp_paddr_change = parse_alloc(ctx, sizeof(struct sctp_paddr_change_expr));
 	$$->value.sctp_paddr_change->spc_type = $2;
 	$$->value.sctp_paddr_change->spc_flags = $4;
 	$$->value.sctp_paddr_change->spc_length = $6;
 	$$->value.sctp_paddr_change->spc_aaddr = $8;
 	$$->value.sctp_paddr_change->spc_state = $10;
 	$$->value.sctp_paddr_change->spc_error = $12;
-	$$->value.sctp_paddr_change->spc_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$->value.sctp_paddr_change->spc_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 }
 ;
 ssf_type
 : SSF_TYPE '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("ssf_type out of range");
+		semantic_error(ctx, "ssf_type out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
 | SSF_TYPE '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| SSF_TYPE '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SSF_TYPE '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 ssf_length
 : SSF_LENGTH '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("ssf_length out of range");
+		semantic_error(ctx, "ssf_length out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SSF_LENGTH '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SSF_LENGTH '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 ssf_flags
 : SSF_FLAGS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("ssf_flags out of range");
+		semantic_error(ctx, "ssf_flags out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
 | SSF_FLAGS '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| SSF_FLAGS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SSF_FLAGS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 ssf_error
 : SSF_ERROR '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("ssf_error out of range");
+		semantic_error(ctx, "ssf_error out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
 | SSF_ERROR '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| SSF_ERROR '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SSF_ERROR '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 ssf_info
 : SSF_INFO '=' sctp_sndrcvinfo { $$ = $3; }
-| SSF_INFO '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SSF_INFO '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 ssf_data
-: SSF_DATA '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+: SSF_DATA '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 | SSF_DATA '=' array { $$ = $3; }
 ;
 
 sctp_send_failed
 : '{' ssf_type ',' ssf_flags ',' ssf_length ',' ssf_error ',' ssf_info ',' SSF_ASSOC_ID '=' sctp_assoc_id ',' ssf_data '}' {
-	$$ = new_expression(EXPR_SCTP_SEND_FAILED);
-	$$->value.sctp_send_failed = calloc(1, sizeof(struct sctp_send_failed_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_SEND_FAILED);
+	$$->value.sctp_send_failed = parse_alloc(ctx, sizeof(struct sctp_send_failed_expr));
 	$$->value.sctp_send_failed->ssf_type = $2;
 	$$->value.sctp_send_failed->ssf_flags = $4;
 	$$->value.sctp_send_failed->ssf_length = $6;
@@ -5273,14 +5225,14 @@ sctp_send_failed
 	$$->value.sctp_send_failed->ssf_data = $16;
 }
 | '{' ssf_type ',' ssf_flags ',' ssf_length ',' ssf_error ',' ssf_info ',' ssf_data '}' {
-	$$ = new_expression(EXPR_SCTP_SEND_FAILED);
-	$$->value.sctp_send_failed = calloc(1, sizeof(struct sctp_send_failed_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_SEND_FAILED);
+	$$->value.sctp_send_failed = parse_alloc(ctx, sizeof(struct sctp_send_failed_expr));
 	$$->value.sctp_send_failed->ssf_type = $2;
 	$$->value.sctp_send_failed->ssf_flags = $4;
 	$$->value.sctp_send_failed->ssf_length = $6;
 	$$->value.sctp_send_failed->ssf_error = $8;
 	$$->value.sctp_send_failed->ssf_info = $10;
-	$$->value.sctp_send_failed->ssf_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$->value.sctp_send_failed->ssf_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 	$$->value.sctp_send_failed->ssf_data = $12;
 }
 ;
@@ -5288,51 +5240,50 @@ sctp_send_failed
 sai_type
 : SAI_TYPE '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sai_type out of range");
+		semantic_error(ctx, "sai_type out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
 | SAI_TYPE '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| SAI_TYPE '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SAI_TYPE '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sai_flags
 : SAI_FLAGS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sai_flags out of range");
+		semantic_error(ctx, "sai_flags out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SAI_FLAGS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SAI_FLAGS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sai_length
 : SAI_LENGTH '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("sai_length out of range");
+		semantic_error(ctx, "sai_length out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SAI_LENGTH '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SAI_LENGTH '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sai_adaptation_ind
 : SAI_ADAPTATION_IND '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("sai_adaptation_ind out of range");
+		semantic_error(ctx, "sai_adaptation_ind out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SAI_ADAPTATION_IND '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SAI_ADAPTATION_IND '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_adaptation_event
 : '{' sai_type ',' sai_flags ',' sai_length ',' sai_adaptation_ind ',' SAI_ASSOC_ID '=' sctp_assoc_id '}' {
-	$$ = new_expression(EXPR_SCTP_ADAPTATION_EVENT);
-	$$->value.sctp_adaptation_event = calloc(1, sizeof(struct sctp_adaptation_event_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_ADAPTATION_EVENT);
+	$$->value.sctp_adaptation_event = parse_alloc(ctx, sizeof(struct sctp_adaptation_event_expr));
 	$$->value.sctp_adaptation_event->sai_type = $2;
 	$$->value.sctp_adaptation_event->sai_flags = $4;
 	$$->value.sctp_adaptation_event->sai_length = $6;
@@ -5340,54 +5291,53 @@ sctp_adaptation_event
 	$$->value.sctp_adaptation_event->sai_assoc_id = $12;
 }
 | '{' sai_type ',' sai_flags ',' sai_length ',' sai_adaptation_ind '}' {
-	$$ = new_expression(EXPR_SCTP_ADAPTATION_EVENT);
-	$$->value.sctp_adaptation_event = calloc(1, sizeof(struct sctp_adaptation_event_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_ADAPTATION_EVENT);
+	$$->value.sctp_adaptation_event = parse_alloc(ctx, sizeof(struct sctp_adaptation_event_expr));
 	$$->value.sctp_adaptation_event->sai_type = $2;
 	$$->value.sctp_adaptation_event->sai_flags = $4;
 	$$->value.sctp_adaptation_event->sai_length = $6;
 	$$->value.sctp_adaptation_event->sai_adaptation_ind = $8;
-	$$->value.sctp_adaptation_event->sai_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$->value.sctp_adaptation_event->sai_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 }
 ;
 
 sn_type
 : SN_TYPE '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sn_type out of range");
+		semantic_error(ctx, "sn_type out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
 | SN_TYPE '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| SN_TYPE '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SN_TYPE '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sn_flags
 : SN_FLAGS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("sn_flags out of range");
+		semantic_error(ctx, "sn_flags out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| SN_FLAGS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SN_FLAGS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sn_length
 : SN_LENGTH '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("sn_length out of range");
+		semantic_error(ctx, "sn_length out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| SN_LENGTH '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| SN_LENGTH '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_tlv
 : '{' sn_type ',' sn_flags ',' sn_length '}' {
-	$$ = new_expression(EXPR_SCTP_TLV);
-	$$->value.sctp_tlv = calloc(1, sizeof(struct sctp_tlv_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_TLV);
+	$$->value.sctp_tlv = parse_alloc(ctx, sizeof(struct sctp_tlv_expr));
 	$$->value.sctp_tlv->sn_type = $2;
 	$$->value.sctp_tlv->sn_flags = $4;
 	$$->value.sctp_tlv->sn_length = $6;
@@ -5397,17 +5347,17 @@ sctp_tlv
 gaids_number_of_ids
 : GAIDS_NUMBER_OF_IDS '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("gaids_number_of_ids out of range");
+		semantic_error(ctx, "gaids_number_of_ids out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| GAIDS_NUMBER_OF_IDS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| GAIDS_NUMBER_OF_IDS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_assoc_ids
 : '{' gaids_number_of_ids ',' GAIDS_ASSOC_ID '=' array '}' {
-	$$ = new_expression(EXPR_SCTP_ASSOC_IDS);
-	$$->value.sctp_assoc_ids = calloc(1, sizeof(struct sctp_assoc_ids_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_ASSOC_IDS);
+	$$->value.sctp_assoc_ids = parse_alloc(ctx, sizeof(struct sctp_assoc_ids_expr));
 	$$->value.sctp_assoc_ids->gaids_number_of_ids = $2;
 	$$->value.sctp_assoc_ids->gaids_assoc_id = $6;
 };
@@ -5415,93 +5365,92 @@ sctp_assoc_ids
 gauth_number_of_chunks
 : GAUTH_NUMBER_OF_CHUNKS '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("gauth_number_of_chunks out of range");
+		semantic_error(ctx, "gauth_number_of_chunks out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| GAUTH_NUMBER_OF_CHUNKS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| GAUTH_NUMBER_OF_CHUNKS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_authchunks
 : '{' GAUTH_ASSOC_ID '=' sctp_assoc_id ',' gauth_number_of_chunks ',' GAUTH_CHUNKS '=' array '}' {
-	$$ = new_expression(EXPR_SCTP_AUTHCHUNKS);
-	$$->value.sctp_authchunks = calloc(1, sizeof(struct sctp_authchunks_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_AUTHCHUNKS);
+	$$->value.sctp_authchunks = parse_alloc(ctx, sizeof(struct sctp_authchunks_expr));
 	$$->value.sctp_authchunks->gauth_assoc_id = $4;
 	$$->value.sctp_authchunks->gauth_number_of_chunks = $6;
 	$$->value.sctp_authchunks->gauth_chunks = $10;
 }
 | '{' gauth_number_of_chunks ',' GAUTH_CHUNKS '=' array '}' {
-	$$ = new_expression(EXPR_SCTP_AUTHCHUNKS);
-	$$->value.sctp_authchunks = calloc(1, sizeof(struct sctp_authchunks_expr));
-	$$->value.sctp_authchunks->gauth_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_SCTP_AUTHCHUNKS);
+	$$->value.sctp_authchunks = parse_alloc(ctx, sizeof(struct sctp_authchunks_expr));
+	$$->value.sctp_authchunks->gauth_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 	$$->value.sctp_authchunks->gauth_number_of_chunks = $2;
 	$$->value.sctp_authchunks->gauth_chunks = $6;
 };
 
 sctp_setpeerprim
 : '{' SSPP_ASSOC_ID '=' sctp_assoc_id ',' SSPP_ADDR '=' sockaddr '}' {
-	$$ = new_expression(EXPR_SCTP_SETPEERPRIM);
-	$$->value.sctp_setpeerprim = calloc(1, sizeof(struct sctp_setpeerprim_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_SETPEERPRIM);
+	$$->value.sctp_setpeerprim = parse_alloc(ctx, sizeof(struct sctp_setpeerprim_expr));
 	$$->value.sctp_setpeerprim->sspp_assoc_id = $4;
 	$$->value.sctp_setpeerprim->sspp_addr = $8;
 }
 | '{' SSPP_ADDR '=' sockaddr '}' {
-	$$ = new_expression(EXPR_SCTP_SETPEERPRIM);
-	$$->value.sctp_setpeerprim = calloc(1, sizeof(struct sctp_setpeerprim_expr));
-	$$->value.sctp_setpeerprim->sspp_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_SCTP_SETPEERPRIM);
+	$$->value.sctp_setpeerprim = parse_alloc(ctx, sizeof(struct sctp_setpeerprim_expr));
+	$$->value.sctp_setpeerprim->sspp_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 	$$->value.sctp_setpeerprim->sspp_addr = $4;
 };
 
 sctp_authchunk
 : '{' SAUTH_CHUNK '=' INTEGER '}' {
-	$$ = new_expression(EXPR_SCTP_AUTHCHUNK);
-	$$->value.sctp_authchunk = calloc(1, sizeof(struct sctp_authchunk_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_AUTHCHUNK);
+	$$->value.sctp_authchunk = parse_alloc(ctx, sizeof(struct sctp_authchunk_expr));
 	if (!is_valid_u8($4)) {
-		semantic_error("sauth_chunk out of range");
+		semantic_error(ctx, "sauth_chunk out of range");
 	}
-	$$->value.sctp_authchunk->sauth_chunk = new_integer_expression($4, "%hhu");
+	$$->value.sctp_authchunk->sauth_chunk = new_integer_expression(ctx, $4, "%hhu");
 };
 
 sctp_authkey
 : '{' SCA_ASSOC_ID '=' sctp_assoc_id ',' SCA_KEYNUMBER '=' INTEGER ',' SCA_KEYLENGTH '=' INTEGER ',' SCA_KEY '=' array '}' {
-	$$ = new_expression(EXPR_SCTP_AUTHKEY);
-	$$->value.sctp_authkey = calloc(1, sizeof(struct sctp_authkey_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_AUTHKEY);
+	$$->value.sctp_authkey = parse_alloc(ctx, sizeof(struct sctp_authkey_expr));
 	$$->value.sctp_authkey->sca_assoc_id = $4;
 	if (!is_valid_u16($8)) {
-		semantic_error("sca_keynumber out of range");
+		semantic_error(ctx, "sca_keynumber out of range");
 	}
-	$$->value.sctp_authkey->sca_keynumber = new_integer_expression($8, "%hu");
+	$$->value.sctp_authkey->sca_keynumber = new_integer_expression(ctx, $8, "%hu");
 	if (!is_valid_u16($12)) {
-		semantic_error("sca_keylength out of range");
+		semantic_error(ctx, "sca_keylength out of range");
 	}
-	$$->value.sctp_authkey->sca_keylength = new_integer_expression($12, "%hu");
+	$$->value.sctp_authkey->sca_keylength = new_integer_expression(ctx, $12, "%hu");
 	$$->value.sctp_authkey->sca_key = $16;
 }
 | '{' SCA_KEYNUMBER '=' INTEGER ',' SCA_KEYLENGTH '=' INTEGER ',' SCA_KEY '=' array '}' {
-	$$ = new_expression(EXPR_SCTP_AUTHKEY);
-	$$->value.sctp_authkey = calloc(1, sizeof(struct sctp_authkey_expr));
-	$$->value.sctp_authkey->sca_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_SCTP_AUTHKEY);
+	$$->value.sctp_authkey = parse_alloc(ctx, sizeof(struct sctp_authkey_expr));
+	$$->value.sctp_authkey->sca_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 	if (!is_valid_u16($4)) {
-		semantic_error("sca_keynumber out of range");
+		semantic_error(ctx, "sca_keynumber out of range");
 	}
-	$$->value.sctp_authkey->sca_keynumber = new_integer_expression($4, "%hu");
+	$$->value.sctp_authkey->sca_keynumber = new_integer_expression(ctx, $4, "%hu");
 	if (!is_valid_u16($8)) {
-		semantic_error("sca_keylength out of range");
+		semantic_error(ctx, "sca_keylength out of range");
 	}
-	$$->value.sctp_authkey->sca_keylength = new_integer_expression($8, "%hu");
+	$$->value.sctp_authkey->sca_keylength = new_integer_expression(ctx, $8, "%hu");
 	$$->value.sctp_authkey->sca_key = $12;
 };
 
 srs_flags
 : SRS_FLAGS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("srs_flags out of range");
+		semantic_error(ctx, "srs_flags out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
 | SRS_FLAGS '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
 | SRS_FLAGS '=' binary_expression {
 	$$ = $3;
@@ -5510,101 +5459,99 @@ srs_flags
 
 sctp_reset_streams
 : '{' SRS_ASSOC_ID '=' sctp_assoc_id ',' srs_flags ',' SRS_NUMBER_STREAMS '=' INTEGER ',' SRS_STREAM_LIST '=' array '}' {
-	$$ = new_expression(EXPR_SCTP_RESET_STREAMS);
-	$$->value.sctp_reset_streams = calloc(1, sizeof(struct sctp_reset_streams_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_RESET_STREAMS);
+	$$->value.sctp_reset_streams = parse_alloc(ctx, sizeof(struct sctp_reset_streams_expr));
 	$$->value.sctp_reset_streams->srs_assoc_id = $4;
 	$$->value.sctp_reset_streams->srs_flags = $6;
 	if (!is_valid_u16($10)) {
-		semantic_error("srs_number_streams out of range");
+		semantic_error(ctx, "srs_number_streams out of range");
 	}
-	$$->value.sctp_reset_streams->srs_number_streams = new_integer_expression($10, "%hu");
+	$$->value.sctp_reset_streams->srs_number_streams = new_integer_expression(ctx, $10, "%hu");
 	$$->value.sctp_reset_streams->srs_stream_list = $14;
 }
 | '{' srs_flags ',' SRS_NUMBER_STREAMS '=' INTEGER ',' SRS_STREAM_LIST '=' array '}' {
-	$$ = new_expression(EXPR_SCTP_RESET_STREAMS);
-	$$->value.sctp_reset_streams = calloc(1, sizeof(struct sctp_reset_streams_expr));
-	$$->value.sctp_reset_streams->srs_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_SCTP_RESET_STREAMS);
+	$$->value.sctp_reset_streams = parse_alloc(ctx, sizeof(struct sctp_reset_streams_expr));
+	$$->value.sctp_reset_streams->srs_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 	$$->value.sctp_reset_streams->srs_flags = $2;
 	if (!is_valid_u16($6)) {
-		semantic_error("srs_number_streams out of range");
+		semantic_error(ctx, "srs_number_streams out of range");
 	}
-	$$->value.sctp_reset_streams->srs_number_streams = new_integer_expression($6, "%hu");
+	$$->value.sctp_reset_streams->srs_number_streams = new_integer_expression(ctx, $6, "%hu");
 	$$->value.sctp_reset_streams->srs_stream_list = $10;
 }
 ;
 
 sctp_add_streams
 : '{' SAS_ASSOC_ID '=' sctp_assoc_id ',' SAS_INSTRMS '=' INTEGER ',' SAS_OUTSTRMS '=' INTEGER '}' {
-	$$ = new_expression(EXPR_SCTP_ADD_STREAMS);
-	$$->value.sctp_add_streams = calloc(1, sizeof(struct sctp_add_streams_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_ADD_STREAMS);
+	$$->value.sctp_add_streams = parse_alloc(ctx, sizeof(struct sctp_add_streams_expr));
 	$$->value.sctp_add_streams->sas_assoc_id = $4;
 	if (!is_valid_u16($8)) {
-		semantic_error("sas_instrms out of range");
+		semantic_error(ctx, "sas_instrms out of range");
 	}
-	$$->value.sctp_add_streams->sas_instrms = new_integer_expression($8, "%hu");
+	$$->value.sctp_add_streams->sas_instrms = new_integer_expression(ctx, $8, "%hu");
 	if (!is_valid_u16($12)) {
-		semantic_error("sas_outstrms out of range");
+		semantic_error(ctx, "sas_outstrms out of range");
 	}
-	$$->value.sctp_add_streams->sas_outstrms = new_integer_expression($12, "%hu");
+	$$->value.sctp_add_streams->sas_outstrms = new_integer_expression(ctx, $12, "%hu");
 }
 | '{' SAS_INSTRMS '=' INTEGER ',' SAS_OUTSTRMS '=' INTEGER '}' {
-	$$ = new_expression(EXPR_SCTP_ADD_STREAMS);
-	$$->value.sctp_add_streams = calloc(1, sizeof(struct sctp_add_streams_expr));
-	$$->value.sctp_add_streams->sas_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_SCTP_ADD_STREAMS);
+	$$->value.sctp_add_streams = parse_alloc(ctx, sizeof(struct sctp_add_streams_expr));
+	$$->value.sctp_add_streams->sas_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 	if (!is_valid_u16($4)) {
-		semantic_error("sas_instrms out of range");
+		semantic_error(ctx, "sas_instrms out of range");
 	}
-	$$->value.sctp_add_streams->sas_instrms = new_integer_expression($4, "%hu");
+	$$->value.sctp_add_streams->sas_instrms = new_integer_expression(ctx, $4, "%hu");
 	if (!is_valid_u16($8)) {
-		semantic_error("sas_outstrms out of range");
+		semantic_error(ctx, "sas_outstrms out of range");
 	}
-	$$->value.sctp_add_streams->sas_outstrms = new_integer_expression($8, "%hu");
+	$$->value.sctp_add_streams->sas_outstrms = new_integer_expression(ctx, $8, "%hu");
 }
 ;
 
 strreset_type
 : STRRESET_TYPE '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("strreset_type out of range");
+		semantic_error(ctx, "strreset_type out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
 | STRRESET_TYPE '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| STRRESET_TYPE '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| STRRESET_TYPE '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 strreset_flags
 : STRRESET_FLAGS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("strreset_flags out of range");
+		semantic_error(ctx, "strreset_flags out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
 | STRRESET_FLAGS '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| STRRESET_FLAGS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| STRRESET_FLAGS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 | STRRESET_FLAGS '=' binary_expression { $$ = $3; }
 ;
 
 strreset_length
 : STRRESET_LENGTH '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("strreset_length out of range");
+		semantic_error(ctx, "strreset_length out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| STRRESET_LENGTH '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| STRRESET_LENGTH '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_stream_reset_event
 : '{' strreset_type ',' strreset_flags ',' strreset_length ',' STRRESET_ASSOC_ID '=' sctp_assoc_id ',' STRRESET_STREAM_LIST '=' array '}' {
-	$$ = new_expression(EXPR_SCTP_STREAM_RESET_EVENT);
-	$$->value.sctp_stream_reset_event = calloc(1, sizeof(struct sctp_stream_reset_event_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_STREAM_RESET_EVENT);
+	$$->value.sctp_stream_reset_event = parse_alloc(ctx, sizeof(struct sctp_stream_reset_event_expr));
 	$$->value.sctp_stream_reset_event->strreset_type = $2;
 	$$->value.sctp_stream_reset_event->strreset_flags = $4;
 	$$->value.sctp_stream_reset_event->strreset_length = $6;
@@ -5616,79 +5563,77 @@ sctp_stream_reset_event
 assocreset_type
 : ASSOCRESET_TYPE '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("assocreset_type out of range");
+		semantic_error(ctx, "assocreset_type out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
 | ASSOCRESET_TYPE '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| ASSOCRESET_TYPE '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| ASSOCRESET_TYPE '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 assocreset_flags
 : ASSOCRESET_FLAGS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("assocreset_flags out of range");
+		semantic_error(ctx, "assocreset_flags out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
 | ASSOCRESET_FLAGS '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| ASSOCRESET_FLAGS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| ASSOCRESET_FLAGS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 | ASSOCRESET_FLAGS '=' binary_expression { $$ = $3; }
 ;
 
 assocreset_length
 : ASSOCRESET_LENGTH '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("assocreset_length out of range");
+		semantic_error(ctx, "assocreset_length out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| ASSOCRESET_LENGTH '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| ASSOCRESET_LENGTH '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 assocreset_local_tsn
 : ASSOCRESET_LOCAL_TSN '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("assocreset_local_tsn out of range");
+		semantic_error(ctx, "assocreset_local_tsn out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
 | ASSOCRESET_LOCAL_TSN '=' HEX_INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("assocreset_local_tsn out of range");
+		semantic_error(ctx, "assocreset_local_tsn out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| ASSOCRESET_LOCAL_TSN '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| ASSOCRESET_LOCAL_TSN '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 assocreset_remote_tsn
 : ASSOCRESET_REMOTE_TSN '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("assocreset_remote_tsn out of range");
+		semantic_error(ctx, "assocreset_remote_tsn out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
 | ASSOCRESET_REMOTE_TSN '=' HEX_INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("assocreset_remote_tsn out of range");
+		semantic_error(ctx, "assocreset_remote_tsn out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| ASSOCRESET_REMOTE_TSN '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| ASSOCRESET_REMOTE_TSN '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_assoc_reset_event
 : '{' assocreset_type ',' assocreset_flags ',' assocreset_length ',' ASSOCRESET_ASSOC_ID '=' sctp_assoc_id ','
 	assocreset_local_tsn ',' assocreset_remote_tsn '}' {
-	$$ = new_expression(EXPR_SCTP_ASSOC_RESET_EVENT);
-	$$->value.sctp_assoc_reset_event = calloc(1, sizeof(struct sctp_assoc_reset_event_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_ASSOC_RESET_EVENT);
+	$$->value.sctp_assoc_reset_event = parse_alloc(ctx, sizeof(struct sctp_assoc_reset_event_expr));
 	$$->value.sctp_assoc_reset_event->assocreset_type = $2;
 	$$->value.sctp_assoc_reset_event->assocreset_flags = $4;
 	$$->value.sctp_assoc_reset_event->assocreset_length = $6;
@@ -5701,66 +5646,64 @@ sctp_assoc_reset_event
 strchange_type
 : STRCHANGE_TYPE '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("strchange_type out of range");
+		semantic_error(ctx, "strchange_type out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
 | STRCHANGE_TYPE '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| STRCHANGE_TYPE '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| STRCHANGE_TYPE '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 strchange_flags
 : STRCHANGE_FLAGS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("strchange_flags out of range");
+		semantic_error(ctx, "strchange_flags out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
 | STRCHANGE_FLAGS '=' WORD {
-	$$ = new_expression(EXPR_WORD);
-	$$->value.string = $3;
+	$$ = new_word_expression(ctx, $3);
 }
-| STRCHANGE_FLAGS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| STRCHANGE_FLAGS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 | STRCHANGE_FLAGS '=' binary_expression { $$ = $3; }
 ;
 
 strchange_length
 : STRCHANGE_LENGTH '=' INTEGER {
 	if (!is_valid_u32($3)) {
-		semantic_error("strchange_length out of range");
+		semantic_error(ctx, "strchange_length out of range");
 	}
-	$$ = new_integer_expression($3, "%u");
+	$$ = new_integer_expression(ctx, $3, "%u");
 }
-| STRCHANGE_LENGTH '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| STRCHANGE_LENGTH '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 strchange_instrms
 : STRCHANGE_INSTRMS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("strchange_instrms out of range");
+		semantic_error(ctx, "strchange_instrms out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| STRCHANGE_INSTRMS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| STRCHANGE_INSTRMS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 strchange_outstrms
 : STRCHANGE_OUTSTRMS '=' INTEGER {
 	if (!is_valid_u16($3)) {
-		semantic_error("strchange_outstrms out of range");
+		semantic_error(ctx, "strchange_outstrms out of range");
 	}
-	$$ = new_integer_expression($3, "%hu");
+	$$ = new_integer_expression(ctx, $3, "%hu");
 }
-| STRCHANGE_OUTSTRMS '=' ELLIPSIS { $$ = new_expression(EXPR_ELLIPSIS); }
+| STRCHANGE_OUTSTRMS '=' ELLIPSIS { $$ = new_expression(ctx, EXPR_ELLIPSIS); }
 ;
 
 sctp_stream_change_event
 : '{' strchange_type ',' strchange_flags ',' strchange_length ',' STRCHANGE_ASSOC_ID '=' sctp_assoc_id ',' strchange_instrms ',' strchange_outstrms '}' {
-	$$ = new_expression(EXPR_SCTP_STREAM_CHANGE_EVENT);
-	$$->value.sctp_stream_change_event = calloc(1, sizeof(struct sctp_stream_change_event_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_STREAM_CHANGE_EVENT);
+	$$->value.sctp_stream_change_event = parse_alloc(ctx, sizeof(struct sctp_stream_change_event_expr));
 	$$->value.sctp_stream_change_event->strchange_type = $2;
 	$$->value.sctp_stream_change_event->strchange_flags = $4;
 	$$->value.sctp_stream_change_event->strchange_length = $6;
@@ -5772,7 +5715,7 @@ sctp_stream_change_event
 
 sue_address
 : SUE_ADDRESS '=' ELLIPSIS {
-	$$ = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_ELLIPSIS);
 }
 | SUE_ADDRESS '=' sockaddr {
 	$$ = $3;
@@ -5782,27 +5725,27 @@ sue_address
 sue_port
 : SUE_PORT '=' _HTONS_ '(' INTEGER ')' {
 	if (!is_valid_u16($5)) {
-		semantic_error("sue_port out of range");
+		semantic_error(ctx, "sue_port out of range");
 	}
-	$$ = new_integer_expression(htons($5), "%u");
+	$$ = new_integer_expression(ctx, htons($5), "%u");
 }
 | SUE_PORT '=' ELLIPSIS {
-	$$ = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_ELLIPSIS);
 }
 ;
 
 sctp_udpencaps
 : '{' SUE_ASSOC_ID '=' sctp_assoc_id ',' sue_address ',' sue_port '}' {
-	$$ = new_expression(EXPR_SCTP_UDPENCAPS);
-	$$->value.sctp_udpencaps = calloc(1, sizeof(struct sctp_udpencaps_expr));
+	$$ = new_expression(ctx, EXPR_SCTP_UDPENCAPS);
+	$$->value.sctp_udpencaps = parse_alloc(ctx, sizeof(struct sctp_udpencaps_expr));
 	$$->value.sctp_udpencaps->sue_assoc_id = $4;
 	$$->value.sctp_udpencaps->sue_address = $6;
 	$$->value.sctp_udpencaps->sue_port = $8;
 }
 | '{' sue_address ',' sue_port '}' {
-	$$ = new_expression(EXPR_SCTP_UDPENCAPS);
-	$$->value.sctp_udpencaps = calloc(1, sizeof(struct sctp_udpencaps_expr));
-	$$->value.sctp_udpencaps->sue_assoc_id = new_expression(EXPR_ELLIPSIS);
+	$$ = new_expression(ctx, EXPR_SCTP_UDPENCAPS);
+	$$->value.sctp_udpencaps = parse_alloc(ctx, sizeof(struct sctp_udpencaps_expr));
+	$$->value.sctp_udpencaps->sue_assoc_id = new_expression(ctx, EXPR_ELLIPSIS);
 	$$->value.sctp_udpencaps->sue_address = $2;
 	$$->value.sctp_udpencaps->sue_port = $4;
 }
@@ -5811,7 +5754,7 @@ sctp_udpencaps
 opt_errno
 :                   { $$ = NULL; }
 | WORD note         {
-	$$ = malloc(sizeof(struct errno_spec));
+	$$ = parse_alloc(ctx, sizeof(struct errno_spec));
 	$$->errno_macro = $1;
 	$$->strerror    = $2;
 }
@@ -5828,28 +5771,28 @@ note
 
 word_list
 : WORD              { $$ = $1; }
-| word_list WORD    { asprintf(&($$), "%s %s", $1, $2); free($1); free($2); }
+| word_list WORD    { $$ = arena_asprintf(ctx->arena, "%s %s", $1, $2); }
 ;
 
 command_spec
 : BACK_QUOTED       {
-	$$ = malloc(sizeof(struct command_spec));
+	$$ = parse_alloc(ctx, sizeof(struct command_spec));
 	$$->command_line = $1;
-	current_script_line = yylineno;
+	ctx->script_line = yyget_lineno(scanner);
 }
 ;
 
 code_spec
 : CODE              {
-	$$ = calloc(1, sizeof(struct code_spec));
+	$$ = parse_alloc(ctx, sizeof(struct code_spec));
 	$$->text = $1;
-	current_script_line = yylineno;
+	ctx->script_line = yyget_lineno(scanner);
 }
 ;
 
 null
 : NULL_ {
-	$$ = new_expression(EXPR_NULL);
+	$$ = new_expression(ctx, EXPR_NULL);
 }
 ;
 
@@ -5860,7 +5803,7 @@ opt_cleanup_command
 
 cleanup_command
 : command_spec {
-	out_script->cleanup_command = $1;
-	cleanup_cmd = out_script->cleanup_command->command_line;
+	ctx->script->cleanup_command = $1;
+	cleanup_cmd = ctx->script->cleanup_command->command_line;
 }
 ;
@@ -0,0 +1,261 @@
+/*
+ * Copyright 2013 Google Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+/*
+ * Implementation for recording packets to a pcapng file.
+ *
+ * The format is described in draft-ietf-opsawg-pcapng. We write one
+ * section per writer, holding one interface of raw IP packets (no
+ * link layer header), with timestamps in the default microsecond
+ * resolution. Blocks are written in host byte order, as the format
+ * allows, since readers check the byte order magic.
+ */
+
+#include "pcapng.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "logging.h"
+
+/* Once this many bytes are waiting we wake the writer thread. */
+#define PCAPNG_WAKE_BYTES		(64*1024)
+
+/* Otherwise the writer thread wakes up this often to write. */
+#define PCAPNG_WAKE_USECS		(100*1000)
+
+/* A growable buffer of encoded blocks. */
+struct pcapng_buffer {
+	u8 *bytes;
+	size_t len;		/* bytes in use */
+	size_t size;		/* bytes allocated */
+};
+
+struct pcapng_writer {
+	FILE *file;
+	pthread_t thread;		/* writes 'pending' to 'file' */
+	pthread_mutex_t mutex;		/* guards 'pending' and 'stopping' */
+	pthread_cond_t wake;		/* wakes the writer thread */
+	struct pcapng_buffer pending;	/* blocks not yet written */
+	bool stopping;			/* should the thread finish up? */
+};
+
+/* Pad a length to the 32-bit boundary all pcapng fields align to. */
+static inline u32 pad4(u32 len)
+{
+	return (len + 3) & ~3U;
+}
+
+/* Reserve 'len' more bytes at the end of the buffer, and return a
+ * pointer to them.
+ */
+static u8 *buffer_append(struct pcapng_buffer *buffer, size_t len)
+{
+	u8 *p;
+
+	if (buffer->len + len > buffer->size) {
+		buffer->size = max(2 * buffer->size, buffer->len + len);
+		buffer->bytes = realloc(buffer->bytes, buffer->size);
+		if (buffer->bytes == NULL)
+			die_perror("realloc");
+	}
+	p = buffer->bytes + buffer->len;
+	buffer->len += len;
+	return p;
+}
+
+static u8 *put_u16(u8 *p, u16 value)
+{
+	memcpy(p, &value, sizeof(value));
+	return p + sizeof(value);
+}
+
+static u8 *put_u32(u8 *p, u32 value)
+{
+	memcpy(p, &value, sizeof(value));
+	return p + sizeof(value);
+}
+
+/* Copy 'len' bytes and zero-pad them to a 32-bit boundary. */
+static u8 *put_padded(u8 *p, const void *bytes, u32 len)
+{
+	memcpy(p, bytes, len);
+	memset(p + len, 0, pad4(len) - len);
+	return p + pad4(len);
+}
+
+/* Write the section header and interface description blocks. */
+static void write_headers(struct pcapng_writer *writer)
+{
+	struct pcapng_buffer buffer = { NULL, 0, 0 };
+	const u32 shb_len = 28, idb_len = 20;
+	u8 *p;
+
+	p = buffer_append(&buffer, shb_len);
+	p = put_u32(p, PCAPNG_SECTION_HEADER_BLOCK);
+	p = put_u32(p, shb_len);
+	p = put_u32(p, PCAPNG_BYTE_ORDER_MAGIC);
+	p = put_u16(p, 1);		/* major version */
+	p = put_u16(p, 0);		/* minor version */
+	p = put_u32(p, 0xffffffff);	/* section length: unknown */
+	p = put_u32(p, 0xffffffff);
+	p = put_u32(p, shb_len);
+
+	p = buffer_append(&buffer, idb_len);
+	p = put_u32(p, PCAPNG_INTERFACE_BLOCK);
+	p = put_u32(p, idb_len);
+	p = put_u16(p, PCAPNG_LINKTYPE_RAW);
+	p = put_u16(p, 0);		/* reserved */
+	p = put_u32(p, 0);		/* snap length: unlimited */
+	p = put_u32(p, idb_len);
+
+	if (fwrite(buffer.bytes, 1, buffer.len, writer->file) != buffer.len)
+		die_perror("pcapng write");
+	free(buffer.bytes);
+}
+
+static void *pcapng_writer_thread(void *arg)
+{
+	struct pcapng_writer *writer = arg;
+	struct pcapng_buffer out = { NULL, 0, 0 };
+	struct pcapng_buffer swap;
+	struct timespec timeout;
+	bool stopping = false;
+
+	while (!stopping) {
+		pthread_mutex_lock(&writer->mutex);
+		if ((writer->pending.len < PCAPNG_WAKE_BYTES) &&
+		    !writer->stopping) {
+			clock_gettime(CLOCK_REALTIME, &timeout);
+			timeout.tv_nsec += PCAPNG_WAKE_USECS * 1000;
+			if (timeout.tv_nsec >= 1000000000) {
+				timeout.tv_sec += 1;
+				timeout.tv_nsec -= 1000000000;
+			}
+			pthread_cond_timedwait(&writer->wake, &writer->mutex,
+					       &timeout);
+		}
+		/* Take the pending blocks, leaving our empty buffer. */
+		swap = writer->pending;
+		writer->pending = out;
+		out = swap;
+		stopping = writer->stopping;
+		pthread_mutex_unlock(&writer->mutex);
+
+		if (out.len > 0 &&
+		    fwrite(out.bytes, 1, out.len, writer->file) != out.len)
+			die_perror("pcapng write");
+		out.len = 0;
+	}
+
+	free(out.bytes);
+	return NULL;
+}
+
+struct pcapng_writer *pcapng_writer_new(const char *path, bool append)
+{
+	struct pcapng_writer *writer = calloc(1, sizeof(*writer));
+
+	writer->file = fopen(path, append ? "ab" : "wb");
+	if (writer->file == NULL)
+		die_perror(append ? "fopen --pcap_out file for append" :
+			   "fopen --pcap_out file");
+	write_headers(writer);
+
+	if (pthread_mutex_init(&writer->mutex, NULL) != 0)
+		die_perror("pthread_mutex_init");
+	if (pthread_cond_init(&writer->wake, NULL) != 0)
+		die_perror("pthread_cond_init");
+	if (pthread_create(&writer->thread, NULL, pcapng_writer_thread,
+			   writer) != 0)
+		die_perror("pthread_create");
+	return writer;
+}
+
+void pcapng_writer_free(struct pcapng_writer *writer)
+{
+	pthread_mutex_lock(&writer->mutex);
+	writer->stopping = true;
+	pthread_cond_signal(&writer->wake);
+	pthread_mutex_unlock(&writer->mutex);
+
+	if (pthread_join(writer->thread, NULL) != 0)
+		die_perror("pthread_join");
+	if (fclose(writer->file) != 0)
+		die_perror("pcapng fclose");
+
+	pthread_cond_destroy(&writer->wake);
+	pthread_mutex_destroy(&writer->mutex);
+	free(writer->pending.bytes);
+	memset(writer, 0, sizeof(*writer));  /* paranoia to help catch bugs */
+	free(writer);
+}
+
+void pcapng_write_packet(struct pcapng_writer *writer,
+			 struct packet *packet,
+			 s64 time_usecs,
+			 enum direction_t direction,
+			 const char *comment)
+{
+	u32 data_len = packet->ip_bytes;
+	u32 comment_len = (comment != NULL) ? strlen(comment) : 0;
+	u32 flags = (direction == DIRECTION_INBOUND) ?
+		PCAPNG_EPB_FLAG_INBOUND : PCAPNG_EPB_FLAG_OUTBOUND;
+	u32 block_len;
+	u8 *p;
+
+	block_len = 28 + pad4(data_len) +	/* header and packet */
+		    4 + sizeof(flags) +		/* epb_flags option */
+		    4;				/* end of options */
+	if (comment_len > 0)
+		block_len += 4 + pad4(comment_len);
+	block_len += 4;				/* trailing block length */
+
+	pthread_mutex_lock(&writer->mutex);
+
+	p = buffer_append(&writer->pending, block_len);
+	p = put_u32(p, PCAPNG_ENHANCED_PACKET_BLOCK);
+	p = put_u32(p, block_len);
+	p = put_u32(p, 0);			/* interface ID */
+	p = put_u32(p, (u64)time_usecs >> 32);
+	p = put_u32(p, (u64)time_usecs & 0xffffffff);
+	p = put_u32(p, data_len);		/* captured length */
+	p = put_u32(p, data_len);		/* original length */
+	p = put_padded(p, packet_start(packet), data_len);
+
+	p = put_u16(p, PCAPNG_OPT_EPB_FLAGS);
+	p = put_u16(p, sizeof(flags));
+	p = put_u32(p, flags);
+	if (comment_len > 0) {
+		p = put_u16(p, PCAPNG_OPT_COMMENT);
+		p = put_u16(p, comment_len);
+		p = put_padded(p, comment, comment_len);
+	}
+	p = put_u16(p, PCAPNG_OPT_END);
+	p = put_u16(p, 0);
+	p = put_u32(p, block_len);
+	assert(p == writer->pending.bytes + writer->pending.len);
+
+	if (writer->pending.len >= PCAPNG_WAKE_BYTES)
+		pthread_cond_signal(&writer->wake);
+
+	pthread_mutex_unlock(&writer->mutex);
+}
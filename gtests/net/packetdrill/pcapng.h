@@ -0,0 +1,75 @@
+/*
+ * Copyright 2013 Google Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+/*
+ * Interface for recording packets to a pcapng file. The caller's
+ * thread only copies each packet into a memory buffer; a background
+ * thread does the file I/O, so that recording does not perturb the
+ * timing of the test.
+ */
+
+#ifndef __PCAPNG_H__
+#define __PCAPNG_H__
+
+#include "types.h"
+
+#include "packet.h"
+
+/* Block types. */
+#define PCAPNG_SECTION_HEADER_BLOCK	0x0A0D0D0A
+#define PCAPNG_INTERFACE_BLOCK		0x00000001
+#define PCAPNG_SIMPLE_PACKET_BLOCK	0x00000003
+#define PCAPNG_ENHANCED_PACKET_BLOCK	0x00000006
+
+#define PCAPNG_BYTE_ORDER_MAGIC		0x1A2B3C4D
+#define PCAPNG_LINKTYPE_RAW		101	/* bare IPv4 or IPv6 */
+
+/* Option codes. */
+#define PCAPNG_OPT_END			0
+#define PCAPNG_OPT_COMMENT		1
+#define PCAPNG_OPT_EPB_FLAGS		2
+#define PCAPNG_OPT_IF_TSRESOL		9
+
+/* Direction bits in the epb_flags option. */
+#define PCAPNG_EPB_FLAG_INBOUND		0x1
+#define PCAPNG_EPB_FLAG_OUTBOUND	0x2
+
+struct pcapng_writer;
+
+/* Create (or, if 'append', append a new section to) the given pcapng
+ * file and start a thread writing packets to it. Exits on error.
+ */
+extern struct pcapng_writer *pcapng_writer_new(const char *path,
+					       bool append);
+
+/* Write out all recorded packets, stop the writer thread, close the
+ * file and free the writer.
+ */
+extern void pcapng_writer_free(struct pcapng_writer *writer);
+
+/* Record the given IP packet, with the given wall clock time, the
+ * direction it traveled relative to the kernel under test, and a
+ * comment (which may be NULL).
+ */
+extern void pcapng_write_packet(struct pcapng_writer *writer,
+				struct packet *packet,
+				s64 time_usecs,
+				enum direction_t direction,
+				const char *comment);
+
+#endif /* __PCAPNG_H__ */
@@ -0,0 +1,590 @@
+/*
+ * Copyright 2013 Google Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+/*
+ * Implementation for a network device that replays a recorded capture.
+ *
+ * We read the whole capture into memory up front and index its IP
+ * packets, and then keep two cursors into that index: one for the
+ * outbound packets we hand out from receive(), and one for the inbound
+ * packets we check send() against. Keeping the two apart means the
+ * exact interleaving of inbound and outbound packets in the capture
+ * does not matter; the timestamps of the outbound packets are checked
+ * against the script as usual.
+ *
+ * We read classic pcap files, with microsecond or nanosecond
+ * timestamps, and pcapng files. Packets are classified as inbound or
+ * outbound by the pcapng epb_flags option where present (as written by
+ * --pcap_out), and otherwise by whether they come from the live local
+ * IP address.
+ */
+
+#include "replay_netdev.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include "ethernet.h"
+#include "logging.h"
+#include "packet.h"
+#include "packet_parser.h"
+#include "packet_to_string.h"
+#include "pcapng.h"
+
+/* Classic pcap magic numbers, for microsecond and nanosecond files. */
+#define PCAP_MAGIC_USECS	0xA1B2C3D4
+#define PCAP_MAGIC_NSECS	0xA1B23C4D
+
+#define PCAP_FILE_HEADER_BYTES		24
+#define PCAP_RECORD_HEADER_BYTES	16
+
+/* The link types we know how to find the IP header in. */
+#define LINKTYPE_NULL		0	/* BSD loopback */
+#define LINKTYPE_ETHERNET	1
+#define LINKTYPE_RAW		101
+#define LINKTYPE_LINUX_SLL	113	/* "tcpdump -i any" */
+#define LINKTYPE_IPV4		228
+#define LINKTYPE_IPV6		229
+
+/* One IP packet in the capture. */
+struct replay_record {
+	s64 time_usecs;			/* wall clock time of capture */
+	enum direction_t direction;	/* relative to the kernel under test */
+	const u8 *ip;			/* IP header, within the capture */
+	u32 ip_bytes;			/* bytes of IP header and payload */
+	int number;			/* position in capture, from 1 */
+};
+
+/* An interface described by a pcapng interface description block. */
+struct replay_interface {
+	u32 link_type;
+	u64 units_per_sec;		/* timestamp resolution */
+};
+
+struct replay_netdev {
+	struct netdev netdev;		/* "inherit" from netdev */
+
+	struct config *config;		/* this test's config (not owned) */
+	const char *path;		/* path of the capture (not owned) */
+
+	u8 *capture;			/* contents of the capture file */
+	size_t capture_bytes;
+
+	struct replay_record *records;	/* IP packets in capture order */
+	int num_records;
+	int max_records;		/* number of records allocated */
+
+	int next_inbound;		/* index of next record to check */
+	int next_outbound;		/* index of next record to receive */
+};
+
+struct netdev_ops replay_netdev_ops;
+
+/* "Downcast" an abstract netdev to our flavor. */
+static inline struct replay_netdev *to_replay_netdev(struct netdev *netdev)
+{
+	return (struct replay_netdev *)netdev;
+}
+
+static u16 get_u16(const u8 *p, bool swapped)
+{
+	u16 value;
+
+	memcpy(&value, p, sizeof(value));
+	return swapped ? (value >> 8) | (value << 8) : value;
+}
+
+static u32 get_u32(const u8 *p, bool swapped)
+{
+	u32 value;
+
+	memcpy(&value, p, sizeof(value));
+	return swapped ? __builtin_bswap32(value) : value;
+}
+
+/* Read the whole capture file into memory. */
+static void read_capture(struct replay_netdev *netdev)
+{
+	struct stat st;
+	FILE *f = fopen(netdev->path, "r");
+
+	if (f == NULL)
+		die_perror("fopen --replay file");
+	if (fstat(fileno(f), &st) < 0)
+		die_perror("fstat");
+	netdev->capture_bytes = st.st_size;
+	netdev->capture = malloc(netdev->capture_bytes + 1);
+	if (fread(netdev->capture, 1, netdev->capture_bytes, f) !=
+	    netdev->capture_bytes)
+		die("%s: error reading capture\n", netdev->path);
+	fclose(f);
+}
+
+/* Return a pointer to the IP header in a captured frame of the given
+ * link type, adjusting *len to match, or NULL if it is not an IP
+ * packet.
+ */
+static const u8 *frame_ip_header(struct replay_netdev *netdev,
+				 u32 link_type, const u8 *frame, u32 *len)
+{
+	u32 header_bytes = 0;
+	u16 ether_type = 0;
+
+	switch (link_type) {
+	case LINKTYPE_RAW:
+	case LINKTYPE_IPV4:
+	case LINKTYPE_IPV6:
+		return frame;
+	case LINKTYPE_NULL:
+		/* A 4-byte address family, in the capturing host's order. */
+		header_bytes = 4;
+		break;
+	case LINKTYPE_ETHERNET:
+		header_bytes = sizeof(struct ether_header);
+		if (*len >= header_bytes)
+			ether_type = get_u16(frame + header_bytes - 2, false);
+		if (ntohs(ether_type) == ETHERTYPE_VLAN)
+			header_bytes += 4;
+		break;
+	case LINKTYPE_LINUX_SLL:
+		header_bytes = 16;
+		break;
+	default:
+		die("%s: unsupported link type %u\n", netdev->path, link_type);
+	}
+	if (*len <= header_bytes)
+		return NULL;
+	*len -= header_bytes;
+	return frame + header_bytes;
+}
+
+/* Index the given captured frame, if it holds an IP packet. 'flags' is
+ * the pcapng epb_flags value, or 0 if unknown.
+ */
+static void add_record(struct replay_netdev *netdev, s64 time_usecs,
+		       u32 link_type, const u8 *frame,
+		       u32 captured_bytes, u32 original_bytes, u32 flags)
+{
+	struct config *config = netdev->config;
+	struct replay_record *record;
+	u32 len = captured_bytes;
+	const u8 *ip = frame_ip_header(netdev, link_type, frame, &len);
+	bool outbound;
+
+	if (ip == NULL)
+		return;
+	if ((ip[0] >> 4) == 4 && len >= 20) {
+		outbound = (config->live_local_ip.address_family == AF_INET &&
+			    memcmp(ip + 12, &config->live_local_ip.ip.v4,
+				   sizeof(struct in_addr)) == 0);
+	} else if ((ip[0] >> 4) == 6 && len >= 40) {
+		outbound = (config->live_local_ip.address_family == AF_INET6 &&
+			    memcmp(ip + 8, &config->live_local_ip.ip.v6,
+				   sizeof(struct in6_addr)) == 0);
+	} else {
+		return;		/* not IP, e.g. ARP */
+	}
+	if (captured_bytes < original_bytes)
+		die("%s: packet %d was truncated by the capture's snaplen\n",
+		    netdev->path, netdev->num_records + 1);
+
+	if (flags & PCAPNG_EPB_FLAG_INBOUND)
+		outbound = false;
+	else if (flags & PCAPNG_EPB_FLAG_OUTBOUND)
+		outbound = true;
+
+	if (netdev->num_records == netdev->max_records) {
+		netdev->max_records = max(2 * netdev->max_records, 1024);
+		netdev->records = realloc(netdev->records,
+					  netdev->max_records *
+					  sizeof(*netdev->records));
+	}
+	record = &netdev->records[netdev->num_records++];
+	record->time_usecs = time_usecs;
+	record->direction = outbound ? DIRECTION_OUTBOUND : DIRECTION_INBOUND;
+	record->ip = ip;
+	record->ip_bytes = len;
+	record->number = netdev->num_records;
+}
+
+/* Convert a timestamp in the given units to microseconds. */
+static s64 timestamp_to_usecs(u64 timestamp, u64 units_per_sec)
+{
+	return (timestamp / units_per_sec) * 1000000ULL +
+		(timestamp % units_per_sec) * 1000000ULL / units_per_sec;
+}
+
+static void parse_pcap(struct replay_netdev *netdev)
+{
+	const u8 *p = netdev->capture;
+	const u8 *end = netdev->capture + netdev->capture_bytes;
+	u32 magic = get_u32(p, false);
+	bool swapped = false;
+	u64 units_per_sec = 1000000;
+	u32 link_type;
+
+	if (magic == __builtin_bswap32(PCAP_MAGIC_USECS) ||
+	    magic == __builtin_bswap32(PCAP_MAGIC_NSECS)) {
+		swapped = true;
+		magic = __builtin_bswap32(magic);
+	}
+	if (magic == PCAP_MAGIC_NSECS)
+		units_per_sec = 1000000000;
+	link_type = get_u32(p + 20, swapped) & 0xffff;
+
+	for (p += PCAP_FILE_HEADER_BYTES;
+	     end - p >= PCAP_RECORD_HEADER_BYTES;) {
+		u64 timestamp = (u64)get_u32(p, swapped) * units_per_sec +
+				get_u32(p + 4, swapped);
+		u32 captured_bytes = get_u32(p + 8, swapped);
+		u32 original_bytes = get_u32(p + 12, swapped);
+
+		p += PCAP_RECORD_HEADER_BYTES;
+		if (captured_bytes > end - p)
+			die("%s: truncated capture\n", netdev->path);
+		add_record(netdev, timestamp_to_usecs(timestamp, units_per_sec),
+			   link_type, p, captured_bytes, original_bytes, 0);
+		p += captured_bytes;
+	}
+}
+
+/* Find the given option in a pcapng block's options, returning its
+ * value and length or NULL if it is not there.
+ */
+static const u8 *find_pcapng_option(const u8 *p, const u8 *end, u16 code,
+				    bool swapped, u16 *len)
+{
+	while (end - p >= 4) {
+		u16 option_code = get_u16(p, swapped);
+		u16 option_len = get_u16(p + 2, swapped);
+
+		if (option_code == PCAPNG_OPT_END ||
+		    option_len > end - p - 4)
+			break;
+		if (option_code == code) {
+			*len = option_len;
+			return p + 4;
+		}
+		p += 4 + ((option_len + 3) & ~3);
+	}
+	return NULL;
+}
+
+static void parse_pcapng(struct replay_netdev *netdev)
+{
+	const u8 *p = netdev->capture;
+	const u8 *end = netdev->capture + netdev->capture_bytes;
+	struct replay_interface *interfaces = NULL;
+	u32 num_interfaces = 0;
+	bool swapped = false;
+
+	while (end - p >= 12) {
+		u32 type = get_u32(p, swapped);
+		u32 block_bytes;
+		const u8 *option, *options, *options_end;
+		u16 option_len;
+
+		if (type == PCAPNG_SECTION_HEADER_BLOCK) {
+			u32 magic = get_u32(p + 8, false);
+
+			if (magic == PCAPNG_BYTE_ORDER_MAGIC)
+				swapped = false;
+			else if (magic == __builtin_bswap32(
+						PCAPNG_BYTE_ORDER_MAGIC))
+				swapped = true;
+			else
+				die("%s: bad pcapng byte order magic\n",
+				    netdev->path);
+			num_interfaces = 0;	/* each section starts over */
+		}
+		block_bytes = get_u32(p + 4, swapped);
+		if (block_bytes < 12 || (block_bytes % 4) != 0 ||
+		    block_bytes > end - p)
+			die("%s: truncated or corrupt pcapng block\n",
+			    netdev->path);
+		options_end = p + block_bytes - 4;
+
+		if (type == PCAPNG_INTERFACE_BLOCK && block_bytes >= 20) {
+			struct replay_interface *interface;
+
+			interfaces = realloc(interfaces, (num_interfaces + 1) *
+					     sizeof(*interfaces));
+			interface = &interfaces[num_interfaces++];
+			interface->link_type = get_u16(p + 8, swapped);
+			interface->units_per_sec = 1000000;
+			option = find_pcapng_option(p + 16, options_end,
+						    PCAPNG_OPT_IF_TSRESOL,
+						    swapped, &option_len);
+			if (option != NULL && option_len >= 1) {
+				u8 exponent = option[0] & 0x7f;
+
+				interface->units_per_sec = 1;
+				while (exponent-- > 0) {
+					interface->units_per_sec *=
+						(option[0] & 0x80) ? 2 : 10;
+				}
+			}
+		} else if (type == PCAPNG_ENHANCED_PACKET_BLOCK &&
+			   block_bytes >= 32) {
+			u32 interface_id = get_u32(p + 8, swapped);
+			u64 timestamp = ((u64)get_u32(p + 12, swapped) << 32) |
+					get_u32(p + 16, swapped);
+			u32 captured_bytes = get_u32(p + 20, swapped);
+			u32 original_bytes = get_u32(p + 24, swapped);
+			u32 flags = 0;
+
+			if (interface_id >= num_interfaces)
+				die("%s: packet from unknown interface %u\n",
+				    netdev->path, interface_id);
+			if (captured_bytes > options_end - (p + 28))
+				die("%s: truncated or corrupt pcapng block\n",
+				    netdev->path);
+			options = p + 28 + ((captured_bytes + 3) & ~3);
+			option = find_pcapng_option(options, options_end,
+						    PCAPNG_OPT_EPB_FLAGS,
+						    swapped, &option_len);
+			if (option != NULL && option_len == 4)
+				flags = get_u32(option, swapped);
+			add_record(netdev,
+				   timestamp_to_usecs(
+					   timestamp,
+					   interfaces[interface_id].
+					   units_per_sec),
+				   interfaces[interface_id].link_type,
+				   p + 28, captured_bytes, original_bytes,
+				   flags);
+		} else {
+			/* Simple packet blocks carry no timestamps, so
+			 * are no use to us; nor are name resolution or
+			 * statistics blocks.
+			 */
+			DEBUGP("skipping pcapng block type 0x%x\n", type);
+		}
+		p += block_bytes;
+	}
+	free(interfaces);
+}
+
+struct netdev *replay_netdev_new(struct config *config)
+{
+	struct replay_netdev *netdev = calloc(1, sizeof(struct replay_netdev));
+	u32 magic;
+
+	netdev->netdev.ops = &replay_netdev_ops;
+	netdev->config = config;
+	netdev->path = config->replay;
+
+	read_capture(netdev);
+	if (netdev->capture_bytes < PCAP_FILE_HEADER_BYTES)
+		die("%s: not a pcap or pcapng file\n", netdev->path);
+
+	magic = get_u32(netdev->capture, false);
+	if (magic == PCAPNG_SECTION_HEADER_BLOCK)
+		parse_pcapng(netdev);
+	else if (magic == PCAP_MAGIC_USECS || magic == PCAP_MAGIC_NSECS ||
+		 magic == __builtin_bswap32(PCAP_MAGIC_USECS) ||
+		 magic == __builtin_bswap32(PCAP_MAGIC_NSECS))
+		parse_pcap(netdev);
+	else
+		die("%s: not a pcap or pcapng file\n", netdev->path);
+
+	if (netdev->num_records == 0)
+		die("%s: no IP packets in capture\n", netdev->path);
+	DEBUGP("replaying %d packets from %s\n",
+	       netdev->num_records, netdev->path);
+
+	return (struct netdev *)netdev;
+}
+
+s64 replay_netdev_start_time_usecs(struct netdev *a_netdev)
+{
+	struct replay_netdev *netdev = to_replay_netdev(a_netdev);
+
+	return netdev->records[0].time_usecs;
+}
+
+/* Advance *index to the next record in the given direction, returning
+ * it, or NULL if there are no more.
+ */
+static struct replay_record *next_record(struct replay_netdev *netdev,
+					 int *index,
+					 enum direction_t direction)
+{
+	while (*index < netdev->num_records &&
+	       netdev->records[*index].direction != direction)
+		++*index;
+	if (*index == netdev->num_records)
+		return NULL;
+	return &netdev->records[*index];
+}
+
+u16 replay_netdev_next_remote_port(struct netdev *a_netdev)
+{
+	struct replay_netdev *netdev = to_replay_netdev(a_netdev);
+	struct replay_record *record;
+	u32 header_bytes;
+
+	record = next_record(netdev, &netdev->next_inbound,
+			     DIRECTION_INBOUND);
+	if (record == NULL)
+		return 0;
+	/* TCP, UDP and SCTP all start with the source port. We don't
+	 * bother with IPv6 extension headers here, since we don't
+	 * inject any.
+	 */
+	header_bytes = ((record->ip[0] >> 4) == 4) ?
+		(record->ip[0] & 0x0f) * 4 : 40;
+	if (record->ip_bytes < header_bytes + 2)
+		return 0;
+	return ntohs(get_u16(record->ip + header_bytes, false));
+}
+
+static void replay_netdev_free(struct netdev *a_netdev)
+{
+	struct replay_netdev *netdev = to_replay_netdev(a_netdev);
+
+	free(netdev->records);
+	free(netdev->capture);
+
+	memset(netdev, 0, sizeof(*netdev));  /* paranoia to help catch bugs */
+	free(netdev);
+}
+
+/* Copy the record into a packet from the pool and parse it. */
+static enum packet_parse_result_t record_to_packet(
+	struct replay_record *record, struct packet_pool *pool,
+	u8 udp_encaps, struct packet **packet, char **error)
+{
+	u16 ether_type = ((record->ip[0] >> 4) == 4) ?
+		ETHERTYPE_IP : ETHERTYPE_IPV6;
+
+	*packet = packet_pool_get(pool, record->ip_bytes);
+	memcpy((*packet)->buffer, record->ip, record->ip_bytes);
+	(*packet)->time_usecs = record->time_usecs;
+	return parse_packet(*packet, record->ip_bytes, ether_type,
+			    udp_encaps, error);
+}
+
+/* Return a string describing the given packet, for error messages. */
+static char *describe_packet(struct packet *packet)
+{
+	char *dump = NULL, *error = NULL;
+
+	if (packet_to_string(packet, DUMP_FULL, &dump, &error)) {
+		free(dump);
+		dump = error;
+	}
+	return dump;
+}
+
+/* Check a packet the script injects against the next inbound packet
+ * in the capture. We die on a mismatch, as a local netdev does if it
+ * fails to inject a packet.
+ */
+static int replay_netdev_send(struct netdev *a_netdev,
+			      struct packet *packet)
+{
+	struct replay_netdev *netdev = to_replay_netdev(a_netdev);
+	struct replay_record *record;
+	struct packet *captured = NULL;
+	char *injected_dump = NULL, *captured_dump = NULL, *error = NULL;
+
+	DEBUGP("replay_netdev_send\n");
+
+	record = next_record(netdev, &netdev->next_inbound,
+			     DIRECTION_INBOUND);
+	if (record == NULL) {
+		injected_dump = describe_packet(packet);
+		die("%s: injected packet is not in capture: %s\n",
+		    netdev->path, injected_dump);
+	}
+	++netdev->next_inbound;
+
+	if (record->ip_bytes == packet->ip_bytes &&
+	    memcmp(record->ip, packet_start(packet), record->ip_bytes) == 0)
+		return STATUS_OK;
+
+	injected_dump = describe_packet(packet);
+	if (record_to_packet(record, NULL, netdev->config->udp_encaps,
+			     &captured, &error) == PACKET_OK)
+		captured_dump = describe_packet(captured);
+	else
+		captured_dump = error;
+	die("%s: injected packet differs from packet %d in capture\n"
+	    "injected: %s\n"
+	    "captured: %s\n",
+	    netdev->path, record->number, injected_dump, captured_dump);
+	return STATUS_ERR;	/* not reached */
+}
+
+/* Hand out the next outbound packet in the capture. Since the script
+ * runs on the capture's clock, a packet captured after the deadline
+ * is one that did not arrive in time.
+ */
+static int replay_netdev_receive(struct netdev *a_netdev,
+				 struct packet_pool *pool, u8 udp_encaps,
+				 s64 deadline_usecs, struct packet **packet,
+				 char **error)
+{
+	struct replay_netdev *netdev = to_replay_netdev(a_netdev);
+	struct replay_record *record;
+	enum packet_parse_result_t result;
+
+	DEBUGP("replay_netdev_receive\n");
+
+	assert(*packet == NULL);	/* should be no packet yet */
+	while (1) {
+		record = next_record(netdev, &netdev->next_outbound,
+				     DIRECTION_OUTBOUND);
+		if (record == NULL) {
+			if (deadline_usecs != NO_DEADLINE)
+				return STATUS_TIMEOUT;
+			if (asprintf(error, "no more outbound packets in %s",
+				     netdev->path) < 0)
+				die_perror("asprintf");
+			return STATUS_ERR;
+		}
+		if (deadline_usecs != NO_DEADLINE &&
+		    record->time_usecs > deadline_usecs)
+			return STATUS_TIMEOUT;
+		++netdev->next_outbound;
+
+		result = record_to_packet(record, pool, udp_encaps,
+					  packet, error);
+		if (result == PACKET_OK)
+			return STATUS_OK;
+
+		packet_free(*packet);
+		*packet = NULL;
+
+		if (result == PACKET_BAD)
+			return STATUS_ERR;
+
+		DEBUGP("parse_result:%d; error parsing packet: %s\n",
+		       result, *error);
+	}
+}
+
+struct netdev_ops replay_netdev_ops = {
+	.free = replay_netdev_free,
+	.send = replay_netdev_send,
+	.receive = replay_netdev_receive,
+};
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2013 Google Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+/*
+ * Interface for a network device that replays a recorded capture
+ * instead of talking to a kernel. The outbound packets in the capture
+ * are what we "sniff", and the packets the script injects are checked
+ * against the inbound packets in the capture. This lets us check a
+ * script against a capture (e.g. from --pcap_out or tcpdump) without
+ * root privileges, a tun device, or waiting in real time.
+ */
+
+#ifndef __REPLAY_NETDEV_H__
+#define __REPLAY_NETDEV_H__
+
+#include "types.h"
+
+#include "config.h"
+#include "netdev.h"
+
+/* Allocate and return a new netdev replaying the pcap or pcapng file
+ * named by config->replay. Exits on error.
+ */
+extern struct netdev *replay_netdev_new(struct config *config);
+
+/* Return the wall clock time of the first packet in the capture. */
+extern s64 replay_netdev_start_time_usecs(struct netdev *netdev);
+
+/* Return the source port of the next inbound packet in the capture,
+ * or 0 if there is none. When the script injects a SYN, this is the
+ * port the live run picked for the remote end of the connection.
+ */
+extern u16 replay_netdev_next_remote_port(struct netdev *netdev);
+
+#endif /* __REPLAY_NETDEV_H__ */
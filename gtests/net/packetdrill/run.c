@@ -34,39 +34,57 @@
 #include <sys/mman.h>
 #include <sys/socket.h>
 #include <sys/times.h>
+#include <time.h>
 #include <unistd.h>
+#if defined(linux)
+#include <sys/prctl.h>
+#endif
 #include "ip.h"
 #include "logging.h"
 #include "netdev.h"
+#include "packet_pool.h"
+#include "replay_netdev.h"
 #include "wire_client_netdev.h"
 #include "parse.h"
 #include "run_command.h"
 #include "run_packet.h"
 #include "run_system_call.h"
 #include "script.h"
+#include "script_cache.h"
 #include "socket.h"
 #include "system.h"
 #include "tcp.h"
 #include "tcp_options.h"
 
-/* MAX_SPIN_USECS is the maximum amount of time (in microseconds) to
- * spin waiting for an event. We sleep up until this many microseconds
+/* state->spin_usecs is the amount of time (in microseconds) to spin
+ * waiting for an event. We sleep up until this many microseconds
  * before a script event. We get the best results on tickless
  * (CONFIG_NO_HZ=y) kernels when we try to sleep until the exact jiffy
  * of a script event; this reduces the staleness/noise we see in
  * jiffies values on tickless kernels, since the kernel updates the
  * jiffies value at the time we wake, and then we execute the test
- * event shortly thereafter. The value below was chosen experimentally
- * based on experiences on a 2.2GHz machine for which there was a
- * measured overhead of roughly 15 usec for the unlock/usleep/lock
- * sequence that wait_for_event() must execute while waiting
- * for the next event.
+ * event shortly thereafter.
+ *
+ * Rather than a fixed value, the spin window tracks the wakeup
+ * latency we actually observe on this host, plus SPIN_MARGIN_USECS
+ * for the unlock/sleep/lock sequence that wait_for_event() must
+ * execute while waiting for the next event: a quiet machine spins
+ * for a few microseconds, while a busy shared one spins long enough
+ * to still hit its events on time. INITIAL_SPIN_USECS, the value we
+ * used to use always, is where we start if calibration fails.
  */
 #if defined(__FreeBSD__)
-const int MAX_SPIN_USECS = 100;
+const int INITIAL_SPIN_USECS = 100;
 #else
-const int MAX_SPIN_USECS = 20;
+const int INITIAL_SPIN_USECS = 20;
 #endif
+const int MIN_SPIN_USECS = 2;
+const int MAX_SPIN_USECS = 2000;
+const int SPIN_MARGIN_USECS = 5;
+
+/* Number of short sleeps used to calibrate the initial spin window. */
+const int SPIN_CALIBRATION_SLEEPS = 8;
+const int SPIN_CALIBRATION_SLEEP_USECS = 200;
 
 /* Global bool init_cmd_exed */
 bool init_cmd_exed = false;
@@ -82,6 +100,100 @@ const char *script_path;
 
 static struct state *state = NULL;
 
+/* Get the time in microseconds on a clock that wall clock adjustments
+ * do not step, for timing our sleeps.
+ */
+static s64 monotonic_usecs(void)
+{
+/* clock_gettime is available in MacOS 10.12 and higher. */
+#if !defined(__APPLE__) || (defined(__APPLE__) && (MAC_OS_X_VERSION_MIN_REQUIRED >= 101200))
+	struct timespec ts;
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) < 0)
+		die_perror("clock_gettime");
+	return (s64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#else
+	return now_usecs();
+#endif
+}
+
+/* Sleep until the given monotonic_usecs() time, if this OS gives us a
+ * fine-grained way to do so; otherwise return at once, so that the
+ * caller spins instead.
+ */
+static void sleep_until_usecs(s64 wake_usecs)
+{
+#if defined(linux) || defined(__FreeBSD__) || defined(__NetBSD__)
+	struct timespec ts;
+	int status;
+
+	ts.tv_sec = wake_usecs / 1000000;
+	ts.tv_nsec = (wake_usecs % 1000000) * 1000;
+	do {
+		status = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME,
+					 &ts, NULL);
+	} while (status == EINTR);
+	if (status != 0) {
+		errno = status;
+		die_perror("clock_nanosleep");
+	}
+#elif defined(__APPLE__)
+	s64 wait_usecs = wake_usecs - monotonic_usecs();
+	if (wait_usecs > 0)
+		usleep(wait_usecs);
+#endif
+}
+
+/* Bound a spin window to the range we allow. */
+static s64 clamp_spin_usecs(s64 spin_usecs)
+{
+	if (spin_usecs < MIN_SPIN_USECS)
+		return MIN_SPIN_USECS;
+	if (spin_usecs > MAX_SPIN_USECS)
+		return MAX_SPIN_USECS;
+	return spin_usecs;
+}
+
+/* Measure how late this host wakes us up from a few short sleeps,
+ * and return a spin window that covers the worst of those.
+ */
+static s64 calibrate_spin_usecs(void)
+{
+	s64 max_latency_usecs = -1;
+	int i;
+
+	for (i = 0; i < SPIN_CALIBRATION_SLEEPS; ++i) {
+		s64 wake_usecs = monotonic_usecs() +
+				 SPIN_CALIBRATION_SLEEP_USECS;
+		s64 latency_usecs;
+
+		sleep_until_usecs(wake_usecs);
+		latency_usecs = monotonic_usecs() - wake_usecs;
+		if (latency_usecs > max_latency_usecs)
+			max_latency_usecs = latency_usecs;
+	}
+	if (max_latency_usecs < 0)	/* we can't sleep on this OS */
+		return INITIAL_SPIN_USECS;
+	return clamp_spin_usecs(max_latency_usecs + SPIN_MARGIN_USECS);
+}
+
+/* Adapt the spin window to the latency of our latest wakeup: grow it
+ * right away if we woke up later than it allowed for, so the next
+ * events are on time, and otherwise shrink it gradually.
+ */
+static void update_spin_usecs(struct state *state, s64 latency_usecs)
+{
+	s64 target_usecs = latency_usecs + SPIN_MARGIN_USECS;
+
+	if (target_usecs > state->spin_usecs)
+		state->spin_usecs = target_usecs;
+	else
+		state->spin_usecs -= (state->spin_usecs - target_usecs) / 8;
+	state->spin_usecs = clamp_spin_usecs(state->spin_usecs);
+}
+
+/* Have we started the --pcap_out file for an earlier script? */
+static bool pcap_out_started;
+
 struct state *state_new(struct config *config,
 			struct script *script,
 			struct netdev *netdev)
@@ -95,11 +207,22 @@ struct state *state_new(struct config *config,
 
 	state->config = config;
 	state->script = script;
+	state->spin_usecs = calibrate_spin_usecs();
 	state->netdev = netdev;
 	state->packets = packets_new();
+	state->packet_pool = packet_pool_new();
 	state->syscalls = syscalls_new(state);
 	state->code = code_new(config);
 	state->sockets = NULL;
+	state->socket_index = socket_index_new();
+	if (config->stats_json != NULL)
+		state->stats = script_stats_new();
+	if (config->pcap_out != NULL) {
+		/* Each script in this run gets its own pcapng section. */
+		state->pcap_writer = pcapng_writer_new(config->pcap_out,
+						       pcap_out_started);
+		pcap_out_started = true;
+	}
 	return state;
 }
 
@@ -121,10 +244,14 @@ static void close_all_sockets(struct state *state)
 			if (close(socket->live.fd))
 				die_perror("close");
 		}
+		/* Wire clients leave this to the server, and replays
+		 * have no kernel state to clean up.
+		 */
 		if ((socket->state != SOCKET_INIT) &&
 		    (socket->state != SOCKET_NEW) &&
 		    (socket->state != SOCKET_PASSIVE_LISTENING) &&
-		    (state->config->is_wire_client == false)) {
+		    (state->config->is_wire_client == false) &&
+		    (state->config->replay == NULL)) {
 			switch (socket->protocol) {
 			case IPPROTO_TCP:
 				if (reset_connection(state, socket) != STATUS_OK)
@@ -140,10 +267,22 @@ static void close_all_sockets(struct state *state)
 		}
 		struct socket *dead_socket = socket;
 		socket = socket->next;
+		socket_index_remove(state->socket_index, dead_socket);
 		socket_free(dead_socket);
 	}
 }
 
+void state_write_stats(struct state *state, bool passed)
+{
+	if (state->stats == NULL)
+		return;
+	script_stats_write(state->stats, state->config->stats_json,
+			   state->config->script_path,
+			   state->config->tolerance_usecs, passed);
+	script_stats_free(state->stats);
+	state->stats = NULL;
+}
+
 void state_free(struct state *state, int about_to_die)
 {
 	/* We have to stop the system call thread first, since it's using
@@ -156,9 +295,20 @@ void state_free(struct state *state, int about_to_die)
 	 * per-connection kernel state.
 	 */
 	close_all_sockets(state);
+	socket_index_free(state->socket_index);
+
+	/* The RSTs above are the last packets we record. */
+	if (state->pcap_writer != NULL)
+		pcapng_writer_free(state->pcap_writer);
+
+	/* A script that fails still gets its line in the report, since
+	 * its timing is what we most want to see.
+	 */
+	state_write_stats(state, !about_to_die);
 
 	netdev_free(state->netdev);
 	packets_free(state->packets);
+	packet_pool_free(state->packet_pool);
 	code_free(state->code);
 
 	run_unlock(state);
@@ -250,6 +400,26 @@ int verify_time(struct state *state, enum event_time_t time_type,
 	}
 }
 
+s64 time_error_usecs(struct state *state, enum event_time_t time_type,
+		     s64 script_usecs, s64 script_usecs_end, s64 live_usecs)
+{
+	s64 actual_usecs = live_time_to_script_time_usecs(state, live_usecs);
+
+	if (time_type == ANY_TIME)
+		return 0;
+
+	if (time_type == ABSOLUTE_RANGE_TIME ||
+	    time_type == RELATIVE_RANGE_TIME) {
+		if (actual_usecs < script_usecs)
+			return actual_usecs - script_usecs;
+		if (actual_usecs > script_usecs_end)
+			return actual_usecs - script_usecs_end;
+		return 0;
+	}
+
+	return actual_usecs - script_usecs;
+}
+
 /* Return a static string describing the given event, for error messages. */
 static const char *event_description(struct event *event)
 {
@@ -293,6 +463,7 @@ void check_event_time(struct state *state, s64 live_usecs)
 			state->event->time_usecs,
 			state->event->time_usecs_end, live_usecs,
 			description, &error)) {
+		state_write_stats(state, false);
 		die("%s:%d: %s\n",
 		    state->config->script_path,
 		    state->event->line_number,
@@ -312,7 +483,7 @@ void adjust_relative_event_times(struct state *state, struct event *event)
 	    event->time_type != RELATIVE_RANGE_TIME)
 		return;
 
-	offset_usecs = now_usecs() - state->live_start_time_usecs;
+	offset_usecs = live_now_usecs(state) - state->live_start_time_usecs;
 	event->offset_usecs = offset_usecs;
 
 	event->time_usecs += offset_usecs;
@@ -327,53 +498,70 @@ void adjust_relative_event_times(struct state *state, struct event *event)
 	}
 }
 
+/* Report how long after its scheduled time we got to the current
+ * event, for spotting hosts too noisy to run tests reliably.
+ */
+static void report_scheduling_error(struct state *state, s64 error_usecs)
+{
+	if (state->stats != NULL)
+		histogram_record(&state->stats->scheduling_error, error_usecs);
+	DEBUGP("%d: scheduling error %lld usecs, spin window %lld usecs\n",
+	       state->event->line_number, error_usecs, state->spin_usecs);
+	if (state->config->verbose) {
+		printf("%s:%d: scheduling error: %lld usecs "
+		       "(spin window %lld usecs)\n",
+		       state->config->script_path, state->event->line_number,
+		       error_usecs, state->spin_usecs);
+	}
+}
+
 void wait_for_event(struct state *state)
 {
 	s64 event_usecs =
 		script_time_to_live_time_usecs(
 			state, state->event->time_usecs);
+	s64 deadline_usecs, sleep_usecs, live_usecs;
+	s64 latency_usecs = -1;
+
+	/* A replay runs at memory speed, with nothing to wait for. */
+	if (state->config->replay != NULL) {
+		state->replay_now_usecs = max(state->replay_now_usecs,
+					      event_usecs);
+		return;
+	}
+
 	DEBUGP("waiting until %lld -- now is %lld\n",
 	       event_usecs, now_usecs());
 	run_unlock(state);
-	while (1) {
-		const s64 wait_usecs = event_usecs - now_usecs();
-		if (wait_usecs <= 0)
-			break;
-
-		/* If we're waiting a long time, and we are on an OS
-		 * that we know has a fine-grained usleep(), then
-		 * usleep() instead of spinning on the CPU.
-		 */
-#if defined(linux) || defined(__APPLE__)
-		/* Since the scheduler may not wake us up precisely
-		 * when we tell it to, sleep until just before the
-		 * event we're waiting for and then spin.
-		 */
-		if (wait_usecs > MAX_SPIN_USECS) {
-			usleep(wait_usecs - MAX_SPIN_USECS);
-		}
-#endif
-#if defined(__FreeBSD__)
-		/* Since the scheduler may not wake us up precisely
-		 * when we tell it to, sleep until just before the
-		 * event we're waiting for and then spin.
-		 * Since FreeBSD is overshooting by about 10 percent,
-		 * take this into account.
-		 */
-		if (wait_usecs > MAX_SPIN_USECS) {
-			useconds_t delta = (useconds_t)(wait_usecs - MAX_SPIN_USECS);
 
-			delta -= delta >> 3;
-			usleep(delta);
-		}
-#endif
+	/* Script events are scheduled in wall clock time, to match
+	 * packet timestamps, but we wait on the monotonic clock, so
+	 * that wall clock adjustments while we wait do not upset us.
+	 */
+	deadline_usecs = monotonic_usecs() + (event_usecs - now_usecs());
 
-		/* At this point we should only have a millisecond or
-		 * two to wait, so we spin.
-		 */
+	/* Since the scheduler may not wake us up precisely when we
+	 * tell it to, sleep until just before the event we're waiting
+	 * for and then spin.
+	 */
+	sleep_usecs = deadline_usecs - state->spin_usecs;
+	if (sleep_usecs > monotonic_usecs()) {
+		sleep_until_usecs(sleep_usecs);
+		latency_usecs = monotonic_usecs() - sleep_usecs;
 	}
+
+	/* At this point we should only have a few microseconds to
+	 * wait, so we spin.
+	 */
+	while (monotonic_usecs() < deadline_usecs)
+		;
+
 	run_lock(state);
-	check_event_time(state, now_usecs());
+	if (latency_usecs >= 0)
+		update_spin_usecs(state, latency_usecs);
+	live_usecs = now_usecs();
+	report_scheduling_error(state, live_usecs - event_usecs);
+	check_event_time(state, live_usecs);
 }
 
 int get_next_event(struct state *state, char **error)
@@ -420,6 +608,37 @@ int get_next_event(struct state *state, char **error)
 	return STATUS_OK;
 }
 
+/* When replaying a capture there is no kernel to run system calls,
+ * commands or code against, so we skip those events, and just move
+ * the replay clock on to their scheduled times. The replay clock
+ * starts out on the script's clock; we move it onto the capture's
+ * clock at the first packet event, which should be the first packet
+ * in the capture. Returns true if the event is one to skip.
+ */
+static bool replay_skips_event(struct state *state, struct event *event,
+			       bool *clock_set)
+{
+	s64 offset_usecs;
+
+	if (event->type != PACKET_EVENT) {
+		DEBUGP("%d: skipping event for replay\n", event->line_number);
+		state->replay_now_usecs =
+			max(state->replay_now_usecs,
+			    script_time_to_live_time_usecs(
+				    state, event->time_usecs));
+		return true;
+	}
+	if (!*clock_set) {
+		offset_usecs = replay_netdev_start_time_usecs(state->netdev) -
+			script_time_to_live_time_usecs(state,
+						       event->time_usecs);
+		state->live_start_time_usecs += offset_usecs;
+		state->replay_now_usecs += offset_usecs;
+		*clock_set = true;
+	}
+	return false;
+}
+
 /* Run the given packet event; print warnings/errors, and exit on error. */
 static void run_local_packet_event(struct state *state, struct event *event,
 				   struct packet *packet)
@@ -444,6 +663,14 @@ static void run_local_packet_event(struct state *state, struct event *event,
  */
 void set_scheduling_priority(void)
 {
+#if defined(linux)
+	/* Ask the kernel not to defer our timer wakeups to batch them
+	 * with others, so sleeps in wait_for_event() end on time.
+	 */
+	if (prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0) < 0)
+		die_perror("prctl(PR_SET_TIMERSLACK)");
+#endif
+
 	/* Get the CPU count and skip this if we only have 1 CPU. */
 	int num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
 	if (num_cpus < 0)
@@ -564,6 +791,7 @@ void run_script(struct config *config, struct script *script)
 	char *error = NULL;
 	struct netdev *netdev = NULL;
 	struct event *event = NULL;
+	bool replay_clock_set = false;
 
 	init_cmd_exed = false;
 	if (script->init_command != NULL)
@@ -581,8 +809,11 @@ void run_script(struct config *config, struct script *script)
 
 	DEBUGP("run_script: running script\n");
 
-	set_scheduling_priority();
-	lock_memory();
+	/* Replays don't run in real time, so need no special treatment. */
+	if (config->replay == NULL) {
+		set_scheduling_priority();
+		lock_memory();
+	}
 
 	/* This interpreter loop runs for local mode or wire client mode. */
 	assert(!config->is_wire_server);
@@ -594,6 +825,8 @@ void run_script(struct config *config, struct script *script)
 	 */
 	if (config->is_wire_client)
 		netdev = wire_client_netdev_new(config);
+	else if (config->replay != NULL)
+		netdev = replay_netdev_new(config);
 	else
 		netdev = local_netdev_new(config);
 
@@ -604,7 +837,7 @@ void run_script(struct config *config, struct script *script)
 		wire_client_init(state->wire_client, config, script, state);
 	}
 
-	if (script->init_command != NULL) {
+	if (script->init_command != NULL && config->replay == NULL) {
 		if (safe_system(script->init_command->command_line,
 				&error)) {
 			asprintf(&error, "%s: error executing init command: %s\n",
@@ -617,7 +850,10 @@ void run_script(struct config *config, struct script *script)
 
 	signal(SIGPIPE, SIG_IGN);	/* ignore EPIPE */
 
-	state->live_start_time_usecs = schedule_start_time_usecs();
+	if (config->replay != NULL)
+		state->live_start_time_usecs = 0;  /* see replay_skips_event() */
+	else
+		state->live_start_time_usecs = schedule_start_time_usecs();
 	DEBUGP("live_start_time_usecs is %lld\n",
 	       state->live_start_time_usecs);
 
@@ -642,6 +878,10 @@ void run_script(struct config *config, struct script *script)
 		 */
 		adjust_relative_event_times(state, event);
 
+		if (config->replay != NULL &&
+		    replay_skips_event(state, event, &replay_clock_set))
+			continue;
+
 		switch (event->type) {
 		case PACKET_EVENT:
 			/* For wire clients, the server handles packets. */
@@ -674,16 +914,19 @@ void run_script(struct config *config, struct script *script)
 	if (state->wire_client != NULL)
 		wire_client_next_event(state->wire_client, NULL);
 
-	if (run_cleanup_command() == STATUS_ERR)
-		exit(EXIT_FAILURE);
+	/* A replay has no cleanup command or post-processing code to run. */
+	if (config->replay == NULL) {
+		if (run_cleanup_command() == STATUS_ERR)
+			exit(EXIT_FAILURE);
 
-	if (code_execute(state->code, &error)) {
-		char *script_path = strdup(state->config->script_path);
-		state_free(state, 1);
-		die("%s: error executing code: %s\n",
-		    script_path, error);
-		free(script_path);
-		free(error);
+		if (code_execute(state->code, &error)) {
+			char *script_path = strdup(state->config->script_path);
+			state_free(state, 1);
+			die("%s: error executing code: %s\n",
+			    script_path, error);
+			free(script_path);
+			free(error);
+		}
 	}
 
 	state_free(state, 0);
@@ -691,6 +934,24 @@ void run_script(struct config *config, struct script *script)
 	DEBUGP("run_script: done running\n");
 }
 
+#if defined(linux)
+/* Return the --script_cache entry for the given script, or NULL if
+ * there is no --script_cache. We need it before the script's options
+ * have been parsed, so we look at the command line on its own.
+ */
+static struct script_cache *find_script_cache(int argc, char *argv[],
+					      const struct script *script)
+{
+	char *dir;
+	int num_options;
+
+	dir = command_line_script_cache(argc, argv, &num_options);
+	if (dir == NULL)
+		return NULL;
+	return script_cache_new(dir, argv + 1, num_options, script);
+}
+#endif
+
 int parse_script_and_set_config(int argc, char *argv[],
 				struct config *config,
 				struct script *script,
@@ -703,6 +964,10 @@ int parse_script_and_set_config(int argc, char *argv[],
 		.config = config,
 		.script = script,
 	};
+#if defined(linux)
+	struct script_cache *cache = NULL;
+#endif
+	int result;
 
 	DEBUGP("parse_and_run_script: %s\n", script_path);
 	assert(script_path != NULL);
@@ -717,5 +982,25 @@ int parse_script_and_set_config(int argc, char *argv[],
 	else
 		read_script(script_path, script);
 
-	return parse_script(config, script, &invocation);
+#if defined(linux)
+	/* A wire server gets its scripts from clients, which do their
+	 * own caching, so we only cache the scripts we read ourselves.
+	 */
+	if (script_buffer == NULL)
+		cache = find_script_cache(argc, argv, script);
+	if (cache != NULL && script_cache_load(cache, script) == STATUS_OK) {
+		script_cache_free(cache);
+		parse_and_finalize_config(&invocation);
+		return STATUS_OK;
+	}
+#endif
+
+	result = parse_script(config, script, &invocation);
+
+#if defined(linux)
+	if (cache != NULL && result == STATUS_OK)
+		script_cache_store(cache, script);
+	script_cache_free(cache);
+#endif
+	return result;
 }
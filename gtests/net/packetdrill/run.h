@@ -63,10 +63,12 @@
 #include "code.h"
 #include "config.h"
 #include "netdev.h"
+#include "pcapng.h"
 #include "run_packet.h"
 #include "run_system_call.h"
 #include "script.h"
 #include "socket.h"
+#include "stats.h"
 #include "wire_client.h"
 
 /* Public top-level entry point for executing a test script */
@@ -91,8 +93,10 @@ struct state {
 	struct config *config;		/* test configuration */
 	struct netdev *netdev;		/* for sending/receiving TCP packets */
 	struct packets *packets;	/* for processing packets */
+	struct packet_pool *packet_pool;	/* for recycling live packets */
 	struct syscalls *syscalls;	/* for running system calls */
 	struct socket *sockets;		/* list of all live sockets */
+	struct socket_index *socket_index;	/* sockets by 4-tuple */
 	struct socket *socket_under_test;	/* socket handling packets */
 	struct script *script;			/* script we're running */
 	struct event *event;			/* the current event */
@@ -102,6 +106,13 @@ struct state {
 	s64 script_start_time_usecs;	/* time of first event in script */
 	s64 script_last_time_usecs;	/* time of previous event in script */
 	s64 live_start_time_usecs;	/* time of first event in live test */
+	s64 spin_usecs;			/* spin this long before events */
+	/* Inbound packets mapped and ready to inject together. */
+	struct packet *inbound_batch[NETDEV_MAX_BATCH];
+	int num_inbound_batch;		/* number of packets in the batch */
+	struct pcapng_writer *pcap_writer;	/* for --pcap_out, or NULL */
+	s64 replay_now_usecs;		/* for --replay, the live time now */
+	struct script_stats *stats;	/* for --stats_json, or NULL */
 };
 
 /* Allocate all run-time state for executing a test script. */
@@ -112,6 +123,12 @@ extern struct state *state_new(struct config *config,
 /* Free all run-time state for a test. */
 void state_free(struct state *state, int about_to_die);
 
+/* If --stats_json is on, append the script's line to the report and
+ * stop collecting stats. Paths that die() without state_free() must
+ * call this first, so that failing scripts are reported too.
+ */
+extern void state_write_stats(struct state *state, bool passed);
+
 /* Grab the global lock for all global state. */
 static inline void run_lock(struct state *state)
 {
@@ -129,6 +146,17 @@ static inline void run_unlock(struct state *state)
 /* Get the wall clock time of day in microseconds. */
 extern s64 now_usecs(void);
 
+/* Get the live time in microseconds: the wall clock time of day, or
+ * when replaying a capture, the time the replay has reached on the
+ * capture's clock.
+ */
+static inline s64 live_now_usecs(const struct state *state)
+{
+	if (state->config->replay != NULL)
+		return state->replay_now_usecs;
+	return now_usecs();
+}
+
 /* Convert script time to live wall clock time. */
 static inline s64 script_time_to_live_time_usecs(struct state *state,
 						 s64 script_time_usecs)
@@ -163,6 +191,14 @@ extern int verify_time(struct state *state, enum event_time_t time_type,
 		       s64 live_usecs, const char *description, char **error);
 extern void check_event_time(struct state *state, s64 live_usecs);
 
+/* Return how far (in microseconds, negative if early) the given live
+ * time is from the time or time range the script expected, for
+ * --stats_json. Returns 0 for ANY_TIME.
+ */
+extern s64 time_error_usecs(struct state *state, enum event_time_t time_type,
+			    s64 script_usecs, s64 script_usecs_end,
+			    s64 live_usecs);
+
 /* Set the start (and end time, if applicable) for the event if it
  * uses wildcard or relative timing.
  */
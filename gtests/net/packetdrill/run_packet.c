@@ -37,6 +37,7 @@
 #include "packet.h"
 #include "packet_checksum.h"
 #include "packet_to_string.h"
+#include "replay_netdev.h"
 #include "run.h"
 #include "script.h"
 #include "sctp_iterator.h"
@@ -86,6 +87,10 @@ static u16 ephemeral_port(void)
  */
 static u16 next_ephemeral_port(struct state *state)
 {
+	/* A replay must use whatever port the recorded run picked. */
+	if (state->config->replay != NULL)
+		return replay_netdev_next_remote_port(state->netdev);
+
 	if (state->packets->next_ephemeral_port >= 0) {
 		int port = state->packets->next_ephemeral_port;
 		assert(port <= 0xffff);
@@ -96,29 +101,66 @@ static u16 next_ephemeral_port(struct state *state)
 	}
 }
 
-/* Add a dump of the given packet to the given error message.
- * Frees *error and replaces it with a version that has the original
- * *error followed by the given type and a hex dump of the given
- * packet.
+/* The packets behind a verification result. We capture them by
+ * reference, and only pay to format them if we report a problem.
+ */
+struct packet_diagnostics {
+	struct packet_dump {
+		const char *type;	/* e.g. "script" or "actual" */
+		struct packet *packet;
+		s64 time_usecs;
+	} dumps[2];
+	int num_dumps;
+};
+
+/* Remember to dump the given packet if we report a problem. */
+static void add_packet_dump(struct packet_diagnostics *diag,
+			    const char *type, struct packet *packet,
+			    s64 time_usecs)
+{
+	struct packet_dump *dump;
+
+	assert(diag->num_dumps < ARRAY_SIZE(diag->dumps));
+	dump = &diag->dumps[diag->num_dumps++];
+	dump->type = type;
+	dump->packet = packet;
+	dump->time_usecs = time_usecs;
+}
+
+/* Frees *error and replaces it with a version that has the original
+ * *error followed by the type and a dump of each captured packet. We
+ * write everything into one stream, rather than allocating a string
+ * per packet and another per concatenation.
  */
-static void add_packet_dump(char **error, const char *type,
-			    struct packet *packet, s64 time_usecs,
-			    enum dump_format_t format)
+static void render_packet_diagnostics(const struct packet_diagnostics *diag,
+				      enum dump_format_t format,
+				      char **error)
 {
-	if (packet->ip_bytes != 0) {
-		char *old_error = *error;
-		char *dump = NULL, *dump_error = NULL;
+	char *message = NULL, *dump_error = NULL;
+	size_t size = 0;
+	FILE *s = open_memstream(&message, &size);
+	int i;
+
+	if (*error != NULL)
+		fputs(*error, s);
+	for (i = 0; i < diag->num_dumps; ++i) {
+		const struct packet_dump *dump = &diag->dumps[i];
 
-		if (packet_to_string(packet, format, &dump, &dump_error) == STATUS_OK) {
-			asprintf(error, "%s\n%s packet: %9.6f %s%s%s",
-				 old_error, type, usecs_to_secs(time_usecs), dump,
-				 dump_error ? "\n" : "",
-				 dump_error ? dump_error : "");
+		if (dump->packet->ip_bytes == 0)
+			continue;
+		fprintf(s, "\n%s packet: %9.6f ",
+			dump->type, usecs_to_secs(dump->time_usecs));
+		packet_to_stream(s, dump->packet, format, &dump_error);
+		if (dump_error != NULL) {
+			fprintf(s, "\n%s", dump_error);
+			free(dump_error);
+			dump_error = NULL;
 		}
-		free(dump);
-		free(dump_error);
-		free(old_error);
 	}
+	fclose(s);
+
+	free(*error);
+	*error = message;
 }
 
 /* For verbose runs, print a short packet dump of all live packets. */
@@ -139,16 +181,51 @@ static void verbose_packet_dump(struct state *state, const char *type,
 	}
 }
 
-/* See if the live packet matches the live 4-tuple of the socket under test. */
+/* Record a live packet we injected or sniffed: count it for
+ * --stats_json, and with --pcap_out write it out, noting the script
+ * event we were handling at the time.
+ */
+static void record_live_packet(struct state *state, struct packet *packet,
+			       s64 time_usecs, enum direction_t direction)
+{
+	char comment[256];
+
+	if (state->stats != NULL) {
+		if (direction == DIRECTION_INBOUND)
+			++state->stats->packets_injected;
+		else
+			++state->stats->packets_sniffed;
+	}
+
+	if (state->pcap_writer == NULL)
+		return;
+
+	if (state->event != NULL) {
+		snprintf(comment, sizeof(comment), "%s:%d: script time %.6f",
+			 state->config->script_path, state->event->line_number,
+			 usecs_to_secs(state->event->time_usecs));
+	} else {
+		snprintf(comment, sizeof(comment), "%s: cleanup",
+			 state->config->script_path);
+	}
+	pcapng_write_packet(state->pcap_writer, packet, time_usecs,
+			    direction, comment);
+}
+
+/* See if the live packet matches the live 4-tuple of a known socket.
+ * We check the socket under test first, since that is by far the most
+ * common case, and then fall back to the index of all sockets.
+ */
 static struct socket *find_socket_for_live_packet(
 	struct state *state, const struct packet *packet,
 	enum direction_t *direction)
 {
 	struct socket *socket = state->socket_under_test;	/* shortcut */
 
-	DEBUGP("find_connect_for_live_packet\n");
+	DEBUGP("find_socket_for_live_packet\n");
 	if (socket == NULL)
-		return NULL;
+		return socket_index_find(state->socket_index,
+					 SOCKET_INDEX_LIVE, packet, direction);
 
 	struct tuple packet_tuple, live_outbound, live_inbound;
 	get_packet_tuple(packet, &packet_tuple);
@@ -168,7 +245,8 @@ static struct socket *find_socket_for_live_packet(
 		       socket->state);
 		return socket;
 	}
-	return NULL;
+	return socket_index_find(state->socket_index, SOCKET_INDEX_LIVE,
+				 packet, direction);
 }
 
 static struct socket *setup_new_child_socket(struct state *state, const struct packet *packet) {
@@ -203,9 +281,18 @@ static struct socket *setup_new_child_socket(struct state *state, const struct p
 	socket->live.local.ip		= config->live_local_ip;
 	socket->live.local.port		= htons(config->live_bind_port);
 	socket->live.fd			= -1;
+	socket_index_update(state->socket_index, socket);
 	return socket;
 }
 
+/* Do we run the script's system calls? Wire servers leave them to the
+ * wire client, and replays of a capture have no kernel to run them.
+ */
+static inline bool sees_system_calls(const struct config *config)
+{
+	return !config->is_wire_server && config->replay == NULL;
+}
+
 static inline bool sctp_is_init_packet(const struct packet *packet) {
 	struct sctp_chunk_list_item *item;
 	
@@ -228,6 +315,16 @@ static inline bool sctp_is_init_packet(const struct packet *packet) {
 	return false;
 }
 
+/* Return true iff the packet is a TCP SYN or an SCTP INIT. */
+static inline bool is_connection_request(const struct packet *packet)
+{
+	if (packet->tcp != NULL)
+		return packet->tcp->syn && !packet->tcp->ack;
+	if (packet->sctp != NULL)
+		return sctp_is_init_packet(packet);
+	return false;
+}
+
 static inline void sctp_socket_set_initiate_tag(struct socket *socket, u32 initiate_tag) {
 	socket->script.remote_initiate_tag = initiate_tag;
 	socket->live.remote_initiate_tag = initiate_tag;
@@ -262,9 +359,9 @@ static struct socket *handle_listen_for_script_packet(
 	if (!match)
 		return NULL;
 
-	if (config->is_wire_server) {
-		/* On wire servers we don't see the system calls, so
-		 * we won't have any socket_under_test yet.
+	if (!sees_system_calls(config)) {
+		/* On wire servers and replays we don't see the system
+		 * calls, so we won't have any socket_under_test yet.
 		 */
 		match = (socket == NULL);
 	} else {
@@ -349,19 +446,53 @@ static struct socket *handle_listen_for_script_packet(
 	return socket;
 }
 
-/* See if the socket under test is a connecting socket that would emit
- * this outgoing script SYN. If so, return a pointer to the socket;
+/* Return the socket of the packet's protocol that has been waiting
+ * longest in connect() for its first packet to go out, or NULL.
+ */
+static struct socket *find_connecting_socket(struct state *state,
+					     const struct packet *packet)
+{
+	int protocol = packet_ip_protocol(packet, state->config->udp_encaps);
+	struct socket *socket = NULL, *oldest = NULL;
+
+	/* The list is newest-first, so the last match is the oldest. */
+	for (socket = state->sockets; socket != NULL; socket = socket->next) {
+		if ((socket->state == SOCKET_ACTIVE_CONNECTING) &&
+		    (socket->protocol == protocol))
+			oldest = socket;
+	}
+	return oldest;
+}
+
+/* Return the listening socket of the packet's protocol, if any, that
+ * was most recently created.
+ */
+static struct socket *find_listening_socket(struct state *state,
+					    const struct packet *packet)
+{
+	int protocol = packet_ip_protocol(packet, state->config->udp_encaps);
+	struct socket *socket = NULL;
+
+	for (socket = state->sockets; socket != NULL; socket = socket->next) {
+		if ((socket->state == SOCKET_PASSIVE_LISTENING) &&
+		    (socket->protocol == protocol))
+			return socket;
+	}
+	return NULL;
+}
+
+/* See if the socket under test, or failing that the oldest other
+ * connecting socket, would emit this outgoing script SYN. If so,
+ * anoint it as the socket under test and return a pointer to it;
  * otherwise, return NULL.
  */
 static struct socket *handle_connect_for_script_packet(
 	struct state *state, const struct packet *packet,
 	enum direction_t direction)
 {
-	/* Does this packet match this socket? For now we only support
-	 * testing one socket at a time, so we merely check whether
-	 * the socket is connecting. (If we were to support testing
-	 * more than one socket at a time then we'd want to check to
-	 * see if the address tuples in the packet and socket match.)
+	/* Does this packet match this socket? A connecting socket has
+	 * no script 4-tuple yet, so we go by connect() order: the
+	 * script must list the SYNs in the order of the connect() calls.
 	 */
 	struct config *config = state->config;
 	struct socket *socket = state->socket_under_test;	/* shortcut */
@@ -390,21 +521,27 @@ static struct socket *handle_connect_for_script_packet(
 	if (!match)
 		return NULL;
 
-	if (config->is_wire_server) {
-		/* On wire servers we don't see the system calls, so
-		 * we won't have any socket_under_test yet.
+	if (!sees_system_calls(config)) {
+		/* On wire servers and replays we don't see the system
+		 * calls, so we won't have any socket_under_test yet.
 		 */
 		match = (socket == NULL);
 	} else {
-		/* In local mode we will certainly know about this socket. */
-		match = ((socket != NULL) &&
-			 (socket->state == SOCKET_ACTIVE_CONNECTING));
+		/* In local mode we will certainly know about this socket,
+		 * though with several connects in flight it may not be
+		 * the socket under test.
+		 */
+		if ((socket == NULL) ||
+		    (socket->state != SOCKET_ACTIVE_CONNECTING))
+			socket = find_connecting_socket(state, packet);
+		match = (socket != NULL);
 	}
 	if (!match)
 		return NULL;
+	state->socket_under_test = socket;
 
 	if (socket == NULL) {
-		/* Wire server. Create a socket for this outbound SYN
+		/* Wire server or replay. Create a socket for this outbound SYN
 		 * packet. Any further packets in the test script are
 		 * mapped here.
 		 */
@@ -435,28 +572,17 @@ static struct socket *handle_connect_for_script_packet(
 		socket->script.local_initial_tsn = ntohl(init->initial_tsn);
 		socket->script.local_initiate_tag = ntohl(init->initiate_tag);
 	}
+	socket_index_update(state->socket_index, socket);
 	return socket;
 }
 
-/* Look for a connecting socket that would emit this outgoing live packet. */
-static struct socket *find_connect_for_live_packet(
-	struct state *state, struct packet *packet,
-	enum direction_t *direction)
+/* Return true iff the given connecting socket would emit this
+ * outgoing live packet with the given 4-tuple.
+ */
+static bool is_connect_match_for_live_packet(const struct socket *socket,
+					     const struct packet *packet,
+					     const struct tuple *tuple)
 {
-	struct sctp_chunks_iterator iter;
-	struct sctp_chunk *chunk;
-	struct _sctp_init_chunk *init;
-	struct tuple tuple;
-	char *error;
-
-	DEBUGP("find_connect_for_live_packet\n");
-	get_packet_tuple(packet, &tuple);
-
-	*direction = DIRECTION_INVALID;
-	struct socket *socket = state->socket_under_test;	/* shortcut */
-	if (!socket)
-		return NULL;
-
 	bool is_sctp_match =
 		(packet->sctp &&
 		 (socket->protocol == IPPROTO_SCTP) &&
@@ -475,11 +601,44 @@ static struct socket *find_connect_for_live_packet(
 		 (socket->state == SOCKET_ACTIVE_CONNECTING));
 	if (!is_sctp_match && !is_tcp_match &&
 	    !is_udp_match && !is_udplite_match)
-		return NULL;
+		return false;
 
-	if (!is_equal_ip(&tuple.dst.ip, &socket->live.remote.ip) ||
-	    !is_equal_port(tuple.dst.port, socket->live.remote.port))
-		return NULL;
+	return (is_equal_ip(&tuple->dst.ip, &socket->live.remote.ip) &&
+		is_equal_port(tuple->dst.port, socket->live.remote.port));
+}
+
+/* Look for a connecting socket that would emit this outgoing live
+ * packet: the socket under test if it matches, or else any other
+ * socket whose connection has not yet been assigned a local port.
+ */
+static struct socket *find_connect_for_live_packet(
+	struct state *state, struct packet *packet,
+	enum direction_t *direction)
+{
+	struct sctp_chunks_iterator iter;
+	struct sctp_chunk *chunk;
+	struct _sctp_init_chunk *init;
+	struct tuple tuple;
+	char *error;
+
+	DEBUGP("find_connect_for_live_packet\n");
+	get_packet_tuple(packet, &tuple);
+
+	*direction = DIRECTION_INVALID;
+	struct socket *socket = state->socket_under_test;	/* shortcut */
+	if ((socket == NULL) ||
+	    !is_connect_match_for_live_packet(socket, packet, &tuple)) {
+		for (socket = state->sockets;
+		     socket != NULL;
+		     socket = socket->next) {
+			if ((socket->live.local.port == 0) &&
+			    is_connect_match_for_live_packet(socket, packet,
+							     &tuple))
+				break;
+		}
+		if (socket == NULL)
+			return NULL;
+	}
 
 	*direction = DIRECTION_OUTBOUND;
 	/* Using the details in this outgoing packet, fill in the
@@ -502,6 +661,7 @@ static struct socket *find_connect_for_live_packet(
 			socket->live.local_initial_tsn = ntohl(init->initial_tsn);
 		}
 	}
+	socket_index_update(state->socket_index, socket);
 
 	return socket;
 }
@@ -553,6 +713,70 @@ static int find_tcp_timestamp(struct packet *packet, char **error)
 	return *error ? STATUS_ERR : STATUS_OK;
 }
 
+/* Rewrite the 32-bit big-endian field at 'field' in the layer 4
+ * header of the given packet to 'value', incrementally updating the
+ * packet's checksum if it is being kept current.
+ */
+static void rewrite_l4_be32(struct packet *packet, void *field, u32 value)
+{
+	__be32 old_bytes;
+
+	memcpy(&old_bytes, field, sizeof(old_bytes));
+	put_unaligned_be32(value, field);
+	checksum_packet_update_l4(packet, field, &old_bytes,
+				  sizeof(old_bytes));
+}
+
+/* Like set_packet_tuple(), but incrementally updates the packet's
+ * checksums for the new addresses and ports if they are being kept
+ * current, rather than leaving them for a full re-checksum.
+ */
+static void rewrite_packet_tuple(struct packet *packet,
+				 const struct tuple *tuple, bool encapsulated)
+{
+	struct tuple old_tuple;
+	__be16 *src_port, *dst_port;
+
+	if (!(packet->flags & FLAG_CHECKSUMS_VALID)) {
+		set_packet_tuple(packet, tuple, encapsulated);
+		return;
+	}
+
+	get_packet_tuple(packet, &old_tuple);
+	set_packet_tuple(packet, tuple, encapsulated);
+
+	if (packet->ipv4 != NULL) {
+		checksum_packet_update_ip(packet, &packet->ipv4->src_ip,
+					  &old_tuple.src.ip.ip.v4,
+					  sizeof(struct in_addr));
+		checksum_packet_update_ip(packet, &packet->ipv4->dst_ip,
+					  &old_tuple.dst.ip.ip.v4,
+					  sizeof(struct in_addr));
+	} else {
+		checksum_packet_update_ip(packet, &packet->ipv6->src_ip,
+					  &old_tuple.src.ip.ip.v6,
+					  sizeof(struct in6_addr));
+		checksum_packet_update_ip(packet, &packet->ipv6->dst_ip,
+					  &old_tuple.dst.ip.ip.v6,
+					  sizeof(struct in6_addr));
+	}
+
+	if (packet->tcp != NULL) {
+		src_port = &packet->tcp->src_port;
+		dst_port = &packet->tcp->dst_port;
+	} else if (packet->udp != NULL) {
+		src_port = &packet->udp->src_port;
+		dst_port = &packet->udp->dst_port;
+	} else {
+		src_port = &packet->udplite->src_port;
+		dst_port = &packet->udplite->dst_port;
+	}
+	checksum_packet_update_l4(packet, src_port, &old_tuple.src.port,
+				  sizeof(old_tuple.src.port));
+	checksum_packet_update_l4(packet, dst_port, &old_tuple.dst.port,
+				  sizeof(old_tuple.dst.port));
+}
+
 /* A helper to help translate SACK sequence numbers between live and
  * script space. Specifically, it offsets SACK block sequence numbers
  * by the given 'ack_offset'. Returns STATUS_OK on success; on
@@ -572,13 +796,15 @@ static int offset_sack_blocks(struct packet *packet,
 				return STATUS_ERR;
 			int i = 0;
 			for (i = 0; i < num_blocks; ++i) {
-				u32 val;
-				val = ntohl(option->data.sack.block[i].left);
-				val += ack_offset;
-				option->data.sack.block[i].left = htonl(val);
-				val = ntohl(option->data.sack.block[i].right);
-				val += ack_offset;
-				option->data.sack.block[i].right = htonl(val);
+				__be32 *left = &option->data.sack.block[i].left;
+				__be32 *right = &option->data.sack.block[i].right;
+
+				rewrite_l4_be32(packet, left,
+						get_unaligned_be32(left) +
+						ack_offset);
+				rewrite_l4_be32(packet, right,
+						get_unaligned_be32(right) +
+						ack_offset);
 			}
 		}
 	}
@@ -933,7 +1159,7 @@ static int map_inbound_packet(
 	/* Remap packet to live values. */
 	struct tuple live_inbound;
 	socket_get_inbound(&socket->live, &live_inbound);
-	set_packet_tuple(live_packet, &live_inbound, udp_encaps != 0);
+	rewrite_packet_tuple(live_packet, &live_inbound, udp_encaps != 0);
 
 	if ((live_packet->icmpv4 != NULL) || (live_packet->icmpv6 != NULL))
 		return map_inbound_icmp_packet(socket, live_packet, udp_encaps, error);
@@ -950,15 +1176,15 @@ static int map_inbound_packet(
 	const bool is_syn = live_packet->tcp->syn;
 	const u32 seq_offset = remote_seq_script_to_live_offset(socket, is_syn);
 	if ((live_packet->flags & FLAG_ABSOLUTE_SEQ) == 0) {
-		live_packet->tcp->seq =
-		    htonl(ntohl(live_packet->tcp->seq) + seq_offset);
+		rewrite_l4_be32(live_packet, &live_packet->tcp->seq,
+				ntohl(live_packet->tcp->seq) + seq_offset);
 	}
 
 	/* Remap the ACK and SACKs from script sequence number to live. */
 	const u32 ack_offset = local_seq_script_to_live_offset(socket, is_syn);
 	if (live_packet->tcp->ack)
-		live_packet->tcp->ack_seq =
-			htonl(ntohl(live_packet->tcp->ack_seq) + ack_offset);
+		rewrite_l4_be32(live_packet, &live_packet->tcp->ack_seq,
+				ntohl(live_packet->tcp->ack_seq) + ack_offset);
 	if (offset_sack_blocks(live_packet, ack_offset, error))
 		return STATUS_ERR;
 
@@ -987,7 +1213,8 @@ static int map_inbound_packet(
 				 packet_tcp_ts_ecr(live_packet));
 			return STATUS_ERR;
 		}
-		packet_set_tcp_ts_ecr(live_packet, live_ts_ecr);
+		rewrite_l4_be32(live_packet, live_packet->tcp_ts_ecr,
+				live_ts_ecr);
 	}
 
 	return STATUS_OK;
@@ -995,7 +1222,6 @@ static int map_inbound_packet(
 
 static int map_outbound_live_sctp_packet(
 	struct socket *socket,
-	struct packet *live_packet,
 	struct packet *actual_packet,
 	struct packet *script_packet,
 	char **error)
@@ -1169,22 +1395,24 @@ static int map_outbound_live_sctp_packet(
 	return STATUS_OK;
 }
 
-/* Transforms values in the 'actual_packet' by mapping outbound packet
- * values in the sniffed 'live_packet' (address 4-tuple, sequence
- * number in seq, timestamp value) from live values to script values
- * in the space of 'script_packet'. This will allow us to compare a
- * packet sent by the kernel to the packet expected by the script.
+/* Transforms outbound packet values in the sniffed 'live_packet'
+ * (address 4-tuple, sequence number in seq, timestamp value) in place
+ * from live values to script values in the space of 'script_packet',
+ * making it the "actual" packet. This will allow us to compare a
+ * packet sent by the kernel to the packet expected by the script,
+ * without copying the packet. Each field is read before it is
+ * rewritten, so the live values are gone once this returns.
  */
 static int map_outbound_live_packet(
 	struct socket *socket,
 	struct packet *live_packet,
-	struct packet *actual_packet,
 	struct packet *script_packet,
 	u8 udp_encaps,
 	char **error)
 {
 	DEBUGP("map_outbound_live_packet\n");
 
+	struct packet *actual_packet = live_packet;	/* mapped in place */
 	struct tuple live_packet_tuple, live_outbound, script_outbound;
 
 	/* Verify packet addresses are outbound and live for this socket. */
@@ -1197,7 +1425,7 @@ static int map_outbound_live_packet(
 	set_packet_tuple(actual_packet, &script_outbound, udp_encaps != 0);
 
 	if (live_packet->sctp) {
-		return map_outbound_live_sctp_packet(socket, live_packet, actual_packet, script_packet, error);
+		return map_outbound_live_sctp_packet(socket, actual_packet, script_packet, error);
 	}
 
 	/* If no TCP headers to rewrite, then we're done. */
@@ -2851,7 +3079,9 @@ static int verify_outbound_live_payload(
 }
 
 /* Verify that the outbound packet correctly matches the expected
- * outbound packet from the script.
+ * outbound packet from the script. This rewrites 'live_packet' into
+ * script space, so the caller must not use it afterward except to
+ * free it.
  * Return STATUS_OK upon success.  If non_fatal_packet is unset in the
  * config, return STATUS_ERR upon all failures.  With non_fatal_packet,
  * return STATUS_WARN upon non-fatal failures.
@@ -2865,24 +3095,30 @@ static int verify_outbound_live_packet(
 
 	int result = STATUS_ERR;	/* return value */
 	bool non_fatal = false;		/* ok to continue on error? */
+	struct packet_diagnostics diag = { .num_dumps = 0 };
 	enum event_time_t time_type = state->event->time_type;
 	s64 script_usecs = state->event->time_usecs;
 	s64 script_usecs_end = state->event->time_usecs_end;
 
 	/* The "actual" packet will be the live packet with values
-	 * mapped into script space.
+	 * mapped into script space. We map the live packet in place
+	 * rather than copying it, since the caller is done with it.
 	 */
-	struct packet *actual_packet = packet_copy(live_packet);
+	struct packet *actual_packet = live_packet;
 	s64 actual_usecs = live_time_to_script_time_usecs(
 		state, live_packet->time_usecs);
 
+	/* If we report a problem, show both packets. */
+	add_packet_dump(&diag, "script", script_packet, script_usecs);
+	add_packet_dump(&diag, "actual", actual_packet, actual_usecs);
+
 	/* Before mapping, see if the live outgoing checksums are correct. */
 	if (verify_outbound_live_checksums(live_packet, error))
 		goto out;
 
 	/* Map live packet values into script space for easy comparison. */
 	if (map_outbound_live_packet(
-		    socket, live_packet, actual_packet, script_packet,
+		    socket, live_packet, script_packet,
 		    state->config->udp_encaps, error))
 		goto out;
 
@@ -2911,6 +3147,12 @@ static int verify_outbound_live_packet(
 
 	/* Verify that kernel sent packet at the time the script expected. */
 	DEBUGP("packet time_usecs: %lld\n", live_packet->time_usecs);
+	if (state->stats != NULL && time_type != ANY_TIME) {
+		histogram_record(&state->stats->packet_timing_error,
+				 time_error_usecs(state, time_type,
+						  script_usecs, script_usecs_end,
+						  live_packet->time_usecs));
+	}
 	if (verify_time(state, time_type, script_usecs,
 				script_usecs_end, live_packet->time_usecs,
 				"outbound packet", error)) {
@@ -2918,16 +3160,10 @@ static int verify_outbound_live_packet(
 		goto out;
 	}
 
-	result = STATUS_OK;
+	return STATUS_OK;
 
 out:
-	add_packet_dump(error, "script", script_packet, script_usecs,
-			DUMP_SHORT);
-	if (actual_packet != NULL) {
-		add_packet_dump(error, "actual", actual_packet,
-				actual_usecs, DUMP_SHORT);
-		packet_free(actual_packet);
-	}
+	render_packet_diagnostics(&diag, DUMP_SHORT, error);
 	if (result == STATUS_ERR &&
 	    non_fatal &&
 	    state->config->non_fatal_packet) {
@@ -2936,41 +3172,101 @@ out:
 	return result;
 }
 
-/* Sniff the next outbound live packet and return it. */
+/* Return the script time after which verify_time() would reject the
+ * outbound packet the current event expects, or NO_DEADLINE if there
+ * is no such time: the event accepts any time, or late packets are
+ * only warnings, so we must wait for them to report them.
+ */
+static s64 outbound_packet_deadline(struct state *state)
+{
+	struct event *event = state->event;
+
+	if (event->time_type == ANY_TIME || state->config->non_fatal_packet)
+		return NO_DEADLINE;
+
+	if (event->time_type == ABSOLUTE_RANGE_TIME ||
+	    event->time_type == RELATIVE_RANGE_TIME)
+		return event->time_usecs_end + state->config->tolerance_usecs;
+	return event->time_usecs + state->config->tolerance_usecs;
+}
+
+/* Return the next outbound live packet for the expected socket: one we
+ * parked for it earlier, or else the next one we sniff for it. Packets
+ * we sniff for the script's other sockets are parked for them, so that
+ * the script can list the packets of concurrent flows in any order
+ * that keeps each flow's own packets in order.
+ */
 static int sniff_outbound_live_packet(
 	struct state *state, struct socket *expected_socket,
 	struct packet **packet, char **error)
 {
 	DEBUGP("sniff_outbound_live_packet\n");
 	struct socket *socket = NULL;
+	struct packet *dropped = NULL;
 	enum direction_t direction = DIRECTION_INVALID;
+	s64 script_deadline_usecs = outbound_packet_deadline(state);
+	s64 live_deadline_usecs = NO_DEADLINE;
+	int result;
+
 	assert(*packet == NULL);
+	*packet = socket_unpark_packet(expected_socket);
+	if (*packet != NULL) {
+		DEBUGP("using parked packet\n");
+		return STATUS_OK;
+	}
+
+	if (script_deadline_usecs != NO_DEADLINE)
+		live_deadline_usecs = script_time_to_live_time_usecs(
+			state, script_deadline_usecs);
+
 	while (1) {
-		if (netdev_receive(state->netdev, state->config->udp_encaps,
-				   packet, error))
+		result = netdev_receive(state->netdev, state->packet_pool,
+					state->config->udp_encaps,
+					live_deadline_usecs, packet, error);
+		if (result == STATUS_TIMEOUT) {
+			asprintf(error, "timing error: expected outbound packet "
+				 "at %.6f sec but no packet by %.6f sec",
+				 usecs_to_secs(state->event->time_usecs),
+				 usecs_to_secs(script_deadline_usecs));
 			return STATUS_ERR;
+		}
+		if (result != STATUS_OK)
+			return STATUS_ERR;
+		record_live_packet(state, *packet, (*packet)->time_usecs,
+				   DIRECTION_OUTBOUND);
+		/* A replay's clock moves on with each packet it sees. */
+		if (state->config->replay != NULL)
+			state->replay_now_usecs = max(state->replay_now_usecs,
+						      (*packet)->time_usecs);
 		/* See if the packet matches an existing, known socket. */
 		socket = find_socket_for_live_packet(state, *packet,
 						     &direction);
-		if ((socket != NULL) && (direction == DIRECTION_OUTBOUND))
-			break;
-		/* See if the packet matches a recent connect() call. */
-		socket = find_connect_for_live_packet(state, *packet,
-						      &direction);
-		if ((socket != NULL) && (direction == DIRECTION_OUTBOUND))
-			break;
+		if ((socket == NULL) || (direction != DIRECTION_OUTBOUND)) {
+			/* See if the packet matches a recent connect() call. */
+			socket = find_connect_for_live_packet(state, *packet,
+							      &direction);
+		}
+		if ((socket != NULL) && (direction == DIRECTION_OUTBOUND)) {
+			if (socket == expected_socket)
+				break;
+			/* Hold it until the script gets to that socket. */
+			DEBUGP("parking packet for another socket\n");
+			dropped = socket_park_packet(socket, *packet);
+			*packet = NULL;
+			if (dropped == NULL)
+				continue;
+			*packet = dropped;
+		}
+		/* Not a packet for any socket of ours, or too old to
+		 * still be of interest; keep sniffing.
+		 */
+		if (state->stats != NULL)
+			++state->stats->packets_ignored;
 		packet_free(*packet);
 		*packet = NULL;
 	}
 
 	assert(*packet != NULL);
-	assert(socket != NULL);
-	assert(direction == DIRECTION_OUTBOUND);
-
-	if (socket != expected_socket) {
-		asprintf(error, "packet is not for expected socket");
-		return STATUS_ERR;
-	}
 	return STATUS_OK;
 }
 
@@ -2999,6 +3295,9 @@ static int find_or_create_socket_for_script_packet(
 	enum direction_t direction, struct socket **socket,
 	char **error)
 {
+	enum direction_t socket_direction = DIRECTION_INVALID;
+	struct socket *listener = NULL;
+
 	*socket = NULL;
 
 	DEBUGP("find_or_create_socket_for_script_packet\n");
@@ -3020,6 +3319,30 @@ static int find_or_create_socket_for_script_packet(
 			return STATUS_OK;
 	}
 	/* See if there is an existing connection to handle this packet. */
+	*socket = socket_index_find(state->socket_index, SOCKET_INDEX_SCRIPT,
+				    packet, &socket_direction);
+	if ((*socket != NULL) && (socket_direction == direction)) {
+		state->socket_under_test = *socket;
+		return STATUS_OK;
+	}
+
+	/* Is this a new inbound connection for a listening socket that
+	 * is no longer the socket under test, because we've already
+	 * accepted other connections from it?
+	 */
+	if (sees_system_calls(state->config) &&
+	    is_connection_request(packet) &&
+	    (listener = find_listening_socket(state, packet)) != NULL) {
+		struct socket *old_socket_under_test = state->socket_under_test;
+
+		state->socket_under_test = listener;
+		*socket = handle_listen_for_script_packet(state,
+							  packet, direction);
+		if (*socket != NULL)
+			return STATUS_OK;
+		state->socket_under_test = old_socket_under_test;
+	}
+
 	if (state->socket_under_test != NULL &&
 	    is_script_packet_match_for_socket(state, packet,
 					      state->socket_under_test)) {
@@ -3084,7 +3407,7 @@ static int do_outbound_script_packet(
 		}
 	}
 
-	/* Sniff outbound live packet and verify it's for the right socket. */
+	/* Get the next outbound live packet for this socket. */
 	if (sniff_outbound_live_packet(state, socket, &live_packet, error))
 		goto out;
 
@@ -3239,7 +3562,7 @@ out:
 }
 
 /* Checksum the packet and inject it into the kernel under test. */
-static int send_live_ip_packet(struct netdev *netdev,
+static int send_live_ip_packet(struct state *state,
 			       struct packet *packet)
 {
 	assert(packet->ip_bytes > 0);
@@ -3249,10 +3572,77 @@ static int send_live_ip_packet(struct netdev *netdev,
 	assert(packet->sctp || packet->tcp || packet->udp || packet->udplite ||
 	       packet->icmpv4 || packet->icmpv6);
 
-	/* Fill in layer 3 and layer 4 checksums */
-	checksum_packet(packet);
+	/* Fill in layer 3 and layer 4 checksums, unless they were filled
+	 * in ahead of time and have been kept current since then.
+	 */
+	if (!(packet->flags & FLAG_CHECKSUMS_VALID))
+		checksum_packet(packet);
+
+	record_live_packet(state, packet, live_now_usecs(state),
+			   DIRECTION_INBOUND);
+	return netdev_send(state->netdev, packet);
+}
+
+/* Is the event after the given one an inbound packet due at the same
+ * script time (the same absolute time, or "+0"), so that we can
+ * inject both packets back to back?
+ */
+static bool next_event_joins_batch(const struct event *event)
+{
+	const struct event *next = event->next;
+
+	if (next == NULL || next->type != PACKET_EVENT ||
+	    packet_direction(next->event.packet) != DIRECTION_INBOUND)
+		return false;
+	if (next->time_type == RELATIVE_TIME)
+		return next->time_usecs == 0;
+	return (next->time_type == ABSOLUTE_TIME) &&
+	       (next->time_usecs == event->time_usecs);
+}
+
+/* Free the packets in the inbound batch and empty it. */
+static void free_inbound_batch(struct state *state)
+{
+	int i;
+
+	for (i = 0; i < state->num_inbound_batch; ++i)
+		packet_free(state->inbound_batch[i]);
+	state->num_inbound_batch = 0;
+}
+
+/* Inject all the packets in the inbound batch into the kernel. */
+static int flush_inbound_batch(struct state *state)
+{
+	int result;
 
-	return netdev_send(netdev, packet);
+	DEBUGP("injecting batch of %d packets\n", state->num_inbound_batch);
+	result = netdev_send_batch(state->netdev, state->inbound_batch,
+				   state->num_inbound_batch);
+	free_inbound_batch(state);
+	return result;
+}
+
+/* Checksum the packet and add it to the inbound batch, which takes
+ * ownership of it. Unless the next event in the script injects
+ * another packet at the same time, inject the whole batch, so that a
+ * train of packets goes out in one burst rather than having each
+ * packet scheduled separately.
+ */
+static int queue_live_ip_packet(struct state *state, struct packet *packet)
+{
+	if (!(packet->flags & FLAG_CHECKSUMS_VALID))
+		checksum_packet(packet);
+
+	record_live_packet(state, packet, live_now_usecs(state),
+			   DIRECTION_INBOUND);
+
+	assert(state->num_inbound_batch < NETDEV_MAX_BATCH);
+	state->inbound_batch[state->num_inbound_batch++] = packet;
+
+	if ((state->num_inbound_batch < NETDEV_MAX_BATCH) &&
+	    next_event_joins_batch(state->event))
+		return STATUS_OK;
+	return flush_inbound_batch(state);
 }
 
 /* Perform the action implied by an inbound packet in a script */
@@ -3399,7 +3789,8 @@ static int do_inbound_script_packet(
 	}
 
 	/* Start with a bit-for-bit copy of the packet from the script. */
-	struct packet *live_packet = packet_copy(packet);
+	struct packet *live_packet = packet_copy_in_pool(state->packet_pool,
+							 packet);
 	/* Map packet fields from script values to live values. */
 	if (map_inbound_packet(socket, live_packet, state->config->udp_encaps,
 			       error))
@@ -3407,7 +3798,7 @@ static int do_inbound_script_packet(
 
 	verbose_packet_dump(state, "inbound injected", live_packet,
 			    live_time_to_script_time_usecs(
-				    state, now_usecs()));
+				    state, live_now_usecs(state)));
 
 	if (live_packet->tcp) {
 		/* Save the TCP header so we can reset the connection later. */
@@ -3440,11 +3831,11 @@ static int do_inbound_script_packet(
 			DEBUGP("socket_under_test = %p\n", state->socket_under_test);
 			state->socket_under_test = setup_new_child_socket(state, packet);
 			socket_get_inbound(&state->socket_under_test->live, &live_inbound);
-			set_packet_tuple(live_packet, &live_inbound, state->config->udp_encaps != 0);
+			rewrite_packet_tuple(live_packet, &live_inbound, state->config->udp_encaps != 0);
 	}
 
-	/* Inject live packet into kernel. */
-	result = send_live_ip_packet(state->netdev, live_packet);
+	/* Inject live packet into kernel, possibly along with others. */
+	return queue_live_ip_packet(state, live_packet);
 
 out:
 	packet_free(live_packet);
@@ -3481,7 +3872,19 @@ int run_packet_event(
 		else if (result == STATUS_ERR)
 			goto out;
 	} else if (direction == DIRECTION_INBOUND) {
-		wait_for_event(state);
+		/* Checksum TCP and UDP packets before we wait, so that
+		 * remapping them to live values at the scheduled time
+		 * only needs incremental checksum updates, whose cost
+		 * does not depend on the payload size.
+		 */
+		if ((packet->tcp != NULL) || (packet->udp != NULL) ||
+		    (packet->udplite != NULL))
+			checksum_packet(packet);
+		/* Later packets in a batch were due when the first one
+		 * was, so only the first one waits.
+		 */
+		if (state->num_inbound_batch == 0)
+			wait_for_event(state);
 		if (do_inbound_script_packet(state, packet, socket, &err))
 			goto out;
 	} else {
@@ -3491,6 +3894,9 @@ int run_packet_event(
 	return STATUS_OK;	 /* everything went fine */
 
 out:
+	/* Drop any packets we were holding for a batch. */
+	free_inbound_batch(state);
+
 	/* Format a more complete error message and return that. */
 	asprintf(error, "%s:%d: %s handling packet: %s\n",
 		 state->config->script_path, event->line_number,
@@ -3565,7 +3971,7 @@ int reset_connection(struct state *state, struct socket *socket)
 	set_packet_tuple(packet, &live_inbound, state->config->udp_encaps != 0);
 
 	/* Inject live packet into kernel. */
-	result = send_live_ip_packet(state->netdev, packet);
+	result = send_live_ip_packet(state, packet);
 
 	packet_free(packet);
 
@@ -3628,7 +4034,7 @@ int abort_association(struct state *state, struct socket *socket)
 	}
 
 	/* Inject live packet into kernel. */
-	result = send_live_ip_packet(state->netdev, packet);
+	result = send_live_ip_packet(state, packet);
 
 	packet_free(packet);
 
@@ -1639,6 +1639,26 @@ static int pollfds_check(struct expression *fds_expression,
 	return STATUS_OK;
 }
 
+/* Return the syscall thread that is handling the given blocking
+ * system call. Must be called with the global lock held.
+ */
+static struct syscall_thread *find_syscall_thread(struct state *state,
+						  struct syscall_spec *syscall)
+{
+	struct syscalls *syscalls = state->syscalls;
+	int i;
+
+	for (i = 0; i < syscalls->num_threads; ++i) {
+		struct syscall_thread *thread = &syscalls->threads[i];
+
+		if ((thread->event != NULL) &&
+		    (thread->event->event.syscall == syscall))
+			return thread;
+	}
+	assert(!"blocking system call without a syscall thread");
+	return NULL;
+}
+
 /* For blocking system calls, give up the global lock and wake the
  * main thread so it can continue test execution. Callers should call
  * this function immediately before calling a system call in order to
@@ -1648,12 +1668,19 @@ static int pollfds_check(struct expression *fds_expression,
 static void begin_syscall(struct state *state, struct syscall_spec *syscall)
 {
 	if (is_blocking_syscall(syscall)) {
-		assert(state->syscalls->state == SYSCALL_ENQUEUED);
-		state->syscalls->state = SYSCALL_RUNNING;
+		struct syscall_thread *thread =
+			find_syscall_thread(state, syscall);
+
+		assert(thread->state == SYSCALL_ENQUEUED);
+		if (state->stats != NULL)
+			thread->live_start_usecs = now_usecs();
+		thread->state = SYSCALL_RUNNING;
 		run_unlock(state);
 		DEBUGP("syscall thread: begin_syscall signals dequeued\n");
 		if (pthread_cond_signal(&state->syscalls->dequeued) != 0)
 			die_perror("pthread_cond_signal");
+	} else if (state->stats != NULL) {
+		state->syscalls->live_start_usecs = now_usecs();
 	}
 }
 
@@ -1676,11 +1703,22 @@ static int end_syscall(struct state *state, struct syscall_spec *syscall,
 	/* For blocking calls, advance state and reacquire the global lock. */
 	if (is_blocking_syscall(syscall)) {
 		s64 live_end_usecs = now_usecs();
+		struct syscall_thread *thread;
+
 		DEBUGP("syscall thread: end_syscall grabs lock\n");
 		run_lock(state);
-		state->syscalls->live_end_usecs = live_end_usecs;
-		assert(state->syscalls->state == SYSCALL_RUNNING);
-		state->syscalls->state = SYSCALL_DONE;
+		thread = find_syscall_thread(state, syscall);
+		thread->live_end_usecs = live_end_usecs;
+		assert(thread->state == SYSCALL_RUNNING);
+		thread->state = SYSCALL_DONE;
+		if (state->stats != NULL)
+			histogram_record(&state->stats->syscall_duration,
+					 live_end_usecs -
+					 thread->live_start_usecs);
+	} else if (state->stats != NULL) {
+		histogram_record(&state->stats->syscall_duration,
+				 now_usecs() -
+				 state->syscalls->live_start_usecs);
 	}
 
 	/* Compare actual vs expected return value */
@@ -1965,9 +2003,13 @@ static int run_syscall_accept(struct state *state,
 #endif
 		    (socket->state == SOCKET_PASSIVE_SYNACK_ACKED) ||
 		    (socket->state == SOCKET_PASSIVE_COOKIE_ECHO_RECEIVED)) {
-			assert(is_equal_ip(&socket->live.remote.ip, &ip));
-			assert(is_equal_port(socket->live.remote.port,
-					     htons(port)));
+			/* With several connections pending, accept()
+			 * may return them in any order.
+			 */
+			if (!is_equal_ip(&socket->live.remote.ip, &ip) ||
+			    !is_equal_port(socket->live.remote.port,
+					   htons(port)))
+				continue;
 			socket->script.fd	= script_accepted_fd;
 			socket->live.fd		= live_accepted_fd;
 			return STATUS_OK;
@@ -1997,6 +2039,7 @@ static int run_syscall_accept(struct state *state,
 
 	socket->live.fd			= live_accepted_fd;
 	socket->script.fd		= script_accepted_fd;
+	socket_index_update(state->socket_index, socket);
 
 #if defined(DEBUG)
 	if (debug_logging) {
@@ -2058,6 +2101,7 @@ static int run_syscall_connect(struct state *state,
 	socket->script.local.port		= 0;
 	socket->live.remote.ip   = state->config->live_remote_ip;
 	socket->live.remote.port = htons(state->config->live_connect_port);
+	socket_index_update(state->socket_index, socket);
 	DEBUGP("success: setting socket to state %d\n", socket->state);
 	return STATUS_OK;
 }
@@ -2082,6 +2126,8 @@ static int run_syscall_sctp_peeloff(struct state *state,
 
 	memcpy(new_socket, copy_socket, sizeof(struct socket));
 	new_socket->next = temp_socket;
+	/* The association stays indexed under the original socket. */
+	memset(new_socket->index_links, 0, sizeof(new_socket->index_links));
 	new_socket->live.fd		= live_new_fd;
 	new_socket->script.fd		= script_new_fd;
 	DEBUGP("success: setting socket to state %d\n", new_socket->state);
@@ -6927,7 +6973,30 @@ struct system_call_entry system_call_table[] = {
 	{"sctp_recvv",      syscall_sctp_recvv}
 };
 
-/* Evaluate the system call arguments and invoke the system call. */
+void prepare_system_call(struct syscall_spec *syscall)
+{
+	char *error = NULL;
+	int i = 0;
+
+	for (i = 0; i < ARRAY_SIZE(system_call_table); ++i) {
+		if (strcmp(syscall->name, system_call_table[i].name) == 0) {
+			syscall->handler = system_call_table[i].function;
+			break;
+		}
+	}
+
+	/* Script symbolic expressions only depend on the script itself,
+	 * so they can all be evaluated ahead of time. If that fails,
+	 * leave them to be evaluated (and the error reported) later.
+	 */
+	if (evaluate_expression_list(syscall->arguments,
+				     &syscall->evaluated_arguments, &error))
+		free(error);
+}
+
+/* Invoke the system call, with its handler and arguments as prepared
+ * by prepare_system_call().
+ */
 static void invoke_system_call(
 	struct state *state, struct event *event, struct syscall_spec *syscall)
 {
@@ -6936,29 +7005,28 @@ static void invoke_system_call(
 	char *error = NULL, *script_path = NULL;
 	const char *name = syscall->name;
 	struct expression_list *args = NULL;
-	int i = 0;
 	int result = 0;
 
 	/* Wait for the right time before firing off this event. */
 	wait_for_event(state);
 
-	/* Find and invoke the handler for this system call. */
-	for (i = 0; i < ARRAY_SIZE(system_call_table); ++i)
-		if (strcmp(name, system_call_table[i].name) == 0)
-			break;
-	if (i == ARRAY_SIZE(system_call_table)) {
+	if (syscall->handler == NULL) {
 		asprintf(&error, "Unknown system call: '%s'", name);
 		goto error_out;
 	}
 
-	/* Evaluate script symbolic expressions to get live numeric args for
-	 * system calls.
+	/* Take ownership of the live numeric args for the system call,
+	 * evaluating script symbolic expressions now if that was not
+	 * possible at parse time.
 	 */
-	if (evaluate_expression_list(syscall->arguments, &args, &error))
+	args = syscall->evaluated_arguments;
+	syscall->evaluated_arguments = NULL;
+	if ((args == NULL) &&
+	    evaluate_expression_list(syscall->arguments, &args, &error))
 		goto error_out;
 
 	/* Run the system call. */
-	result = system_call_table[i].function(state, syscall, args, &error);
+	result = syscall->handler(state, syscall, args, &error);
 
 	free_expression_list(args);
 
@@ -6976,15 +7044,69 @@ error_out:
 	free(error);
 }
 
-/* Wait for the system call thread to go idle. To avoid mystifying
- * hangs when scripts specify overlapping time ranges for blocking
- * system calls, we limit the duration of our waiting to 1 second.
+static void *system_call_thread(void *arg);
+
+/* Start another syscall thread, and return it. */
+static struct syscall_thread *start_syscall_thread(struct state *state)
+{
+	struct syscalls *syscalls = state->syscalls;
+	struct syscall_thread *thread;
+
+	assert(syscalls->num_threads < MAX_SYSCALL_THREADS);
+	thread = &syscalls->threads[syscalls->num_threads];
+	thread->state = SYSCALL_IDLE;
+	thread->run_state = state;
+
+	if (pthread_cond_init(&thread->enqueued, NULL) != 0)
+		die_perror("pthread_cond_init");
+
+	if (pthread_create(&thread->thread, NULL, system_call_thread,
+			   thread) != 0) {
+		die_perror("pthread_create");
+	}
+
+	++syscalls->num_threads;
+	return thread;
+}
+
+/* Return an idle syscall thread, or NULL if there is none. */
+static struct syscall_thread *find_idle_thread(struct syscalls *syscalls)
+{
+	int i;
+
+	for (i = 0; i < syscalls->num_threads; ++i) {
+		if (syscalls->threads[i].state == SYSCALL_IDLE)
+			return &syscalls->threads[i];
+	}
+	return NULL;
+}
+
+/* Return the first syscall thread that is busy with a system call,
+ * or NULL if they are all idle.
+ */
+static struct syscall_thread *find_busy_thread(struct syscalls *syscalls)
+{
+	int i;
+
+	for (i = 0; i < syscalls->num_threads; ++i) {
+		if (syscalls->threads[i].state != SYSCALL_IDLE)
+			return &syscalls->threads[i];
+	}
+	return NULL;
+}
+
+/* Wait until a syscall thread goes idle. If 'any' is true, return as
+ * soon as any thread is idle; otherwise wait for all of them. To avoid
+ * mystifying hangs when scripts specify overlapping time ranges for
+ * more blocking system calls than we have threads, we limit the
+ * duration of our waiting to 1 second.
  */
-static int await_idle_thread(struct state *state)
+static int await_idle_threads(struct state *state, bool any)
 {
 	struct timespec end_time = { .tv_sec = 0, .tv_nsec = 0 };
 	const int MAX_WAIT_SECS = 1;
-	while (state->syscalls->state != SYSCALL_IDLE) {
+	while (any ? (find_idle_thread(state->syscalls) == NULL) :
+		     (find_busy_thread(state->syscalls) != NULL)) {
 		/* On the first time through the loop, calculate end time. */
 		if (end_time.tv_sec == 0) {
 /* clock_gettime is available in MacOS 10.12 and higher. */
@@ -7012,6 +7134,25 @@ static int await_idle_thread(struct state *state)
 	return STATUS_OK;
 }
 
+/* Return an idle syscall thread to run a blocking system call,
+ * starting a new one if all of them are busy. If we already have the
+ * maximum number of threads, wait for one of them to go idle; on
+ * timeout return NULL.
+ */
+static struct syscall_thread *get_idle_thread(struct state *state)
+{
+	struct syscalls *syscalls = state->syscalls;
+	struct syscall_thread *thread = find_idle_thread(syscalls);
+
+	if (thread != NULL)
+		return thread;
+	if (syscalls->num_threads < MAX_SYSCALL_THREADS)
+		return start_syscall_thread(state);
+	if (await_idle_threads(state, true))
+		return NULL;
+	return find_idle_thread(syscalls);
+}
+
 #if !defined(__SunOS_5_11)
 static int yield(void)
 {
@@ -7029,30 +7170,36 @@ static int yield(void)
 }
 #endif
 
-/* Enqueue the system call for the syscall thread and wake up the thread. */
+/* Enqueue the system call for an idle syscall thread and wake up
+ * that thread.
+ */
 static void enqueue_system_call(
 	struct state *state, struct event *event, struct syscall_spec *syscall)
 {
 	char *error = NULL, *script_path = NULL;
+	struct syscall_thread *thread = NULL;
 	bool done = false;
 
-	/* Wait if there are back-to-back blocking system calls. */
-	if (await_idle_thread(state)) {
-		asprintf(&error, "blocking system call while another blocking "
-			 "system call is already in progress");
+	/* Wait if all syscall threads are busy with blocking calls. */
+	thread = get_idle_thread(state);
+	if (thread == NULL) {
+		asprintf(&error, "blocking system call while %d other "
+			 "blocking system calls are already in progress",
+			 MAX_SYSCALL_THREADS);
 		goto error_out;
 	}
 
 	/* Enqueue the system call info and wake up the syscall thread. */
 	DEBUGP("main thread: signal enqueued\n");
-	state->syscalls->state = SYSCALL_ENQUEUED;
-	if (pthread_cond_signal(&state->syscalls->enqueued) != 0)
+	thread->event = event;
+	thread->state = SYSCALL_ENQUEUED;
+	if (pthread_cond_signal(&thread->enqueued) != 0)
 		die_perror("pthread_cond_signal");
 
 	/* Wait for the syscall thread to dequeue and start the system call. */
-	while (state->syscalls->state == SYSCALL_ENQUEUED) {
+	while (thread->state == SYSCALL_ENQUEUED) {
 		DEBUGP("main thread: waiting for dequeued signal; "
-		       "state: %d\n", state->syscalls->state);
+		       "state: %d\n", thread->state);
 		if (pthread_cond_wait(&state->syscalls->dequeued,
 				      &state->mutex) != 0) {
 			die_perror("pthread_cond_wait");
@@ -7075,7 +7222,7 @@ static void enqueue_system_call(
 		 * the system call in a timely fashion.
 		 */
 		DEBUGP("main thread: unlocking and yielding\n");
-		thread_id = state->syscalls->thread_id;
+		thread_id = thread->thread_id;
 		run_unlock(state);
 #if defined(__SunOS_5_11)
 		yield();
@@ -7091,7 +7238,7 @@ static void enqueue_system_call(
 		/* Grab the lock again and see if the thread is idle. */
 		DEBUGP("main thread: locking and reading state\n");
 		run_lock(state);
-		if (state->syscalls->state == SYSCALL_IDLE)
+		if (thread->state == SYSCALL_IDLE)
 			done = true;
 	}
 	DEBUGP("main thread: continuing after syscall\n");
@@ -7118,12 +7265,13 @@ void run_system_call_event(
 		invoke_system_call(state, event, syscall);
 }
 
-/* The code executed by our system call thread, which executes
+/* The code executed by each of our system call threads, which execute
  * blocking system calls.
  */
 static void *system_call_thread(void *arg)
 {
-	struct state *state = (struct state *)arg;
+	struct syscall_thread *thread = (struct syscall_thread *)arg;
+	struct state *state = thread->run_state;
 	char *error = NULL;
 	struct event *event = NULL;
 	struct syscall_spec *syscall = NULL;
@@ -7138,25 +7286,24 @@ static void *system_call_thread(void *arg)
 	run_lock(state);
 
 #if defined(linux)
-	state->syscalls->thread_id = gettid();
-	if (state->syscalls->thread_id < 0)
+	thread->thread_id = gettid();
+	if (thread->thread_id < 0)
 		die_perror("gettid");
 #elif defined(__FreeBSD__)
-	state->syscalls->thread_id = pthread_getthreadid_np();
+	thread->thread_id = pthread_getthreadid_np();
 #elif defined(__APPLE__)
-	state->syscalls->thread_id = pthread_mach_thread_np(pthread_self());
+	thread->thread_id = pthread_mach_thread_np(pthread_self());
 #else
-	state->syscalls->thread_id = 0;		/* FIXME */
+	thread->thread_id = 0;		/* FIXME */
 #endif
 
 	while (!done) {
-		DEBUGP("syscall thread: in state %d\n",
-		       state->syscalls->state);
+		DEBUGP("syscall thread: in state %d\n", thread->state);
 
-		switch (state->syscalls->state) {
+		switch (thread->state) {
 		case SYSCALL_IDLE:
 			DEBUGP("syscall thread: waiting\n");
-			if (pthread_cond_wait(&state->syscalls->enqueued,
+			if (pthread_cond_wait(&thread->enqueued,
 					      &state->mutex)) {
 				die_perror("pthread_cond_wait");
 			}
@@ -7169,15 +7316,15 @@ static void *system_call_thread(void *arg)
 
 		case SYSCALL_ENQUEUED:
 			DEBUGP("syscall thread: invoking syscall\n");
-			/* Remember the syscall event, since below we
-			 * release the global lock and the main thread
-			 * will move on to other, later events.
+			/* The main thread handed us the syscall event;
+			 * below we release the global lock and the
+			 * main thread will move on to other, later
+			 * events.
 			 */
-			event = state->event;
+			event = thread->event;
 			syscall = event->event.syscall;
 			assert(event->type == SYSCALL_EVENT);
-			state->syscalls->event = event;
-			state->syscalls->live_end_usecs = -1;
+			thread->live_end_usecs = -1;
 
 			/* Make the system call. Note that our callees
 			 * here will release the global lock before
@@ -7188,12 +7335,13 @@ static void *system_call_thread(void *arg)
 			invoke_system_call(state, event, syscall);
 
 			/* Check end time for the blocking system call. */
-			assert(state->syscalls->live_end_usecs >= 0);
+			assert(thread->live_end_usecs >= 0);
 			if (verify_time(state,
 						event->time_type,
 						syscall->end_usecs, 0,
-						state->syscalls->live_end_usecs,
+						thread->live_end_usecs,
 						"system call return", &error)) {
+				state_write_stats(state, false);
 				die("%s:%d: %s\n",
 				    state->config->script_path,
 				    event->line_number,
@@ -7204,10 +7352,10 @@ static void *system_call_thread(void *arg)
 			 * thread if it's waiting for this call to
 			 * finish.
 			 */
-			assert(state->syscalls->state == SYSCALL_DONE);
-			state->syscalls->state = SYSCALL_IDLE;
-			state->syscalls->event = NULL;
-			state->syscalls->live_end_usecs = -1;
+			assert(thread->state == SYSCALL_DONE);
+			thread->state = SYSCALL_IDLE;
+			thread->event = NULL;
+			thread->live_end_usecs = -1;
 			DEBUGP("syscall thread: now idle\n");
 			if (pthread_cond_signal(&state->syscalls->idle) != 0)
 				die_perror("pthread_cond_signal");
@@ -7229,56 +7377,69 @@ struct syscalls *syscalls_new(struct state *state)
 {
 	struct syscalls *syscalls = calloc(1, sizeof(struct syscalls));
 
-	syscalls->state = SYSCALL_IDLE;
-
-	if (pthread_create(&syscalls->thread, NULL, system_call_thread,
-			   state) != 0) {
-		die_perror("pthread_create");
-	}
-
 	if ((pthread_cond_init(&syscalls->idle, NULL) != 0) ||
-	    (pthread_cond_init(&syscalls->enqueued, NULL) != 0) ||
 	    (pthread_cond_init(&syscalls->dequeued, NULL) != 0)) {
 		die_perror("pthread_cond_init");
 	}
 
+	/* Start with one syscall thread; more are started on demand. */
+	state->syscalls = syscalls;
+	start_syscall_thread(state);
+
 	return syscalls;
 }
 
 void syscalls_free(struct state *state, struct syscalls *syscalls, int about_to_die)
 {
-	int status;
+	struct syscall_thread *busy;
+	int status, i;
 
-	/* Wait a bit for the thread to go idle. */
-	status = await_idle_thread(state);
+	/* Wait a bit for the threads to go idle. */
+	status = await_idle_threads(state, false);
+	busy = find_busy_thread(syscalls);
 	if ((status == STATUS_ERR) && (about_to_die == 0)) {
+		state_write_stats(state, false);
 		die("%s:%d: runtime error: exiting while "
 		    "a blocking system call is in progress\n",
 		    state->config->script_path,
-		    syscalls->event->line_number);
+		    busy->event->line_number);
 	}
 
-	if (status == STATUS_ERR) {
-		/* Canceling the thread. */
-		DEBUGP("main thread: canceling syscall thread \n");
-		pthread_cancel(syscalls->thread);
-	} else {
-		/* Send a request to terminate the thread. */
-		DEBUGP("main thread: signaling syscall thread to exit\n");
-		syscalls->state = SYSCALL_EXITING;
-		if (pthread_cond_signal(&syscalls->enqueued) != 0)
-			die_perror("pthread_cond_signal");
+	for (i = 0; i < syscalls->num_threads; ++i) {
+		struct syscall_thread *thread = &syscalls->threads[i];
+
+		if (thread->state != SYSCALL_IDLE) {
+			/* Canceling the thread. */
+			DEBUGP("main thread: canceling syscall thread \n");
+			if (!pthread_equal(thread->thread, pthread_self()))
+				pthread_cancel(thread->thread);
+		} else {
+			/* Send a request to terminate the thread. */
+			DEBUGP("main thread: signaling syscall thread to exit\n");
+			thread->state = SYSCALL_EXITING;
+			if (pthread_cond_signal(&thread->enqueued) != 0)
+				die_perror("pthread_cond_signal");
+		}
 	}
-	/* Release the lock briefly and wait for syscall thread to finish. */
+	/* Release the lock briefly and wait for syscall threads to finish. */
 	run_unlock(state);
 	DEBUGP("main thread: unlocking, waiting for syscall thread exit\n");
-	void *thread_result = NULL;
-	if (pthread_join(syscalls->thread, &thread_result) != 0)
-		die_perror("pthread_cancel");
-	DEBUGP("main thread: joined syscall thread; relocking\n");
+	for (i = 0; i < syscalls->num_threads; ++i) {
+		struct syscall_thread *thread = &syscalls->threads[i];
+		void *thread_result = NULL;
+
+		if (pthread_equal(thread->thread, pthread_self()))
+			continue;
+		if (pthread_join(thread->thread, &thread_result) != 0)
+			die_perror("pthread_join");
+	}
+	DEBUGP("main thread: joined syscall threads; relocking\n");
 	run_lock(state);
+	for (i = 0; i < syscalls->num_threads; ++i) {
+		if (pthread_cond_destroy(&syscalls->threads[i].enqueued) != 0)
+			die_perror("pthread_cond_destroy");
+	}
 	if ((pthread_cond_destroy(&syscalls->idle) != 0) ||
-	    (pthread_cond_destroy(&syscalls->enqueued) != 0) ||
 	    (pthread_cond_destroy(&syscalls->dequeued) != 0)) {
 		die_perror("pthread_cond_destroy");
 	}
@@ -32,7 +32,14 @@
 
 struct state;
 
-/* States in which the system call thread can be. */
+/* The maximum number of blocking system calls that may be in progress
+ * at once. Each runs in its own syscall thread; threads are started
+ * as needed, the first time a script has that many blocking calls
+ * outstanding.
+ */
+#define MAX_SYSCALL_THREADS	16
+
+/* States in which a system call thread can be. */
 enum syscall_state_t {
 	SYSCALL_IDLE,		/* system call thread is idle */
 	SYSCALL_ENQUEUED,	/* blocking system call is ready to execute */
@@ -41,15 +48,15 @@ enum syscall_state_t {
 	SYSCALL_EXITING,	/* process is exiting */
 };
 
-/* Internal state for the system call module, including the "syscall
- * thread", which handles blocking system calls.
- */
-struct syscalls {
+/* A "syscall thread", which handles one blocking system call at a time. */
+struct syscall_thread {
 	enum syscall_state_t state;	/* current state of syscall thread */
 	struct event *event;		/* current system call it's running */
+	s64 live_start_usecs;		/* time of last system call entry */
 	s64 live_end_usecs;		/* time of last system call return */
+	struct state *run_state;	/* interpreter state we run for */
 
-	/* Handles for the syscall thread, for blocking system calls. */
+	/* Handles for the syscall thread. */
 	pthread_t thread;		/* pthread thread handle */
 #if defined(linux)
 	pid_t thread_id;		/* kernel thread ID  */
@@ -61,23 +68,35 @@ struct syscalls {
 	int thread_id;			/* FIXME */
 #endif
 
-	/* The main thread waits on this condition variable. The
-	 * system call thread signals this when it has finished
-	 * executing a blocking system call and is now idle and ready
-	 * to execute another blocking system call.
-	 */
-	pthread_cond_t idle;
-
 	/* The system call thread waits on this condition
 	 * variable. The main thread signals this when it has enqueued
-	 * a blocking system call to execute, and thus the system call
-	 * thread should wake up and execute that system call. The
+	 * a blocking system call for this thread to execute, and thus
+	 * the thread should wake up and execute that system call. The
 	 * main thread also signals this when it's time to exit.
 	 */
 	pthread_cond_t enqueued;
+};
 
-	/* The main thread waits on this condition variable. The
-	 * system call thread signals this after it has dequeued the
+/* Internal state for the system call module, including the pool of
+ * syscall threads, which handle blocking system calls.
+ */
+struct syscalls {
+	struct syscall_thread threads[MAX_SYSCALL_THREADS];
+	int num_threads;		/* number of threads started */
+	s64 live_start_usecs;		/* entry time of the non-blocking
+					 * call on the main thread, for
+					 * --stats_json
+					 */
+
+	/* The main thread waits on this condition variable. A
+	 * system call thread signals this when it has finished
+	 * executing a blocking system call and is now idle and ready
+	 * to execute another blocking system call.
+	 */
+	pthread_cond_t idle;
+
+	/* The main thread waits on this condition variable. A
+	 * system call thread signals this after it has dequeued its
 	 * system call and just before it invokes the system call, at
 	 * which point the main thread should wake up to continue test
 	 * execution.
@@ -93,12 +112,22 @@ extern void syscalls_free(struct state *state,
 			  struct syscalls *syscalls,
 			  int about_to_die);
 
+/* Called by the parser for each system call in a script: look up the
+ * handler for the call and evaluate its arguments up front, so that
+ * doing so does not take time while the script is running. Errors
+ * are not reported here but when the system call is invoked, as
+ * before.
+ */
+extern void prepare_system_call(struct syscall_spec *syscall);
+
 /* Execute the given system call event. The system call may be
  * expected to block for a while, or it may be expected to return
- * immediately. To keep things simple, currently we only support
- * at most one blocking system call at a time; if a script attempts to
- * start a second blocking call before the first blocking call has
- * returned then this second call raises a runtime error.
+ * immediately. Each blocking system call runs in a syscall thread of
+ * its own, so up to MAX_SYSCALL_THREADS of them may be in progress
+ * concurrently (e.g. several threads blocked in accept() on the same
+ * listener); if a script attempts to start more than that, the extra
+ * call waits briefly for one to return and then raises a runtime
+ * error.
  */
 void run_system_call_event(struct state *state,
 			   struct event *event,
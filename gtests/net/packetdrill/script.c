@@ -26,9 +26,12 @@
 
 #include <fcntl.h>
 #include <poll.h>
+#include <pthread.h>
 #include <stdlib.h>
+#include <sys/mman.h>
 
 #include "assert.h"
+#include "logging.h"
 #include "symbols.h"
 
 /* Fill in a value representing the given expression in
@@ -47,6 +50,32 @@ void init_script(struct script *script)
 	script->event_list = NULL;
 }
 
+void script_free(struct script *script)
+{
+	struct event *event;
+
+	/* Everything the parser built is in the arena (or the cached
+	 * image), apart from the heap-allocated objects some events
+	 * point to.
+	 */
+	for (event = script->event_list; event != NULL; event = event->next) {
+		if (event->type == PACKET_EVENT && script->image == NULL) {
+			packet_free(event->event.packet);
+		} else if (event->type == SYSCALL_EVENT) {
+			free_expression_list(
+				event->event.syscall->evaluated_arguments);
+		}
+	}
+	if (script->cleanup_command != NULL &&
+	    cleanup_cmd == script->cleanup_command->command_line)
+		cleanup_cmd = NULL;
+	free(script->buffer);
+	arena_free(script->arena);
+	if (script->image != NULL)
+		munmap(script->image, script->image_bytes);
+	init_script(script);
+}
+
 /* This table maps expression types to human-readable strings */
 struct expression_type_entry {
 	enum expression_t type;
@@ -164,29 +193,70 @@ struct int_symbol cross_platform_symbols[] = {
 	{ 0, NULL },
 };
 
+/* All the symbols from cross_platform_symbols and platform_symbols(),
+ * sorted by name so we can binary search them. Built on first use.
+ * A name may appear in more than one table, but always for the same
+ * constant, so it does not matter which entry a search finds.
+ */
+static struct int_symbol *symbol_index;
+static size_t symbol_index_len;
+static pthread_once_t symbol_index_once = PTHREAD_ONCE_INIT;
+
+static int compare_int_symbols(const void *a, const void *b)
+{
+	const struct int_symbol *symbol_a = a;
+	const struct int_symbol *symbol_b = b;
+
+	return strcmp(symbol_a->name, symbol_b->name);
+}
+
+static size_t count_int_symbols(const struct int_symbol *symbols)
+{
+	size_t n = 0;
+
+	while (symbols[n].name != NULL)
+		++n;
+	return n;
+}
+
+static void build_symbol_index(void)
+{
+	struct int_symbol *platform = platform_symbols();
+	size_t cross_len = count_int_symbols(cross_platform_symbols);
+	size_t platform_len = count_int_symbols(platform);
+
+	symbol_index_len = cross_len + platform_len;
+	symbol_index = calloc(symbol_index_len, sizeof(struct int_symbol));
+	assert(symbol_index != NULL);
+	memcpy(symbol_index, cross_platform_symbols,
+	       cross_len * sizeof(struct int_symbol));
+	memcpy(symbol_index + cross_len, platform,
+	       platform_len * sizeof(struct int_symbol));
+	qsort(symbol_index, symbol_index_len, sizeof(struct int_symbol),
+	      compare_int_symbols);
+}
+
 /* Do a symbol->int lookup, and return true iff we found the symbol. */
-static bool lookup_int_symbol(const char *input_symbol, s64 *output_integer,
-			      struct int_symbol *symbols)
-{
-	int i;
-	for (i = 0; symbols[i].name != NULL ; ++i) {
-		if (strcmp(input_symbol, symbols[i].name) == 0) {
-			*output_integer = symbols[i].value;
-			return true;
-		}
-	}
-	return false;
+static bool lookup_int_symbol(const char *input_symbol, s64 *output_integer)
+{
+	const struct int_symbol key = { .name = input_symbol };
+	const struct int_symbol *symbol;
+
+	if (pthread_once(&symbol_index_once, build_symbol_index) != 0)
+		die_perror("pthread_once");
+
+	symbol = bsearch(&key, symbol_index, symbol_index_len,
+			 sizeof(struct int_symbol), compare_int_symbols);
+	if (symbol == NULL)
+		return false;
+	*output_integer = symbol->value;
+	return true;
 }
 
 int symbol_to_int(const char *input_symbol, s64 *output_integer,
 		  char **error)
 {
-	if (lookup_int_symbol(input_symbol, output_integer,
-			      cross_platform_symbols))
-		return STATUS_OK;
-
-	if (lookup_int_symbol(input_symbol, output_integer,
-			      platform_symbols()))
+	if (lookup_int_symbol(input_symbol, output_integer))
 		return STATUS_OK;
 
 	asprintf(error, "unknown symbol: '%s'", input_symbol);
@@ -802,6 +872,81 @@ static int evaluate_list_expression(struct expression *in,
 					&out->value.list, error);
 }
 
+static int evaluate_linger_expression(struct expression *in,
+				      struct expression *out, char **error)
+{
+	struct linger_expr *in_linger;
+	struct linger_expr *out_linger;
+
+	assert(in->type == EXPR_LINGER);
+	assert(in->value.linger);
+	assert(out->type == EXPR_LINGER);
+
+	out->value.linger = calloc(1, sizeof(struct linger_expr));
+
+	in_linger = in->value.linger;
+	out_linger = out->value.linger;
+	if (evaluate(in_linger->l_onoff,	&out_linger->l_onoff,	error))
+		return STATUS_ERR;
+	if (evaluate(in_linger->l_linger,	&out_linger->l_linger,	error))
+		return STATUS_ERR;
+
+	return STATUS_OK;
+}
+
+#if defined(__FreeBSD__) || defined(__NetBSD__)
+static int evaluate_accept_filter_arg_expression(struct expression *in,
+						 struct expression *out,
+						 char **error)
+{
+	struct accept_filter_arg_expr *in_arg;
+	struct accept_filter_arg_expr *out_arg;
+
+	assert(in->type == EXPR_ACCEPT_FILTER_ARG);
+	assert(in->value.accept_filter_arg);
+	assert(out->type == EXPR_ACCEPT_FILTER_ARG);
+
+	out->value.accept_filter_arg =
+		calloc(1, sizeof(struct accept_filter_arg_expr));
+
+	in_arg = in->value.accept_filter_arg;
+	out_arg = out->value.accept_filter_arg;
+	if (evaluate(in_arg->af_name,		&out_arg->af_name,	error))
+		return STATUS_ERR;
+	if (evaluate(in_arg->af_arg,		&out_arg->af_arg,	error))
+		return STATUS_ERR;
+
+	return STATUS_OK;
+}
+#endif
+
+#if defined(__FreeBSD__)
+static int evaluate_tcp_function_set_expression(struct expression *in,
+						struct expression *out,
+						char **error)
+{
+	struct tcp_function_set_expr *in_set;
+	struct tcp_function_set_expr *out_set;
+
+	assert(in->type == EXPR_TCP_FUNCTION_SET);
+	assert(in->value.tcp_function_set);
+	assert(out->type == EXPR_TCP_FUNCTION_SET);
+
+	out->value.tcp_function_set =
+		calloc(1, sizeof(struct tcp_function_set_expr));
+
+	in_set = in->value.tcp_function_set;
+	out_set = out->value.tcp_function_set;
+	if (evaluate(in_set->function_set_name,
+		     &out_set->function_set_name, error))
+		return STATUS_ERR;
+	if (evaluate(in_set->pcbcnt,		&out_set->pcbcnt,	error))
+		return STATUS_ERR;
+
+	return STATUS_OK;
+}
+#endif
+
 static int evaluate_iovec_expression(struct expression *in,
 				     struct expression *out, char **error)
 {
@@ -2775,20 +2920,17 @@ static int evaluate(struct expression *in,
 	case EXPR_INTEGER:		/* copy as-is */
 		out->value.num = in->value.num;
 		break;
-	case EXPR_LINGER:		/* copy as-is */
-		memcpy(&out->value.linger, &in->value.linger,
-		       sizeof(in->value.linger));
+	case EXPR_LINGER:
+		result = evaluate_linger_expression(in, out, error);
 		break;
 #if defined(__FreeBSD__) | defined(__NetBSD__)
-	case EXPR_ACCEPT_FILTER_ARG:		/* copy as-is */
-		memcpy(&out->value.accept_filter_arg, &in->value.accept_filter_arg,
-		       sizeof(in->value.accept_filter_arg));
+	case EXPR_ACCEPT_FILTER_ARG:
+		result = evaluate_accept_filter_arg_expression(in, out, error);
 		break;
 #endif
 #if defined(__FreeBSD__)
-	case EXPR_TCP_FUNCTION_SET:		/* copy as-is */
-		memcpy(&out->value.tcp_function_set, &in->value.tcp_function_set,
-		       sizeof(in->value.tcp_function_set));
+	case EXPR_TCP_FUNCTION_SET:
+		result = evaluate_tcp_function_set_expression(in, out, error);
 		break;
 #endif
 	case EXPR_SCTP_RTOINFO:
@@ -28,8 +28,11 @@
 #include "types.h"
 
 #include <sys/time.h>
+#include "arena.h"
 #include "packet.h"
 
+struct state;
+
 /* The types of expressions in a script */
 enum expression_t {
 	EXPR_NONE,
@@ -683,6 +686,16 @@ struct syscall_spec {
 	struct errno_spec *error;		/* errno symbol or NULL */
 	char *note;				/* extra note from strace */
 	s64 end_usecs;				/* finish time, if it blocks */
+
+	/* Filled in at parse time by prepare_system_call(), so that no
+	 * name lookup or argument evaluation happens while the script
+	 * runs. 'handler' is NULL for an unknown system call, and
+	 * 'evaluated_arguments' is NULL if the arguments still need to
+	 * be evaluated (or there are none).
+	 */
+	int (*handler)(struct state *state, struct syscall_spec *syscall,
+		       struct expression_list *args, char **error);
+	struct expression_list *evaluated_arguments;
 };
 #define SYSCALL_NON_BLOCKING  -1		/* end_usecs if non-blocking */
 
@@ -755,9 +768,13 @@ struct option_list {
 	struct option_list *next;
 };
 
-/* A parsed script. The script owns all of the data to which
- * it points. TODO: add a script_free() to free everything when we are
- * done executing the script, instead of leaking all that memory.
+/* A parsed script. The script owns all of the data to which it
+ * points. The options, events, expressions and strings built by the
+ * parser all live in the script's arena; the packets of packet events
+ * (and any pre-evaluated system call arguments) are on the heap, since
+ * they are built by code shared with the interpreter. A script loaded
+ * from --script_cache instead lives entirely in its mapped image. Call
+ * script_free() to release everything once the script has run.
  */
 struct script {
 	struct option_list *option_list;    /* linked list of options */
@@ -766,6 +783,9 @@ struct script {
 	struct command_spec *cleanup_command;  /* untimed cleanup command */
 	char		*buffer;	    /* raw input text of the script */
 	int		length;		    /* number of bytes in the script */
+	struct arena	*arena;		    /* owns the parsed representation */
+	void		*image;		    /* or the mapped cached script */
+	size_t		image_bytes;	    /* size of the mapped image */
 };
 
 /* Global pointer for final command we always execute at end of script: */
@@ -783,6 +803,11 @@ struct flag_name {
 /* Initialize a script object */
 extern void init_script(struct script *script);
 
+/* Free everything a parsed script owns, leaving it as if just
+ * initialized by init_script().
+ */
+extern void script_free(struct script *script);
+
 /* Look up the value of the given symbol, and fill it in. On success,
  * return STATUS_OK; if the symbol cannot be found, return
  * STATUS_ERR and fill in an error message in *error.
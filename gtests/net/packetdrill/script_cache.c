@@ -0,0 +1,865 @@
+/*
+ * Copyright 2013 Google Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+/*
+ * Implementation for --script_cache.
+ *
+ * A cache file is an image of the parsed script: a header, then a copy
+ * of every object the script points to, with each pointer rewritten as
+ * if the image were mapped at SCRIPT_CACHE_BASE, then a table giving
+ * the offset of each of those pointers, for relocating the image if it
+ * ends up mapped somewhere else. Things that depend on where the
+ * packetdrill binary is loaded (system call handlers) or that the run
+ * takes ownership of (pre-evaluated system call arguments) are left
+ * out of the image and redone by prepare_system_call() after loading.
+ */
+
+#include "script_cache.h"
+
+#if defined(linux)
+
+#include <elf.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <link.h>
+#include <netinet/in.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "assert.h"
+#include "hash.h"
+#include "logging.h"
+#include "packet.h"
+#include "run_system_call.h"
+#include "sctp_packet.h"
+
+#define SCRIPT_CACHE_MAGIC	"PDSCRIPT"
+#define SCRIPT_CACHE_VERSION	1
+
+/* Where we'd like the image to be mapped, so that it needs no
+ * relocation: an address that is normally free in a process.
+ */
+#if __SIZEOF_POINTER__ == 8
+#define SCRIPT_CACHE_BASE	((uintptr_t)0x200000000000ULL)
+#else
+#define SCRIPT_CACHE_BASE	((uintptr_t)0x60000000UL)
+#endif
+
+/* Every object in the image starts on a multiple of this. */
+#define IMAGE_ALIGN		16
+
+struct script_cache_header {
+	char magic[8];			/* SCRIPT_CACHE_MAGIC */
+	u32 version;			/* SCRIPT_CACHE_VERSION */
+	u32 num_relocs;			/* entries in the relocation table */
+	u64 key[2];			/* the key the image was stored under */
+	u64 base;			/* address the image was linked for */
+	u64 bytes;			/* total size of the file */
+	u64 relocs;			/* offset of the relocation table */
+	u64 script;			/* offset of the struct script */
+};
+
+struct script_cache {
+	u64 key[2];			/* hash of build, options and script */
+	char *path;			/* file for this entry */
+	char *dir;			/* the --script_cache directory */
+};
+
+/* An image being built. Since the buffer moves as it grows, objects in
+ * it are always referred to by their offset.
+ */
+struct image {
+	u8 *bytes;			/* the image so far */
+	size_t bytes_used;		/* bytes of the image filled in */
+	size_t bytes_size;		/* bytes allocated for the image */
+	u64 *relocs;			/* offsets of pointers in the image */
+	int num_relocs;			/* number of pointers so far */
+	int max_relocs;			/* space allocated in relocs[] */
+	bool failed;			/* met something we can't store? */
+};
+
+/* For each expression type whose value points to a struct made up of
+ * nothing but expression pointers, the size of that struct.
+ */
+#define EXPR_STRUCT(type, name)	[type] = sizeof(struct name)
+static const size_t expression_struct_bytes[NUM_EXPR_TYPES] = {
+	EXPR_STRUCT(EXPR_LINGER, linger_expr),
+	EXPR_STRUCT(EXPR_IOVEC, iovec_expr),
+	EXPR_STRUCT(EXPR_MSGHDR, msghdr_expr),
+	EXPR_STRUCT(EXPR_CMSGHDR, cmsghdr_expr),
+	EXPR_STRUCT(EXPR_POLLFD, pollfd_expr),
+#if defined(__FreeBSD__) || defined(__NetBSD__)
+	EXPR_STRUCT(EXPR_ACCEPT_FILTER_ARG, accept_filter_arg_expr),
+#endif
+#if defined(__FreeBSD__)
+	EXPR_STRUCT(EXPR_SF_HDTR, sf_hdtr_expr),
+	EXPR_STRUCT(EXPR_TCP_FUNCTION_SET, tcp_function_set_expr),
+#endif
+	EXPR_STRUCT(EXPR_SCTP_RTOINFO, sctp_rtoinfo_expr),
+	EXPR_STRUCT(EXPR_SCTP_INITMSG, sctp_initmsg_expr),
+	EXPR_STRUCT(EXPR_SCTP_ASSOC_VALUE, sctp_assoc_value_expr),
+	EXPR_STRUCT(EXPR_SCTP_HMACALGO, sctp_hmacalgo_expr),
+	EXPR_STRUCT(EXPR_SCTP_AUTHKEYID, sctp_authkeyid_expr),
+	EXPR_STRUCT(EXPR_SCTP_SACKINFO, sctp_sack_info_expr),
+	EXPR_STRUCT(EXPR_SCTP_STATUS, sctp_status_expr),
+	EXPR_STRUCT(EXPR_SCTP_PADDRINFO, sctp_paddrinfo_expr),
+	EXPR_STRUCT(EXPR_SCTP_STREAM_VALUE, sctp_stream_value_expr),
+	EXPR_STRUCT(EXPR_SCTP_PEER_ADDR_PARAMS, sctp_paddrparams_expr),
+	EXPR_STRUCT(EXPR_SCTP_ASSOCPARAMS, sctp_assocparams_expr),
+	EXPR_STRUCT(EXPR_SCTP_EVENT, sctp_event_expr),
+	EXPR_STRUCT(EXPR_SCTP_EVENT_SUBSCRIBE, sctp_event_subscribe_expr),
+	EXPR_STRUCT(EXPR_SCTP_SNDINFO, sctp_sndinfo_expr),
+	EXPR_STRUCT(EXPR_SCTP_SETPRIM, sctp_setprim_expr),
+	EXPR_STRUCT(EXPR_SCTP_SETADAPTATION, sctp_setadaptation_expr),
+	EXPR_STRUCT(EXPR_SCTP_SNDRCVINFO, sctp_sndrcvinfo_expr),
+	EXPR_STRUCT(EXPR_SCTP_PRINFO, sctp_prinfo_expr),
+	EXPR_STRUCT(EXPR_SCTP_DEFAULT_PRINFO, sctp_default_prinfo_expr),
+	EXPR_STRUCT(EXPR_SCTP_AUTHINFO, sctp_authinfo_expr),
+	EXPR_STRUCT(EXPR_SCTP_SENDV_SPA, sctp_sendv_spa_expr),
+	EXPR_STRUCT(EXPR_SCTP_RCVINFO, sctp_rcvinfo_expr),
+	EXPR_STRUCT(EXPR_SCTP_NXTINFO, sctp_nxtinfo_expr),
+	EXPR_STRUCT(EXPR_SCTP_RECVV_RN, sctp_recvv_rn_expr),
+	EXPR_STRUCT(EXPR_SCTP_ASSOC_CHANGE, sctp_assoc_change_expr),
+	EXPR_STRUCT(EXPR_SCTP_PADDR_CHANGE, sctp_paddr_change_expr),
+	EXPR_STRUCT(EXPR_SCTP_REMOTE_ERROR, sctp_remote_error_expr),
+	EXPR_STRUCT(EXPR_SCTP_SEND_FAILED, sctp_send_failed_expr),
+	EXPR_STRUCT(EXPR_SCTP_SHUTDOWN_EVENT, sctp_shutdown_event_expr),
+	EXPR_STRUCT(EXPR_SCTP_ADAPTATION_EVENT, sctp_adaptation_event_expr),
+	EXPR_STRUCT(EXPR_SCTP_PDAPI_EVENT, sctp_pdapi_event_expr),
+	EXPR_STRUCT(EXPR_SCTP_AUTHKEY_EVENT, sctp_authkey_event_expr),
+	EXPR_STRUCT(EXPR_SCTP_SENDER_DRY_EVENT, sctp_sender_dry_event_expr),
+	EXPR_STRUCT(EXPR_SCTP_SEND_FAILED_EVENT, sctp_send_failed_event_expr),
+	EXPR_STRUCT(EXPR_SCTP_TLV, sctp_tlv_expr),
+	EXPR_STRUCT(EXPR_SCTP_EXTRCVINFO, sctp_extrcvinfo_expr),
+	EXPR_STRUCT(EXPR_SCTP_ASSOC_IDS, sctp_assoc_ids_expr),
+	EXPR_STRUCT(EXPR_SCTP_AUTHCHUNKS, sctp_authchunks_expr),
+	EXPR_STRUCT(EXPR_SCTP_SETPEERPRIM, sctp_setpeerprim_expr),
+	EXPR_STRUCT(EXPR_SCTP_AUTHCHUNK, sctp_authchunk_expr),
+	EXPR_STRUCT(EXPR_SCTP_AUTHKEY, sctp_authkey_expr),
+	EXPR_STRUCT(EXPR_SCTP_RESET_STREAMS, sctp_reset_streams_expr),
+	EXPR_STRUCT(EXPR_SCTP_ADD_STREAMS, sctp_add_streams_expr),
+	EXPR_STRUCT(EXPR_SCTP_STREAM_RESET_EVENT,
+		    sctp_stream_reset_event_expr),
+	EXPR_STRUCT(EXPR_SCTP_ASSOC_RESET_EVENT, sctp_assoc_reset_event_expr),
+	EXPR_STRUCT(EXPR_SCTP_STREAM_CHANGE_EVENT,
+		    sctp_stream_change_event_expr),
+	EXPR_STRUCT(EXPR_SCTP_UDPENCAPS, sctp_udpencaps_expr),
+};
+#undef EXPR_STRUCT
+
+/* Return 'bytes' of zeroed space at the end of the image, as an offset. */
+static size_t image_alloc(struct image *image, size_t bytes)
+{
+	size_t offset = image->bytes_used;
+
+	bytes = (bytes + IMAGE_ALIGN - 1) & ~(size_t)(IMAGE_ALIGN - 1);
+	if (offset + bytes > image->bytes_size) {
+		image->bytes_size = max(image->bytes_size * 2, offset + bytes);
+		image->bytes = realloc(image->bytes, image->bytes_size);
+		assert(image->bytes != NULL);
+	}
+	memset(image->bytes + offset, 0, bytes);
+	image->bytes_used += bytes;
+	return offset;
+}
+
+/* Copy the given object to the end of the image; return its offset. */
+static size_t image_copy(struct image *image, const void *object,
+			 size_t bytes)
+{
+	size_t offset = image_alloc(image, bytes);
+
+	memcpy(image->bytes + offset, object, bytes);
+	return offset;
+}
+
+/* Set the pointer at offset 'slot' to point to the object at offset
+ * 'target', or to NULL if 'target' is 0 (which is the header, so no
+ * object lives there).
+ */
+static void image_link(struct image *image, size_t slot, size_t target)
+{
+	uintptr_t value = 0;
+
+	if (target != 0) {
+		value = SCRIPT_CACHE_BASE + target;
+		if (image->num_relocs == image->max_relocs) {
+			image->max_relocs = max(image->max_relocs * 2, 256);
+			image->relocs = realloc(image->relocs,
+						image->max_relocs *
+						sizeof(image->relocs[0]));
+			assert(image->relocs != NULL);
+		}
+		image->relocs[image->num_relocs++] = slot;
+	}
+	memcpy(image->bytes + slot, &value, sizeof(value));
+}
+
+/* Point 'field' of the struct 'type' at offset 'at' to 'target'. */
+#define LINK(at, type, field, target) \
+	image_link(image, (at) + offsetof(type, field), (target))
+
+static size_t put_string(struct image *image, const char *string)
+{
+	if (string == NULL)
+		return 0;
+	return image_copy(image, string, strlen(string) + 1);
+}
+
+static size_t put_expression_list(struct image *image,
+				  const struct expression_list *list);
+
+static size_t put_expression(struct image *image,
+			     const struct expression *expression)
+{
+	const struct expression *const *fields;
+	size_t at, value, bytes;
+	int i;
+
+	if (expression == NULL)
+		return 0;
+
+	at = image_copy(image, expression, sizeof(*expression));
+	LINK(at, struct expression, format,
+	     put_string(image, expression->format));
+
+	switch (expression->type) {
+	case EXPR_NONE:
+	case EXPR_NULL:
+	case EXPR_ELLIPSIS:
+	case EXPR_INTEGER:
+		return at;
+	case EXPR_WORD:
+	case EXPR_STRING:
+		value = put_string(image, expression->value.string);
+		break;
+	case EXPR_SOCKET_ADDRESS_IPV4:
+		value = image_copy(image, expression->value.socket_address_ipv4,
+				   sizeof(struct sockaddr_in));
+		break;
+	case EXPR_SOCKET_ADDRESS_IPV6:
+		value = image_copy(image, expression->value.socket_address_ipv6,
+				   sizeof(struct sockaddr_in6));
+		break;
+	case EXPR_BINARY:
+		value = image_copy(image, expression->value.binary,
+				   sizeof(struct binary_expression));
+		LINK(value, struct binary_expression, op,
+		     put_string(image, expression->value.binary->op));
+		LINK(value, struct binary_expression, lhs,
+		     put_expression(image, expression->value.binary->lhs));
+		LINK(value, struct binary_expression, rhs,
+		     put_expression(image, expression->value.binary->rhs));
+		break;
+	case EXPR_LIST:
+		value = put_expression_list(image, expression->value.list);
+		break;
+	default:
+		if (expression->type >= NUM_EXPR_TYPES ||
+		    expression_struct_bytes[expression->type] == 0) {
+			image->failed = true;
+			return at;
+		}
+		/* All the other values are structs of expressions. */
+		bytes = expression_struct_bytes[expression->type];
+		memcpy(&fields, &expression->value, sizeof(fields));
+		value = image_copy(image, fields, bytes);
+		for (i = 0; i < bytes / sizeof(fields[0]); ++i) {
+			image_link(image, value + i * sizeof(fields[0]),
+				   put_expression(image, fields[i]));
+		}
+		break;
+	}
+	LINK(at, struct expression, value, value);
+	return at;
+}
+
+static size_t put_expression_list(struct image *image,
+				  const struct expression_list *list)
+{
+	size_t first = 0, prev = 0, at;
+
+	for (; list != NULL; list = list->next) {
+		at = image_copy(image, list, sizeof(*list));
+		LINK(at, struct expression_list, expression,
+		     put_expression(image, list->expression));
+		LINK(at, struct expression_list, next, 0);
+		if (prev != 0)
+			LINK(prev, struct expression_list, next, at);
+		else
+			first = at;
+		prev = at;
+	}
+	return first;
+}
+
+/* Return the offset in the image of a pointer into the given packet's
+ * buffer, which is at offset 'buffer' in the image.
+ */
+static size_t packet_offset(struct image *image, const struct packet *packet,
+			    size_t buffer, const void *p)
+{
+	const u8 *byte = p;
+
+	if (p == NULL)
+		return 0;
+	if (byte < packet->buffer ||
+	    byte >= packet->buffer + packet->buffer_bytes) {
+		image->failed = true;
+		return 0;
+	}
+	return buffer + (byte - packet->buffer);
+}
+
+/* Point 'field' of the struct 'type' at offset 'at' into the packet. */
+#define LINK_PACKET(at, type, field, p) \
+	LINK(at, type, field, packet_offset(image, packet, buffer, (p)))
+
+static size_t put_parameter_list(struct image *image,
+				 const struct packet *packet, size_t buffer,
+				 const struct sctp_parameter_list *list)
+{
+	const struct sctp_parameter_list_item *item;
+	size_t at, prev = 0, item_at;
+
+	at = image_copy(image, list, sizeof(*list));
+	LINK(at, struct sctp_parameter_list, first, 0);
+	LINK(at, struct sctp_parameter_list, last, 0);
+	for (item = list->first; item != NULL; item = item->next) {
+		item_at = image_copy(image, item, sizeof(*item));
+		LINK_PACKET(item_at, struct sctp_parameter_list_item,
+			    parameter, item->parameter);
+		LINK(item_at, struct sctp_parameter_list_item, next, 0);
+		if (prev != 0)
+			LINK(prev, struct sctp_parameter_list_item, next,
+			     item_at);
+		else
+			LINK(at, struct sctp_parameter_list, first, item_at);
+		LINK(at, struct sctp_parameter_list, last, item_at);
+		prev = item_at;
+	}
+	return at;
+}
+
+static size_t put_cause_list(struct image *image,
+			     const struct packet *packet, size_t buffer,
+			     const struct sctp_cause_list *list)
+{
+	const struct sctp_cause_list_item *item;
+	size_t at, prev = 0, item_at;
+
+	at = image_copy(image, list, sizeof(*list));
+	LINK(at, struct sctp_cause_list, first, 0);
+	LINK(at, struct sctp_cause_list, last, 0);
+	for (item = list->first; item != NULL; item = item->next) {
+		item_at = image_copy(image, item, sizeof(*item));
+		LINK_PACKET(item_at, struct sctp_cause_list_item,
+			    cause, item->cause);
+		LINK(item_at, struct sctp_cause_list_item, next, 0);
+		if (prev != 0)
+			LINK(prev, struct sctp_cause_list_item, next, item_at);
+		else
+			LINK(at, struct sctp_cause_list, first, item_at);
+		LINK(at, struct sctp_cause_list, last, item_at);
+		prev = item_at;
+	}
+	return at;
+}
+
+static size_t put_chunk_list(struct image *image,
+			     const struct packet *packet, size_t buffer,
+			     const struct sctp_chunk_list *list)
+{
+	const struct sctp_chunk_list_item *item;
+	size_t at, prev = 0, item_at;
+
+	if (list == NULL)
+		return 0;
+
+	at = image_copy(image, list, sizeof(*list));
+	LINK(at, struct sctp_chunk_list, first, 0);
+	LINK(at, struct sctp_chunk_list, last, 0);
+	for (item = list->first; item != NULL; item = item->next) {
+		item_at = image_copy(image, item, sizeof(*item));
+		LINK_PACKET(item_at, struct sctp_chunk_list_item,
+			    chunk, item->chunk);
+		LINK(item_at, struct sctp_chunk_list_item, parameter_list,
+		     put_parameter_list(image, packet, buffer,
+					item->parameter_list));
+		LINK(item_at, struct sctp_chunk_list_item, cause_list,
+		     put_cause_list(image, packet, buffer, item->cause_list));
+		LINK(item_at, struct sctp_chunk_list_item, next, 0);
+		if (prev != 0)
+			LINK(prev, struct sctp_chunk_list_item, next, item_at);
+		else
+			LINK(at, struct sctp_chunk_list, first, item_at);
+		LINK(at, struct sctp_chunk_list, last, item_at);
+		prev = item_at;
+	}
+	return at;
+}
+
+static size_t put_packet(struct image *image, const struct packet *packet)
+{
+	size_t at, buffer;
+	int i;
+
+	at = image_copy(image, packet, sizeof(*packet));
+	buffer = image_copy(image, packet->buffer, packet->buffer_bytes);
+	LINK(at, struct packet, buffer, buffer);
+
+	for (i = 0; i < ARRAY_SIZE(packet->headers); ++i) {
+		LINK_PACKET(at + i * sizeof(struct header), struct packet,
+			    headers[0].h.ptr, packet->headers[i].h.ptr);
+	}
+	LINK_PACKET(at, struct packet, ipv4, packet->ipv4);
+	LINK_PACKET(at, struct packet, ipv6, packet->ipv6);
+	LINK_PACKET(at, struct packet, sctp, packet->sctp);
+	LINK_PACKET(at, struct packet, tcp, packet->tcp);
+	LINK_PACKET(at, struct packet, udp, packet->udp);
+	LINK_PACKET(at, struct packet, udplite, packet->udplite);
+	LINK_PACKET(at, struct packet, icmpv4, packet->icmpv4);
+	LINK_PACKET(at, struct packet, icmpv6, packet->icmpv6);
+	LINK_PACKET(at, struct packet, tcp_ts_val, packet->tcp_ts_val);
+	LINK_PACKET(at, struct packet, tcp_ts_ecr, packet->tcp_ts_ecr);
+	LINK(at, struct packet, chunk_list,
+	     put_chunk_list(image, packet, buffer, packet->chunk_list));
+	LINK(at, struct packet, pool, 0);
+	LINK(at, struct packet, pool_next, 0);
+	return at;
+}
+
+static size_t put_syscall(struct image *image,
+			  const struct syscall_spec *syscall)
+{
+	size_t at, error = 0;
+
+	at = image_copy(image, syscall, sizeof(*syscall));
+	LINK(at, struct syscall_spec, name, put_string(image, syscall->name));
+	LINK(at, struct syscall_spec, arguments,
+	     put_expression_list(image, syscall->arguments));
+	LINK(at, struct syscall_spec, result,
+	     put_expression(image, syscall->result));
+	if (syscall->error != NULL) {
+		error = image_copy(image, syscall->error,
+				   sizeof(struct errno_spec));
+		LINK(error, struct errno_spec, errno_macro,
+		     put_string(image, syscall->error->errno_macro));
+		LINK(error, struct errno_spec, strerror,
+		     put_string(image, syscall->error->strerror));
+	}
+	LINK(at, struct syscall_spec, error, error);
+	LINK(at, struct syscall_spec, note, put_string(image, syscall->note));
+	/* Redone by prepare_system_call() when the image is loaded. */
+	LINK(at, struct syscall_spec, handler, 0);
+	LINK(at, struct syscall_spec, evaluated_arguments, 0);
+	return at;
+}
+
+static size_t put_command(struct image *image,
+			  const struct command_spec *command)
+{
+	size_t at;
+
+	if (command == NULL)
+		return 0;
+	at = image_copy(image, command, sizeof(*command));
+	LINK(at, struct command_spec, command_line,
+	     put_string(image, command->command_line));
+	return at;
+}
+
+static size_t put_event(struct image *image, const struct event *event)
+{
+	size_t at, target = 0;
+
+	at = image_copy(image, event, sizeof(*event));
+	switch (event->type) {
+	case PACKET_EVENT:
+		target = put_packet(image, event->event.packet);
+		break;
+	case SYSCALL_EVENT:
+		target = put_syscall(image, event->event.syscall);
+		break;
+	case COMMAND_EVENT:
+		target = put_command(image, event->event.command);
+		break;
+	case CODE_EVENT:
+		target = image_copy(image, event->event.code,
+				    sizeof(struct code_spec));
+		LINK(target, struct code_spec, text,
+		     put_string(image, event->event.code->text));
+		break;
+	case INVALID_EVENT:
+	case NUM_EVENT_TYPES:
+		image->failed = true;
+		break;
+	/* We omit default case so compiler catches missing values. */
+	}
+	LINK(at, struct event, event, target);
+	LINK(at, struct event, next, 0);
+	return at;
+}
+
+static size_t put_script(struct image *image, const struct script *script)
+{
+	const struct option_list *option;
+	const struct event *event;
+	size_t at, prev, next;
+
+	at = image_copy(image, script, sizeof(*script));
+
+	prev = 0;
+	LINK(at, struct script, option_list, 0);
+	for (option = script->option_list; option != NULL;
+	     option = option->next) {
+		next = image_copy(image, option, sizeof(*option));
+		LINK(next, struct option_list, name,
+		     put_string(image, option->name));
+		LINK(next, struct option_list, value,
+		     put_string(image, option->value));
+		LINK(next, struct option_list, next, 0);
+		if (prev != 0)
+			LINK(prev, struct option_list, next, next);
+		else
+			LINK(at, struct script, option_list, next);
+		prev = next;
+	}
+
+	prev = 0;
+	LINK(at, struct script, event_list, 0);
+	for (event = script->event_list; event != NULL; event = event->next) {
+		next = put_event(image, event);
+		if (prev != 0)
+			LINK(prev, struct event, next, next);
+		else
+			LINK(at, struct script, event_list, next);
+		prev = next;
+	}
+
+	LINK(at, struct script, init_command,
+	     put_command(image, script->init_command));
+	LINK(at, struct script, cleanup_command,
+	     put_command(image, script->cleanup_command));
+	/* The caller keeps the text it read; the rest is the image. */
+	LINK(at, struct script, buffer, 0);
+	LINK(at, struct script, arena, 0);
+	LINK(at, struct script, image, 0);
+	return at;
+}
+
+#undef LINK_PACKET
+#undef LINK
+
+/* An identity for this packetdrill binary, so that a rebuilt binary,
+ * whose structs or symbol values may differ, never uses images left
+ * by an older one.
+ */
+struct build_id {
+	u8 bytes[64];
+	int length;
+};
+
+/* A dl_iterate_phdr() callback to find the GNU build ID note of the
+ * executable, which is the first object listed.
+ */
+static int find_build_id(struct dl_phdr_info *info, size_t size, void *data)
+{
+	struct build_id *id = data;
+	int i;
+
+	for (i = 0; i < info->dlpi_phnum; ++i) {
+		const ElfW(Phdr) *phdr = &info->dlpi_phdr[i];
+		const u8 *p, *end;
+
+		if (phdr->p_type != PT_NOTE)
+			continue;
+		p = (const u8 *)(info->dlpi_addr + phdr->p_vaddr);
+		end = p + phdr->p_memsz;
+		while (p + sizeof(ElfW(Nhdr)) <= end) {
+			const ElfW(Nhdr) *note = (const ElfW(Nhdr) *)p;
+			const u8 *name = p + sizeof(*note);
+			const u8 *desc = name + ((note->n_namesz + 3) & ~3);
+
+			if (note->n_type == NT_GNU_BUILD_ID &&
+			    note->n_namesz == sizeof("GNU") &&
+			    memcmp(name, "GNU", sizeof("GNU")) == 0 &&
+			    note->n_descsz <= sizeof(id->bytes) &&
+			    desc + note->n_descsz <= end) {
+				memcpy(id->bytes, desc, note->n_descsz);
+				id->length = note->n_descsz;
+				return 1;
+			}
+			p = desc + ((note->n_descsz + 3) & ~3);
+		}
+	}
+	return 1;
+}
+
+/* Fill in the build ID of this binary. Without a build ID note, fall
+ * back on the identity and modification time of the executable file.
+ * Returns STATUS_OK on success, or STATUS_ERR if we can't tell.
+ */
+static int get_build_id(struct build_id *id)
+{
+	struct stat exe;
+
+	memset(id, 0, sizeof(*id));
+	dl_iterate_phdr(find_build_id, id);
+	if (id->length > 0)
+		return STATUS_OK;
+
+	if (stat("/proc/self/exe", &exe) != 0)
+		return STATUS_ERR;
+	memcpy(id->bytes, &exe.st_dev, sizeof(exe.st_dev));
+	memcpy(id->bytes + 8, &exe.st_ino, sizeof(exe.st_ino));
+	memcpy(id->bytes + 16, &exe.st_size, sizeof(exe.st_size));
+	memcpy(id->bytes + 24, &exe.st_mtim, sizeof(exe.st_mtim));
+	id->length = 24 + sizeof(exe.st_mtim);
+	return STATUS_OK;
+}
+
+struct script_cache *script_cache_new(const char *dir,
+				      char **options, int num_options,
+				      const struct script *script)
+{
+	static struct build_id build_id;
+	static bool have_build_id;
+	struct script_cache *cache;
+	char *key_text = NULL;
+	size_t key_bytes = 0;
+	FILE *s;
+	int i;
+
+	if (!have_build_id) {
+		if (get_build_id(&build_id) != STATUS_OK)
+			return NULL;
+		have_build_id = true;
+	}
+
+	/* The parsed script depends on the options (e.g. the IP version
+	 * decides what the packets look like), so the key covers them.
+	 */
+	s = open_memstream(&key_text, &key_bytes);
+	fprintf(s, "%s %d", SCRIPT_CACHE_MAGIC, SCRIPT_CACHE_VERSION);
+	fwrite(build_id.bytes, 1, build_id.length, s);
+	for (i = 0; i < num_options; ++i)
+		fwrite(options[i], 1, strlen(options[i]) + 1, s);
+	fwrite(script->buffer, 1, script->length, s);
+	fclose(s);
+
+	cache = calloc(1, sizeof(struct script_cache));
+	MurmurHash3_x64_128(key_text, key_bytes, 0, cache->key);
+	free(key_text);
+
+	/* If we can't even name the file, just run without the cache. */
+	if (asprintf(&cache->path, "%s/%016llx%016llx.pds", dir,
+		     (unsigned long long)cache->key[0],
+		     (unsigned long long)cache->key[1]) < 0) {
+		free(cache);
+		return NULL;
+	}
+	cache->dir = strdup(dir);
+	return cache;
+}
+
+void script_cache_free(struct script_cache *cache)
+{
+	if (cache == NULL)
+		return;
+	free(cache->path);
+	free(cache->dir);
+	free(cache);
+}
+
+/* Check that the mapped file is a whole, current image for our key. */
+static bool image_is_valid(const struct script_cache *cache,
+			   const struct script_cache_header *header,
+			   size_t bytes)
+{
+	return (memcmp(header->magic, SCRIPT_CACHE_MAGIC,
+		       sizeof(header->magic)) == 0 &&
+		header->version == SCRIPT_CACHE_VERSION &&
+		header->key[0] == cache->key[0] &&
+		header->key[1] == cache->key[1] &&
+		header->bytes == bytes &&
+		header->script >= sizeof(*header) &&
+		header->script + sizeof(struct script) <= header->relocs &&
+		header->relocs <= bytes &&
+		header->num_relocs <= (bytes - header->relocs) / sizeof(u64));
+}
+
+int script_cache_load(struct script_cache *cache, struct script *script)
+{
+	const struct script_cache_header *header;
+	const struct script *cached;
+	struct event *event;
+	struct stat info;
+	uintptr_t delta;
+	const u64 *relocs;
+	u8 *image;
+	int fd, i;
+
+	fd = open(cache->path, O_RDONLY);
+	if (fd < 0)
+		return STATUS_ERR;
+	if (fstat(fd, &info) != 0 ||
+	    info.st_size < sizeof(struct script_cache_header)) {
+		close(fd);
+		return STATUS_ERR;
+	}
+
+	/* Private and writable, since the run adjusts event times and
+	 * packets in place, and we may need to relocate.
+	 */
+	image = mmap((void *)SCRIPT_CACHE_BASE, info.st_size,
+		     PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (image == MAP_FAILED)
+		return STATUS_ERR;
+
+	header = (const struct script_cache_header *)image;
+	if (!image_is_valid(cache, header, info.st_size)) {
+		munmap(image, info.st_size);
+		return STATUS_ERR;
+	}
+
+	delta = (uintptr_t)image - header->base;
+	if (delta != 0) {
+		relocs = (const u64 *)(image + header->relocs);
+		for (i = 0; i < header->num_relocs; ++i) {
+			uintptr_t *p;
+
+			if (relocs[i] + sizeof(*p) > header->relocs) {
+				munmap(image, info.st_size);
+				return STATUS_ERR;
+			}
+			p = (uintptr_t *)(image + relocs[i]);
+			*p += delta;
+		}
+	}
+	DEBUGP("script_cache_load: %s at %p, %s relocation\n", cache->path,
+	       image, delta != 0 ? "with" : "without");
+
+	cached = (const struct script *)(image + header->script);
+	script->option_list	= cached->option_list;
+	script->init_command	= cached->init_command;
+	script->event_list	= cached->event_list;
+	script->cleanup_command	= cached->cleanup_command;
+	script->image		= image;
+	script->image_bytes	= info.st_size;
+
+	/* Redo what the parser does beyond building the script. */
+	for (event = script->event_list; event != NULL; event = event->next) {
+		if (event->type == SYSCALL_EVENT)
+			prepare_system_call(event->event.syscall);
+	}
+	if (script->cleanup_command != NULL)
+		cleanup_cmd = script->cleanup_command->command_line;
+
+	return STATUS_OK;
+}
+
+/* Write the given bytes, or return STATUS_ERR. */
+static int write_all(int fd, const void *data, size_t bytes)
+{
+	const u8 *p = data;
+
+	while (bytes > 0) {
+		ssize_t n = write(fd, p, bytes);
+
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return STATUS_ERR;
+		p += n;
+		bytes -= n;
+	}
+	return STATUS_OK;
+}
+
+void script_cache_store(struct script_cache *cache,
+			const struct script *script)
+{
+	struct script_cache_header *header;
+	struct image image;
+	char *temp_path = NULL;
+	size_t script_at;
+	int fd, status;
+
+	memset(&image, 0, sizeof(image));
+	image_alloc(&image, sizeof(struct script_cache_header));
+	script_at = put_script(&image, script);
+	if (image.failed) {
+		DEBUGP("script_cache_store: %s can't be cached\n",
+		       cache->path);
+		goto out;
+	}
+
+	header = (struct script_cache_header *)image.bytes;
+	memcpy(header->magic, SCRIPT_CACHE_MAGIC, sizeof(header->magic));
+	header->version = SCRIPT_CACHE_VERSION;
+	header->num_relocs = image.num_relocs;
+	header->key[0] = cache->key[0];
+	header->key[1] = cache->key[1];
+	header->base = SCRIPT_CACHE_BASE;
+	header->relocs = image.bytes_used;
+	header->script = script_at;
+	header->bytes = image.bytes_used +
+		image.num_relocs * sizeof(image.relocs[0]);
+
+	/* Write to a file of our own and rename it into place, so that
+	 * scripts running in parallel never see half an image.
+	 */
+	if (mkdir(cache->dir, 0755) != 0 && errno != EEXIST)
+		goto error;
+	if (asprintf(&temp_path, "%s.%d", cache->path, getpid()) < 0) {
+		temp_path = NULL;
+		goto error;
+	}
+	fd = open(temp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		goto error;
+	status = write_all(fd, image.bytes, image.bytes_used);
+	if (status == STATUS_OK)
+		status = write_all(fd, image.relocs,
+				   image.num_relocs * sizeof(image.relocs[0]));
+	if (close(fd) != 0 || status != STATUS_OK ||
+	    rename(temp_path, cache->path) != 0) {
+		int saved_errno = errno;
+
+		unlink(temp_path);
+		errno = saved_errno;
+		goto error;
+	}
+	goto out;
+
+error:
+	fprintf(stderr, "packetdrill: can't write --script_cache file %s: %s\n",
+		cache->path, strerror(errno));
+out:
+	free(temp_path);
+	free(image.bytes);
+	free(image.relocs);
+}
+
+#endif /* linux */
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2013 Google Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+/*
+ * Interface for --script_cache, a directory of compiled scripts.
+ *
+ * Once a script has been parsed, we write its parsed representation
+ * (options, events, packets and expression trees) to the cache as a
+ * single image, keyed by a hash of the packetdrill build, the command
+ * line options and the script text. The next run of the same script
+ * with the same options maps the image and runs it, with no lexing
+ * or parsing. The image is linked to run at a fixed address, so if
+ * the mapping lands there the script is ready as soon as it is
+ * mapped; otherwise we relocate its pointers first.
+ */
+
+#ifndef __SCRIPT_CACHE_H__
+#define __SCRIPT_CACHE_H__
+
+#include "types.h"
+
+#include "script.h"
+
+/* The cache entry for one script, run with one set of options. */
+struct script_cache;
+
+/* Return the cache entry in the directory 'dir' for the given script,
+ * whose text must already be in script->buffer, run with the given
+ * command line options. Returns NULL if we can't identify this
+ * packetdrill build, in which case nothing is cached.
+ */
+extern struct script_cache *script_cache_new(const char *dir,
+					     char **options, int num_options,
+					     const struct script *script);
+
+/* Free the given cache entry. NULL is a no-op. */
+extern void script_cache_free(struct script_cache *cache);
+
+/* If the script is in the cache, map it and fill in 'script' with
+ * it, ready to run, and return STATUS_OK. Otherwise, return
+ * STATUS_ERR, leaving 'script' alone, and the caller should parse it.
+ * The caller must still finalize the config from the script options.
+ */
+extern int script_cache_load(struct script_cache *cache,
+			     struct script *script);
+
+/* Write the given freshly parsed script to the cache. Problems writing
+ * it are reported to stderr but are otherwise ignored, since the
+ * script itself is fine.
+ */
+extern void script_cache_store(struct script_cache *cache,
+			       const struct script *script);
+
+#endif /* __SCRIPT_CACHE_H__ */
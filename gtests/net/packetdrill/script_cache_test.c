@@ -0,0 +1,294 @@
+/*
+ * Copyright 2013 Google Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+/*
+ * Unit test for script_cache.c: parse a script, store it in the
+ * cache, load it back and check that we get the same script.
+ */
+
+#include "script_cache.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "assert.h"
+#include "config.h"
+#include "packet_to_string.h"
+#include "parse.h"
+
+int debug_logging = 0;
+
+#if defined(linux)
+
+static const char *script_text =
+	"--tolerance_usecs=10000\n"
+	"\n"
+	"0   socket(..., SOCK_STREAM, IPPROTO_TCP) = 3\n"
+	"+0  setsockopt(3, SOL_SOCKET, SO_REUSEADDR, [1], 4) = 0\n"
+	"+0  bind(3, ..., ...) = 0\n"
+	"+0  listen(3, 1) = 0\n"
+	"\n"
+	"+0  < S 0:0(0) win 32792 <mss 1000,sackOK,nop,nop,nop,wscale 7>\n"
+	"+0  > S. 0:0(0) ack 1 <mss 1460,nop,nop,sackOK,nop,wscale 8>\n"
+	"+.1 < . 1:1(0) ack 1 win 257\n"
+	"+0  accept(3, ..., ...) = 4\n"
+	"\n"
+	"+0  writev(4, [{..., 400}, {..., 600}], 2) = 1000\n"
+	"+0  > P. 1:1001(1000) ack 1\n"
+	"+0  poll([{fd=4, events=POLLIN|POLLOUT, revents=POLLOUT}], 1, 0)"
+	" = 1\n"
+	"+.1~+.2 read(4, ..., 1000) = -1 EAGAIN (Resource temporarily"
+	" unavailable)\n"
+	"+0  `echo done`\n";
+
+/* Parse the script above, as parse_script_and_set_config() would. */
+static void parse_test_script(struct config *config, struct script *script)
+{
+	static char *argv[] = { "packetdrill", NULL };
+	struct invocation invocation = {
+		.argc = 1,
+		.argv = argv,
+		.config = config,
+		.script = script,
+	};
+
+	set_default_config(config);
+	config->script_path = strdup("script_cache_test.pkt");
+	init_script(script);
+	copy_script(script_text, script);
+	assert(parse_script(config, script, &invocation) == STATUS_OK);
+}
+
+static void check_same_expression(const struct expression *a,
+				  const struct expression *b);
+
+static void check_same_list(const struct expression_list *a,
+			    const struct expression_list *b)
+{
+	for (; a != NULL && b != NULL; a = a->next, b = b->next)
+		check_same_expression(a->expression, b->expression);
+	assert(a == NULL && b == NULL);
+}
+
+static void check_same_expression(const struct expression *a,
+				  const struct expression *b)
+{
+	if (a == NULL || b == NULL) {
+		assert(a == b);
+		return;
+	}
+	assert(a != b);
+	assert(a->type == b->type);
+	assert((a->format == NULL) == (b->format == NULL));
+	if (a->format != NULL)
+		assert(strcmp(a->format, b->format) == 0);
+
+	switch (a->type) {
+	case EXPR_NULL:
+	case EXPR_ELLIPSIS:
+		break;
+	case EXPR_INTEGER:
+		assert(a->value.num == b->value.num);
+		break;
+	case EXPR_WORD:
+	case EXPR_STRING:
+		assert(strcmp(a->value.string, b->value.string) == 0);
+		break;
+	case EXPR_BINARY:
+		assert(strcmp(a->value.binary->op, b->value.binary->op) == 0);
+		check_same_expression(a->value.binary->lhs,
+				      b->value.binary->lhs);
+		check_same_expression(a->value.binary->rhs,
+				      b->value.binary->rhs);
+		break;
+	case EXPR_LIST:
+		check_same_list(a->value.list, b->value.list);
+		break;
+	case EXPR_IOVEC:
+		check_same_expression(a->value.iovec->iov_base,
+				      b->value.iovec->iov_base);
+		check_same_expression(a->value.iovec->iov_len,
+				      b->value.iovec->iov_len);
+		break;
+	case EXPR_POLLFD:
+		check_same_expression(a->value.pollfd->fd,
+				      b->value.pollfd->fd);
+		check_same_expression(a->value.pollfd->events,
+				      b->value.pollfd->events);
+		check_same_expression(a->value.pollfd->revents,
+				      b->value.pollfd->revents);
+		break;
+	default:
+		assert(!"expression type not used by this test");
+	}
+}
+
+static void check_same_packet(struct packet *a, struct packet *b)
+{
+	char *a_string = NULL, *b_string = NULL, *error = NULL;
+
+	assert(a->direction == b->direction);
+	assert(a->ip_bytes == b->ip_bytes);
+	assert(a->buffer != b->buffer);
+	assert(memcmp(a->buffer, b->buffer, a->ip_bytes) == 0);
+
+	/* The header pointers must point into the loaded buffer. */
+	assert(packet_to_string(a, DUMP_FULL, &a_string, &error) == STATUS_OK);
+	assert(packet_to_string(b, DUMP_FULL, &b_string, &error) == STATUS_OK);
+	assert(strcmp(a_string, b_string) == 0);
+	free(a_string);
+	free(b_string);
+}
+
+static void check_same_script(const struct script *a, const struct script *b)
+{
+	const struct option_list *a_opt = a->option_list;
+	const struct option_list *b_opt = b->option_list;
+	const struct event *a_event = a->event_list;
+	const struct event *b_event = b->event_list;
+
+	for (; a_opt != NULL && b_opt != NULL;
+	     a_opt = a_opt->next, b_opt = b_opt->next) {
+		assert(strcmp(a_opt->name, b_opt->name) == 0);
+		assert(strcmp(a_opt->value, b_opt->value) == 0);
+	}
+	assert(a_opt == NULL && b_opt == NULL);
+
+	for (; a_event != NULL && b_event != NULL;
+	     a_event = a_event->next, b_event = b_event->next) {
+		assert(a_event->line_number == b_event->line_number);
+		assert(a_event->time_usecs == b_event->time_usecs);
+		assert(a_event->time_usecs_end == b_event->time_usecs_end);
+		assert(a_event->offset_usecs == b_event->offset_usecs);
+		assert(a_event->time_type == b_event->time_type);
+		assert(a_event->type == b_event->type);
+
+		switch (a_event->type) {
+		case PACKET_EVENT:
+			check_same_packet(a_event->event.packet,
+					  b_event->event.packet);
+			break;
+		case SYSCALL_EVENT: {
+			const struct syscall_spec *a_call =
+				a_event->event.syscall;
+			const struct syscall_spec *b_call =
+				b_event->event.syscall;
+
+			assert(strcmp(a_call->name, b_call->name) == 0);
+			assert(a_call->end_usecs == b_call->end_usecs);
+			assert(a_call->handler == b_call->handler);
+			check_same_list(a_call->arguments, b_call->arguments);
+			check_same_expression(a_call->result, b_call->result);
+			assert((a_call->error == NULL) ==
+			       (b_call->error == NULL));
+			if (a_call->error != NULL)
+				assert(strcmp(a_call->error->errno_macro,
+					      b_call->error->errno_macro) == 0);
+			break;
+		}
+		case COMMAND_EVENT:
+			assert(strcmp(a_event->event.command->command_line,
+				      b_event->event.command->command_line)
+			       == 0);
+			break;
+		default:
+			assert(!"event type not used by this test");
+		}
+	}
+	assert(a_event == NULL && b_event == NULL);
+}
+
+/* Remove the cache directory and the entries in it. */
+static void remove_cache_dir(const char *dir)
+{
+	DIR *d = opendir(dir);
+	struct dirent *entry;
+	char *path;
+
+	assert(d != NULL);
+	while ((entry = readdir(d)) != NULL) {
+		if (entry->d_name[0] == '.')
+			continue;
+		assert(asprintf(&path, "%s/%s", dir, entry->d_name) >= 0);
+		assert(unlink(path) == 0);
+		free(path);
+	}
+	closedir(d);
+	assert(rmdir(dir) == 0);
+}
+
+static void test_round_trip(void)
+{
+	char dir[] = "/tmp/script_cache_test.XXXXXX";
+	char *options[] = { "--tolerance_usecs=10000", "--ip_version=ipv4" };
+	struct config config;
+	struct script parsed, first, second, other;
+	struct script_cache *cache, *other_cache;
+
+	assert(mkdtemp(dir) != NULL);
+	parse_test_script(&config, &parsed);
+
+	/* Nothing is cached until we store the script. */
+	cache = script_cache_new(dir, options, 2, &parsed);
+	assert(cache != NULL);
+	init_script(&first);
+	assert(script_cache_load(cache, &first) == STATUS_ERR);
+	script_cache_store(cache, &parsed);
+
+	assert(script_cache_load(cache, &first) == STATUS_OK);
+	assert(first.image != NULL);
+	check_same_script(&parsed, &first);
+
+	/* The first image holds the address the image is linked at, if
+	 * it could be had, so a second one must be relocated.
+	 */
+	init_script(&second);
+	assert(script_cache_load(cache, &second) == STATUS_OK);
+	assert(second.image != NULL && second.image != first.image);
+	check_same_script(&parsed, &second);
+
+	/* Other options mean another entry. */
+	other_cache = script_cache_new(dir, options, 1, &parsed);
+	assert(other_cache != NULL);
+	init_script(&other);
+	assert(script_cache_load(other_cache, &other) == STATUS_ERR);
+
+	script_cache_free(other_cache);
+	script_cache_free(cache);
+	script_free(&second);
+	script_free(&first);
+	script_free(&parsed);
+	remove_cache_dir(dir);
+}
+
+int main(void)
+{
+	test_round_trip();
+	return 0;
+}
+
+#else
+
+int main(void)
+{
+	return 0;		/* --script_cache is Linux-only */
+}
+
+#endif  /* linux */
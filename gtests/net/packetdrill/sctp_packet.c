@@ -32,208 +32,123 @@
  * - Add support for error causes
  */
 
+/* Makes room for 'needed' entries of 'entry_bytes' each in the array
+ * at '*entries', which currently has room for '*capacity' of them.
+ */
+static void
+sctp_list_reserve(void **entries, u32 *capacity, u32 needed,
+		  size_t entry_bytes)
+{
+	u32 new_capacity;
+
+	if (needed <= *capacity) {
+		return;
+	}
+	new_capacity = (*capacity < 16) ? 16 : 2 * *capacity;
+	if (new_capacity < needed) {
+		new_capacity = needed;
+	}
+	*entries = realloc(*entries, new_capacity * entry_bytes);
+	assert(*entries != NULL);
+	*capacity = new_capacity;
+}
+
 struct sctp_byte_list *
 sctp_byte_list_new(void)
 {
 	struct sctp_byte_list *list;
 
-	list = malloc(sizeof(struct sctp_byte_list));
+	list = calloc(1, sizeof(struct sctp_byte_list));
 	assert(list != NULL);
-	list->first = NULL;
-	list->last = NULL;
-	list->nr_entries = 0;
 	return list;
 }
 
 void
-sctp_byte_list_append(struct sctp_byte_list *list,
-                      struct sctp_byte_list_item *item)
+sctp_byte_list_append(struct sctp_byte_list *list, u8 byte)
 {
-	assert(item->next == NULL);
-	if (list->last == NULL) {
-		assert(list->first == NULL);
-		assert(list->nr_entries == 0);
-		list->first = item;
-	} else {
-		assert(list->first != NULL);
-		list->last->next = item;
-	}
-	list->last = item;
-	list->nr_entries++;
+	sctp_byte_list_append_bytes(list, &byte, 1);
 }
 
 void
-sctp_byte_list_free(struct sctp_byte_list *list)
+sctp_byte_list_append_bytes(struct sctp_byte_list *list,
+			    const u8 *bytes, u16 len)
 {
-	struct sctp_byte_list_item *current_item, *next_item;
+	assert(list->nr_entries + len <= UINT16_MAX);
+	sctp_list_reserve((void **)&list->bytes, &list->capacity,
+			  list->nr_entries + len, sizeof(u8));
+	memcpy(list->bytes + list->nr_entries, bytes, len);
+	list->nr_entries += len;
+}
 
+void
+sctp_byte_list_free(struct sctp_byte_list *list)
+{
 	if (list == NULL) {
 		return;
 	}
-	current_item = list->first;
-	while (current_item != NULL) {
-		assert(list->nr_entries > 0);
-		next_item = current_item->next;
-		assert(next_item != NULL || current_item == list->last);
-		free(current_item);
-		current_item = next_item;
-		list->nr_entries--;
-	}
-	assert(list->nr_entries == 0);
+	free(list->bytes);
 	free(list);
 }
 
-struct sctp_byte_list_item *
-sctp_byte_list_item_new(u8 byte)
-{
-	struct sctp_byte_list_item *item;
-
-	item = malloc(sizeof(struct sctp_byte_list_item));
-	assert(item != NULL);
-	item->next = NULL;
-	item->byte = byte;
-	return item;
-}
-
 struct sctp_u16_list *
 sctp_u16_list_new(void)
 {
 	struct sctp_u16_list *list;
 
-	list = malloc(sizeof(struct sctp_u16_list));
+	list = calloc(1, sizeof(struct sctp_u16_list));
 	assert(list != NULL);
-	list->first = NULL;
-	list->last = NULL;
-	list->nr_entries = 0;
 	return list;
 }
 
 void
-sctp_u16_list_append(struct sctp_u16_list *list,
-                      struct sctp_u16_list_item *item)
+sctp_u16_list_append(struct sctp_u16_list *list, u16 value)
 {
-	assert(item->next == NULL);
-	if (list->last == NULL) {
-		assert(list->first == NULL);
-		assert(list->nr_entries == 0);
-		list->first = item;
-	} else {
-		assert(list->first != NULL);
-		list->last->next = item;
-	}
-	list->last = item;
-	list->nr_entries++;
+	assert(list->nr_entries < UINT16_MAX);
+	sctp_list_reserve((void **)&list->values, &list->capacity,
+			  list->nr_entries + 1, sizeof(u16));
+	list->values[list->nr_entries++] = value;
 }
 
 void
 sctp_u16_list_free(struct sctp_u16_list *list)
 {
-	struct sctp_u16_list_item *current_item, *next_item;
-
 	if (list == NULL) {
 		return;
 	}
-	current_item = list->first;
-	while (current_item != NULL) {
-		assert(list->nr_entries > 0);
-		next_item = current_item->next;
-		assert(next_item != NULL || current_item == list->last);
-		free(current_item);
-		current_item = next_item;
-		list->nr_entries--;
-	}
-	assert(list->nr_entries == 0);
+	free(list->values);
 	free(list);
 }
 
-struct sctp_u16_list_item *
-sctp_u16_list_item_new(u16 val)
-{
-	struct sctp_u16_list_item *item;
-
-	item = malloc(sizeof(struct sctp_u16_list_item));
-	assert(item != NULL);
-	item->next = NULL;
-	item->value = val;
-	return item;
-}
-
 struct sctp_sack_block_list *
 sctp_sack_block_list_new(void)
 {
 	struct sctp_sack_block_list *list;
 
-	list = malloc(sizeof(struct sctp_sack_block_list));
+	list = calloc(1, sizeof(struct sctp_sack_block_list));
 	assert(list != NULL);
-	list->first = NULL;
-	list->last = NULL;
-	list->nr_entries = 0;
 	return list;
 }
 
 void
 sctp_sack_block_list_append(struct sctp_sack_block_list *list,
-                            struct sctp_sack_block_list_item *item)
+			    union sctp_sack_block block)
 {
-	assert(item->next == NULL);
-	if (list->last == NULL) {
-		assert(list->first == NULL);
-		assert(list->nr_entries == 0);
-		list->first = item;
-	} else {
-		assert(list->first != NULL);
-		list->last->next = item;
-	}
-	list->last = item;
-	list->nr_entries++;
+	assert(list->nr_entries < UINT16_MAX);
+	sctp_list_reserve((void **)&list->blocks, &list->capacity,
+			  list->nr_entries + 1, sizeof(union sctp_sack_block));
+	list->blocks[list->nr_entries++] = block;
 }
 
 void
 sctp_sack_block_list_free(struct sctp_sack_block_list *list)
 {
-	struct sctp_sack_block_list_item *current_item, *next_item;
-
 	if (list == NULL) {
 		return;
 	}
-	current_item = list->first;
-	while (current_item != NULL) {
-		assert(list->nr_entries > 0);
-		next_item = current_item->next;
-		assert(next_item != NULL || current_item == list->last);
-		free(current_item);
-		current_item = next_item;
-		list->nr_entries--;
-	}
-	assert(list->nr_entries == 0);
+	free(list->blocks);
 	free(list);
 }
 
-struct sctp_sack_block_list_item *
-sctp_sack_block_list_item_gap_new(u16 start, u16 end)
-{
-	struct sctp_sack_block_list_item *item;
-
-	item = malloc(sizeof(struct sctp_sack_block_list_item));
-	assert(item != NULL);
-	item->next = NULL;
-	item->block.gap.start = start;
-	item->block.gap.end = end;
-	return item;
-}
-
-struct sctp_sack_block_list_item *
-sctp_sack_block_list_item_dup_new(u32 tsn)
-{
-	struct sctp_sack_block_list_item *item;
-
-	item = malloc(sizeof(struct sctp_sack_block_list_item));
-	assert(item != NULL);
-	item->next = NULL;
-	item->block.tsn = tsn;
-	return item;
-}
-
 struct sctp_forward_tsn_ids_list *
 sctp_forward_tsn_ids_list_new () {
 	struct sctp_forward_tsn_ids_list *list;
@@ -502,9 +417,8 @@ sctp_generic_chunk_new(s64 type, s64 flgs, s64 len,
                        struct sctp_byte_list *bytes)
 {
 	struct sctp_chunk *chunk;
-	struct sctp_byte_list_item *item;
 	u32 flags;
-	u16 length, header_length, value_length, padding_length, i;
+	u16 length, header_length, value_length, padding_length;
 
 	flags = 0;
 	header_length = (u16)sizeof(struct sctp_chunk);
@@ -543,11 +457,8 @@ sctp_generic_chunk_new(s64 type, s64 flgs, s64 len,
 	}
 	chunk->length = htons(length);
 	if (bytes != NULL) {
-		for (i = 0, item = bytes->first;
-		     item != NULL;
-		     i++, item = item->next) {
-			chunk->value[i] = item->byte;
-		}
+		memcpy(chunk->value, bytes->bytes, value_length);
+		sctp_byte_list_free(bytes);
 	} else {
 		memset(chunk->value, 0, value_length);
 	}
@@ -794,7 +705,6 @@ sctp_sack_chunk_new(s64 flgs, s64 cum_tsn, s64 a_rwnd,
                     struct sctp_sack_block_list *dups)
 {
 	struct _sctp_sack_chunk *chunk;
-	struct sctp_sack_block_list_item *item;
 	u32 flags;
 	u32 length;
 	u16 i, nr_gaps, nr_dups;
@@ -845,23 +755,16 @@ sctp_sack_chunk_new(s64 flgs, s64 cum_tsn, s64 a_rwnd,
 	chunk->nr_dup_tsns = htons(nr_dups);
 
 	if (gaps != NULL) {
-		for (i = 0, item = gaps->first;
-		     (i < nr_gaps) && (item != NULL);
-		     i++, item = item->next) {
-			chunk->block[i].gap.start = htons(item->block.gap.start);
-			chunk->block[i].gap.end = htons(item->block.gap.end);
+		for (i = 0; i < nr_gaps; i++) {
+			chunk->block[i].gap.start = htons(gaps->blocks[i].gap.start);
+			chunk->block[i].gap.end = htons(gaps->blocks[i].gap.end);
 		}
-		assert((i == nr_gaps) && (item == NULL));
 		sctp_sack_block_list_free(gaps);
-		
 	}
 	if (dups != NULL) {
-		for (i = 0, item = dups->first;
-		     (i < nr_dups) && (item != NULL);
-		     i++, item = item->next) {
-			chunk->block[i + nr_gaps].tsn= htonl(item->block.tsn);
+		for (i = 0; i < nr_dups; i++) {
+			chunk->block[i + nr_gaps].tsn = htonl(dups->blocks[i].tsn);
 		}
-		assert((i == nr_dups) && (item == NULL));
 		sctp_sack_block_list_free(dups);
 	}
 	return sctp_chunk_list_item_new((struct sctp_chunk *)chunk,
@@ -876,7 +779,6 @@ sctp_nr_sack_chunk_new(s64 flgs, s64 cum_tsn, s64 a_rwnd,
 		    struct sctp_sack_block_list *nr_gaps_list,
                     struct sctp_sack_block_list *dups) {
 	struct _sctp_nr_sack_chunk *chunk;
-	struct sctp_sack_block_list_item *item;
 	u32 flags;
 	u32 length;
 	u16 i, nr_gaps, nr_dups, number_of_nr_gaps;
@@ -936,32 +838,23 @@ sctp_nr_sack_chunk_new(s64 flgs, s64 cum_tsn, s64 a_rwnd,
 	chunk->nr_of_nr_gap_blocks = htons(number_of_nr_gaps);
 
 	if (gaps != NULL) {
-		for (i = 0, item = gaps->first;
-		     (i < nr_gaps) && (item != NULL);
-		     i++, item = item->next) {
-			chunk->block[i].gap.start = htons(item->block.gap.start);
-			chunk->block[i].gap.end = htons(item->block.gap.end);
+		for (i = 0; i < nr_gaps; i++) {
+			chunk->block[i].gap.start = htons(gaps->blocks[i].gap.start);
+			chunk->block[i].gap.end = htons(gaps->blocks[i].gap.end);
 		}
-		assert((i == nr_gaps) && (item == NULL));
 		sctp_sack_block_list_free(gaps);
 	}
 	if (nr_gaps_list != NULL) {
-		for (i = 0, item = nr_gaps_list->first;
-		     (i < number_of_nr_gaps) && (item != NULL);
-		     i++, item = item->next) {
-			chunk->block[i + nr_gaps].gap.start = htons(item->block.gap.start);
-			chunk->block[i + nr_gaps].gap.end = htons(item->block.gap.end);
+		for (i = 0; i < number_of_nr_gaps; i++) {
+			chunk->block[i + nr_gaps].gap.start = htons(nr_gaps_list->blocks[i].gap.start);
+			chunk->block[i + nr_gaps].gap.end = htons(nr_gaps_list->blocks[i].gap.end);
 		}
-		assert((i == number_of_nr_gaps) && (item == NULL));
 		sctp_sack_block_list_free(nr_gaps_list);
 	}
 	if (dups != NULL) {
-		for (i = 0, item = dups->first;
-		     (i < nr_dups) && (item != NULL);
-		     i++, item = item->next) {
-			chunk->block[i + nr_gaps + number_of_nr_gaps].tsn= htonl(item->block.tsn);
+		for (i = 0; i < nr_dups; i++) {
+			chunk->block[i + nr_gaps + number_of_nr_gaps].tsn = htonl(dups->blocks[i].tsn);
 		}
-		assert((i == nr_dups) && (item == NULL));
 		sctp_sack_block_list_free(dups);
 	}
 	return sctp_chunk_list_item_new((struct sctp_chunk *)chunk,
@@ -1237,9 +1130,8 @@ struct sctp_chunk_list_item *
 sctp_cookie_echo_chunk_new(s64 flgs, s64 len, struct sctp_byte_list *cookie)
 {
 	struct _sctp_cookie_echo_chunk *chunk;
-	struct sctp_byte_list_item *item;
 	u32 flags;
-	u16 chunk_length, cookie_length, padding_length, i;
+	u16 chunk_length, cookie_length, padding_length;
 
 	assert((len == -1) ||
 	       (is_valid_u16(len) &&
@@ -1269,11 +1161,9 @@ sctp_cookie_echo_chunk_new(s64 flgs, s64 len, struct sctp_byte_list *cookie)
 	}
 	chunk->length = htons(chunk_length);
 	if (cookie != NULL) {
-		for (i = 0, item = cookie->first;
-		     item != NULL;
-		     i++, item = item->next) {
-			chunk->cookie[i] = item->byte;
-		}
+		assert(cookie->nr_entries == cookie_length);
+		memcpy(chunk->cookie, cookie->bytes, cookie_length);
+		sctp_byte_list_free(cookie);
 	} else {
 		flags |= FLAG_CHUNK_VALUE_NOCHECK;
 		memset(chunk->cookie, 'A', cookie_length);
@@ -1717,14 +1607,10 @@ sctp_chunk_list_append(struct sctp_chunk_list *list,
 }
 
 void
-sctp_chunk_list_free(struct sctp_chunk_list *list)
+sctp_chunk_list_clear(struct sctp_chunk_list *list)
 {
 	struct sctp_chunk_list_item *current_item, *next_item;
-	
-	if (list == NULL) {
-		return;
-	}
-	
+
 	current_item = list->first;
 	while (current_item != NULL) {
 		next_item = current_item->next;
@@ -1736,6 +1622,19 @@ sctp_chunk_list_free(struct sctp_chunk_list *list)
 		free(current_item);
 		current_item = next_item;
 	}
+	list->first = NULL;
+	list->last = NULL;
+	list->length = 0;
+}
+
+void
+sctp_chunk_list_free(struct sctp_chunk_list *list)
+{
+	if (list == NULL) {
+		return;
+	}
+
+	sctp_chunk_list_clear(list);
 	free(list);
 }
 
@@ -1757,9 +1656,8 @@ struct sctp_parameter_list_item *
 sctp_generic_parameter_new(s64 type, s64 len, struct sctp_byte_list *bytes)
 {
 	struct sctp_parameter *parameter;
-	struct sctp_byte_list_item *item;
 	u32 flags;
-	u16 length, header_length, value_length, padding_length, i;
+	u16 length, header_length, value_length, padding_length;
 
 	flags = 0;
 	header_length = (u16)sizeof(struct sctp_parameter);
@@ -1792,11 +1690,8 @@ sctp_generic_parameter_new(s64 type, s64 len, struct sctp_byte_list *bytes)
 	}
 	parameter->length = htons(length);
 	if (bytes != NULL) {
-		for (i = 0, item = bytes->first;
-		     item != NULL;
-		     i++, item = item->next) {
-			parameter->value[i] = item->byte;
-		}
+		memcpy(parameter->value, bytes->bytes, value_length);
+		sctp_byte_list_free(bytes);
 	} else {
 		memset(parameter->value, 0, value_length);
 	}
@@ -2051,8 +1946,7 @@ sctp_supported_extensions_parameter_new(struct sctp_byte_list *list)
 	struct sctp_supported_extensions_parameter *parameter;
 
 	u32 flags;
-	u16 i, parameter_length, padding_length;
-	struct sctp_byte_list_item *item;
+	u16 parameter_length, padding_length;
 
 	flags = 0;
 	parameter_length = sizeof(struct sctp_supported_extensions_parameter);
@@ -2074,13 +1968,9 @@ sctp_supported_extensions_parameter_new(struct sctp_byte_list *list)
 	parameter->type = htons(SCTP_SUPPORTED_EXTENSIONS_PARAMETER_TYPE);
 	parameter->length = htons(parameter_length);
 	if (list != NULL) {
-		for (i = 0, item = list->first;
-		     (i < list->nr_entries) && (item != NULL);
-		     i++, item = item->next) {
-			parameter->chunk_type[i] = item->byte;
-		}
-		assert((i == list->nr_entries) && (item == NULL));
+		memcpy(parameter->chunk_type, list->bytes, list->nr_entries);
 		memset(parameter->chunk_type + list->nr_entries, 0, padding_length);
+		sctp_byte_list_free(list);
 	}
 	return sctp_parameter_list_item_new((struct sctp_parameter *)parameter,
 	                                    parameter_length, flags);
@@ -2157,7 +2047,7 @@ sctp_outgoing_ssn_reset_request_parameter_new(s64 reqsn, s64 respsn, s64 last_ts
 	struct sctp_outgoing_ssn_reset_request_parameter *parameter;
 	u32 flags = 0;
 	u16 parameter_length;
-	int i = 0, sid_len = 0;
+	int i, sid_len = 0;
 
 	if (sids != NULL) {
 		sid_len = sids->nr_entries;
@@ -2188,12 +2078,10 @@ sctp_outgoing_ssn_reset_request_parameter_new(s64 reqsn, s64 respsn, s64 last_ts
 	} else {
 		parameter->last_tsn = htonl((u32)last_tsn);
 	}
-	if (sids != NULL) {
-		struct sctp_u16_list_item *item;
-		for (item = sids->first; item != NULL; item = item->next) {
-			parameter->sids[i++] = htons(item->value);
-		}
+	for (i = 0; i < sid_len; i++) {
+		parameter->sids[i] = htons(sids->values[i]);
 	}
+	sctp_u16_list_free(sids);
 
 	return sctp_parameter_list_item_new((struct sctp_parameter *)parameter,
 					    parameter_length, flags);
@@ -2205,7 +2093,7 @@ sctp_incoming_ssn_reset_request_parameter_new(s64 reqsn, struct sctp_u16_list *s
 	struct sctp_incoming_ssn_reset_request_parameter *parameter;
 	u32 flags = 0;
 	u16 parameter_length;
-	int i = 0, sid_len = 0;
+	int i, sid_len = 0;
 
 	if (sids != NULL) {
 		sid_len = sids->nr_entries;
@@ -2224,12 +2112,10 @@ sctp_incoming_ssn_reset_request_parameter_new(s64 reqsn, struct sctp_u16_list *s
 	} else {
 		parameter->reqsn = htonl((u32)reqsn);
 	}
-	if (sids != NULL) {
-		struct sctp_u16_list_item *item;
-		for (item = sids->first; item != NULL; item = item->next) {
-			parameter->sids[i++] = htons(item->value);
-		}
+	for (i = 0; i < sid_len; i++) {
+		parameter->sids[i] = htons(sids->values[i]);
 	}
+	sctp_u16_list_free(sids);
 	return sctp_parameter_list_item_new((struct sctp_parameter *)parameter,
 					    parameter_length, flags);
 }
@@ -2379,7 +2265,6 @@ struct sctp_parameter_list_item *
 sctp_generic_reconfig_request_parameter_new(s32 type, s32 len, s64 reqsn, struct sctp_byte_list *payload)
 {
 	struct sctp_reconfig_generic_request_parameter *parameter;
-	struct sctp_byte_list_item *item;
 	u32 flags = 0;
 	u16 parameter_length;
 	u16 payload_len=0;
@@ -2409,10 +2294,8 @@ sctp_generic_reconfig_request_parameter_new(s32 type, s32 len, s64 reqsn, struct
 		parameter->reqsn = htonl((u32)reqsn);
 	}
 	if (payload != NULL) {
-		int i = 0;
-		for (i = 0, item = payload->first; item != NULL; i++, item = item->next) {
-			parameter->value[i] = item->byte;
-		}
+		memcpy(parameter->value, payload->bytes, payload_len);
+		sctp_byte_list_free(payload);
 	}
 
 	return sctp_parameter_list_item_new((struct sctp_parameter *)parameter,
@@ -2518,9 +2401,8 @@ struct sctp_cause_list_item *
 sctp_generic_cause_new(s64 code, s64 len, struct sctp_byte_list *bytes)
 {
 	struct sctp_cause *cause;
-	struct sctp_byte_list_item *item;
 	u32 flags;
-	u16 length, header_length, information_length, padding_length, i;
+	u16 length, header_length, information_length, padding_length;
 
 	flags = 0;
 	header_length = (u16)sizeof(struct sctp_cause);
@@ -2553,11 +2435,8 @@ sctp_generic_cause_new(s64 code, s64 len, struct sctp_byte_list *bytes)
 	}
 	cause->length = htons(length);
 	if (bytes != NULL) {
-		for (i = 0, item = bytes->first;
-		     item != NULL;
-		     i++, item = item->next) {
-			cause->information[i] = item->byte;
-		}
+		memcpy(cause->information, bytes->bytes, information_length);
+		sctp_byte_list_free(bytes);
 	} else {
 		memset(cause->information, 0, information_length);
 	}
@@ -3519,10 +3398,10 @@ new_sctp_packet(int address_family,
 
 #ifdef DEBUG
 static void print_sctp_byte_list(struct sctp_byte_list *list) {
-	struct sctp_byte_list_item *item;
+	u16 i;
 
-	for (item = list->first; item != NULL; item = item->next) {
-		DEBUGP("0x%.2x,", item->byte);
+	for (i = 0; i < list->nr_entries; i++) {
+		DEBUGP("0x%.2x,", list->bytes[i]);
 	}
 }
 #endif
@@ -3539,7 +3418,6 @@ new_sctp_generic_packet(int address_family,
 			char **error) {
 	struct packet *packet;  /* the newly-allocated result packet */
 	struct header *sctp_header, *udp_header;
-	struct sctp_byte_list_item *item = NULL;
 	/* Calculate lengths in bytes of all sections of the packet */
 	const int ip_option_bytes = 0;
 	const int ip_header_bytes = (ip_header_min_len(address_family) +
@@ -3549,7 +3427,6 @@ new_sctp_generic_packet(int address_family,
 	const int sctp_chunk_bytes = bytes->nr_entries;
 	int ip_bytes;
 	bool encapsulate = (udp_src_port > 0) || (udp_dst_port > 0);
-	u16 i;
 
 #ifdef DEBUG
 	print_sctp_byte_list(bytes);
@@ -3558,6 +3435,7 @@ new_sctp_generic_packet(int address_family,
 	if (direction == DIRECTION_OUTBOUND) {
 		asprintf(error,
 			"generic packets can only be specified as inbound.");
+		sctp_byte_list_free(bytes);
 		return NULL;
 	}
 
@@ -3566,6 +3444,7 @@ new_sctp_generic_packet(int address_family,
 		asprintf(error, "IP options are not padded correctly "
 			 "to ensure IP header is a multiple of 4 bytes: "
 			 "%d excess bytes", ip_option_bytes & 0x3);
+		sctp_byte_list_free(bytes);
 		return NULL;
 	}
 	assert((ip_header_bytes & 0x3) == 0);
@@ -3577,6 +3456,7 @@ new_sctp_generic_packet(int address_family,
 
 	if (ip_bytes > MAX_SCTP_DATAGRAM_BYTES) {
 		asprintf(error, "SCTP packet too large");
+		sctp_byte_list_free(bytes);
 		return NULL;
 	}
 
@@ -3629,9 +3509,8 @@ new_sctp_generic_packet(int address_family,
 	packet->sctp->v_tag = htonl((u32)tag);
 	packet->sctp->crc32c = htonl(0);
 
-	for (i = 0, item = bytes->first; item != NULL; i++, item = item->next) {
-		sctp_chunk_start[i] = item->byte;
-	}
+	memcpy(sctp_chunk_start, bytes->bytes, sctp_chunk_bytes);
+	sctp_byte_list_free(bytes);
 
 	packet->chunk_list = NULL;
 	packet->ip_bytes = ip_bytes;
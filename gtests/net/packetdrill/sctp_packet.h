@@ -29,63 +29,52 @@
 #include "packet.h"
 #include "sctp.h"
 
-struct sctp_byte_list_item {
-	struct sctp_byte_list_item *next;
-	u8 byte;
-};
-
+/* The byte, u16 and SACK block lists built by the parser keep their
+ * entries in one contiguous, growable array, so that scripts with long
+ * cookies or payloads cost a handful of reallocs rather than a malloc
+ * per byte, and so that chunks can be filled in with a single memcpy.
+ * The chunk, parameter, cause and packet constructors below take
+ * ownership of any such list passed to them, and free it.
+ */
 struct sctp_byte_list {
-	struct sctp_byte_list_item *first;
-	struct sctp_byte_list_item *last;
+	u8 *bytes;
 	u16 nr_entries;
+	u32 capacity;
 };
 
 struct sctp_byte_list *
 sctp_byte_list_new(void);
 
 void
-sctp_byte_list_append(struct sctp_byte_list *list,
-                      struct sctp_byte_list_item *item);
+sctp_byte_list_append(struct sctp_byte_list *list, u8 byte);
 
 void
-sctp_byte_list_free(struct sctp_byte_list *list);
+sctp_byte_list_append_bytes(struct sctp_byte_list *list,
+			    const u8 *bytes, u16 len);
 
-struct sctp_byte_list_item *
-sctp_byte_list_item_new(u8 byte);
-
-struct sctp_u16_list_item {
-	struct sctp_u16_list_item *next;
-	u16 value;
-};
+void
+sctp_byte_list_free(struct sctp_byte_list *list);
 
 struct sctp_u16_list {
-	struct sctp_u16_list_item *first;
-	struct sctp_u16_list_item *last;
+	u16 *values;
 	u16 nr_entries;
+	u32 capacity;
 };
 
 struct sctp_u16_list *
 sctp_u16_list_new(void);
 
 void
-sctp_u16_list_append(struct sctp_u16_list *list,
-		     struct sctp_u16_list_item *item);
+sctp_u16_list_append(struct sctp_u16_list *list, u16 value);
 
 void
 sctp_u16_list_free(struct sctp_u16_list *list);
 
-struct sctp_u16_list_item *
-sctp_u16_list_item_new(u16 val);
-
-struct sctp_sack_block_list_item {
-	struct sctp_sack_block_list_item *next;
-	union sctp_sack_block block;
-};
-
+/* The blocks are kept in host byte order. */
 struct sctp_sack_block_list {
-	struct sctp_sack_block_list_item *first;
-	struct sctp_sack_block_list_item *last;
+	union sctp_sack_block *blocks;
 	u16 nr_entries;
+	u32 capacity;
 };
 
 struct sctp_sack_block_list *
@@ -93,17 +82,11 @@ sctp_sack_block_list_new(void);
 
 void
 sctp_sack_block_list_append(struct sctp_sack_block_list *list,
-			    struct sctp_sack_block_list_item *item);
+			    union sctp_sack_block block);
 
 void
 sctp_sack_block_list_free(struct sctp_sack_block_list *list);
 
-struct sctp_sack_block_list_item *
-sctp_sack_block_list_item_gap_new(u16 start, u16 end);
-
-struct sctp_sack_block_list_item *
-sctp_sack_block_list_item_dup_new(u32 tsn);
-
 struct sctp_forward_tsn_ids_list_item {
 	struct sctp_forward_tsn_ids_list_item *next;
 	u16 stream_identifier;
@@ -398,6 +381,9 @@ void
 sctp_chunk_list_append(struct sctp_chunk_list *list,
                        struct sctp_chunk_list_item *item);
 
+void
+sctp_chunk_list_clear(struct sctp_chunk_list *list);
+
 void
 sctp_chunk_list_free(struct sctp_chunk_list *list);
 
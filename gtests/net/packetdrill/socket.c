@@ -26,8 +26,25 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include "hash.h"
 #include "run.h"
 
+/* Initial number of hash buckets for each tuple type; must be a power
+ * of two. We double the bucket count whenever the load factor hits 1.
+ */
+#define SOCKET_INDEX_INITIAL_BUCKETS	16
+
+/* One chained hash table of sockets, keyed by one type of tuple. */
+struct socket_table {
+	struct socket **buckets;	/* chains linked via index_links */
+	u32 num_buckets;		/* number of buckets; a power of 2 */
+	u32 num_sockets;		/* number of sockets in the table */
+};
+
+struct socket_index {
+	struct socket_table tables[SOCKET_INDEX_NUM_KEYS];
+};
+
 struct socket *socket_new(struct state *state)
 {
 	struct socket *socket = calloc(1, sizeof(struct socket));
@@ -39,6 +56,10 @@ struct socket *socket_new(struct state *state)
 
 void socket_free(struct socket *socket)
 {
+	struct packet *packet;
+
+	while ((packet = socket_unpark_packet(socket)) != NULL)
+		packet_free(packet);
 	hash_map_free(socket->ts_val_map);
 	 /* paranoia to help catch bugs */
 	memset(socket->prepared_cookie_echo, 0, socket->prepared_cookie_echo_length);
@@ -50,3 +71,238 @@ void socket_free(struct socket *socket)
 	memset(socket, 0, sizeof(*socket));
 	free(socket);
 }
+
+struct packet *socket_park_packet(struct socket *socket,
+				  struct packet *packet)
+{
+	struct packet *dropped = NULL;
+
+	if (socket->num_parked_packets == MAX_PARKED_PACKETS)
+		dropped = socket_unpark_packet(socket);
+	socket->parked_packets[socket->num_parked_packets++] = packet;
+	return dropped;
+}
+
+struct packet *socket_unpark_packet(struct socket *socket)
+{
+	struct packet *packet;
+
+	if (socket->num_parked_packets == 0)
+		return NULL;
+	packet = socket->parked_packets[0];
+	--socket->num_parked_packets;
+	memmove(&socket->parked_packets[0], &socket->parked_packets[1],
+		socket->num_parked_packets * sizeof(struct packet *));
+	return packet;
+}
+
+struct socket_index *socket_index_new(void)
+{
+	struct socket_index *index = calloc(1, sizeof(struct socket_index));
+	int key;
+
+	for (key = 0; key < SOCKET_INDEX_NUM_KEYS; ++key) {
+		struct socket_table *table = &index->tables[key];
+
+		table->num_buckets = SOCKET_INDEX_INITIAL_BUCKETS;
+		table->buckets = calloc(table->num_buckets,
+					sizeof(struct socket *));
+	}
+	return index;
+}
+
+void socket_index_free(struct socket_index *index)
+{
+	int key;
+
+	for (key = 0; key < SOCKET_INDEX_NUM_KEYS; ++key)
+		free(index->tables[key].buckets);
+	memset(index, 0, sizeof(*index));  /* paranoia to help catch bugs */
+	free(index);
+}
+
+static u32 tuple_hash(const struct tuple *tuple)
+{
+	u32 hash = 0;
+
+	MurmurHash3_x86_32(tuple, sizeof(*tuple), 0, &hash);
+	return hash;
+}
+
+/* Return the bucket chain where the given tuple belongs. */
+static struct socket **table_bucket(struct socket_table *table,
+				    const struct tuple *tuple)
+{
+	return &table->buckets[tuple_hash(tuple) & (table->num_buckets - 1)];
+}
+
+static void table_insert(struct socket_table *table,
+			 enum socket_index_key_t key,
+			 struct socket *socket);
+
+/* Double the number of buckets and rehash all the sockets. */
+static void table_grow(struct socket_table *table,
+		       enum socket_index_key_t key)
+{
+	struct socket **old_buckets = table->buckets;
+	u32 old_num_buckets = table->num_buckets;
+	u32 i;
+
+	table->num_buckets *= 2;
+	table->buckets = calloc(table->num_buckets, sizeof(struct socket *));
+	table->num_sockets = 0;
+
+	for (i = 0; i < old_num_buckets; ++i) {
+		struct socket *socket = old_buckets[i];
+
+		while (socket != NULL) {
+			struct socket *next = socket->index_links[key].next;
+
+			table_insert(table, key, socket);
+			socket = next;
+		}
+	}
+	free(old_buckets);
+}
+
+/* Add the socket to the head of its chain, under the tuple already
+ * stored in its link for this key.
+ */
+static void table_insert(struct socket_table *table,
+			 enum socket_index_key_t key,
+			 struct socket *socket)
+{
+	struct socket_index_link *link = &socket->index_links[key];
+	struct socket **bucket = table_bucket(table, &link->tuple);
+
+	link->next = *bucket;
+	link->is_indexed = true;
+	*bucket = socket;
+	++table->num_sockets;
+}
+
+static void table_remove(struct socket_table *table,
+			 enum socket_index_key_t key,
+			 struct socket *socket)
+{
+	struct socket_index_link *link = &socket->index_links[key];
+	struct socket **prev = table_bucket(table, &link->tuple);
+
+	while (*prev != socket) {
+		assert(*prev != NULL);
+		prev = &(*prev)->index_links[key].next;
+	}
+	*prev = link->next;
+	link->next = NULL;
+	link->is_indexed = false;
+	--table->num_sockets;
+}
+
+/* Fill in the inbound tuple of the given type for the socket. Return
+ * true iff the tuple is complete enough to index.
+ */
+static bool socket_index_tuple(const struct socket *socket,
+			       enum socket_index_key_t key,
+			       struct tuple *tuple)
+{
+	const struct socket_state *state = (key == SOCKET_INDEX_LIVE) ?
+		&socket->live : &socket->script;
+
+	socket_get_inbound(state, tuple);
+	return (tuple->src.port != 0) && (tuple->dst.port != 0);
+}
+
+void socket_index_update(struct socket_index *index, struct socket *socket)
+{
+	int key;
+
+	for (key = 0; key < SOCKET_INDEX_NUM_KEYS; ++key) {
+		struct socket_table *table = &index->tables[key];
+		struct socket_index_link *link = &socket->index_links[key];
+		struct tuple tuple;
+		bool is_complete = socket_index_tuple(socket, key, &tuple);
+
+		if (link->is_indexed) {
+			if (is_complete && is_equal_tuple(&tuple, &link->tuple))
+				continue;
+			table_remove(table, key, socket);
+		}
+		if (!is_complete)
+			continue;
+
+		if (table->num_sockets >= table->num_buckets)
+			table_grow(table, key);
+		link->tuple = tuple;
+		table_insert(table, key, socket);
+	}
+}
+
+void socket_index_remove(struct socket_index *index, struct socket *socket)
+{
+	int key;
+
+	for (key = 0; key < SOCKET_INDEX_NUM_KEYS; ++key) {
+		if (socket->index_links[key].is_indexed)
+			table_remove(&index->tables[key], key, socket);
+	}
+}
+
+/* Return true iff the socket speaks the transport protocol of the
+ * packet, checked in the same order get_packet_tuple() uses.
+ */
+static bool is_protocol_match(const struct socket *socket,
+			      const struct packet *packet)
+{
+	if (packet->sctp != NULL)
+		return socket->protocol == IPPROTO_SCTP;
+	if (packet->tcp != NULL)
+		return socket->protocol == IPPROTO_TCP;
+	if (packet->udp != NULL)
+		return socket->protocol == IPPROTO_UDP;
+	if (packet->udplite != NULL)
+		return socket->protocol == IPPROTO_UDPLITE;
+	return false;
+}
+
+/* Return the socket indexed under the given inbound tuple, if any. */
+static struct socket *table_lookup(struct socket_table *table,
+				   enum socket_index_key_t key,
+				   const struct tuple *tuple,
+				   const struct packet *packet)
+{
+	struct socket *socket = *table_bucket(table, tuple);
+
+	for (; socket != NULL; socket = socket->index_links[key].next) {
+		if (is_equal_tuple(&socket->index_links[key].tuple, tuple) &&
+		    is_protocol_match(socket, packet))
+			return socket;
+	}
+	return NULL;
+}
+
+struct socket *socket_index_find(struct socket_index *index,
+				 enum socket_index_key_t key,
+				 const struct packet *packet,
+				 enum direction_t *direction)
+{
+	struct socket_table *table = &index->tables[key];
+	struct tuple packet_tuple, reversed_tuple;
+	struct socket *socket = NULL;
+
+	get_packet_tuple(packet, &packet_tuple);
+
+	socket = table_lookup(table, key, &packet_tuple, packet);
+	if (socket != NULL) {
+		*direction = DIRECTION_INBOUND;
+		return socket;
+	}
+
+	memset(&reversed_tuple, 0, sizeof(reversed_tuple));
+	reverse_tuple(&packet_tuple, &reversed_tuple);
+	socket = table_lookup(table, key, &reversed_tuple, packet);
+	if (socket != NULL) {
+		*direction = DIRECTION_OUTBOUND;
+		return socket;
+	}
+	return NULL;
+}
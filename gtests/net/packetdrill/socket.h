@@ -81,6 +81,28 @@ struct socket_state {
 	u32 remote_initiate_tag;	/* v-tag expected by the peer */
 };
 
+/* The 4-tuples under which we index sockets: the live tuple lets us
+ * classify sniffed packets, and the script tuple lets us route script
+ * packets, to the right one of many concurrent sockets.
+ */
+enum socket_index_key_t {
+	SOCKET_INDEX_LIVE,
+	SOCKET_INDEX_SCRIPT,
+	SOCKET_INDEX_NUM_KEYS,
+};
+
+/* A socket's membership in one of the hash chains of a socket_index. */
+struct socket_index_link {
+	struct socket *next;		/* next socket in the same bucket */
+	struct tuple tuple;		/* inbound tuple we're indexed under */
+	bool is_indexed;		/* are we currently in the index? */
+};
+
+/* How many sniffed outbound packets we hold for a socket while the
+ * script is busy with other sockets.
+ */
+#define MAX_PARKED_PACKETS	64
+
 /* The runtime state for a socket */
 struct socket {
 	enum socket_state_t state;	/* current state of socket */
@@ -127,6 +149,17 @@ struct socket {
 	u16 prepared_heartbeat_ack_length;
 
 	struct socket *next;	/* next in linked list of sockets */
+
+	/* Our entries in state->socket_index, one per key type. */
+	struct socket_index_link index_links[SOCKET_INDEX_NUM_KEYS];
+
+	/* Outbound live packets for this socket that we sniffed while
+	 * the script expected a packet from another socket, oldest
+	 * first. The script's next outbound packet for this socket is
+	 * checked against the oldest of them before we sniff again.
+	 */
+	struct packet *parked_packets[MAX_PARKED_PACKETS];
+	int num_parked_packets;
 };
 
 struct state;
@@ -137,6 +170,49 @@ extern struct socket *socket_new(struct state *state);
 /* Deallocate a socket. */
 extern void socket_free(struct socket *socket);
 
+/* Hold the given sniffed outbound packet for the socket until the
+ * script expects it. If the socket already holds MAX_PARKED_PACKETS,
+ * drop and return the oldest, for the caller to free; else return NULL.
+ */
+extern struct packet *socket_park_packet(struct socket *socket,
+					 struct packet *packet);
+
+/* Return the oldest packet parked for the socket, which the caller
+ * now owns, or NULL if there is none.
+ */
+extern struct packet *socket_unpark_packet(struct socket *socket);
+
+/* A hash index of sockets by their live and script 4-tuples. */
+struct socket_index;
+
+/* Allocate and initialize an empty socket index. */
+extern struct socket_index *socket_index_new(void);
+
+/* Free the index. Does not free the sockets in it. */
+extern void socket_index_free(struct socket_index *index);
+
+/* (Re-)index the given socket under its current live and script
+ * 4-tuples. Call this whenever either tuple changes. Sockets whose
+ * tuple does not yet have both ports filled in are not indexed under
+ * that tuple.
+ */
+extern void socket_index_update(struct socket_index *index,
+				struct socket *socket);
+
+/* Remove the given socket from the index entirely. */
+extern void socket_index_remove(struct socket_index *index,
+				struct socket *socket);
+
+/* Return the most recently indexed socket of the matching protocol
+ * whose tuple of the given type matches the 4-tuple of the given
+ * packet, or NULL if there is none. On success, set *direction to
+ * tell whether the packet is inbound to or outbound from the socket.
+ */
+extern struct socket *socket_index_find(struct socket_index *index,
+					enum socket_index_key_t key,
+					const struct packet *packet,
+					enum direction_t *direction);
+
 /* Get the tuple we expect to see in outbound packets from this socket. */
 static inline void socket_get_outbound(
 	const struct socket_state *socket_state, struct tuple *tuple)
@@ -0,0 +1,199 @@
+/*
+ * Copyright 2013 Google Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+/*
+ * Implementation for the timing statistics we gather for --stats_json.
+ *
+ * The histogram buckets are laid out as in HdrHistogram: the first
+ * HISTOGRAM_SUB_BUCKETS buckets hold the values 0, 1, 2, ... exactly,
+ * and after that each power of two range [2^k, 2^(k+1)) is split into
+ * HISTOGRAM_SUB_BUCKETS/2 equal buckets, so bucket widths grow in
+ * step with the values they hold.
+ */
+
+#include "stats.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "logging.h"
+
+/* Return the index of the bucket counting the given value. */
+static int histogram_index(u64 value)
+{
+	int shift;
+
+	if (value < HISTOGRAM_SUB_BUCKETS)
+		return value;
+
+	/* Shift the value down so it has HISTOGRAM_SUB_BUCKET_BITS
+	 * significant bits, the top one of which is always set.
+	 */
+	shift = 63 - __builtin_clzll(value) - (HISTOGRAM_SUB_BUCKET_BITS - 1);
+	if (shift > HISTOGRAM_MAX_SHIFT)
+		return HISTOGRAM_BUCKETS - 1;
+	return HISTOGRAM_SUB_BUCKETS +
+		(shift - 1) * (HISTOGRAM_SUB_BUCKETS / 2) +
+		(int)(value >> shift) - (HISTOGRAM_SUB_BUCKETS / 2);
+}
+
+/* Return the largest value counted by the bucket at the given index. */
+static u64 histogram_bucket_max(int index)
+{
+	int shift;
+	u64 sub_bucket;
+
+	if (index < HISTOGRAM_SUB_BUCKETS)
+		return index;
+
+	index -= HISTOGRAM_SUB_BUCKETS;
+	shift = index / (HISTOGRAM_SUB_BUCKETS / 2) + 1;
+	sub_bucket = index % (HISTOGRAM_SUB_BUCKETS / 2) +
+		(HISTOGRAM_SUB_BUCKETS / 2);
+	return ((sub_bucket + 1) << shift) - 1;
+}
+
+void histogram_record(struct histogram *histogram, s64 value)
+{
+	u64 magnitude = (value < 0) ? -(u64)value : (u64)value;
+
+	++histogram->counts[histogram_index(magnitude)];
+	if (histogram->total_count == 0 || magnitude < histogram->min)
+		histogram->min = magnitude;
+	if (magnitude > histogram->max)
+		histogram->max = magnitude;
+	histogram->sum += magnitude;
+	++histogram->total_count;
+}
+
+u64 histogram_percentile(const struct histogram *histogram,
+			 double percentile)
+{
+	u64 target, count = 0;
+	int i;
+
+	if (histogram->total_count == 0)
+		return 0;
+
+	/* The rank of the value we want, counting from 1. */
+	target = (u64)(percentile / 100.0 * histogram->total_count + 0.5);
+	target = max(target, 1ULL);
+
+	for (i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+		count += histogram->counts[i];
+		if (count >= target) {
+			/* Don't overstate the value for sparse buckets. */
+			return min(histogram_bucket_max(i), histogram->max);
+		}
+	}
+	return histogram->max;
+}
+
+struct script_stats *script_stats_new(void)
+{
+	return calloc(1, sizeof(struct script_stats));
+}
+
+void script_stats_free(struct script_stats *stats)
+{
+	free(stats);
+}
+
+void stats_report_init(const char *path)
+{
+	int fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+
+	if (fd < 0)
+		die_perror("open --stats_json file");
+	close(fd);
+}
+
+/* Write the given string as a JSON string literal. */
+static void write_json_string(FILE *s, const char *string)
+{
+	const char *p;
+
+	fputc('"', s);
+	for (p = string; *p != '\0'; ++p) {
+		if (*p == '"' || *p == '\\')
+			fprintf(s, "\\%c", *p);
+		else if ((u8)*p < 0x20)
+			fprintf(s, "\\u%04x", (u8)*p);
+		else
+			fputc(*p, s);
+	}
+	fputc('"', s);
+}
+
+static void write_json_histogram(FILE *s, const char *name,
+				 const struct histogram *histogram)
+{
+	double mean = 0;
+
+	if (histogram->total_count > 0)
+		mean = histogram->sum / histogram->total_count;
+
+	fprintf(s, "\"%s\":{\"count\":%llu,\"min\":%llu,\"mean\":%.1f,"
+		"\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,\"p99.9\":%llu,"
+		"\"max\":%llu}",
+		name, histogram->total_count, histogram->min, mean,
+		histogram_percentile(histogram, 50),
+		histogram_percentile(histogram, 90),
+		histogram_percentile(histogram, 99),
+		histogram_percentile(histogram, 99.9),
+		histogram->max);
+}
+
+void script_stats_write(const struct script_stats *stats,
+			const char *path, const char *script_path,
+			int tolerance_usecs, bool passed)
+{
+	char *line = NULL;
+	size_t size = 0;
+	FILE *s = open_memstream(&line, &size);
+	int fd;
+
+	fputs("{\"script\":", s);
+	write_json_string(s, script_path);
+	fprintf(s, ",\"passed\":%s,\"tolerance_usecs\":%d,",
+		passed ? "true" : "false", tolerance_usecs);
+	fprintf(s, "\"packets\":{\"injected\":%llu,\"sniffed\":%llu,"
+		"\"ignored\":%llu},",
+		stats->packets_injected, stats->packets_sniffed,
+		stats->packets_ignored);
+	write_json_histogram(s, "scheduling_error_usecs",
+			     &stats->scheduling_error);
+	fputc(',', s);
+	write_json_histogram(s, "packet_timing_error_usecs",
+			     &stats->packet_timing_error);
+	fputc(',', s);
+	write_json_histogram(s, "syscall_duration_usecs",
+			     &stats->syscall_duration);
+	fputs("}\n", s);
+	fclose(s);
+
+	fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+	if (fd < 0)
+		die_perror("open --stats_json file");
+	if (write(fd, line, size) != (ssize_t)size)
+		die_perror("write --stats_json file");
+	close(fd);
+	free(line);
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2013 Google Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+/*
+ * Interface for the timing statistics we gather for --stats_json: how
+ * far from their scheduled times events actually happen, and how much
+ * traffic a script moves, so that scripts drifting toward the edge of
+ * tolerance_usecs can be spotted before they start to flake.
+ */
+
+#ifndef __STATS_H__
+#define __STATS_H__
+
+#include "types.h"
+
+/* A histogram in the style of HdrHistogram. Values below
+ * HISTOGRAM_SUB_BUCKETS are counted exactly; larger ones fall into
+ * buckets less than 1/64 as wide as the values they hold, so the
+ * percentiles we report are within 2% of the true values, while the
+ * histogram stays a small fixed size and recording a value is O(1).
+ */
+#define HISTOGRAM_SUB_BUCKET_BITS	7
+#define HISTOGRAM_SUB_BUCKETS		(1 << HISTOGRAM_SUB_BUCKET_BITS)
+#define HISTOGRAM_MAX_SHIFT		32	/* values up to ~2^39 */
+#define HISTOGRAM_BUCKETS		(HISTOGRAM_SUB_BUCKETS + \
+					 HISTOGRAM_MAX_SHIFT * \
+					 (HISTOGRAM_SUB_BUCKETS / 2))
+
+struct histogram {
+	u64 counts[HISTOGRAM_BUCKETS];
+	u64 total_count;		/* number of values recorded */
+	u64 min;			/* smallest value recorded */
+	u64 max;			/* largest value recorded */
+	double sum;			/* sum of values, for the mean */
+};
+
+/* Record a value. We record the magnitude of negative values, since
+ * what we care about is how far off something was.
+ */
+extern void histogram_record(struct histogram *histogram, s64 value);
+
+/* Return the value at the given percentile (e.g. 99.9), or 0 if the
+ * histogram is empty.
+ */
+extern u64 histogram_percentile(const struct histogram *histogram,
+				double percentile);
+
+/* Everything we measure about one run of a script. */
+struct script_stats {
+	struct histogram scheduling_error;	/* usecs late for events */
+	struct histogram packet_timing_error;	/* usecs outbound packets
+						 * were off their times
+						 */
+	struct histogram syscall_duration;	/* usecs system calls took */
+
+	u64 packets_injected;		/* inbound packets we injected */
+	u64 packets_sniffed;		/* outbound packets we sniffed */
+	u64 packets_ignored;		/* sniffed, but not for the script */
+};
+
+/* Allocate and return zeroed statistics for a script. */
+extern struct script_stats *script_stats_new(void);
+
+/* Free the given statistics. */
+extern void script_stats_free(struct script_stats *stats);
+
+/* Create the given report file if it does not exist, so that we fail
+ * up front rather than after running a script if we can't write it.
+ * An existing report is kept and appended to, so that separate
+ * packetdrill processes can share one; the caller rotates it as
+ * needed. Exits on error.
+ */
+extern void stats_report_init(const char *path);
+
+/* Append the statistics for a script to the report file as a line of
+ * JSON. Each line is a single write() to a file opened for appending,
+ * so scripts running in parallel can share a report. Exits on error.
+ */
+extern void script_stats_write(const struct script_stats *stats,
+			       const char *path, const char *script_path,
+			       int tolerance_usecs, bool passed);
+
+#endif /* __STATS_H__ */
@@ -0,0 +1,200 @@
+/*
+ * Copyright 2013 Google Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+/*
+ * Unit test for stats.c.
+ */
+
+#include "stats.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "assert.h"
+
+int debug_logging = 0;
+
+/* Return true iff 'value' is no more than 2% above 'expected'. */
+static bool is_close(u64 value, u64 expected)
+{
+	return value >= expected && value <= expected + expected / 50;
+}
+
+static void test_histogram_empty(void)
+{
+	struct histogram *histogram = calloc(1, sizeof(*histogram));
+
+	assert(histogram_percentile(histogram, 50) == 0);
+	assert(histogram_percentile(histogram, 100) == 0);
+	free(histogram);
+}
+
+static void test_histogram_exact(void)
+{
+	struct histogram *histogram = calloc(1, sizeof(*histogram));
+	int i;
+
+	/* Small values each get a bucket of their own. */
+	for (i = 0; i < HISTOGRAM_SUB_BUCKETS; ++i)
+		histogram_record(histogram, i);
+	assert(histogram->total_count == HISTOGRAM_SUB_BUCKETS);
+	assert(histogram->min == 0);
+	assert(histogram->max == HISTOGRAM_SUB_BUCKETS - 1);
+	assert(histogram_percentile(histogram, 0) == 0);
+	assert(histogram_percentile(histogram, 50) ==
+	       HISTOGRAM_SUB_BUCKETS / 2 - 1);
+	assert(histogram_percentile(histogram, 100) ==
+	       HISTOGRAM_SUB_BUCKETS - 1);
+	free(histogram);
+}
+
+static void test_histogram_negative(void)
+{
+	struct histogram *histogram = calloc(1, sizeof(*histogram));
+
+	/* We record how far off a value is, not which way. */
+	histogram_record(histogram, -5);
+	histogram_record(histogram, 7);
+	assert(histogram->min == 5);
+	assert(histogram->max == 7);
+	assert(histogram->sum == 12);
+	assert(histogram_percentile(histogram, 50) == 5);
+	free(histogram);
+}
+
+static void test_histogram_precision(void)
+{
+	struct histogram *histogram = calloc(1, sizeof(*histogram));
+	u64 value;
+	int i;
+
+	/* Percentiles of a wide spread of values are within 2%. */
+	for (i = 1; i <= 100000; ++i)
+		histogram_record(histogram, i);
+	assert(is_close(histogram_percentile(histogram, 50), 50000));
+	assert(is_close(histogram_percentile(histogram, 90), 90000));
+	assert(is_close(histogram_percentile(histogram, 99), 99000));
+	assert(is_close(histogram_percentile(histogram, 99.9), 99900));
+	assert(histogram_percentile(histogram, 100) == 100000);
+	free(histogram);
+
+	/* ...and so are those of single values of every magnitude. */
+	for (value = HISTOGRAM_SUB_BUCKETS; value < (1ULL << 38);
+	     value = value * 3 + 1) {
+		histogram = calloc(1, sizeof(*histogram));
+		histogram_record(histogram, value);
+		histogram_record(histogram, value * 2);
+		assert(is_close(histogram_percentile(histogram, 50), value));
+		assert(histogram_percentile(histogram, 100) == value * 2);
+		free(histogram);
+	}
+}
+
+static void test_histogram_overflow(void)
+{
+	struct histogram *histogram = calloc(1, sizeof(*histogram));
+
+	/* Values past the top bucket land in it, but max stays exact. */
+	histogram_record(histogram, 1LL << 50);
+	assert(histogram->counts[HISTOGRAM_BUCKETS - 1] == 1);
+	assert(histogram->max == 1ULL << 50);
+	assert(histogram_percentile(histogram, 50) > 0);
+	free(histogram);
+}
+
+static bool starts_with(const char *s, const char *prefix)
+{
+	return strncmp(s, prefix, strlen(prefix)) == 0;
+}
+
+/* Return the contents of the given file, which the caller must free. */
+static char *read_file(const char *path)
+{
+	FILE *f = fopen(path, "r");
+	char *contents = calloc(1, 4096);
+	size_t len;
+
+	assert(f != NULL);
+	len = fread(contents, 1, 4095, f);
+	contents[len] = '\0';
+	fclose(f);
+	return contents;
+}
+
+static void test_script_stats_write(void)
+{
+	char path[] = "/tmp/stats_test.XXXXXX";
+	struct script_stats *stats = script_stats_new();
+	char *contents, *line;
+	int fd;
+
+	fd = mkstemp(path);
+	assert(fd >= 0);
+	close(fd);
+	stats_report_init(path);
+
+	stats->packets_injected = 3;
+	stats->packets_sniffed = 4;
+	histogram_record(&stats->scheduling_error, 10);
+	script_stats_write(stats, path, "pass.pkt", 4000, true);
+
+	/* A failing script gets its line too, marked as failed. */
+	histogram_record(&stats->packet_timing_error, 5000);
+	script_stats_write(stats, path, "dir/\"fail\".pkt", 4000, false);
+
+	contents = read_file(path);
+	line = contents;
+	assert(starts_with(line, "{\"script\":\"pass.pkt\",\"passed\":true,"
+			   "\"tolerance_usecs\":4000,\"packets\":"
+			   "{\"injected\":3,\"sniffed\":4,\"ignored\":0},"
+			   "\"scheduling_error_usecs\":{\"count\":1,"));
+	line = strchr(line, '\n');
+	assert(line != NULL);
+	++line;
+	assert(starts_with(line, "{\"script\":\"dir/\\\"fail\\\".pkt\","
+			   "\"passed\":false,"));
+	assert(strstr(line, "\"packet_timing_error_usecs\":{\"count\":1,"
+		      "\"min\":5000,") != NULL);
+	line = strchr(line, '\n');
+	assert(line != NULL && line[1] == '\0');
+
+	/* A later packetdrill process appends to the same report. */
+	stats_report_init(path);
+	script_stats_write(stats, path, "next.pkt", 4000, true);
+	free(contents);
+	contents = read_file(path);
+	line = strchr(strchr(contents, '\n') + 1, '\n') + 1;
+	assert(starts_with(contents, "{\"script\":\"pass.pkt\","));
+	assert(starts_with(line, "{\"script\":\"next.pkt\","));
+
+	free(contents);
+	script_stats_free(stats);
+	unlink(path);
+}
+
+int main(void)
+{
+	test_histogram_empty();
+	test_histogram_exact();
+	test_histogram_negative();
+	test_histogram_precision();
+	test_histogram_overflow();
+	test_script_stats_write();
+	return 0;
+}
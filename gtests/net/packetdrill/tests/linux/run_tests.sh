@@ -1,6 +1,11 @@
 #!/bin/bash
+# Each script runs in its own network namespace, so there is no
+# shared tcp_metrics state to flush between them. Set PARALLEL=N to
+# run up to N scripts at once.
+if [ -n "$PARALLEL" ]; then
+  exec ../../packetdrill --parallel=$PARALLEL `find . -name "*.pkt" | sort`
+fi
 for f in `find . -name "*.pkt" | sort`; do
   echo "Running $f ..."
-  ip tcp_metrics flush all > /dev/null 2>&1
-  ../../packetdrill $f
+  ../../packetdrill --netns $f
 done
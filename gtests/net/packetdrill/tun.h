@@ -80,11 +80,16 @@
 /* TUNSETIFF ifr flags */
 #define IFF_TUN         0x0001
 #define IFF_TAP         0x0002
+#define IFF_NAPI        0x0010
+#define IFF_MULTI_QUEUE 0x0100
 #define IFF_NO_PI       0x1000
 #define IFF_ONE_QUEUE   0x2000
 #define IFF_VNET_HDR    0x4000
 #define IFF_TUN_EXCL    0x8000
 
+/* Most queues a multi-queue tun device may have. */
+#define TUN_MAX_QUEUES  256
+
 /* Features for GSO (TUNSETOFFLOAD). */
 #define TUN_F_CSUM      0x01    /* You can hand me unchecksummed packets. */
 #define TUN_F_TSO4      0x02    /* I can handle TSO for IPv4 packets */
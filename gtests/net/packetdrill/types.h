@@ -108,6 +108,7 @@ enum status_t {
 	STATUS_OK  = 0,
 	STATUS_ERR = -1,
 	STATUS_WARN = -2,	/* a non-fatal error or warning */
+	STATUS_TIMEOUT = -3,	/* a deadline passed before it happened */
 };
 
 /* The directions in which a packet may flow. */
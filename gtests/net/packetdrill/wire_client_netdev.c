@@ -150,7 +150,9 @@ static int wire_client_netdev_send(struct netdev *a_netdev,
 	return STATUS_ERR;
 }
 
-static int wire_client_netdev_receive(struct netdev *a_netdev, u8 udp_encaps,
+static int wire_client_netdev_receive(struct netdev *a_netdev,
+				      struct packet_pool *pool, u8 udp_encaps,
+				      s64 deadline_usecs,
 				      struct packet **packet, char **error)
 {
 	DEBUGP("wire_client_netdev_receive\n");
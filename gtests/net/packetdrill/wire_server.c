@@ -496,6 +496,7 @@ error_done:
 
 	if (wire_server->state != NULL)
 		state_free(wire_server->state, 0);
+	script_free(&wire_server->script);
 
 	DEBUGP("wire_server_thread: connection is done\n");
 	wire_server_free(wire_server);
@@ -130,6 +130,8 @@ struct netdev *wire_server_netdev_new(
 			      &config->live_gateway_ip);
 
 	netdev->psock = packet_socket_new(netdev->name);
+	if (config->packet_ring)
+		packet_socket_enable_ring(netdev->psock);
 
 	/* Make sure we only see packets from the machine under test. */
 	packet_socket_set_filter(netdev->psock,
@@ -185,7 +187,40 @@ static int wire_server_netdev_send(struct netdev *a_netdev,
 	return result;
 }
 
-static int wire_server_netdev_receive(struct netdev *a_netdev, u8 udp_encaps,
+/* Send a train of packets with one sendmmsg() where we can. */
+static int wire_server_netdev_send_batch(struct netdev *a_netdev,
+					 struct packet **packets,
+					 int num_packets)
+{
+	struct wire_server_netdev *netdev = to_server_netdev(a_netdev);
+	struct ether_header ether[NETDEV_MAX_BATCH];
+	struct iovec ether_frames[NETDEV_MAX_BATCH][2];
+	int address_family;
+	int i;
+
+	DEBUGP("wire_server_netdev_send_batch: %d packets\n", num_packets);
+
+	assert(num_packets <= NETDEV_MAX_BATCH);
+	for (i = 0; i < num_packets; ++i) {
+		address_family = packet_address_family(packets[i]);
+		ether_copy(ether[i].ether_dhost, &netdev->client_ether_addr);
+		ether_copy(ether[i].ether_shost, &netdev->server_ether_addr);
+		ether[i].ether_type =
+			htons(ether_type_for_family(address_family));
+		ether_frames[i][0].iov_base	= &ether[i];
+		ether_frames[i][0].iov_len	= sizeof(ether[i]);
+		ether_frames[i][1].iov_base	= packet_start(packets[i]);
+		ether_frames[i][1].iov_len	= packets[i]->ip_bytes;
+	}
+
+	return packet_socket_writev_batch(netdev->psock, &ether_frames[0][0],
+					  ARRAY_SIZE(ether_frames[0]),
+					  num_packets);
+}
+
+static int wire_server_netdev_receive(struct netdev *a_netdev,
+				      struct packet_pool *pool, u8 udp_encaps,
+				      s64 deadline_usecs,
 				      struct packet **packet, char **error)
 {
 	struct wire_server_netdev *netdev = to_server_netdev(a_netdev);
@@ -193,12 +228,14 @@ static int wire_server_netdev_receive(struct netdev *a_netdev, u8 udp_encaps,
 
 	DEBUGP("wire_server_netdev_receive\n");
 
-	return netdev_receive_loop(netdev->psock, DIRECTION_INBOUND, udp_encaps,
-				   packet, &num_packets, error);
+	return netdev_receive_loop(netdev->psock, pool, DIRECTION_INBOUND,
+				   udp_encaps, deadline_usecs, packet,
+				   &num_packets, error);
 }
 
 struct netdev_ops wire_server_netdev_ops = {
 	.free = wire_server_netdev_free,
 	.send = wire_server_netdev_send,
+	.send_batch = wire_server_netdev_send_batch,
 	.receive = wire_server_netdev_receive,
 };